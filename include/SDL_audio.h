@@ -173,7 +173,7 @@ typedef struct SDL_AudioSpec
 {
     int freq;                   /**< DSP frequency -- samples per second */
     SDL_AudioFormat format;     /**< Audio data format */
-    Uint8 channels;             /**< Number of channels: 1 mono, 2 stereo */
+    Uint8 channels;             /**< Number of channels: 1 mono, 2 stereo, 4 quad, 6 5.1, 8 7.1 */
     Uint8 silence;              /**< Audio buffer silence value (calculated) */
     Uint16 samples;             /**< Audio buffer size in samples (power of 2) */
     Uint16 padding;             /**< Necessary for some compile environments */
@@ -272,6 +272,8 @@ extern DECLSPEC const char *SDLCALL SDL_GetCurrentAudioDriver(void);
  *      and SDL_UnlockAudio() in your code.
  *    - \c desired->userdata is passed as the first parameter to your callback
  *      function.
+ *    - If \c desired->callback is NULL, the device plays audio pushed with
+ *      SDL_QueueAudio() instead.
  *  
  *  The audio device starts out playing silence when it's opened, and should
  *  be enabled for playing by calling \c SDL_PauseAudio(0) when you are ready
@@ -383,6 +385,70 @@ extern DECLSPEC void SDLCALL SDL_PauseAudioDevice(SDL_AudioDeviceID dev,
                                                   int pause_on);
 /*@}*//*Pause audio functions*/
 
+/**
+ *  \name Audio queue functions
+ *
+ *  A device opened with a NULL callback plays audio that is pushed to it,
+ *  in the format of the obtained spec, instead of pulling it from a
+ *  callback.  Pushing never blocks and never takes the audio lock: the
+ *  audio is copied into a ring buffer that the audio thread drains, and
+ *  silence is played whenever it runs dry.
+ *
+ *  Only one thread may queue audio to a given device.  The ring holds
+ *  eight buffers of audio by default; SDL_AUDIO_QUEUE_SIZE sets its size
+ *  in bytes instead.
+ */
+/*@{*/
+/**
+ *  Queue \c len bytes of audio to play on the device.
+ *
+ *  \return The number of bytes queued, which is less than \c len when the
+ *          queue is nearly full and is always a whole number of sample
+ *          frames, or -1 if the device doesn't queue audio.
+ */
+extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev,
+                                           const void *data, Uint32 len);
+
+/**
+ *  Get the number of bytes queued on the device and not yet played, or 0
+ *  if the device doesn't queue audio.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetQueuedAudioSize(SDL_AudioDeviceID dev);
+/*@}*//*Audio queue functions*/
+
+/**
+ *  \name Audio device statistics
+ *
+ *  The audio thread counts what it plays and times every callback.
+ *
+ *  The disk and dummy drivers can render offline, for baking audio or for
+ *  regression tests.  If SDL_AUDIO_FREEWHEEL is set to 1 they don't wait
+ *  for the device and run the callback as fast as it can go.  If
+ *  SDL_AUDIO_FREEWHEEL_FRAMES is set they stop after that many sample
+ *  frames, and the device status becomes ::SDL_AUDIO_STOPPED.  A
+ *  freewheeling app should take the time from \c frames, not from
+ *  SDL_GetTicks().
+ */
+/*@{*/
+typedef struct SDL_AudioDeviceStats
+{
+    Uint64 frames;              /**< Sample frames played, at the device rate */
+    Uint32 callbacks;           /**< Times the callback has run */
+    Uint32 callback_usec;       /**< Microseconds the last callback took */
+    Uint32 callback_usec_max;   /**< ...the longest callback took */
+    Uint64 callback_usec_total; /**< ...all the callbacks took together */
+} SDL_AudioDeviceStats;
+
+/**
+ *  Get the statistics of an open audio device.
+ *
+ *  \return 0 on success, or -1 if the device isn't open.
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceStats(SDL_AudioDeviceID dev,
+                                                    SDL_AudioDeviceStats *
+                                                    stats);
+/*@}*//*Audio device statistics*/
+
 /**
  *  This function loads a WAVE from the data source, automatically freeing
  *  that source if \c freesrc is non-zero.  For example, to load a WAVE file,
@@ -401,6 +467,9 @@ extern DECLSPEC void SDLCALL SDL_PauseAudioDevice(SDL_AudioDeviceID dev,
  *  This function returns NULL and sets the SDL error message if the 
  *  wave file cannot be opened, uses an unknown data format, or is 
  *  corrupt.  Currently raw and MS-ADPCM WAVE files are supported.
+ *
+ *  Long ADPCM files are decoded on a thread per CPU; SDL_WAVE_THREADS
+ *  sets the number of threads instead, or 0 for one per CPU.
  */
 extern DECLSPEC SDL_AudioSpec *SDLCALL SDL_LoadWAV_RW(SDL_RWops * src,
                                                       int freesrc,
@@ -420,6 +489,68 @@ extern DECLSPEC SDL_AudioSpec *SDLCALL SDL_LoadWAV_RW(SDL_RWops * src,
  */
 extern DECLSPEC void SDLCALL SDL_FreeWAV(Uint8 * audio_buf);
 
+/**
+ *  A WAV stream decodes a WAVE file a piece at a time, instead of loading
+ *  all of it like SDL_LoadWAV_RW().  Only the headers are read when it is
+ *  opened, and at most one ADPCM block is held in memory, so long music
+ *  tracks start straight away.  The stream owns the data source until it
+ *  is closed; don't read or seek it meanwhile.
+ */
+struct SDL_WAVStream;
+typedef struct SDL_WAVStream SDL_WAVStream;
+
+/**
+ *  Open a WAVE data source for streaming.  On success \c spec is filled in
+ *  as for SDL_LoadWAV_RW(), and ADPCM data is decoded to ::AUDIO_S16.
+ *
+ *  If \c freesrc is non-zero, the data source is closed when the stream
+ *  is, or right away if this fails.
+ *
+ *  \return The new stream, or NULL on error.
+ */
+extern DECLSPEC SDL_WAVStream *SDLCALL SDL_OpenWAVStream_RW(SDL_RWops * src,
+                                                            int freesrc,
+                                                            SDL_AudioSpec *
+                                                            spec);
+
+/**
+ *  Opens a WAV file for streaming.
+ */
+#define SDL_OpenWAVStream(file, spec) \
+	SDL_OpenWAVStream_RW(SDL_RWFromFile(file, "rb"),1, spec)
+
+/**
+ *  Decode up to \c len bytes of whole sample frames into \c buf.
+ *
+ *  \return The number of bytes decoded, 0 at the end of the data, or -1
+ *          on error.
+ */
+extern DECLSPEC int SDLCALL SDL_WAVStreamRead(SDL_WAVStream * stream,
+                                              void *buf, int len);
+
+/**
+ *  Make \c frame the next sample frame SDL_WAVStreamRead() returns.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_WAVStreamSeek(SDL_WAVStream * stream,
+                                              Uint32 frame);
+
+/**
+ *  \return The sample frame SDL_WAVStreamRead() returns next.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_WAVStreamTell(SDL_WAVStream * stream);
+
+/**
+ *  \return The number of sample frames in the stream.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_WAVStreamLength(SDL_WAVStream * stream);
+
+/**
+ *  Close a stream opened with SDL_OpenWAVStream_RW().
+ */
+extern DECLSPEC void SDLCALL SDL_CloseWAVStream(SDL_WAVStream * stream);
+
 /**
  *  This function takes a source format and rate and a destination format
  *  and rate, and initializes the \c cvt structure with information needed
@@ -449,6 +580,75 @@ extern DECLSPEC int SDLCALL SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
  */
 extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT * cvt);
 
+/**
+ *  An audio stream converts audio a block at a time.  Put data in with
+ *  SDL_AudioStreamPut() in the source format and get it back out with
+ *  SDL_AudioStreamGet() in the destination format, in blocks of any size.
+ *  Unlike SDL_ConvertAudio(), resampling keeps its filter history from one
+ *  block to the next, so block boundaries don't click.
+ *  
+ *  A stream is not locked: use it from one thread at a time.
+ */
+struct SDL_AudioStream;
+typedef struct SDL_AudioStream SDL_AudioStream;
+
+/**
+ *  Create a stream converting between the given formats.
+ *  
+ *  \return The new stream, or NULL on error.
+ */
+extern DECLSPEC SDL_AudioStream *SDLCALL SDL_NewAudioStream(SDL_AudioFormat
+                                                            src_format,
+                                                            Uint8
+                                                            src_channels,
+                                                            int src_rate,
+                                                            SDL_AudioFormat
+                                                            dst_format,
+                                                            Uint8
+                                                            dst_channels,
+                                                            int dst_rate);
+
+/**
+ *  Convert \c len bytes of source data, which must be whole sample frames.
+ *  
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamPut(SDL_AudioStream * stream,
+                                               const void *buf, int len);
+
+/**
+ *  Copy up to \c len bytes of converted data into \c buf.
+ *  
+ *  \return The number of bytes copied, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamGet(SDL_AudioStream * stream,
+                                               void *buf, int len);
+
+/**
+ *  \return The number of converted bytes ready to get.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamAvailable(SDL_AudioStream *
+                                                     stream);
+
+/**
+ *  Convert the last of the source data, which the resampler otherwise holds
+ *  back to look ahead into.  Call this at the end of a sound; the next
+ *  SDL_AudioStreamPut() starts a new one.
+ *  
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamFlush(SDL_AudioStream * stream);
+
+/**
+ *  Throw away any data waiting in the stream, converted or not.
+ */
+extern DECLSPEC void SDLCALL SDL_AudioStreamClear(SDL_AudioStream * stream);
+
+/**
+ *  Free a stream created with SDL_NewAudioStream().
+ */
+extern DECLSPEC void SDLCALL SDL_FreeAudioStream(SDL_AudioStream * stream);
+
 #define SDL_MIX_MAXVOLUME 128
 /**
  *  This takes two audio buffers of the playing audio format and mixes
@@ -470,6 +670,32 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
                                                 SDL_AudioFormat format,
                                                 Uint32 len, int volume);
 
+/**
+ *  One voice for SDL_MixAudioSources(): \c len bytes of audio in the mix
+ *  format, and a volume from 0 - ::SDL_MIX_MAXVOLUME.
+ */
+typedef struct SDL_AudioMixSource
+{
+    const Uint8 *buf;
+    int volume;
+} SDL_AudioMixSource;
+
+/**
+ *  This mixes any number of sources into \c dst at once, as if
+ *  SDL_MixAudioFormat() had been called for each of them, but the sum is
+ *  only clipped once at the end rather than after every source.
+ *
+ *  The existing contents of \c dst are part of the mix, at full volume.
+ *  Float samples are clipped to [-1.0, 1.0].  AUDIO_S16 and AUDIO_F32 in
+ *  either byte order are mixed in a single pass; other formats fall back
+ *  to SDL_MixAudioFormat() for each source.
+ */
+extern DECLSPEC void SDLCALL SDL_MixAudioSources(Uint8 * dst,
+                                                 const SDL_AudioMixSource *
+                                                 sources, int num_sources,
+                                                 SDL_AudioFormat format,
+                                                 Uint32 len);
+
 /**
  *  \name Audio lock functions
  *  
@@ -48,7 +48,10 @@ typedef enum
     
     SDL_BLENDMODE_BLEND = 0x00000002,    /**< dst = (src * A) + (dst * (1-A)) */
     SDL_BLENDMODE_ADD = 0x00000004,      /**< dst = (src * A) + dst */
-    SDL_BLENDMODE_MOD = 0x00000008       /**< dst = src * dst */
+    SDL_BLENDMODE_MOD = 0x00000008,      /**< dst = src * dst */
+    SDL_BLENDMODE_PREMULTIPLIED = 0x00000010 /**< dst = src + (dst * (1-A))
+                                                  (src is already multiplied
+                                                  by A) */
 } SDL_BlendMode;
 
 /* Ends C function definitions when using C++ */
@@ -317,6 +317,25 @@ extern DECLSPEC int SDLCALL SDL_SetSurfaceBlendMode(SDL_Surface * surface,
 extern DECLSPEC int SDLCALL SDL_GetSurfaceBlendMode(SDL_Surface * surface,
                                                     SDL_BlendMode *blendMode);
 
+/**
+ *  \brief Multiply the color of every pixel by its alpha, once, and switch
+ *         the surface to ::SDL_BLENDMODE_PREMULTIPLIED.
+ *  
+ *  Blending premultiplied pixels saves a multiply and a divide per channel
+ *  on every blit, so this is best done right after loading an image.
+ *  Surfaces without an alpha channel are left as they are.  A surface
+ *  whose blend mode is already ::SDL_BLENDMODE_PREMULTIPLIED is taken to
+ *  be converted, so it is left as it is and 0 is returned.
+ *  
+ *  \param surface The surface to convert.
+ *  
+ *  \return 0 on success, or -1 if the surface is not valid or can't be
+ *          locked.
+ *  
+ *  \sa SDL_SetSurfaceBlendMode()
+ */
+extern DECLSPEC int SDLCALL SDL_PremultiplySurfaceAlpha(SDL_Surface * surface);
+
 /**
  *  \brief Set the scale mode used for blit operations.
  *  
@@ -588,6 +607,30 @@ extern DECLSPEC int SDLCALL SDL_UpperBlit
     (SDL_Surface * src, const SDL_Rect * srcrect,
      SDL_Surface * dst, SDL_Rect * dstrect);
 
+/**
+ *  Performs a batch of blits from several source surfaces to one
+ *  destination surface.
+ *  
+ *  Blit \c i copies \c srcrects[i] of \c srcs[i] to \c dstrects[i], with
+ *  the same rules as SDL_BlitSurface().  Either rectangle array, or any
+ *  entry in it, may be NULL.  The final destination rectangles are saved
+ *  in \c dstrects after clipping.  The blits are done in array order, so
+ *  later ones draw over earlier ones where they overlap.
+ *  
+ *  The surfaces are checked and the destination is locked once for the
+ *  whole batch rather than for every blit, which helps when drawing many
+ *  small sprites or tiles, most of all onto an RLE accelerated surface.
+ *  The blits aren't grouped by source, and each source is mapped and
+ *  locked if it needs it, blit by blit, just as SDL_BlitSurface() does.
+ *  
+ *  \return 0 if all the blits succeeded, or -1 if any of them failed.
+ */
+#define SDL_BlitSurfaces SDL_UpperBlits
+
+extern DECLSPEC int SDLCALL SDL_UpperBlits
+    (SDL_Surface ** srcs, const SDL_Rect ** srcrects,
+     SDL_Surface * dst, SDL_Rect ** dstrects, int count);
+
 /**
  *  This is a semi-private blit function and it performs low-level surface
  *  blitting only.
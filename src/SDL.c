@@ -39,6 +39,9 @@ extern void SDL_StartTicks(void);
 extern int SDL_TimerInit(void);
 extern void SDL_TimerQuit(void);
 #endif
+#if !SDL_VIDEO_DISABLED
+extern void SDL_QuitBlitThreads(void);
+#endif
 #if defined(__WIN32__)
 extern int SDL_HelperWindowCreate(void);
 extern int SDL_HelperWindowDestroy(void);
@@ -227,6 +230,11 @@ SDL_Quit(void)
 #endif
     SDL_QuitSubSystem(SDL_INIT_EVERYTHING);
 
+#if !SDL_VIDEO_DISABLED
+    /* Surfaces can be blitted without the video subsystem */
+    SDL_QuitBlitThreads();
+#endif
+
 #ifdef CHECK_LEAKS
 #ifdef DEBUG_BUILD
     printf("[SDL_Quit] : CHECK_LEAKS\n");
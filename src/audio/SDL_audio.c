@@ -29,6 +29,12 @@
 #include "SDL_audiomem.h"
 #include "SDL_sysaudio.h"
 
+#if HAVE_CLOCK_GETTIME
+#include <time.h>
+#elif !defined(__WIN32__)
+#include <sys/time.h>
+#endif
+
 #define _THIS SDL_AudioDevice *_this
 
 static SDL_AudioDriver current_audio;
@@ -263,71 +269,117 @@ finalize_audio_entry_points(void)
 #undef FILL_STUB
 }
 
-/* Streaming functions (for when the input and output buffer sizes are different) */
-/* Write [length] bytes from buf into the streamer */
-static void
-SDL_StreamWrite(SDL_AudioStreamer * stream, Uint8 * buf, int length)
-{
-    int i;
+#if defined(ANDROID)
+#include <android/log.h>
+#endif
 
-    for (i = 0; i < length; ++i) {
-        stream->buffer[stream->write_pos] = buf[i];
-        ++stream->write_pos;
-    }
-}
+/* Default size of the queue, in buffers of audio */
+#define QUEUE_BUFFERS   8
 
-/* Read [length] bytes out of the streamer into buf */
-static void
-SDL_StreamRead(SDL_AudioStreamer * stream, Uint8 * buf, int length)
+/*
+ * The callback for devices opened without one: play whatever has been
+ *  queued, then silence. The app only ever moves queue_head and we only
+ *  move queue_tail, so the atomic adds are all the ordering we need:
+ *  the data is copied before the counter that makes it visible moves.
+ */
+static void SDLCALL
+SDL_AudioQueueCallback(void *userdata, Uint8 * stream, int len)
 {
-    int i;
+    SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
+    const Uint32 head = SDL_AtomicFetchThenAdd32(&device->queue_head, 0);
+    const Uint32 tail = device->queue_tail;
+    const Uint32 pos = tail & (device->queue_size - 1);
+    const Uint32 got = SDL_min(head - tail, (Uint32) len);
+    const Uint32 first = SDL_min(got, device->queue_size - pos);
 
-    for (i = 0; i < length; ++i) {
-        buf[i] = stream->buffer[stream->read_pos];
-        ++stream->read_pos;
+    SDL_memcpy(stream, device->queue + pos, first);
+    SDL_memcpy(stream + first, device->queue, got - first);
+    SDL_AtomicAddThenFetch32(&device->queue_tail, got);
+
+    if (got < (Uint32) len) {
+        SDL_memset(stream + got, device->queue_silence, len - got);
     }
 }
 
-static int
-SDL_StreamLength(SDL_AudioStreamer * stream)
+/* Microseconds since some fixed point, for timing the callback */
+static Uint64
+SDL_AudioTicksUsec(void)
 {
-    return (stream->write_pos - stream->read_pos) % stream->max_len;
+#if HAVE_CLOCK_GETTIME
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((Uint64) now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+#elif defined(__WIN32__)
+    return (Uint64) SDL_GetTicks() * 1000;
+#else
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return ((Uint64) now.tv_sec * 1000000) + now.tv_usec;
+#endif
 }
 
-/* Initialize the stream by allocating the buffer and setting the read/write heads to the beginning */
-#if 0
-static int
-SDL_StreamInit(SDL_AudioStreamer * stream, int max_len, Uint8 silence)
+/* Run the callback once, keeping track of how long it took */
+static void
+SDL_RunAudioCallback(SDL_AudioDevice * device, Uint8 * stream, int len)
 {
-    /* First try to allocate the buffer */
-    stream->buffer = (Uint8 *) SDL_malloc(max_len);
-    if (stream->buffer == NULL) {
-        return -1;
-    }
-
-    stream->max_len = max_len;
-    stream->read_pos = 0;
-    stream->write_pos = 0;
-
-    /* Zero out the buffer */
-    SDL_memset(stream->buffer, silence, max_len);
-
-    return 0;
+    Uint64 start;
+    Uint32 usec;
+
+    /* Queued audio is copied without the mixer lock */
+    if (device->queue) {
+        start = SDL_AudioTicksUsec();
+        (*device->spec.callback) (device->spec.userdata, stream, len);
+        usec = (Uint32) (SDL_AudioTicksUsec() - start);
+    } else {
+        SDL_mutexP(device->mixer_lock);
+        start = SDL_AudioTicksUsec();
+        (*device->spec.callback) (device->spec.userdata, stream, len);
+        usec = (Uint32) (SDL_AudioTicksUsec() - start);
+        SDL_mutexV(device->mixer_lock);
+    }
+
+    SDL_AtomicLock(&device->stats_lock);
+    device->stats.callbacks++;
+    device->stats.callback_usec = usec;
+    device->stats.callback_usec_max =
+        SDL_max(device->stats.callback_usec_max, usec);
+    device->stats.callback_usec_total += usec;
+    SDL_AtomicUnlock(&device->stats_lock);
 }
-#endif
 
-/* Deinitialize the stream simply by freeing the buffer */
+/*
+ * Play a filled buffer and wait until the next one can be filled. When
+ *  freewheeling there's no waiting, and a fixed length render stops the
+ *  thread once the last frame is out.
+ */
 static void
-SDL_StreamDeinit(SDL_AudioStreamer * stream)
+SDL_PlayAudioBuffer(SDL_AudioDevice * device, Uint8 * stream, Uint32 delay)
 {
-    if (stream->buffer != NULL) {
-        SDL_free(stream->buffer);
+    Uint64 frames = device->spec.samples;
+
+    if (stream != device->fake_stream) {
+        current_audio.impl.PlayDevice(device);
     }
-}
 
-#if defined(ANDROID)
-#include <android/log.h>
-#endif
+    SDL_AtomicLock(&device->stats_lock);
+    if (device->freewheel_frames &&
+        (device->stats.frames + frames >= device->freewheel_frames)) {
+        frames = device->freewheel_frames - device->stats.frames;
+        device->enabled = 0;
+    }
+    device->stats.frames += frames;
+    SDL_AtomicUnlock(&device->stats_lock);
+
+    if (device->freewheel) {
+        return;
+    }
+    if (stream != device->fake_stream) {
+        /* Wait for an audio buffer to become available */
+        current_audio.impl.WaitDevice(device);
+    } else {
+        SDL_Delay(delay);
+    }
+}
 
 /* The general mixing thread function */
 int SDLCALL
@@ -336,57 +388,30 @@ SDL_RunAudio(void *devicep)
     SDL_AudioDevice *device = (SDL_AudioDevice *) devicep;
     Uint8 *stream;
     int stream_len;
-    void *udata;
-    void (SDLCALL * fill) (void *userdata, Uint8 * stream, int len);
     int silence;
     Uint32 delay;
 
     /* For streaming when the buffer sizes don't match up */
-    Uint8 *istream;
+    Uint8 *istream = NULL;
     int istream_len = 0;
+    int got;
 
     /* Perform any thread setup */
     device->threadid = SDL_ThreadID();
     current_audio.impl.ThreadInit(device);
 
-    /* Set up the mixing function */
-    fill = device->spec.callback;
-    udata = device->spec.userdata;
-
-    /* By default do not stream */
-    device->use_streamer = 0;
-
     if (device->convert.needed) {
         if (device->convert.src_format == AUDIO_U8) {
             silence = 0x80;
         } else {
             silence = 0;
         }
-
-#if 0                           /* !!! FIXME: I took len_div out of the structure. Use rate_incr instead? */
-        /* If the result of the conversion alters the length, i.e. resampling is being used, use the streamer */
-        if (device->convert.len_mult != 1 || device->convert.len_div != 1) {
-            /* The streamer's maximum length should be twice whichever is larger: spec.size or len_cvt */
-            stream_max_len = 2 * device->spec.size;
-            if (device->convert.len_mult > device->convert.len_div) {
-                stream_max_len *= device->convert.len_mult;
-                stream_max_len /= device->convert.len_div;
-            }
-            if (SDL_StreamInit(&device->streamer, stream_max_len, silence) <
-                0)
-                return -1;
-            device->use_streamer = 1;
-
-            /* istream_len should be the length of what we grab from the callback and feed to conversion,
-               so that we get close to spec_size. I.e. we want device.spec_size = istream_len * u / d
-             */
-            istream_len =
-                device->spec.size * device->convert.len_div /
-                device->convert.len_mult;
-        }
-#endif
-
-        /* stream_len = device->convert.len; */
+        stream_len = device->convert.len;
+    } else if (device->use_streamer) {
+        /* The callback fills blocks in the app's format and rate */
+        istream = device->streamer_buf;
+        istream_len = device->streamer_len;
+        silence = device->spec.silence;
         stream_len = device->spec.size;
     } else {
         silence = device->spec.silence;
@@ -398,17 +423,12 @@ SDL_RunAudio(void *devicep)
 
     /* Determine if the streamer is necessary here */
     if (device->use_streamer == 1) {
-        /* This code is almost the same as the old code. The difference is, instead of reading
-           directly from the callback into "stream", then converting and sending the audio off,
-           we go: callback -> "istream" -> (conversion) -> streamer -> stream -> device.
-           However, reading and writing with streamer are done separately:
-           - We only call the callback and write to the streamer when the streamer does not
-           contain enough samples to output to the device.
-           - We only read from the streamer and tell the device to play when the streamer
-           does have enough samples to output.
-           This allows us to perform resampling in the conversion step, where the output of the
-           resampling process can be any number. We will have to see what a good size for the
-           stream's maximum length is, but I suspect 2*max(len_cvt, stream_len) is a good figure.
+        /* Resampling changes the length of the data, so we go:
+           callback -> "istream" -> streamer -> stream -> device.
+           The callback runs until the streamer holds a whole device
+           buffer, then that much is read out and played; whatever is left
+           over waits for the next buffer, along with the resampler's
+           history.
          */
         while (device->enabled) {
 
@@ -417,73 +437,31 @@ SDL_RunAudio(void *devicep)
                 continue;
             }
 
-            /* Only read in audio if the streamer doesn't have enough already (if it does not have enough samples to output) */
-            if (SDL_StreamLength(&device->streamer) < stream_len) {
-                /* Set up istream */
-                if (device->convert.needed) {
-                    if (device->convert.buf) {
-                        istream = device->convert.buf;
-                    } else {
-                        continue;
-                    }
-                } else {
-/* FIXME: Ryan, this is probably wrong.  I imagine we don't want to get
- * a device buffer both here and below in the stream output.
- */
-                    istream = current_audio.impl.GetDeviceBuf(device);
-                    if (istream == NULL) {
-                        istream = device->fake_stream;
-                    }
-                }
+            /* Only read in audio if the streamer doesn't have enough already */
+            while (SDL_AudioStreamAvailable(device->streamer) < stream_len) {
+                SDL_RunAudioCallback(device, istream, istream_len);
 
-                /* Read from the callback into the _input_ stream */
-                SDL_mutexP(device->mixer_lock);
-                (*fill) (udata, istream, istream_len);
-                SDL_mutexV(device->mixer_lock);
-
-                /* Convert the audio if necessary and write to the streamer */
-                if (device->convert.needed) {
-                    SDL_ConvertAudio(&device->convert);
-                    if (istream == NULL) {
-                        istream = device->fake_stream;
-                    }
-                    /*SDL_memcpy(istream, device->convert.buf, device->convert.len_cvt); */
-                    SDL_StreamWrite(&device->streamer, device->convert.buf,
-                                    device->convert.len_cvt);
-                } else {
-                    SDL_StreamWrite(&device->streamer, istream, istream_len);
+                if (SDL_AudioStreamPut(device->streamer, istream,
+                                       istream_len) < 0) {
+                    break;
                 }
             }
 
-            /* Only output audio if the streamer has enough to output */
-            if (SDL_StreamLength(&device->streamer) >= stream_len) {
-                /* Set up the output stream */
-                if (device->convert.needed) {
-                    if (device->convert.buf) {
-                        stream = device->convert.buf;
-                    } else {
-                        continue;
-                    }
-                } else {
-                    stream = current_audio.impl.GetDeviceBuf(device);
-                    if (stream == NULL) {
-                        stream = device->fake_stream;
-                    }
-                }
-
-                /* Now read from the streamer */
-                SDL_StreamRead(&device->streamer, stream, stream_len);
+            stream = current_audio.impl.GetDeviceBuf(device);
+            if (stream == NULL) {
+                stream = device->fake_stream;
+            }
 
-                /* Ready current buffer for play and change current buffer */
-                if (stream != device->fake_stream) {
-                    current_audio.impl.PlayDevice(device);
-                    /* Wait for an audio buffer to become available */
-                    current_audio.impl.WaitDevice(device);
-                } else {
-                    SDL_Delay(delay);
-                }
+            /* Now read from the streamer, padding with silence if the
+               callback data couldn't be converted */
+            got = SDL_AudioStreamGet(device->streamer, stream, stream_len);
+            if (got < stream_len) {
+                got = SDL_max(got, 0);
+                SDL_memset(stream + got, silence, stream_len - got);
             }
 
+            /* Ready current buffer for play and change current buffer */
+            SDL_PlayAudioBuffer(device, stream, delay);
         }
     } else {
         /* Otherwise, do not use the streamer. This is the old code. */
@@ -510,9 +488,7 @@ SDL_RunAudio(void *devicep)
                 }
             }
 
-            SDL_mutexP(device->mixer_lock);
-            (*fill) (udata, stream, stream_len);
-            SDL_mutexV(device->mixer_lock);
+            SDL_RunAudioCallback(device, stream, stream_len);
 
             /* Convert the audio if necessary */
             if (device->convert.needed) {
@@ -526,23 +502,13 @@ SDL_RunAudio(void *devicep)
             }
 
             /* Ready current buffer for play and change current buffer */
-            if (stream != device->fake_stream) {
-                current_audio.impl.PlayDevice(device);
-                /* Wait for an audio buffer to become available */
-                current_audio.impl.WaitDevice(device);
-            } else {
-                SDL_Delay(delay);
-            }
+            SDL_PlayAudioBuffer(device, stream, delay);
         }
     }
 
     /* Wait for the audio to drain.. */
     current_audio.impl.WaitDone(device);
 
-    /* If necessary, deinit the streamer */
-    if (device->use_streamer == 1)
-        SDL_StreamDeinit(&device->streamer);
-
     return (0);
 }
 
@@ -719,6 +685,15 @@ close_audio_device(SDL_AudioDevice * device)
     if (device->convert.needed) {
         SDL_FreeAudioMem(device->convert.buf);
     }
+    if (device->streamer != NULL) {
+        SDL_FreeAudioStream(device->streamer);
+    }
+    if (device->streamer_buf != NULL) {
+        SDL_FreeAudioMem(device->streamer_buf);
+    }
+    if (device->queue != NULL) {
+        SDL_free(device->queue);
+    }
     if (device->opened) {
         current_audio.impl.CloseDevice(device);
         device->opened = 0;
@@ -737,11 +712,6 @@ prepare_audiospec(const SDL_AudioSpec * orig, SDL_AudioSpec * prepared)
 {
     SDL_memcpy(prepared, orig, sizeof(SDL_AudioSpec));
 
-    if (orig->callback == NULL) {
-        SDL_SetError("SDL_OpenAudio() passed a NULL callback");
-        return 0;
-    }
-
     if (orig->freq == 0) {
         const char *env = SDL_getenv("SDL_AUDIO_FREQUENCY");
         if ((!env) || ((prepared->freq = SDL_atoi(env)) == 0)) {
@@ -768,6 +738,7 @@ prepare_audiospec(const SDL_AudioSpec * orig, SDL_AudioSpec * prepared)
     case 2:                    /* Stereo */
     case 4:                    /* surround */
     case 6:                    /* surround with center and lfe */
+    case 8:                    /* 7.1 surround */
         break;
     default:
         SDL_SetError("Unsupported number of audio channels.");
@@ -816,6 +787,11 @@ open_audio_device(const char *devname, int iscapture,
         return 0;
     }
 
+    if ((iscapture) && (desired->callback == NULL)) {
+        SDL_SetError("SDL_OpenAudio() passed a NULL capture callback");
+        return 0;
+    }
+
     if (!obtained) {
         obtained = &_obtained;
     }
@@ -875,10 +851,26 @@ open_audio_device(const char *devname, int iscapture,
     }
     SDL_memset(device, '\0', sizeof(SDL_AudioDevice));
     device->spec = *obtained;
+    if (device->spec.callback == NULL) {
+        device->spec.callback = SDL_AudioQueueCallback;
+        device->spec.userdata = device;
+    }
     device->enabled = 1;
     device->paused = 1;
     device->iscapture = iscapture;
 
+    /* Drivers that lose nothing by not waiting can render offline */
+    if ((!iscapture) && (current_audio.impl.CanFreewheel)) {
+        const char *env = SDL_getenv("SDL_AUDIO_FREEWHEEL");
+        if ((env) && (SDL_atoi(env) != 0)) {
+            device->freewheel = 1;
+        }
+        env = SDL_getenv("SDL_AUDIO_FREEWHEEL_FRAMES");
+        if (env) {
+            device->freewheel_frames = SDL_strtoull(env, NULL, 10);
+        }
+    }
+
     /* Create a semaphore for locking the sound buffers */
     if (!current_audio.impl.SkipMixerLock) {
         device->mixer_lock = SDL_CreateMutex();
@@ -932,7 +924,28 @@ open_audio_device(const char *devname, int iscapture,
             build_cvt = SDL_TRUE;
         }
     }
-    if (build_cvt) {
+    if (build_cvt && (obtained->freq != device->spec.freq)) {
+        /* Resampling changes the block size, so stream the conversion */
+        device->streamer = SDL_NewAudioStream(obtained->format,
+                                              obtained->channels,
+                                              obtained->freq,
+                                              device->spec.format,
+                                              device->spec.channels,
+                                              device->spec.freq);
+        if (device->streamer == NULL) {
+            close_audio_device(device);
+            return 0;
+        }
+        device->streamer_len = obtained->size;
+        device->streamer_buf =
+            (Uint8 *) SDL_AllocAudioMem(device->streamer_len);
+        if (device->streamer_buf == NULL) {
+            close_audio_device(device);
+            SDL_OutOfMemory();
+            return 0;
+        }
+        device->use_streamer = 1;
+    } else if (build_cvt) {
         /* Build an audio conversion block */
         if (SDL_BuildAudioCVT(&device->convert,
                               obtained->format, obtained->channels,
@@ -943,7 +956,7 @@ open_audio_device(const char *devname, int iscapture,
             return 0;
         }
         if (device->convert.needed) {
-            device->convert.len = (int) (((double) obtained->size) /
+            device->convert.len = (int) (((double) device->spec.size) /
                                          device->convert.len_ratio);
 
             device->convert.buf =
@@ -957,6 +970,29 @@ open_audio_device(const char *devname, int iscapture,
         }
     }
 
+    /* Set up the queue, if the app is going to push audio */
+    if (obtained->callback == NULL) {
+        const char *env = SDL_getenv("SDL_AUDIO_QUEUE_SIZE");
+        Uint32 wanted = obtained->size * QUEUE_BUFFERS;
+        if (env && SDL_atoi(env) > 0) {
+            wanted = (Uint32) SDL_atoi(env);
+        }
+        device->queue_size = 1;
+        while ((device->queue_size < wanted) &&
+               (device->queue_size < 0x40000000)) {
+            device->queue_size *= 2;
+        }
+        device->queue = (Uint8 *) SDL_malloc(device->queue_size);
+        if (device->queue == NULL) {
+            close_audio_device(device);
+            SDL_OutOfMemory();
+            return 0;
+        }
+        device->queue_framesize =
+            (SDL_AUDIO_BITSIZE(obtained->format) / 8) * obtained->channels;
+        device->queue_silence = obtained->silence;
+    }
+
     /* Find an available device ID and store the structure... */
     for (id = min_id - 1; id < SDL_arraysize(open_devices); id++) {
         if (open_devices[id] == NULL) {
@@ -1050,6 +1086,21 @@ SDL_GetAudioDeviceStatus(SDL_AudioDeviceID devid)
 }
 
 
+int
+SDL_GetAudioDeviceStats(SDL_AudioDeviceID devid,
+                        SDL_AudioDeviceStats * stats)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    if (!device) {
+        return -1;
+    }
+    SDL_AtomicLock(&device->stats_lock);
+    *stats = device->stats;
+    SDL_AtomicUnlock(&device->stats_lock);
+    return 0;
+}
+
+
 SDL_AudioStatus
 SDL_GetAudioStatus(void)
 {
@@ -1072,6 +1123,48 @@ SDL_PauseAudio(int pause_on)
 }
 
 
+int
+SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    Uint32 head, tail, pos, first;
+
+    if (!device) {
+        return -1;
+    }
+    if (device->queue == NULL) {
+        SDL_SetError("Audio device has a callback, it can't queue audio");
+        return -1;
+    }
+
+    /* Only this thread moves the head, and the tail only ever grows */
+    head = device->queue_head;
+    tail = SDL_AtomicFetchThenAdd32(&device->queue_tail, 0);
+    len = SDL_min(len, device->queue_size - (head - tail));
+    len -= len % device->queue_framesize;
+
+    pos = head & (device->queue_size - 1);
+    first = SDL_min(len, device->queue_size - pos);
+    SDL_memcpy(device->queue + pos, data, first);
+    SDL_memcpy(device->queue, (const Uint8 *) data + first, len - first);
+    SDL_AtomicAddThenFetch32(&device->queue_head, len);
+
+    return (int) len;
+}
+
+Uint32
+SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    Uint32 tail;
+
+    if (!device || (device->queue == NULL)) {
+        return 0;
+    }
+    tail = SDL_AtomicFetchThenAdd32(&device->queue_tail, 0);
+    return SDL_AtomicFetchThenAdd32(&device->queue_head, 0) - tail;
+}
+
 void
 SDL_LockAudioDevice(SDL_AudioDeviceID devid)
 {
@@ -33,6 +33,13 @@ extern void SDL_CalculateAudioSpec(SDL_AudioSpec * spec);
 /* The actual mixing thread function */
 extern int SDLCALL SDL_RunAudio(void *audiop);
 
+/* Vector units the converters and the mixer may use */
+#define SDL_AUDIO_CPU_ANY       0x00000000
+#define SDL_AUDIO_CPU_SSE2      0x00000001
+
+/* Detected features, or SDL_AUDIO_CPU_FEATURES if that is set */
+extern Uint32 SDL_GetAudioCPUFeatures(void);
+
 /* this is used internally to access some autogenerated code. */
 typedef struct
 {
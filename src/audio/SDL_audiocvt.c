@@ -24,8 +24,14 @@
 /* Functions for audio drivers to perform runtime conversion of audio format */
 
 #include "SDL_audio.h"
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
 #include "SDL_audio_c.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /* #define DEBUG_CONVERT */
 
 /* !!! FIXME */
@@ -43,7 +49,8 @@ SDL_ConvertMono(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 #ifdef DEBUG_CONVERT
     fprintf(stderr, "Converting to mono\n");
 #endif
-    switch (format & (SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
+    switch (format & (SDL_AUDIO_MASK_DATATYPE | SDL_AUDIO_MASK_SIGNED |
+                      SDL_AUDIO_MASK_BITSIZE)) {
     case AUDIO_U8:
         {
             Uint8 *src, *dst;
@@ -335,14 +342,15 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
     fprintf(stderr, "Converting stereo to surround\n");
 #endif
 
-    switch (format & (SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
+    switch (format & (SDL_AUDIO_MASK_DATATYPE | SDL_AUDIO_MASK_SIGNED |
+                      SDL_AUDIO_MASK_BITSIZE)) {
     case AUDIO_U8:
         {
             Uint8 *src, *dst, lf, rf, ce;
 
             src = (Uint8 *) (cvt->buf + cvt->len_cvt);
             dst = (Uint8 *) (cvt->buf + cvt->len_cvt * 3);
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 6;
                 src -= 2;
                 lf = src[0];
@@ -364,7 +372,7 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 
             src = (Sint8 *) cvt->buf + cvt->len_cvt;
             dst = (Sint8 *) cvt->buf + cvt->len_cvt * 3;
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 6;
                 src -= 2;
                 lf = src[0];
@@ -503,8 +511,8 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
     case AUDIO_S32:
         {
             Sint32 lf, rf, ce;
-            const Uint32 *src = (const Uint32 *) cvt->buf + cvt->len_cvt;
-            Uint32 *dst = (Uint32 *) cvt->buf + cvt->len_cvt * 3;
+            const Uint32 *src = (const Uint32 *) (cvt->buf + cvt->len_cvt);
+            Uint32 *dst = (Uint32 *) (cvt->buf + cvt->len_cvt * 3);
 
             if (SDL_AUDIO_ISBIGENDIAN(format)) {
                 for (i = cvt->len_cvt / 8; i; --i) {
@@ -541,8 +549,8 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
     case AUDIO_F32:
         {
             float lf, rf, ce;
-            const float *src = (const float *) cvt->buf + cvt->len_cvt;
-            float *dst = (float *) cvt->buf + cvt->len_cvt * 3;
+            const float *src = (const float *) (cvt->buf + cvt->len_cvt);
+            float *dst = (float *) (cvt->buf + cvt->len_cvt * 3);
 
             if (SDL_AUDIO_ISBIGENDIAN(format)) {
                 for (i = cvt->len_cvt / 8; i; --i) {
@@ -599,7 +607,7 @@ SDL_ConvertSurround_4(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 
             src = (Uint8 *) (cvt->buf + cvt->len_cvt);
             dst = (Uint8 *) (cvt->buf + cvt->len_cvt * 2);
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 4;
                 src -= 2;
                 lf = src[0];
@@ -619,7 +627,7 @@ SDL_ConvertSurround_4(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 
             src = (Sint8 *) cvt->buf + cvt->len_cvt;
             dst = (Sint8 *) cvt->buf + cvt->len_cvt * 2;
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 4;
                 src -= 2;
                 lf = src[0];
@@ -774,6 +782,233 @@ SDL_ConvertSurround_4(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 }
 
 
+/* Bits of a silent sample as they are laid out in memory */
+static Uint32
+SDL_SilenceBits(SDL_AudioFormat format)
+{
+    if (SDL_AUDIO_ISSIGNED(format)) {
+        return 0;
+    }
+    if (SDL_AUDIO_BITSIZE(format) == 8) {
+        return 0x80;
+    }
+    return SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE16(0x8000) :
+        SDL_SwapLE16(0x8000);
+}
+
+/*
+ * 7.1 streams are laid out FL FR FC LFE SL SR BL BR, which is the order
+ *  of the PS3 8 channel port. 5.1 streams keep the order the converters
+ *  above produce: FL FR BL BR FC LFE.
+ */
+
+/* Put a stereo stream on the front pair of a 7.1 stream */
+static void SDLCALL
+SDL_ConvertSurround_8(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    int i;
+
+#ifdef DEBUG_CONVERT
+    fprintf(stderr, "Converting stereo to 7.1\n");
+#endif
+
+#define map_chans_2_to_8(type) \
+    { \
+        const type silence = (type) SDL_SilenceBits(format); \
+        const type *src = (const type *) (cvt->buf + cvt->len_cvt); \
+        type *dst = (type *) (cvt->buf + cvt->len_cvt * 4); \
+        for (i = cvt->len_cvt / (sizeof (type) * 2); i; --i) { \
+            type lf, rf; \
+            src -= 2; \
+            dst -= 8; \
+            lf = src[0]; \
+            rf = src[1]; \
+            dst[0] = lf; \
+            dst[1] = rf; \
+            dst[2] = dst[3] = dst[4] = dst[5] = dst[6] = dst[7] = silence; \
+        } \
+    }
+
+    /* this function only cares about typesize, and data as a block of bits. */
+    switch (SDL_AUDIO_BITSIZE(format)) {
+    case 8:
+        map_chans_2_to_8(Uint8);
+        break;
+    case 16:
+        map_chans_2_to_8(Uint16);
+        break;
+    case 32:
+        map_chans_2_to_8(Uint32);
+        break;
+    }
+
+#undef map_chans_2_to_8
+
+    cvt->len_cvt *= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index] (cvt, format);
+    }
+}
+
+
+/* Move a 5.1 stream into 7.1 order, surrounds on the side pair */
+static void SDLCALL
+SDL_ConvertSurround_6_8(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    int i;
+
+#ifdef DEBUG_CONVERT
+    fprintf(stderr, "Converting 5.1 to 7.1\n");
+#endif
+
+#define map_chans_6_to_8(type) \
+    { \
+        const type silence = (type) SDL_SilenceBits(format); \
+        const type *src = (const type *) (cvt->buf + cvt->len_cvt); \
+        type *dst = (type *) (cvt->buf + (cvt->len_cvt / 6) * 8); \
+        for (i = cvt->len_cvt / (sizeof (type) * 6); i; --i) { \
+            type lf, rf, lr, rr, ce, lfe; \
+            src -= 6; \
+            dst -= 8; \
+            lf = src[0]; \
+            rf = src[1]; \
+            lr = src[2]; \
+            rr = src[3]; \
+            ce = src[4]; \
+            lfe = src[5]; \
+            dst[0] = lf; \
+            dst[1] = rf; \
+            dst[2] = ce; \
+            dst[3] = lfe; \
+            dst[4] = lr; \
+            dst[5] = rr; \
+            dst[6] = dst[7] = silence; \
+        } \
+    }
+
+    /* this function only cares about typesize, and data as a block of bits. */
+    switch (SDL_AUDIO_BITSIZE(format)) {
+    case 8:
+        map_chans_6_to_8(Uint8);
+        break;
+    case 16:
+        map_chans_6_to_8(Uint16);
+        break;
+    case 32:
+        map_chans_6_to_8(Uint32);
+        break;
+    }
+
+#undef map_chans_6_to_8
+
+    cvt->len_cvt = (cvt->len_cvt / 6) * 8;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index] (cvt, format);
+    }
+}
+
+
+/* Fold a 7.1 stream down to stereo: each side gets 2/5 of its front
+   channel and 1/5 each of center, side and back. LFE is dropped. */
+static void SDLCALL
+SDL_ConvertDownmix_8(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    int i;
+
+#ifdef DEBUG_CONVERT
+    fprintf(stderr, "Converting 7.1 down to stereo\n");
+#endif
+
+#define downmix_chans_8_to_2(type, stype, swap) \
+    { \
+        const type *src = (const type *) cvt->buf; \
+        type *dst = (type *) cvt->buf; \
+        for (i = cvt->len_cvt / (sizeof (type) * 8); i; --i) { \
+            const Sint64 ce = (stype) swap(src[2]); \
+            const Sint64 lf = ((stype) swap(src[0])) * 2 + ce + \
+                (stype) swap(src[4]) + (stype) swap(src[6]); \
+            const Sint64 rf = ((stype) swap(src[1])) * 2 + ce + \
+                (stype) swap(src[5]) + (stype) swap(src[7]); \
+            dst[0] = swap((type) (stype) (lf / 5)); \
+            dst[1] = swap((type) (stype) (rf / 5)); \
+            src += 8; \
+            dst += 2; \
+        } \
+    }
+#define downmix_nop(x) (x)
+
+    switch (format & (SDL_AUDIO_MASK_DATATYPE | SDL_AUDIO_MASK_SIGNED |
+                      SDL_AUDIO_MASK_BITSIZE)) {
+    case AUDIO_U8:
+        downmix_chans_8_to_2(Uint8, Uint8, downmix_nop);
+        break;
+    case AUDIO_S8:
+        downmix_chans_8_to_2(Uint8, Sint8, downmix_nop);
+        break;
+    case AUDIO_U16:
+        if (SDL_AUDIO_ISBIGENDIAN(format)) {
+            downmix_chans_8_to_2(Uint16, Uint16, SDL_SwapBE16);
+        } else {
+            downmix_chans_8_to_2(Uint16, Uint16, SDL_SwapLE16);
+        }
+        break;
+    case AUDIO_S16:
+        if (SDL_AUDIO_ISBIGENDIAN(format)) {
+            downmix_chans_8_to_2(Uint16, Sint16, SDL_SwapBE16);
+        } else {
+            downmix_chans_8_to_2(Uint16, Sint16, SDL_SwapLE16);
+        }
+        break;
+    case AUDIO_S32:
+        if (SDL_AUDIO_ISBIGENDIAN(format)) {
+            downmix_chans_8_to_2(Uint32, Sint32, SDL_SwapBE32);
+        } else {
+            downmix_chans_8_to_2(Uint32, Sint32, SDL_SwapLE32);
+        }
+        break;
+    case AUDIO_F32:
+        {
+            const float *src = (const float *) cvt->buf;
+            float *dst = (float *) cvt->buf;
+            if (SDL_AUDIO_ISBIGENDIAN(format)) {
+                for (i = cvt->len_cvt / 32; i; --i, src += 8, dst += 2) {
+                    const float ce = SDL_SwapFloatBE(src[2]);
+                    const float lf = SDL_SwapFloatBE(src[0]) * 0.4f +
+                        (ce + SDL_SwapFloatBE(src[4]) +
+                         SDL_SwapFloatBE(src[6])) * 0.2f;
+                    const float rf = SDL_SwapFloatBE(src[1]) * 0.4f +
+                        (ce + SDL_SwapFloatBE(src[5]) +
+                         SDL_SwapFloatBE(src[7])) * 0.2f;
+                    dst[0] = SDL_SwapFloatBE(lf);
+                    dst[1] = SDL_SwapFloatBE(rf);
+                }
+            } else {
+                for (i = cvt->len_cvt / 32; i; --i, src += 8, dst += 2) {
+                    const float ce = SDL_SwapFloatLE(src[2]);
+                    const float lf = SDL_SwapFloatLE(src[0]) * 0.4f +
+                        (ce + SDL_SwapFloatLE(src[4]) +
+                         SDL_SwapFloatLE(src[6])) * 0.2f;
+                    const float rf = SDL_SwapFloatLE(src[1]) * 0.4f +
+                        (ce + SDL_SwapFloatLE(src[5]) +
+                         SDL_SwapFloatLE(src[7])) * 0.2f;
+                    dst[0] = SDL_SwapFloatLE(lf);
+                    dst[1] = SDL_SwapFloatLE(rf);
+                }
+            }
+        }
+        break;
+    }
+
+#undef downmix_nop
+#undef downmix_chans_8_to_2
+
+    cvt->len_cvt /= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index] (cvt, format);
+    }
+}
+
+
 int
 SDL_ConvertAudio(SDL_AudioCVT * cvt)
 {
@@ -798,6 +1033,410 @@ SDL_ConvertAudio(SDL_AudioCVT * cvt)
 }
 
 
+/*
+ * Vectorised converters for the sample type pairs the mixer and the drivers
+ * hit all the time: S16 and S32 to and from float in either byte order,
+ * U8 to float, and the pairs that only swap bytes. They are picked from
+ * SDL_HandTunedTypeCVT() according to the CPU we are running on, in the
+ * same way SDL_ChooseBlitFunc() picks blitters; SDL_AUDIO_CPU_FEATURES
+ * overrides the detected features (0 forces the autogenerated converters).
+ *
+ * Results match the autogenerated converters for samples in range. Out of
+ * range floats saturate instead of wrapping.
+ */
+
+#define TYPECVT_DIVBY127        0.0078740157480315f
+#define TYPECVT_DIVBY32767      3.05185094759972e-05f
+#define TYPECVT_DIVBY2147483647 4.6566128752458e-10f
+
+/* Whether samples in each byte order must be swapped on this CPU */
+#define TYPECVT_LSB (SDL_BYTEORDER == SDL_BIG_ENDIAN)
+#define TYPECVT_MSB (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+
+#ifdef __SSE2__
+
+typedef struct
+{
+    SDL_AudioFormat src_fmt;
+    SDL_AudioFormat dst_fmt;
+    Uint32 cpu;
+    SDL_AudioFilter filter;
+} SDL_AudioTypeCVTEntry;
+
+/* One sample at a time, for the ragged ends of the vector loops */
+static __inline__ float
+SDL_CvtLoadF32(const float *src, const int swap)
+{
+    return swap ? SDL_SwapFloat(*src) : *src;
+}
+
+static __inline__ void
+SDL_CvtStoreF32(float *dst, const float val, const int swap)
+{
+    *dst = swap ? SDL_SwapFloat(val) : val;
+}
+
+static __inline__ float
+SDL_CvtS16Sample(const Uint16 *src, const int swap)
+{
+    return ((float) ((Sint16) (swap ? SDL_Swap16(*src) : *src))) *
+        TYPECVT_DIVBY32767;
+}
+
+static __inline__ float
+SDL_CvtS32Sample(const Uint32 *src, const int swap)
+{
+    return ((float) ((Sint32) (swap ? SDL_Swap32(*src) : *src))) *
+        TYPECVT_DIVBY2147483647;
+}
+
+static __inline__ void
+SDL_CvtStoreS16(Uint16 *dst, float val, const int swap)
+{
+    Uint16 sample;
+
+    val *= 32767.0f;
+    if (val >= 32767.0f) {
+        sample = (Uint16) 32767;
+    } else if (val <= -32768.0f) {
+        sample = (Uint16) -32768;
+    } else {
+        sample = (Uint16) ((Sint16) val);
+    }
+    *dst = swap ? SDL_Swap16(sample) : sample;
+}
+
+static __inline__ void
+SDL_CvtStoreS32(Uint32 *dst, const float val, const int swap)
+{
+    const double scaled = val * 2147483647.0;
+    Uint32 sample;
+
+    if (scaled >= 2147483647.0) {
+        sample = (Uint32) 2147483647;
+    } else if (scaled <= -2147483648.0) {
+        sample = (Uint32) 0x80000000;
+    } else {
+        sample = (Uint32) ((Sint32) scaled);
+    }
+    *dst = swap ? SDL_Swap32(sample) : sample;
+}
+
+/*
+ * Each kernel converts cvt->buf in place. Conversions that grow the data
+ * start at the end of the buffer, like the autogenerated ones, so every
+ * block is loaded before anything is written over it.
+ */
+#define TYPECVT_FILTER(isa, kernel, src, dst, sswap, dswap) \
+static void SDLCALL \
+SDL_Convert_##src##_to_##dst##_##isa(SDL_AudioCVT * cvt, \
+                                     SDL_AudioFormat format) \
+{ \
+    kernel(cvt, sswap, dswap); \
+    if (cvt->filters[++cvt->filter_index]) { \
+        cvt->filters[cvt->filter_index] (cvt, AUDIO_##dst); \
+    } \
+}
+
+#define TYPECVT_FILTERS(isa) \
+    TYPECVT_FILTER(isa, SDL_CvtS16ToF32_##isa, S16LSB, F32LSB, TYPECVT_LSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtS16ToF32_##isa, S16LSB, F32MSB, TYPECVT_LSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtS16ToF32_##isa, S16MSB, F32LSB, TYPECVT_MSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtS16ToF32_##isa, S16MSB, F32MSB, TYPECVT_MSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS16_##isa, F32LSB, S16LSB, TYPECVT_LSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS16_##isa, F32LSB, S16MSB, TYPECVT_LSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS16_##isa, F32MSB, S16LSB, TYPECVT_MSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS16_##isa, F32MSB, S16MSB, TYPECVT_MSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtS32ToF32_##isa, S32LSB, F32LSB, TYPECVT_LSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtS32ToF32_##isa, S32LSB, F32MSB, TYPECVT_LSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtS32ToF32_##isa, S32MSB, F32LSB, TYPECVT_MSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtS32ToF32_##isa, S32MSB, F32MSB, TYPECVT_MSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS32_##isa, F32LSB, S32LSB, TYPECVT_LSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS32_##isa, F32LSB, S32MSB, TYPECVT_LSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS32_##isa, F32MSB, S32LSB, TYPECVT_MSB, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtF32ToS32_##isa, F32MSB, S32MSB, TYPECVT_MSB, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtU8ToF32_##isa, U8, F32LSB, 0, TYPECVT_LSB) \
+    TYPECVT_FILTER(isa, SDL_CvtU8ToF32_##isa, U8, F32MSB, 0, TYPECVT_MSB) \
+    TYPECVT_FILTER(isa, SDL_CvtSwap16_##isa, S16LSB, S16MSB, 1, 0) \
+    TYPECVT_FILTER(isa, SDL_CvtSwap16_##isa, S16MSB, S16LSB, 1, 0) \
+    TYPECVT_FILTER(isa, SDL_CvtSwap32_##isa, S32LSB, S32MSB, 1, 0) \
+    TYPECVT_FILTER(isa, SDL_CvtSwap32_##isa, S32MSB, S32LSB, 1, 0) \
+    TYPECVT_FILTER(isa, SDL_CvtSwap32_##isa, F32LSB, F32MSB, 1, 0) \
+    TYPECVT_FILTER(isa, SDL_CvtSwap32_##isa, F32MSB, F32LSB, 1, 0)
+
+#define TYPECVT_ENTRY(isa, cpu, src, dst) \
+    { AUDIO_##src, AUDIO_##dst, cpu, SDL_Convert_##src##_to_##dst##_##isa },
+
+#define TYPECVT_ENTRIES(isa, cpu) \
+    TYPECVT_ENTRY(isa, cpu, S16LSB, F32LSB) \
+    TYPECVT_ENTRY(isa, cpu, S16LSB, F32MSB) \
+    TYPECVT_ENTRY(isa, cpu, S16MSB, F32LSB) \
+    TYPECVT_ENTRY(isa, cpu, S16MSB, F32MSB) \
+    TYPECVT_ENTRY(isa, cpu, F32LSB, S16LSB) \
+    TYPECVT_ENTRY(isa, cpu, F32LSB, S16MSB) \
+    TYPECVT_ENTRY(isa, cpu, F32MSB, S16LSB) \
+    TYPECVT_ENTRY(isa, cpu, F32MSB, S16MSB) \
+    TYPECVT_ENTRY(isa, cpu, S32LSB, F32LSB) \
+    TYPECVT_ENTRY(isa, cpu, S32LSB, F32MSB) \
+    TYPECVT_ENTRY(isa, cpu, S32MSB, F32LSB) \
+    TYPECVT_ENTRY(isa, cpu, S32MSB, F32MSB) \
+    TYPECVT_ENTRY(isa, cpu, F32LSB, S32LSB) \
+    TYPECVT_ENTRY(isa, cpu, F32LSB, S32MSB) \
+    TYPECVT_ENTRY(isa, cpu, F32MSB, S32LSB) \
+    TYPECVT_ENTRY(isa, cpu, F32MSB, S32MSB) \
+    TYPECVT_ENTRY(isa, cpu, U8, F32LSB) \
+    TYPECVT_ENTRY(isa, cpu, U8, F32MSB) \
+    TYPECVT_ENTRY(isa, cpu, S16LSB, S16MSB) \
+    TYPECVT_ENTRY(isa, cpu, S16MSB, S16LSB) \
+    TYPECVT_ENTRY(isa, cpu, S32LSB, S32MSB) \
+    TYPECVT_ENTRY(isa, cpu, S32MSB, S32LSB) \
+    TYPECVT_ENTRY(isa, cpu, F32LSB, F32MSB) \
+    TYPECVT_ENTRY(isa, cpu, F32MSB, F32LSB)
+
+#endif /* __SSE2__ */
+
+#ifdef __SSE2__
+static __inline__ __m128i
+SDL_CvtSwap16Vec_SSE2(const __m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static __inline__ __m128i
+SDL_CvtSwap32Vec_SSE2(__m128i v)
+{
+    v = SDL_CvtSwap16Vec_SSE2(v);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+static __inline__ __m128
+SDL_CvtLoadF32Vec_SSE2(const float *src, const int swap)
+{
+    if (swap) {
+        const __m128i v = _mm_loadu_si128((const __m128i *) src);
+        return _mm_castsi128_ps(SDL_CvtSwap32Vec_SSE2(v));
+    }
+    return _mm_loadu_ps(src);
+}
+
+static __inline__ void
+SDL_CvtStoreF32Vec_SSE2(float *dst, const __m128 v, const int swap)
+{
+    if (swap) {
+        _mm_storeu_si128((__m128i *) dst,
+                         SDL_CvtSwap32Vec_SSE2(_mm_castps_si128(v)));
+    } else {
+        _mm_storeu_ps(dst, v);
+    }
+}
+
+static __inline__ void
+SDL_CvtS16ToF32_SSE2(SDL_AudioCVT * cvt, const int sswap, const int dswap)
+{
+    const Uint16 *src = (const Uint16 *) cvt->buf;
+    float *dst = (float *) cvt->buf;
+    const int count = cvt->len_cvt / sizeof(Sint16);
+    const __m128 scale = _mm_set1_ps(TYPECVT_DIVBY32767);
+    int i;
+
+    for (i = count - 1; i >= (count & ~7); --i) {
+        SDL_CvtStoreF32(&dst[i], SDL_CvtS16Sample(&src[i], sswap), dswap);
+    }
+    for (i = (count & ~7) - 8; i >= 0; i -= 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *) &src[i]);
+        __m128i lo, hi;
+        if (sswap) {
+            v = SDL_CvtSwap16Vec_SSE2(v);
+        }
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        SDL_CvtStoreF32Vec_SSE2(&dst[i],
+                                _mm_mul_ps(_mm_cvtepi32_ps(lo), scale),
+                                dswap);
+        SDL_CvtStoreF32Vec_SSE2(&dst[i + 4],
+                                _mm_mul_ps(_mm_cvtepi32_ps(hi), scale),
+                                dswap);
+    }
+    cvt->len_cvt *= 2;
+}
+
+static __inline__ void
+SDL_CvtF32ToS16_SSE2(SDL_AudioCVT * cvt, const int sswap, const int dswap)
+{
+    const float *src = (const float *) cvt->buf;
+    Uint16 *dst = (Uint16 *) cvt->buf;
+    const int count = cvt->len_cvt / sizeof(float);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    int i;
+
+    for (i = 0; i < (count & ~7); i += 8) {
+        const __m128 lo = SDL_CvtLoadF32Vec_SSE2(&src[i], sswap);
+        const __m128 hi = SDL_CvtLoadF32Vec_SSE2(&src[i + 4], sswap);
+        __m128i v = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(lo, scale)),
+                                    _mm_cvttps_epi32(_mm_mul_ps(hi, scale)));
+        if (dswap) {
+            v = SDL_CvtSwap16Vec_SSE2(v);
+        }
+        _mm_storeu_si128((__m128i *) &dst[i], v);
+    }
+    for (; i < count; ++i) {
+        SDL_CvtStoreS16(&dst[i], SDL_CvtLoadF32(&src[i], sswap), dswap);
+    }
+    cvt->len_cvt /= 2;
+}
+
+static __inline__ void
+SDL_CvtS32ToF32_SSE2(SDL_AudioCVT * cvt, const int sswap, const int dswap)
+{
+    const Uint32 *src = (const Uint32 *) cvt->buf;
+    float *dst = (float *) cvt->buf;
+    const int count = cvt->len_cvt / sizeof(Sint32);
+    const __m128 scale = _mm_set1_ps(TYPECVT_DIVBY2147483647);
+    int i;
+
+    for (i = 0; i < (count & ~3); i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) &src[i]);
+        if (sswap) {
+            v = SDL_CvtSwap32Vec_SSE2(v);
+        }
+        SDL_CvtStoreF32Vec_SSE2(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(v), scale),
+                                dswap);
+    }
+    for (; i < count; ++i) {
+        SDL_CvtStoreF32(&dst[i], SDL_CvtS32Sample(&src[i], sswap), dswap);
+    }
+}
+
+static __inline__ void
+SDL_CvtF32ToS32_SSE2(SDL_AudioCVT * cvt, const int sswap, const int dswap)
+{
+    const float *src = (const float *) cvt->buf;
+    Uint32 *dst = (Uint32 *) cvt->buf;
+    const int count = cvt->len_cvt / sizeof(float);
+    const __m128d scale = _mm_set1_pd(2147483647.0);
+    const __m128d max = _mm_set1_pd(2147483647.0);
+    const __m128d min = _mm_set1_pd(-2147483648.0);
+    int i;
+
+    /* Scaled in double precision, exactly like the generic converters */
+    for (i = 0; i < (count & ~3); i += 4) {
+        const __m128 f = SDL_CvtLoadF32Vec_SSE2(&src[i], sswap);
+        __m128d lo = _mm_mul_pd(_mm_cvtps_pd(f), scale);
+        __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(f, f)), scale);
+        __m128i v;
+        lo = _mm_max_pd(_mm_min_pd(lo, max), min);
+        hi = _mm_max_pd(_mm_min_pd(hi, max), min);
+        v = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+        if (dswap) {
+            v = SDL_CvtSwap32Vec_SSE2(v);
+        }
+        _mm_storeu_si128((__m128i *) &dst[i], v);
+    }
+    for (; i < count; ++i) {
+        SDL_CvtStoreS32(&dst[i], SDL_CvtLoadF32(&src[i], sswap), dswap);
+    }
+}
+
+static __inline__ void
+SDL_CvtU8ToF32_SSE2(SDL_AudioCVT * cvt, const int sswap, const int dswap)
+{
+    const Uint8 *src = (const Uint8 *) cvt->buf;
+    float *dst = (float *) cvt->buf;
+    const int count = cvt->len_cvt;
+    const __m128 scale = _mm_set1_ps(TYPECVT_DIVBY127);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i zero = _mm_setzero_si128();
+    int i, j;
+
+    for (i = count - 1; i >= (count & ~15); --i) {
+        SDL_CvtStoreF32(&dst[i], (((float) src[i]) * TYPECVT_DIVBY127) - 1.0f,
+                        dswap);
+    }
+    for (i = (count & ~15) - 16; i >= 0; i -= 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i *) &src[i]);
+        __m128i w[4];
+        w[0] = _mm_unpacklo_epi8(v, zero);
+        w[2] = _mm_unpackhi_epi8(v, zero);
+        w[1] = _mm_unpackhi_epi16(w[0], zero);
+        w[0] = _mm_unpacklo_epi16(w[0], zero);
+        w[3] = _mm_unpackhi_epi16(w[2], zero);
+        w[2] = _mm_unpacklo_epi16(w[2], zero);
+        for (j = 0; j < 4; ++j) {
+            const __m128 f = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(w[j]),
+                                                   scale), one);
+            SDL_CvtStoreF32Vec_SSE2(&dst[i + j * 4], f, dswap);
+        }
+    }
+    cvt->len_cvt *= 4;
+}
+
+static __inline__ void
+SDL_CvtSwap16_SSE2(SDL_AudioCVT * cvt, const int sswap, const int dswap)
+{
+    Uint16 *buf = (Uint16 *) cvt->buf;
+    const int count = cvt->len_cvt / sizeof(Uint16);
+    int i;
+
+    for (i = 0; i < (count & ~7); i += 8) {
+        const __m128i v = _mm_loadu_si128((const __m128i *) &buf[i]);
+        _mm_storeu_si128((__m128i *) &buf[i], SDL_CvtSwap16Vec_SSE2(v));
+    }
+    for (; i < count; ++i) {
+        buf[i] = SDL_Swap16(buf[i]);
+    }
+}
+
+static __inline__ void
+SDL_CvtSwap32_SSE2(SDL_AudioCVT * cvt, const int sswap, const int dswap)
+{
+    Uint32 *buf = (Uint32 *) cvt->buf;
+    const int count = cvt->len_cvt / sizeof(Uint32);
+    int i;
+
+    for (i = 0; i < (count & ~3); i += 4) {
+        const __m128i v = _mm_loadu_si128((const __m128i *) &buf[i]);
+        _mm_storeu_si128((__m128i *) &buf[i], SDL_CvtSwap32Vec_SSE2(v));
+    }
+    for (; i < count; ++i) {
+        buf[i] = SDL_Swap32(buf[i]);
+    }
+}
+
+TYPECVT_FILTERS(SSE2)
+#endif /* __SSE2__ */
+
+#ifdef __SSE2__
+static const SDL_AudioTypeCVTEntry sdl_audio_type_cvt_simd[] = {
+#ifdef __SSE2__
+    TYPECVT_ENTRIES(SSE2, SDL_AUDIO_CPU_SSE2)
+#endif
+    { 0, 0, 0, NULL }
+};
+#endif /* __SSE2__ */
+
+Uint32
+SDL_GetAudioCPUFeatures(void)
+{
+    static Uint32 features = 0xffffffff;
+    const char *override = SDL_getenv("SDL_AUDIO_CPU_FEATURES");
+    Uint32 forced;
+
+    /* Allow an override for testing .. checked every time so one process
+       can compare converters */
+    if (override && (SDL_sscanf(override, "%u", &forced) == 1)) {
+        return forced;
+    }
+
+    if (features == 0xffffffff) {
+        features = SDL_AUDIO_CPU_ANY;
+        if (SDL_HasSSE2()) {
+            features |= SDL_AUDIO_CPU_SSE2;
+        }
+    }
+    return features;
+}
+
 static SDL_AudioFilter
 SDL_HandTunedTypeCVT(SDL_AudioFormat src_fmt, SDL_AudioFormat dst_fmt)
 {
@@ -805,6 +1444,18 @@ SDL_HandTunedTypeCVT(SDL_AudioFormat src_fmt, SDL_AudioFormat dst_fmt)
      * Fill in any future conversions that are specialized to a
      *  processor, platform, compiler, or library here.
      */
+#ifdef __SSE2__
+    const Uint32 features = SDL_GetAudioCPUFeatures();
+    int i;
+
+    for (i = 0; sdl_audio_type_cvt_simd[i].filter; ++i) {
+        const SDL_AudioTypeCVTEntry *entry = &sdl_audio_type_cvt_simd[i];
+        if ((entry->src_fmt == src_fmt) && (entry->dst_fmt == dst_fmt) &&
+            ((entry->cpu & features) == entry->cpu)) {
+            return entry->filter;
+        }
+    }
+#endif
 
     return NULL;                /* no specialized converter code available. */
 }
@@ -859,15 +1510,582 @@ SDL_BuildAudioTypeCVT(SDL_AudioCVT * cvt,
 }
 
 
-static SDL_AudioFilter
-SDL_HandTunedResampleCVT(SDL_AudioCVT * cvt, int dst_channels,
-                         int src_rate, int dst_rate)
-{
-    /*
-     * Fill in any future conversions that are specialized to a
-     *  processor, platform, compiler, or library here.
-     */
-
+/*
+ * Polyphase windowed-sinc resampler.
+ *
+ * This handles any rate pair for the native 16-bit and float formats. Each
+ * reduced rate ratio up/down gets a table of "up" filter phases, built once
+ * when the converter is set up and shared by every SDL_AudioCVT with that
+ * ratio. SDL_AUDIO_RESAMPLER picks the filter length: "linear" (2 taps),
+ * "fast" (8 taps, the default), "best" (32 taps), or "legacy" to use the
+ * autogenerated 2x/4x and arbitrary filters instead.
+ */
+
+#define RESAMPLE_MAX_TAPS       32
+#define RESAMPLE_MAX_CHANNELS   8
+#define RESAMPLE_MAX_PHASES     1024
+#define RESAMPLE_MAX_TABLES     16
+#define RESAMPLE_SHIFT          14      /* fixed point coefficients are Q14 */
+
+#ifndef M_PI
+#define M_PI    3.14159265358979323846
+#endif
+
+/* The filters below rely on constant channel counts and tap lengths being
+   folded into each copy of the loop. */
+#if defined(__GNUC__) && (__GNUC__ >= 4)
+#define RESAMPLE_INLINE __inline__ __attribute__((always_inline))
+#else
+#define RESAMPLE_INLINE __inline__
+#endif
+
+typedef struct
+{
+    int up;                     /* dst_rate / gcd(src_rate, dst_rate) */
+    int down;                   /* src_rate / gcd(src_rate, dst_rate) */
+    int taps;
+    int phases;                 /* up, or RESAMPLE_MAX_PHASES if larger */
+    double rate_incr;           /* matches SDL_AudioCVT::rate_incr */
+    float *coeffs;              /* phases * taps */
+    float *coeffs_2c;           /* each tap twice, for interleaved stereo */
+    Sint16 *coeffs16;           /* phases * taps */
+    Sint16 *coeffs16_2c;        /* tap pairs twice, for pmaddwd on stereo */
+} SDL_ResampleTable;
+
+static SDL_ResampleTable *resample_tables[RESAMPLE_MAX_TABLES];
+static int num_resample_tables = 0;
+static SDL_SpinLock resample_lock = 0;
+
+static int
+SDL_GetResamplerTaps(void)
+{
+    const char *env = SDL_getenv("SDL_AUDIO_RESAMPLER");
+
+    if (env) {
+        if (SDL_strcasecmp(env, "legacy") == 0) {
+            return 0;
+        } else if (SDL_strcasecmp(env, "linear") == 0) {
+            return 2;
+        } else if (SDL_strcasecmp(env, "best") == 0) {
+            return 32;
+        }
+    }
+    return 8;
+}
+
+/* Modified Bessel function of the first kind, for the Kaiser window */
+static double
+SDL_ResampleBesselI0(double x)
+{
+    const double xx = (x * x) / 4.0;
+    double sum = 1.0;
+    double term = 1.0;
+    int k;
+
+    for (k = 1; k < 64; ++k) {
+        term *= xx / ((double) k * (double) k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/* Fill in phase (p) of (table) with a Kaiser windowed sinc, normalised so
+   every phase has unity gain in both float and fixed point. */
+static void
+SDL_BuildResamplePhase(SDL_ResampleTable * table, int p)
+{
+    const int taps = table->taps;
+    const int half = taps / 2;
+    const double frac = ((double) p) / ((double) table->phases);
+    const double rolloff = (taps >= 32) ? 0.94 : 0.86;
+    const double beta = (taps >= 32) ? 8.0 : 5.0;
+    double cutoff = rolloff;
+    double w[RESAMPLE_MAX_TAPS];
+    double sum = 0.0;
+    float *coeffs = table->coeffs + (p * taps);
+    float *coeffs_2c = table->coeffs_2c + (p * taps * 2);
+    Sint16 *coeffs16 = table->coeffs16 + (p * taps);
+    Sint16 *coeffs16_2c = table->coeffs16_2c + (p * taps * 2);
+    int total = 0;
+    int peak = 0;
+    int k;
+
+    /* Lower the cutoff below the new Nyquist rate when downsampling. */
+    if (table->up < table->down) {
+        cutoff *= ((double) table->up) / ((double) table->down);
+    }
+
+    for (k = 0; k < taps; ++k) {
+        /* distance from the output sample to this tap, in source frames */
+        const double x = ((double) (k - (half - 1))) - frac;
+        if (taps == 2) {
+            w[k] = (k == 0) ? (1.0 - frac) : frac;
+        } else {
+            const double u = x / ((double) half);
+            const double window = (u * u >= 1.0) ? 0.0 :
+                SDL_ResampleBesselI0(beta * SDL_sqrt(1.0 - u * u)) /
+                SDL_ResampleBesselI0(beta);
+            const double sinc = (x == 0.0) ? cutoff :
+                SDL_sin(M_PI * cutoff * x) / (M_PI * x);
+            w[k] = sinc * window;
+        }
+        sum += w[k];
+    }
+
+    for (k = 0; k < taps; ++k) {
+        const double c = w[k] / sum;
+        coeffs[k] = (float) c;
+        coeffs_2c[k * 2] = coeffs_2c[k * 2 + 1] = (float) c;
+        coeffs16[k] = (Sint16) SDL_floor(c * (1 << RESAMPLE_SHIFT) + 0.5);
+        total += coeffs16[k];
+        if (coeffs16[k] > coeffs16[peak]) {
+            peak = k;
+        }
+    }
+    coeffs16[peak] += (Sint16) ((1 << RESAMPLE_SHIFT) - total);
+
+    /* [c0 c1 c0 c1 c2 c3 c2 c3] pairs up with frames shuffled to
+       [L0 L1 R0 R1 L2 L3 R2 R3] */
+    for (k = 0; k < taps; k += 2) {
+        coeffs16_2c[k * 2 + 0] = coeffs16[k];
+        coeffs16_2c[k * 2 + 1] = coeffs16[k + 1];
+        coeffs16_2c[k * 2 + 2] = coeffs16[k];
+        coeffs16_2c[k * 2 + 3] = coeffs16[k + 1];
+    }
+}
+
+static SDL_ResampleTable *
+SDL_FindResampleTable(double rate_incr, int taps)
+{
+    SDL_ResampleTable *table = NULL;
+    int i;
+
+    SDL_AtomicLock(&resample_lock);
+    for (i = 0; i < num_resample_tables; ++i) {
+        if ((resample_tables[i]->rate_incr == rate_incr) &&
+            (resample_tables[i]->taps == taps)) {
+            table = resample_tables[i];
+            break;
+        }
+    }
+    SDL_AtomicUnlock(&resample_lock);
+    return table;
+}
+
+/* Tables are never freed: a converter may outlive SDL_AudioQuit() */
+static int
+SDL_AddResampleTable(int src_rate, int dst_rate, int taps)
+{
+    SDL_ResampleTable *table;
+    int a = src_rate, b = dst_rate;
+    int count, p;
+
+    while (b != 0) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+
+    table = (SDL_ResampleTable *) SDL_calloc(1, sizeof(*table));
+    if (table == NULL) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    table->up = dst_rate / a;
+    table->down = src_rate / a;
+    table->taps = taps;
+    table->phases = SDL_min(table->up, RESAMPLE_MAX_PHASES);
+    table->rate_incr = ((double) dst_rate) / ((double) src_rate);
+
+    if (SDL_FindResampleTable(table->rate_incr, taps) != NULL) {
+        SDL_free(table);
+        return 0;               /* already built. */
+    }
+
+    count = table->phases * taps;
+    table->coeffs = (float *) SDL_malloc(count * 3 * sizeof(float));
+    table->coeffs16 = (Sint16 *) SDL_malloc(count * 3 * sizeof(Sint16));
+    if ((table->coeffs == NULL) || (table->coeffs16 == NULL)) {
+        SDL_free(table->coeffs);
+        SDL_free(table->coeffs16);
+        SDL_free(table);
+        SDL_OutOfMemory();
+        return -1;
+    }
+    table->coeffs_2c = table->coeffs + count;
+    table->coeffs16_2c = table->coeffs16 + count;
+    for (p = 0; p < table->phases; ++p) {
+        SDL_BuildResamplePhase(table, p);
+    }
+
+    SDL_AtomicLock(&resample_lock);
+    for (p = 0; p < num_resample_tables; ++p) {
+        if ((resample_tables[p]->rate_incr == table->rate_incr) &&
+            (resample_tables[p]->taps == taps)) {
+            break;              /* another thread beat us to it. */
+        }
+    }
+    if ((p < num_resample_tables) ||
+        (num_resample_tables == RESAMPLE_MAX_TABLES)) {
+        SDL_AtomicUnlock(&resample_lock);
+        SDL_free(table->coeffs);
+        SDL_free(table->coeffs16);
+        SDL_free(table);
+        if (p < num_resample_tables) {
+            return 0;
+        }
+        SDL_SetError("Too many audio resampling rates in use");
+        return -1;
+    }
+    resample_tables[num_resample_tables++] = table;
+    SDL_AtomicUnlock(&resample_lock);
+    return 0;
+}
+
+/* One output frame: (src) points at the first tap of (channels) interleaved
+   channels. These are written so the compiler can vectorise them across
+   channels; the SSE versions below cover mono and stereo. */
+static RESAMPLE_INLINE void
+SDL_ResampleFrame_S16(Sint16 * dst, const Sint16 * src,
+                      const Sint16 * coeffs, int taps, int channels)
+{
+    Sint32 acc[RESAMPLE_MAX_CHANNELS];
+    int c, k;
+
+    for (c = 0; c < channels; ++c) {
+        acc[c] = 1 << (RESAMPLE_SHIFT - 1);
+    }
+    for (k = 0; k < taps; ++k) {
+        const Sint32 w = coeffs[k];
+        for (c = 0; c < channels; ++c) {
+            acc[c] += w * src[c];
+        }
+        src += channels;
+    }
+    for (c = 0; c < channels; ++c) {
+        const Sint32 val = acc[c] >> RESAMPLE_SHIFT;
+        dst[c] = (Sint16) ((val > 32767) ? 32767 :
+                           ((val < -32768) ? -32768 : val));
+    }
+}
+
+static RESAMPLE_INLINE void
+SDL_ResampleFrame_F32(float *dst, const float *src,
+                      const float *coeffs, int taps, int channels)
+{
+    float acc[RESAMPLE_MAX_CHANNELS];
+    int c, k;
+
+    for (c = 0; c < channels; ++c) {
+        acc[c] = 0.0f;
+    }
+    for (k = 0; k < taps; ++k) {
+        const float w = coeffs[k];
+        for (c = 0; c < channels; ++c) {
+            acc[c] += w * src[c];
+        }
+        src += channels;
+    }
+    for (c = 0; c < channels; ++c) {
+        dst[c] = acc[c];
+    }
+}
+
+#ifdef __SSE2__
+static RESAMPLE_INLINE void
+SDL_ResampleFrame_S16_1c_SSE2(Sint16 * dst, const Sint16 * src,
+                              const Sint16 * coeffs, int taps)
+{
+    __m128i acc = _mm_setzero_si128();
+    Sint32 sum[4];
+    Sint32 val;
+    int k;
+
+    for (k = 0; k < taps; k += 8) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) (src + k));
+        const __m128i w = _mm_loadu_si128((const __m128i *) (coeffs + k));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(s, w));
+    }
+    _mm_storeu_si128((__m128i *) sum, acc);
+    val = (sum[0] + sum[1] + sum[2] + sum[3] + (1 << (RESAMPLE_SHIFT - 1)))
+        >> RESAMPLE_SHIFT;
+    dst[0] = (Sint16) ((val > 32767) ? 32767 :
+                       ((val < -32768) ? -32768 : val));
+}
+
+static RESAMPLE_INLINE void
+SDL_ResampleFrame_S16_2c_SSE2(Sint16 * dst, const Sint16 * src,
+                              const Sint16 * coeffs_2c, int taps)
+{
+    __m128i acc = _mm_setzero_si128();
+    Sint32 sum[4];
+    Sint32 l, r;
+    int k;
+
+    for (k = 0; k < taps; k += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *) (src + k * 2));
+        const __m128i w =
+            _mm_loadu_si128((const __m128i *) (coeffs_2c + k * 2));
+        s = _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 1, 2, 0));
+        s = _mm_shufflehi_epi16(s, _MM_SHUFFLE(3, 1, 2, 0));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(s, w));
+    }
+    _mm_storeu_si128((__m128i *) sum, acc);
+    l = (sum[0] + sum[2] + (1 << (RESAMPLE_SHIFT - 1))) >> RESAMPLE_SHIFT;
+    r = (sum[1] + sum[3] + (1 << (RESAMPLE_SHIFT - 1))) >> RESAMPLE_SHIFT;
+    dst[0] = (Sint16) ((l > 32767) ? 32767 : ((l < -32768) ? -32768 : l));
+    dst[1] = (Sint16) ((r > 32767) ? 32767 : ((r < -32768) ? -32768 : r));
+}
+
+static RESAMPLE_INLINE void
+SDL_ResampleFrame_F32_1c_SSE(float *dst, const float *src,
+                             const float *coeffs, int taps)
+{
+    __m128 acc = _mm_setzero_ps();
+    float sum[4];
+    int k;
+
+    for (k = 0; k < taps; k += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src + k),
+                                         _mm_loadu_ps(coeffs + k)));
+    }
+    _mm_storeu_ps(sum, acc);
+    dst[0] = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+static RESAMPLE_INLINE void
+SDL_ResampleFrame_F32_2c_SSE(float *dst, const float *src,
+                             const float *coeffs_2c, int taps)
+{
+    __m128 acc = _mm_setzero_ps();
+    float sum[4];
+    int k;
+
+    for (k = 0; k < taps * 2; k += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src + k),
+                                         _mm_loadu_ps(coeffs_2c + k)));
+    }
+    _mm_storeu_ps(sum, acc);
+    dst[0] = sum[0] + sum[2];
+    dst[1] = sum[1] + sum[3];
+}
+#endif /* __SSE2__ */
+
+/* Steps through (outframes) output frames. (in) holds (inframes) frames;
+   taps that fall off either end repeat the edge frame, as the legacy filters
+   do. (*ppos, *pphase) is the source position, kept between calls by
+   SDL_AudioStream. */
+#define RESAMPLE_LOOP(type, kernel) \
+    { \
+        const type *src = (const type *) in; \
+        type *dst = (type *) out; \
+        type edge[RESAMPLE_MAX_TAPS * RESAMPLE_MAX_CHANNELS]; \
+        for (i = 0; i < outframes; ++i) { \
+            const int p = (table->phases == table->up) ? (int) phase : \
+                (int) ((((Uint64) phase) * table->phases) / table->up); \
+            const int start = pos - (half - 1); \
+            const type *frame = src + (start * channels); \
+            if ((start < 0) || ((start + taps) > inframes)) { \
+                int k, c; \
+                for (k = 0; k < taps; ++k) { \
+                    int f = start + k; \
+                    f = (f < 0) ? 0 : ((f >= inframes) ? inframes - 1 : f); \
+                    for (c = 0; c < channels; ++c) { \
+                        edge[k * channels + c] = src[f * channels + c]; \
+                    } \
+                } \
+                frame = edge; \
+            } \
+            kernel; \
+            dst += channels; \
+            pos += step; \
+            phase += frac_step; \
+            if (phase >= (Uint32) table->up) { \
+                phase -= table->up; \
+                ++pos; \
+            } \
+        } \
+    }
+
+static RESAMPLE_INLINE void
+SDL_ResampleRun(const SDL_ResampleTable * table, SDL_AudioFormat format,
+                const int channels, const int taps,
+                const Uint8 * in, int inframes, Uint8 * out, int outframes,
+                int *ppos, Uint32 * pphase)
+{
+    const int half = taps / 2;
+    const int step = table->down / table->up;
+    const int frac_step = table->down % table->up;
+    Uint32 phase = *pphase;
+    int pos = *ppos;
+    int i;
+
+    if (format == AUDIO_F32SYS) {
+#ifdef __SSE2__
+        if ((channels == 1) && (taps >= 8)) {
+            RESAMPLE_LOOP(float, SDL_ResampleFrame_F32_1c_SSE(dst, frame,
+                          table->coeffs + p * taps, taps));
+        } else if ((channels == 2) && (taps >= 8)) {
+            RESAMPLE_LOOP(float, SDL_ResampleFrame_F32_2c_SSE(dst, frame,
+                          table->coeffs_2c + p * taps * 2, taps));
+        } else
+#endif
+            RESAMPLE_LOOP(float, SDL_ResampleFrame_F32(dst, frame,
+                          table->coeffs + p * taps, taps, channels));
+    } else {
+#ifdef __SSE2__
+        if ((channels == 1) && (taps >= 8)) {
+            RESAMPLE_LOOP(Sint16, SDL_ResampleFrame_S16_1c_SSE2(dst, frame,
+                          table->coeffs16 + p * taps, taps));
+        } else if ((channels == 2) && (taps >= 8)) {
+            RESAMPLE_LOOP(Sint16, SDL_ResampleFrame_S16_2c_SSE2(dst, frame,
+                          table->coeffs16_2c + p * taps * 2, taps));
+        } else
+#endif
+            RESAMPLE_LOOP(Sint16, SDL_ResampleFrame_S16(dst, frame,
+                          table->coeffs16 + p * taps, taps, channels));
+    }
+
+    *ppos = pos;
+    *pphase = phase;
+}
+
+#undef RESAMPLE_LOOP
+
+typedef void (*SDL_ResampleFunc) (const SDL_ResampleTable * table,
+                                  SDL_AudioFormat format,
+                                  const Uint8 * in, int inframes,
+                                  Uint8 * out, int outframes,
+                                  int *ppos, Uint32 * pphase);
+
+/* The stateless SDL_AudioCVT filter: one block, starting at its first frame */
+static void
+SDL_ResampleCVT(SDL_AudioCVT * cvt, SDL_AudioFormat format,
+                int channels, int taps, SDL_ResampleFunc run)
+{
+    const SDL_ResampleTable *table =
+        SDL_FindResampleTable(cvt->rate_incr, taps);
+    const int framesize = (SDL_AUDIO_BITSIZE(format) / 8) * channels;
+    const int srcframes = cvt->len_cvt / framesize;
+    Uint32 phase = 0;
+    int pos = 0;
+
+    if ((table != NULL) && (srcframes > 0)) {
+        const int dstframes =
+            (int) ((((Uint64) srcframes) * table->up) / table->down);
+
+        /* The converter asked for twice the room it needs, so move the
+           source to the end of the buffer and write from the start. */
+        Uint8 *src =
+            cvt->buf + (cvt->len * cvt->len_mult) - (srcframes * framesize);
+        SDL_memmove(src, cvt->buf, srcframes * framesize);
+
+        run(table, format, src, srcframes, cvt->buf, dstframes, &pos, &phase);
+        cvt->len_cvt = dstframes * framesize;
+    }
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index] (cvt, format);
+    }
+}
+
+/* One loop per channel count and tap length, see RESAMPLE_INLINE */
+#define RESAMPLE_FILTER(chans, taps) \
+static void \
+SDL_ResampleRun_##chans##c_##taps(const SDL_ResampleTable * table, \
+                                  SDL_AudioFormat format, \
+                                  const Uint8 * in, int inframes, \
+                                  Uint8 * out, int outframes, \
+                                  int *ppos, Uint32 * pphase) \
+{ \
+    SDL_ResampleRun(table, format, chans, taps, \
+                    in, inframes, out, outframes, ppos, pphase); \
+} \
+static void SDLCALL \
+SDL_Resample_##chans##c_##taps(SDL_AudioCVT * cvt, SDL_AudioFormat format) \
+{ \
+    SDL_ResampleCVT(cvt, format, chans, taps, \
+                    SDL_ResampleRun_##chans##c_##taps); \
+}
+
+RESAMPLE_FILTER(1, 2)
+RESAMPLE_FILTER(1, 8)
+RESAMPLE_FILTER(1, 32)
+RESAMPLE_FILTER(2, 2)
+RESAMPLE_FILTER(2, 8)
+RESAMPLE_FILTER(2, 32)
+RESAMPLE_FILTER(4, 2)
+RESAMPLE_FILTER(4, 8)
+RESAMPLE_FILTER(4, 32)
+RESAMPLE_FILTER(6, 2)
+RESAMPLE_FILTER(6, 8)
+RESAMPLE_FILTER(6, 32)
+RESAMPLE_FILTER(8, 2)
+RESAMPLE_FILTER(8, 8)
+RESAMPLE_FILTER(8, 32)
+
+#undef RESAMPLE_FILTER
+
+static const struct
+{
+    int channels;
+    int taps;
+    SDL_AudioFilter filter;
+    SDL_ResampleFunc run;
+} sdl_resample_filters[] = {
+#define RESAMPLE_ENTRY(chans, taps) \
+    { chans, taps, SDL_Resample_##chans##c_##taps, \
+      SDL_ResampleRun_##chans##c_##taps }
+    RESAMPLE_ENTRY(1, 2),
+    RESAMPLE_ENTRY(1, 8),
+    RESAMPLE_ENTRY(1, 32),
+    RESAMPLE_ENTRY(2, 2),
+    RESAMPLE_ENTRY(2, 8),
+    RESAMPLE_ENTRY(2, 32),
+    RESAMPLE_ENTRY(4, 2),
+    RESAMPLE_ENTRY(4, 8),
+    RESAMPLE_ENTRY(4, 32),
+    RESAMPLE_ENTRY(6, 2),
+    RESAMPLE_ENTRY(6, 8),
+    RESAMPLE_ENTRY(6, 32),
+    RESAMPLE_ENTRY(8, 2),
+    RESAMPLE_ENTRY(8, 8),
+    RESAMPLE_ENTRY(8, 32),
+#undef RESAMPLE_ENTRY
+    { 0, 0, NULL, NULL }
+};
+
+static SDL_AudioFilter
+SDL_HandTunedResampleCVT(SDL_AudioCVT * cvt, int dst_channels,
+                         int src_rate, int dst_rate)
+{
+    /*
+     * Fill in any future conversions that are specialized to a
+     *  processor, platform, compiler, or library here.
+     */
+    const int taps = SDL_GetResamplerTaps();
+    int i;
+
+    if ((taps == 0) || ((cvt->dst_format != AUDIO_S16SYS) &&
+                        (cvt->dst_format != AUDIO_F32SYS))) {
+        return NULL;
+    }
+
+    for (i = 0; sdl_resample_filters[i].filter != NULL; i++) {
+        if ((sdl_resample_filters[i].channels == dst_channels) &&
+            (sdl_resample_filters[i].taps == taps)) {
+            if (SDL_AddResampleTable(src_rate, dst_rate, taps) < 0) {
+                return NULL;    /* fall back to the autogenerated ones. */
+            }
+            /* room to move the source out of the way, see above */
+            cvt->len_mult *= 2;
+            return sdl_resample_filters[i].filter;
+        }
+    }
+
     return NULL;                /* no specialized converter code available. */
 }
 
@@ -953,6 +2171,558 @@ SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, int dst_channels,
 }
 
 
+/*
+ * Fused conversion: type, mono/stereo mapping and rate conversion in one
+ * filter. The chain above walks the whole buffer once per filter; this
+ * decodes a small block of source frames to float, resamples it, and
+ * encodes it straight into place, so each source frame is read once and
+ * each destination frame written once. SDL_BuildAudioCVT() swaps it in for
+ * chains of two or more filters it can cover, except stereo to stereo
+ * resampling, where the chain is faster; SDL_AUDIO_FUSED=0 keeps the
+ * chain, which stays the fallback for everything else.
+ *
+ * Conversions that shrink the data run forwards and ones that grow it run
+ * backwards, as the autogenerated filters do; the resampler window lives
+ * in scratch memory, so a block is never written over source frames that
+ * have not been decoded yet.
+ */
+
+#define FUSED_BLOCK_FRAMES      256     /* about 7k of stack in all */
+#define FUSED_WINDOW_FRAMES     (FUSED_BLOCK_FRAMES + 2 * RESAMPLE_MAX_TAPS)
+#define FUSED_MAX_DOWNSAMPLE    8       /* farther goes through the chain */
+
+typedef struct
+{
+    Uint8 *buf;
+    SDL_AudioFormat src_fmt;
+    SDL_AudioFormat dst_fmt;
+    int src_channels;
+    int dst_channels;
+    int work_channels;          /* channels while resampling */
+    int src_framesize;
+    int dst_framesize;
+} SDL_FusedCVT;
+
+#ifdef __SSE2__
+/* Vector loops for the common formats; they return how many samples they
+   did and leave the rest to the C loops below. */
+static int
+SDL_FusedDecode_SSE2(SDL_AudioFormat format, const Uint8 * src, float *dst,
+                     int samples)
+{
+    const int swap = SDL_AUDIO_ISBIGENDIAN(format) ? TYPECVT_MSB : TYPECVT_LSB;
+    const int count = samples & ~7;
+    int i;
+
+    if (SDL_AUDIO_ISFLOAT(format)) {
+        for (i = 0; i < count; i += 4) {
+            _mm_storeu_ps(dst + i,
+                          SDL_CvtLoadF32Vec_SSE2((const float *) src + i,
+                                                 swap));
+        }
+    } else if (SDL_AUDIO_ISSIGNED(format) && SDL_AUDIO_BITSIZE(format) == 16) {
+        const __m128 scale = _mm_set1_ps(TYPECVT_DIVBY32767);
+        for (i = 0; i < count; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (src + i * 2));
+            if (swap) {
+                v = SDL_CvtSwap16Vec_SSE2(v);
+            }
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(
+                _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(
+                _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale));
+        }
+    } else if (SDL_AUDIO_ISSIGNED(format) && SDL_AUDIO_BITSIZE(format) == 32) {
+        const __m128 scale = _mm_set1_ps(TYPECVT_DIVBY2147483647);
+        for (i = 0; i < count; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (src + i * 4));
+            if (swap) {
+                v = SDL_CvtSwap32Vec_SSE2(v);
+            }
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+        }
+    } else {
+        return 0;
+    }
+    return count;
+}
+
+static int
+SDL_FusedEncode_SSE2(SDL_AudioFormat format, const float *src, Uint8 * dst,
+                     int samples)
+{
+    const int swap = SDL_AUDIO_ISBIGENDIAN(format) ? TYPECVT_MSB : TYPECVT_LSB;
+    const int count = samples & ~7;
+    int i;
+
+    if (SDL_AUDIO_ISFLOAT(format)) {
+        for (i = 0; i < count; i += 4) {
+            SDL_CvtStoreF32Vec_SSE2((float *) dst + i, _mm_loadu_ps(src + i),
+                                    swap);
+        }
+    } else if (SDL_AUDIO_ISSIGNED(format) && SDL_AUDIO_BITSIZE(format) == 16) {
+        /* packs saturates, which is the clamp */
+        const __m128 scale = _mm_set1_ps(32767.0f);
+        for (i = 0; i < count; i += 8) {
+            __m128i v = _mm_packs_epi32(
+                _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale)),
+                _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4),
+                                            scale)));
+            if (swap) {
+                v = SDL_CvtSwap16Vec_SSE2(v);
+            }
+            _mm_storeu_si128((__m128i *) (dst + i * 2), v);
+        }
+    } else {
+        return 0;
+    }
+    return count;
+}
+#endif /* __SSE2__ */
+
+#define FUSED_NOSWAP(x) (x)
+
+#define FUSED_DECODE(fmt, type, swap, expr) \
+    case fmt: \
+        for (; i < samples; ++i) { \
+            const type x = (type) swap(((const type *) src)[i]); \
+            dst[i] = expr; \
+        } \
+        break;
+
+static void
+SDL_FusedDecode(SDL_AudioFormat format, const Uint8 * src, float *dst,
+                int samples)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    i = SDL_FusedDecode_SSE2(format, src, dst, samples);
+#endif
+    switch (format) {
+        FUSED_DECODE(AUDIO_U8, Uint8, FUSED_NOSWAP,
+                     (((float) x) * TYPECVT_DIVBY127) - 1.0f)
+        FUSED_DECODE(AUDIO_S8, Sint8, FUSED_NOSWAP,
+                     ((float) x) * TYPECVT_DIVBY127)
+        FUSED_DECODE(AUDIO_U16LSB, Uint16, SDL_SwapLE16,
+                     (((float) x) * TYPECVT_DIVBY32767) - 1.0f)
+        FUSED_DECODE(AUDIO_U16MSB, Uint16, SDL_SwapBE16,
+                     (((float) x) * TYPECVT_DIVBY32767) - 1.0f)
+        FUSED_DECODE(AUDIO_S16LSB, Sint16, SDL_SwapLE16,
+                     ((float) x) * TYPECVT_DIVBY32767)
+        FUSED_DECODE(AUDIO_S16MSB, Sint16, SDL_SwapBE16,
+                     ((float) x) * TYPECVT_DIVBY32767)
+        FUSED_DECODE(AUDIO_S32LSB, Sint32, SDL_SwapLE32,
+                     ((float) x) * TYPECVT_DIVBY2147483647)
+        FUSED_DECODE(AUDIO_S32MSB, Sint32, SDL_SwapBE32,
+                     ((float) x) * TYPECVT_DIVBY2147483647)
+        FUSED_DECODE(AUDIO_F32LSB, float, SDL_SwapFloatLE, x)
+        FUSED_DECODE(AUDIO_F32MSB, float, SDL_SwapFloatBE, x)
+    }
+}
+
+#undef FUSED_DECODE
+
+/* Integers are clamped first: the resampler can overshoot full scale a
+   little. Floats are passed through, as the resampler leaves them. */
+#define FUSED_ENCODE(fmt, type, swap, expr) \
+    case fmt: \
+        for (; i < samples; ++i) { \
+            const float x = (src[i] > 1.0f) ? 1.0f : \
+                ((src[i] < -1.0f) ? -1.0f : src[i]); \
+            ((type *) dst)[i] = swap((type) (expr)); \
+        } \
+        break;
+
+static void
+SDL_FusedEncode(SDL_AudioFormat format, const float *src, Uint8 * dst,
+                int samples)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    i = SDL_FusedEncode_SSE2(format, src, dst, samples);
+#endif
+    switch (format) {
+        FUSED_ENCODE(AUDIO_U8, Uint8, FUSED_NOSWAP, (x + 1.0f) * 127.0f)
+        FUSED_ENCODE(AUDIO_S8, Sint8, FUSED_NOSWAP, x * 127.0f)
+        FUSED_ENCODE(AUDIO_U16LSB, Uint16, SDL_SwapLE16,
+                     (x + 1.0f) * 32767.0f)
+        FUSED_ENCODE(AUDIO_U16MSB, Uint16, SDL_SwapBE16,
+                     (x + 1.0f) * 32767.0f)
+        FUSED_ENCODE(AUDIO_S16LSB, Sint16, SDL_SwapLE16, x * 32767.0f)
+        FUSED_ENCODE(AUDIO_S16MSB, Sint16, SDL_SwapBE16, x * 32767.0f)
+        FUSED_ENCODE(AUDIO_S32LSB, Sint32, SDL_SwapLE32, x * 2147483647.0)
+        FUSED_ENCODE(AUDIO_S32MSB, Sint32, SDL_SwapBE32, x * 2147483647.0)
+    case AUDIO_F32LSB:
+        for (; i < samples; ++i) {
+            ((float *) dst)[i] = SDL_SwapFloatLE(src[i]);
+        }
+        break;
+    case AUDIO_F32MSB:
+        for (; i < samples; ++i) {
+            ((float *) dst)[i] = SDL_SwapFloatBE(src[i]);
+        }
+        break;
+    }
+}
+
+#undef FUSED_ENCODE
+#undef FUSED_NOSWAP
+
+/* Source frames [first, first + count) to work frames in (dst) */
+static void
+SDL_FusedRead(const SDL_FusedCVT * fused, int first, int count, float *dst)
+{
+    const Uint8 *src = fused->buf + first * fused->src_framesize;
+
+    if (fused->src_channels == fused->work_channels) {
+        SDL_FusedDecode(fused->src_fmt, src, dst, count * fused->src_channels);
+    } else {
+        /* stereo to mono, as SDL_ConvertMono() does it */
+        float stereo[FUSED_BLOCK_FRAMES * 2];
+        int i = 0;
+
+        SDL_FusedDecode(fused->src_fmt, src, stereo, count * 2);
+#ifdef __SSE2__
+        {
+            const __m128 half = _mm_set1_ps(0.5f);
+            for (; i < (count & ~3); i += 4) {
+                const __m128 a = _mm_loadu_ps(stereo + i * 2);
+                const __m128 b = _mm_loadu_ps(stereo + i * 2 + 4);
+                _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_add_ps(
+                    _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                    _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), half));
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            const double added = ((double) stereo[i * 2]) + stereo[i * 2 + 1];
+            dst[i] = (float) (added * 0.5);
+        }
+    }
+}
+
+/* Work frames in (src) to destination frames [first, first + count) */
+static void
+SDL_FusedWrite(const SDL_FusedCVT * fused, int first, int count,
+               const float *src)
+{
+    Uint8 *dst = fused->buf + first * fused->dst_framesize;
+
+    if (fused->dst_channels == fused->work_channels) {
+        SDL_FusedEncode(fused->dst_fmt, src, dst, count * fused->dst_channels);
+    } else {
+        /* mono to stereo */
+        float stereo[FUSED_BLOCK_FRAMES * 2];
+        int i = 0;
+
+#ifdef __SSE2__
+        for (; i < (count & ~3); i += 4) {
+            const __m128 v = _mm_loadu_ps(src + i);
+            _mm_storeu_ps(stereo + i * 2, _mm_unpacklo_ps(v, v));
+            _mm_storeu_ps(stereo + i * 2 + 4, _mm_unpackhi_ps(v, v));
+        }
+#endif
+        for (; i < count; ++i) {
+            stereo[i * 2] = stereo[i * 2 + 1] = src[i];
+        }
+        SDL_FusedEncode(fused->dst_fmt, stereo, dst, count * 2);
+    }
+}
+
+/* Computes destination frames [first, last) from (window), which holds
+   source frames from (wbase) on. */
+static void
+SDL_FusedResample(const SDL_FusedCVT * fused,
+                  const SDL_ResampleTable * table, SDL_ResampleFunc run,
+                  const float *window, int wbase, int wlen,
+                  int first, int last)
+{
+    float out[FUSED_BLOCK_FRAMES * 2];
+
+    while (first < last) {
+        const int count = SDL_min(last - first, FUSED_BLOCK_FRAMES);
+        const Uint64 at = ((Uint64) first) * table->down;
+        int pos = ((int) (at / table->up)) - wbase;
+        Uint32 phase = (Uint32) (at % table->up);
+
+        run(table, AUDIO_F32SYS, (const Uint8 *) window, wlen,
+            (Uint8 *) out, count, &pos, &phase);
+        SDL_FusedWrite(fused, first, count, out);
+        first += count;
+    }
+}
+
+/* Source frame the destination frame (k) is centred on */
+#define FUSED_POS(table, k) \
+    ((int) ((((Uint64) (k)) * (table)->down) / (table)->up))
+
+/* First destination frame whose source position is at least (frame) */
+#define FUSED_FIRST_AT(table, frame) \
+    ((int) (((((Uint64) (frame)) * (table)->up) + (table)->down - 1) / \
+            (table)->down))
+
+static void
+SDL_ConvertFused(SDL_AudioCVT * cvt, int src_channels, int dst_channels,
+                 int taps)
+{
+    SDL_FusedCVT fused;
+    float window[FUSED_WINDOW_FRAMES * 2];
+    int srcframes, dstframes;
+
+    fused.buf = cvt->buf;
+    fused.src_fmt = cvt->src_format;
+    fused.dst_fmt = cvt->dst_format;
+    fused.src_channels = src_channels;
+    fused.dst_channels = dst_channels;
+    fused.work_channels = SDL_min(src_channels, dst_channels);
+    fused.src_framesize = (SDL_AUDIO_BITSIZE(fused.src_fmt) / 8) *
+        src_channels;
+    fused.dst_framesize = (SDL_AUDIO_BITSIZE(fused.dst_fmt) / 8) *
+        dst_channels;
+    srcframes = cvt->len_cvt / fused.src_framesize;
+
+    if (taps == 0) {
+        /* Same rate: each block is decoded before it is written over */
+        int first;
+
+        dstframes = srcframes;
+        if (fused.dst_framesize <= fused.src_framesize) {
+            for (first = 0; first < srcframes; first += FUSED_BLOCK_FRAMES) {
+                const int count =
+                    SDL_min(srcframes - first, FUSED_BLOCK_FRAMES);
+                SDL_FusedRead(&fused, first, count, window);
+                SDL_FusedWrite(&fused, first, count, window);
+            }
+        } else {
+            for (first = srcframes; first > 0; first -= FUSED_BLOCK_FRAMES) {
+                const int count = SDL_min(first, FUSED_BLOCK_FRAMES);
+                SDL_FusedRead(&fused, first - count, count, window);
+                SDL_FusedWrite(&fused, first - count, count, window);
+            }
+        }
+    } else {
+        const SDL_ResampleTable *table =
+            SDL_FindResampleTable(cvt->rate_incr, taps);
+        const int channels = fused.work_channels;
+        const int half = taps / 2;
+        SDL_ResampleFunc run = NULL;
+        int wbase, wlen, next, done, i;
+
+        for (i = 0; sdl_resample_filters[i].run != NULL; i++) {
+            if ((sdl_resample_filters[i].channels == channels) &&
+                (sdl_resample_filters[i].taps == taps)) {
+                run = sdl_resample_filters[i].run;
+            }
+        }
+        if ((table == NULL) || (run == NULL) || (srcframes == 0)) {
+            dstframes = 0;
+        } else if ((((Sint64) fused.dst_framesize) * table->up) <=
+                   (((Sint64) fused.src_framesize) * table->down)) {
+            /* Shrinking: destination frames [0, done) are written, the
+               window holds source frames [wbase, next) */
+            dstframes = (int) ((((Uint64) srcframes) * table->up) /
+                               table->down);
+            wbase = wlen = next = done = 0;
+            while (done < dstframes) {
+                const int count = SDL_min(srcframes - next,
+                                          SDL_min(FUSED_BLOCK_FRAMES,
+                                                  FUSED_WINDOW_FRAMES - wlen));
+                int last, keep;
+
+                SDL_FusedRead(&fused, next, count, window + wlen * channels);
+                wlen += count;
+                next += count;
+
+                if (next == srcframes) {
+                    last = dstframes;
+                } else {
+                    /* every tap inside the window, and nothing written
+                       over source frames that are still to be read */
+                    last = FUSED_FIRST_AT(table, SDL_max(next - half, 0));
+                    last = SDL_min(last, (int) ((((Sint64) next) *
+                                                 fused.src_framesize) /
+                                                fused.dst_framesize));
+                    last = SDL_max(last, done);
+                }
+                SDL_FusedResample(&fused, table, run, window, wbase, wlen,
+                                  done, last);
+                done = last;
+
+                /* drop what the next destination frame no longer needs */
+                keep = FUSED_POS(table, done) - (half - 1);
+                if (keep >= next) {
+                    wbase = next = SDL_min(keep, srcframes);
+                    wlen = 0;
+                } else if (keep > wbase) {
+                    wlen -= keep - wbase;
+                    SDL_memmove(window, window + (keep - wbase) * channels,
+                                wlen * channels * sizeof(float));
+                    wbase = keep;
+                }
+            }
+        } else {
+            /* Growing: destination frames [done, dstframes) are written,
+               the window holds source frames [next, next + wlen) */
+            dstframes = (int) ((((Uint64) srcframes) * table->up) /
+                               table->down);
+            wlen = 0;
+            next = srcframes;
+            done = dstframes;
+            while (done > 0) {
+                const int count = SDL_min(next,
+                                          SDL_min(FUSED_BLOCK_FRAMES,
+                                                  FUSED_WINDOW_FRAMES - wlen));
+                int first, keep;
+
+                SDL_memmove(window + count * channels, window,
+                            wlen * channels * sizeof(float));
+                next -= count;
+                wlen += count;
+                SDL_FusedRead(&fused, next, count, window);
+
+                if (next == 0) {
+                    first = 0;
+                } else {
+                    first = FUSED_FIRST_AT(table, next + half - 1);
+                    first = SDL_max(first, (int) (((((Sint64) next) *
+                                                    fused.src_framesize) +
+                                                   fused.dst_framesize - 1) /
+                                                  fused.dst_framesize));
+                    first = SDL_min(first, done);
+                }
+                SDL_FusedResample(&fused, table, run, window, next, wlen,
+                                  first, done);
+                done = first;
+
+                /* drop what the previous destination frame no longer needs */
+                if (done > 0) {
+                    keep = FUSED_POS(table, done - 1) + half + 1;
+                    if (keep <= next) {
+                        next = keep;
+                        wlen = 0;
+                    } else if (keep < next + wlen) {
+                        wlen = keep - next;
+                    }
+                }
+            }
+        }
+    }
+
+    cvt->len_cvt = dstframes * fused.dst_framesize;
+}
+
+#undef FUSED_POS
+#undef FUSED_FIRST_AT
+
+/* One filter per channel mapping and tap length, 0 taps keeping the rate.
+   There are none for stereo to stereo resampling: the stereo filtering
+   dominates there, and the chain's own pass measured faster. */
+#define FUSED_FILTER(src_chans, dst_chans, taps) \
+static void SDLCALL \
+SDL_ConvertFused_##src_chans##_##dst_chans##_##taps(SDL_AudioCVT * cvt, \
+                                                   SDL_AudioFormat format) \
+{ \
+    SDL_ConvertFused(cvt, src_chans, dst_chans, taps); \
+    if (cvt->filters[++cvt->filter_index]) { \
+        cvt->filters[cvt->filter_index] (cvt, cvt->dst_format); \
+    } \
+}
+
+FUSED_FILTER(1, 1, 0)
+FUSED_FILTER(1, 1, 2)
+FUSED_FILTER(1, 1, 8)
+FUSED_FILTER(1, 1, 32)
+FUSED_FILTER(1, 2, 0)
+FUSED_FILTER(1, 2, 2)
+FUSED_FILTER(1, 2, 8)
+FUSED_FILTER(1, 2, 32)
+FUSED_FILTER(2, 1, 0)
+FUSED_FILTER(2, 1, 2)
+FUSED_FILTER(2, 1, 8)
+FUSED_FILTER(2, 1, 32)
+FUSED_FILTER(2, 2, 0)
+
+#undef FUSED_FILTER
+
+static const struct
+{
+    int src_channels;
+    int dst_channels;
+    int taps;
+    SDL_AudioFilter filter;
+} sdl_fused_filters[] = {
+#define FUSED_ENTRY(src_chans, dst_chans, taps) \
+    { src_chans, dst_chans, taps, \
+      SDL_ConvertFused_##src_chans##_##dst_chans##_##taps }
+    FUSED_ENTRY(1, 1, 0),
+    FUSED_ENTRY(1, 1, 2),
+    FUSED_ENTRY(1, 1, 8),
+    FUSED_ENTRY(1, 1, 32),
+    FUSED_ENTRY(1, 2, 0),
+    FUSED_ENTRY(1, 2, 2),
+    FUSED_ENTRY(1, 2, 8),
+    FUSED_ENTRY(1, 2, 32),
+    FUSED_ENTRY(2, 1, 0),
+    FUSED_ENTRY(2, 1, 2),
+    FUSED_ENTRY(2, 1, 8),
+    FUSED_ENTRY(2, 1, 32),
+    FUSED_ENTRY(2, 2, 0),
+#undef FUSED_ENTRY
+    { 0, 0, 0, NULL }
+};
+
+/* Replaces the filter chain in (cvt) with one fused filter if it can.
+   Returns 1 if it did, 0 to keep the chain. */
+static int
+SDL_BuildAudioFusedCVT(SDL_AudioCVT * cvt,
+                       SDL_AudioFormat src_fmt, int src_channels,
+                       int src_rate, SDL_AudioFormat dst_fmt,
+                       int dst_channels, int dst_rate)
+{
+    const char *env = SDL_getenv("SDL_AUDIO_FUSED");
+    const int src_framesize = (SDL_AUDIO_BITSIZE(src_fmt) / 8) * src_channels;
+    const int dst_framesize = (SDL_AUDIO_BITSIZE(dst_fmt) / 8) * dst_channels;
+    const double ratio = (((double) dst_framesize) * dst_rate) /
+        (((double) src_framesize) * src_rate);
+    int taps = 0;
+    int i;
+
+    if ((env && (SDL_atoi(env) == 0)) || (cvt->filter_index < 2)) {
+        return 0;
+    }
+
+    if (src_rate != dst_rate) {
+        taps = SDL_GetResamplerTaps();
+        if ((taps == 0) || (src_rate > dst_rate * FUSED_MAX_DOWNSAMPLE)) {
+            return 0;
+        }
+    }
+
+    for (i = 0; sdl_fused_filters[i].filter != NULL; i++) {
+        if ((sdl_fused_filters[i].src_channels == src_channels) &&
+            (sdl_fused_filters[i].dst_channels == dst_channels) &&
+            (sdl_fused_filters[i].taps == taps)) {
+            break;
+        }
+    }
+    if (sdl_fused_filters[i].filter == NULL) {
+        return 0;
+    }
+    if ((taps != 0) && (SDL_AddResampleTable(src_rate, dst_rate, taps) < 0)) {
+        return 0;               /* keep the chain. */
+    }
+
+    cvt->filters[0] = sdl_fused_filters[i].filter;
+    cvt->filters[1] = NULL;
+    cvt->filter_index = 1;
+    cvt->len_mult = SDL_max(1, (int) SDL_ceil(ratio));
+    cvt->len_ratio = ratio;
+    return 1;
+}
+
+
 /* Creates a set of audio filters to convert from one format to another.
    Returns -1 if the format conversion is not supported, 0 if there's
    no conversion needed, or 1 if the audio filter is set up.
@@ -963,12 +2733,15 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
                   SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
                   SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
 {
+    const int chain_src_channels = src_channels;
+
     /*
      * !!! FIXME: reorder filters based on which grow/shrink the buffer.
      * !!! FIXME: ideally, we should do everything that shrinks the buffer
      * !!! FIXME: first, so we don't have to process as many bytes in a given
      * !!! FIXME: filter and abuse the CPU cache less. This might not be as
      * !!! FIXME: good in practice as it sounds in theory, though.
+     * !!! FIXME: (SDL_BuildAudioFusedCVT() sidesteps this for mono/stereo.)
      */
 
     /* there are no unsigned types over 16 bits, so catch this up front. */
@@ -1015,6 +2788,23 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
             src_channels = 2;
             cvt->len_ratio *= 2;
         }
+        if ((src_channels == 8) && (dst_channels < 8)) {
+            cvt->filters[cvt->filter_index++] = SDL_ConvertDownmix_8;
+            src_channels = 2;
+            cvt->len_ratio /= 4;
+        }
+        if ((src_channels == 2) && (dst_channels == 8)) {
+            cvt->filters[cvt->filter_index++] = SDL_ConvertSurround_8;
+            src_channels = 8;
+            cvt->len_mult *= 4;
+            cvt->len_ratio *= 4;
+        }
+        if ((src_channels == 6) && (dst_channels == 8)) {
+            cvt->filters[cvt->filter_index++] = SDL_ConvertSurround_6_8;
+            src_channels = 8;
+            cvt->len_mult *= 2;
+            cvt->len_ratio = (cvt->len_ratio * 8) / 6;
+        }
         if ((src_channels == 2) && (dst_channels == 6)) {
             cvt->filters[cvt->filter_index++] = SDL_ConvertSurround;
             src_channels = 6;
@@ -1054,7 +2844,9 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
             cvt->len_ratio /= 2;
         }
         if (src_channels != dst_channels) {
-            /* Uh oh.. */ ;
+            /* the rate filters below would walk a buffer of the wrong shape */
+            SDL_SetError("No conversion available for these channels");
+            return -1;
         }
     }
 
@@ -1064,6 +2856,10 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
         return -1;              /* shouldn't happen, but just in case... */
     }
 
+    /* Collapse the chain into one pass over the buffer, if possible */
+    SDL_BuildAudioFusedCVT(cvt, src_fmt, chain_src_channels, src_rate,
+                           dst_fmt, dst_channels, dst_rate);
+
     /* Set up the filter information */
     if (cvt->filter_index != 0) {
         cvt->needed = 1;
@@ -1077,4 +2873,402 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
 }
 
 
+
+/* Streaming conversion */
+
+/* Source frames converted per pass, which bounds every internal buffer */
+#define STREAM_CHUNK_FRAMES 1024
+
+/* Streamer: a ring of converted bytes waiting to be read */
+typedef struct
+{
+    Uint8 *buffer;
+    int max_len;                /* the maximum length in bytes */
+    int read_pos, write_pos;    /* the position of the write and read heads in bytes */
+} SDL_AudioStreamer;
+
+struct SDL_AudioStream
+{
+    int src_framesize;
+    int dst_framesize;
+
+    /* Source format to the working format, at the source rate */
+    SDL_AudioCVT cvt_before;
+    Uint8 *work;
+
+    /* Resampler, if the rates differ */
+    const SDL_ResampleTable *table;
+    SDL_ResampleFunc resample;
+    int taps;
+    SDL_AudioFormat work_format;
+    int work_framesize;
+    Uint8 *history;             /* source frames the filter still needs */
+    int history_frames;
+    int pos;                    /* next output's frame in (history) */
+    Uint32 phase;
+    Uint64 frames_in;           /* since the last flush */
+    Uint64 frames_out;
+
+    /* Working format to the destination format, at the destination rate */
+    SDL_AudioCVT cvt_after;
+    Uint8 *resampled;
+
+    SDL_AudioStreamer queue;
+};
+
+static int
+SDL_StreamInit(SDL_AudioStreamer * stream, int max_len)
+{
+    stream->buffer = (Uint8 *) SDL_malloc(max_len);
+    if (stream->buffer == NULL) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+
+    stream->max_len = max_len;
+    stream->read_pos = 0;
+    stream->write_pos = 0;
+    return 0;
+}
+
+static void
+SDL_StreamDeinit(SDL_AudioStreamer * stream)
+{
+    if (stream->buffer != NULL) {
+        SDL_free(stream->buffer);
+    }
+}
+
+static int
+SDL_StreamLength(SDL_AudioStreamer * stream)
+{
+    return (stream->write_pos - stream->read_pos + stream->max_len) %
+        stream->max_len;
+}
+
+/* Read [length] bytes out of the streamer into buf */
+static void
+SDL_StreamRead(SDL_AudioStreamer * stream, Uint8 * buf, int length)
+{
+    const int first = SDL_min(length, stream->max_len - stream->read_pos);
+
+    SDL_memcpy(buf, stream->buffer + stream->read_pos, first);
+    SDL_memcpy(buf + first, stream->buffer, length - first);
+    stream->read_pos = (stream->read_pos + length) % stream->max_len;
+}
+
+/* Write [length] bytes from buf into the streamer, growing it if the reader
+   has fallen behind. The ring is never filled completely, so an empty one
+   is unambiguous. */
+static int
+SDL_StreamWrite(SDL_AudioStreamer * stream, const Uint8 * buf, int length)
+{
+    const int used = SDL_StreamLength(stream);
+    int first;
+
+    if (used + length >= stream->max_len) {
+        const int max_len = SDL_max(stream->max_len * 2, used + length + 1);
+        Uint8 *buffer = (Uint8 *) SDL_malloc(max_len);
+        if (buffer == NULL) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+        SDL_StreamRead(stream, buffer, used);
+        SDL_free(stream->buffer);
+        stream->buffer = buffer;
+        stream->max_len = max_len;
+        stream->read_pos = 0;
+        stream->write_pos = used;
+    }
+
+    first = SDL_min(length, stream->max_len - stream->write_pos);
+    SDL_memcpy(stream->buffer + stream->write_pos, buf, first);
+    SDL_memcpy(stream->buffer, buf + first, length - first);
+    stream->write_pos = (stream->write_pos + length) % stream->max_len;
+    return 0;
+}
+
+/* The filter looks back half its taps, so a new stream starts on silence */
+static void
+SDL_AudioStreamResetResampler(SDL_AudioStream * stream)
+{
+    if (stream->table != NULL) {
+        stream->history_frames = (stream->taps / 2) - 1;
+        SDL_memset(stream->history, 0,
+                   stream->history_frames * stream->work_framesize);
+        stream->pos = stream->history_frames;
+        stream->phase = 0;
+        stream->frames_in = 0;
+        stream->frames_out = 0;
+    }
+}
+
+/* Resample every output frame whose taps are all in the history, or when
+   flushing, every one the source frames so far account for. */
+static int
+SDL_AudioStreamResample(SDL_AudioStream * stream, SDL_bool flush)
+{
+    const SDL_ResampleTable *table = stream->table;
+    const int half = stream->taps / 2;
+    const int last = stream->history_frames - half - 1;
+    int outframes = 0;
+    int drop;
+
+    if (stream->pos <= last) {
+        outframes = (int) (((((Uint64) (last - stream->pos + 1)) * table->up)
+                            - stream->phase + table->down - 1) / table->down);
+    }
+    if (flush) {
+        /* every output frame timed before the end of the source */
+        const Uint64 total = ((stream->frames_in * table->up) +
+                              table->down - 1) / table->down;
+        if (stream->frames_out + outframes > total) {
+            outframes = (total > stream->frames_out) ?
+                (int) (total - stream->frames_out) : 0;
+        }
+    }
+
+    if (outframes > 0) {
+        stream->resample(table, stream->work_format, stream->history,
+                         stream->history_frames, stream->resampled,
+                         outframes, &stream->pos, &stream->phase);
+        stream->frames_out += outframes;
+
+        stream->cvt_after.buf = stream->resampled;
+        stream->cvt_after.len = outframes * stream->work_framesize;
+        SDL_ConvertAudio(&stream->cvt_after);
+        if (SDL_StreamWrite(&stream->queue, stream->resampled,
+                            stream->cvt_after.len_cvt) < 0) {
+            return -1;
+        }
+    }
+
+    /* Keep the frames the next output still reaches back to */
+    drop = SDL_min(stream->pos - (half - 1), stream->history_frames);
+    if (drop > 0) {
+        stream->history_frames -= drop;
+        SDL_memmove(stream->history,
+                    stream->history + drop * stream->work_framesize,
+                    stream->history_frames * stream->work_framesize);
+        stream->pos -= drop;
+    }
+    return 0;
+}
+
+SDL_AudioStream *
+SDL_NewAudioStream(SDL_AudioFormat src_format, Uint8 src_channels,
+                   int src_rate, SDL_AudioFormat dst_format,
+                   Uint8 dst_channels, int dst_rate)
+{
+    SDL_AudioStream *stream;
+    int outframes = STREAM_CHUNK_FRAMES;
+    int i;
+
+    stream = (SDL_AudioStream *) SDL_calloc(1, sizeof(*stream));
+    if (stream == NULL) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    stream->src_framesize = (SDL_AUDIO_BITSIZE(src_format) / 8) * src_channels;
+    stream->dst_framesize = (SDL_AUDIO_BITSIZE(dst_format) / 8) * dst_channels;
+
+    if (src_rate == dst_rate) {
+        if (SDL_BuildAudioCVT(&stream->cvt_before, src_format, src_channels,
+                              src_rate, dst_format, dst_channels,
+                              dst_rate) < 0) {
+            SDL_FreeAudioStream(stream);
+            return NULL;
+        }
+    } else {
+        /* Resample in 16-bit unless either end needs more */
+        stream->work_format = ((SDL_AUDIO_BITSIZE(src_format) > 16) ||
+                               (SDL_AUDIO_BITSIZE(dst_format) > 16)) ?
+            AUDIO_F32SYS : AUDIO_S16SYS;
+        stream->work_framesize =
+            (SDL_AUDIO_BITSIZE(stream->work_format) / 8) * dst_channels;
+
+        /* Streams always need the filter history, even for "legacy" */
+        stream->taps = SDL_GetResamplerTaps();
+        if (stream->taps == 0) {
+            stream->taps = 2;
+        }
+        for (i = 0; sdl_resample_filters[i].run != NULL; i++) {
+            if ((sdl_resample_filters[i].channels == dst_channels) &&
+                (sdl_resample_filters[i].taps == stream->taps)) {
+                stream->resample = sdl_resample_filters[i].run;
+                break;
+            }
+        }
+        if (stream->resample == NULL) {
+            SDL_SetError("No resampler for %d channels", (int) dst_channels);
+            SDL_FreeAudioStream(stream);
+            return NULL;
+        }
+        if ((SDL_BuildAudioCVT(&stream->cvt_before, src_format, src_channels,
+                               src_rate, stream->work_format, dst_channels,
+                               src_rate) < 0) ||
+            (SDL_BuildAudioCVT(&stream->cvt_after, stream->work_format,
+                               dst_channels, dst_rate, dst_format,
+                               dst_channels, dst_rate) < 0) ||
+            (SDL_AddResampleTable(src_rate, dst_rate, stream->taps) < 0)) {
+            SDL_FreeAudioStream(stream);
+            return NULL;
+        }
+        if ((stream->cvt_before.len_ratio * stream->src_framesize) !=
+            stream->work_framesize) {
+            SDL_SetError("Unsupported channel conversion");
+            SDL_FreeAudioStream(stream);
+            return NULL;
+        }
+        stream->table = SDL_FindResampleTable(((double) dst_rate) /
+                                              ((double) src_rate),
+                                              stream->taps);
+
+        /* A pass sees at most a chunk plus the taps it carried over */
+        outframes = (int) ((((Uint64) (STREAM_CHUNK_FRAMES + stream->taps))
+                            * stream->table->up) / stream->table->down) + 2;
+        stream->history = (Uint8 *) SDL_malloc((STREAM_CHUNK_FRAMES +
+                                                stream->taps) *
+                                               stream->work_framesize);
+        stream->resampled = (Uint8 *) SDL_malloc(outframes *
+                                                 stream->work_framesize *
+                                                 stream->cvt_after.len_mult);
+        if ((stream->history == NULL) || (stream->resampled == NULL)) {
+            SDL_OutOfMemory();
+            SDL_FreeAudioStream(stream);
+            return NULL;
+        }
+        SDL_AudioStreamResetResampler(stream);
+    }
+
+    stream->work = (Uint8 *) SDL_malloc(STREAM_CHUNK_FRAMES *
+                                        stream->src_framesize *
+                                        stream->cvt_before.len_mult);
+    if (stream->work == NULL) {
+        SDL_OutOfMemory();
+        SDL_FreeAudioStream(stream);
+        return NULL;
+    }
+    if (SDL_StreamInit(&stream->queue,
+                       2 * outframes * stream->dst_framesize) < 0) {
+        SDL_FreeAudioStream(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+int
+SDL_AudioStreamPut(SDL_AudioStream * stream, const void *buf, int len)
+{
+    const Uint8 *src = (const Uint8 *) buf;
+
+    if ((stream == NULL) || (buf == NULL) || (len < 0)) {
+        SDL_SetError("Invalid audio stream parameters");
+        return -1;
+    }
+    if ((len % stream->src_framesize) != 0) {
+        SDL_SetError("Audio stream data must be whole sample frames");
+        return -1;
+    }
+
+    while (len > 0) {
+        const int bytes =
+            SDL_min(len, STREAM_CHUNK_FRAMES * stream->src_framesize);
+
+        SDL_memcpy(stream->work, src, bytes);
+        stream->cvt_before.buf = stream->work;
+        stream->cvt_before.len = bytes;
+        SDL_ConvertAudio(&stream->cvt_before);
+
+        if (stream->table == NULL) {
+            if (SDL_StreamWrite(&stream->queue, stream->work,
+                                stream->cvt_before.len_cvt) < 0) {
+                return -1;
+            }
+        } else {
+            const int frames = bytes / stream->src_framesize;
+            SDL_memcpy(stream->history +
+                       stream->history_frames * stream->work_framesize,
+                       stream->work, frames * stream->work_framesize);
+            stream->history_frames += frames;
+            stream->frames_in += frames;
+            if (SDL_AudioStreamResample(stream, SDL_FALSE) < 0) {
+                return -1;
+            }
+        }
+        src += bytes;
+        len -= bytes;
+    }
+    return 0;
+}
+
+int
+SDL_AudioStreamFlush(SDL_AudioStream * stream)
+{
+    int pad;
+
+    if (stream == NULL) {
+        SDL_SetError("Invalid audio stream parameters");
+        return -1;
+    }
+    if (stream->table != NULL) {
+        /* Silence for the filter to look ahead into */
+        pad = (stream->taps / 2) + 1;
+        SDL_memset(stream->history +
+                   stream->history_frames * stream->work_framesize, 0,
+                   pad * stream->work_framesize);
+        stream->history_frames += pad;
+        if (SDL_AudioStreamResample(stream, SDL_TRUE) < 0) {
+            return -1;
+        }
+        SDL_AudioStreamResetResampler(stream);
+    }
+    return 0;
+}
+
+int
+SDL_AudioStreamAvailable(SDL_AudioStream * stream)
+{
+    return (stream != NULL) ? SDL_StreamLength(&stream->queue) : 0;
+}
+
+int
+SDL_AudioStreamGet(SDL_AudioStream * stream, void *buf, int len)
+{
+    if ((stream == NULL) || (buf == NULL) || (len < 0)) {
+        SDL_SetError("Invalid audio stream parameters");
+        return -1;
+    }
+    len = SDL_min(len, SDL_StreamLength(&stream->queue));
+    SDL_StreamRead(&stream->queue, (Uint8 *) buf, len);
+    return len;
+}
+
+void
+SDL_AudioStreamClear(SDL_AudioStream * stream)
+{
+    if (stream != NULL) {
+        stream->queue.read_pos = stream->queue.write_pos = 0;
+        SDL_AudioStreamResetResampler(stream);
+    }
+}
+
+void
+SDL_FreeAudioStream(SDL_AudioStream * stream)
+{
+    if (stream != NULL) {
+        SDL_StreamDeinit(&stream->queue);
+        if (stream->work != NULL) {
+            SDL_free(stream->work);
+        }
+        if (stream->history != NULL) {
+            SDL_free(stream->history);
+        }
+        if (stream->resampled != NULL) {
+            SDL_free(stream->resampled);
+        }
+        SDL_free(stream);
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -27,10 +27,15 @@
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "SDL_sysaudio.h"
+#include "SDL_audio_c.h"
 #include "SDL_mixer_MMX.h"
 #include "SDL_mixer_MMX_VC.h"
 #include "SDL_mixer_m68k.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
  * Changed to use 0xFE instead of 0xFF for better sound quality.
@@ -362,4 +367,334 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
     }
 }
 
+
+/*
+ * Mixing many sources at once: a block of every source is added into a bus
+ * of 32-bit ints (S16) or floats (F32), and the bus is clipped and stored
+ * into the destination once, rather than clipping after every source.
+ *
+ * S16 voices are summed as sample * volume and shifted down at the end, so
+ * a single voice at full volume comes out unchanged.
+ */
+
+/* Samples in the bus; this is on the stack of the audio thread */
+#define MIX_BUS_SAMPLES 256
+
+/* Voices per pass, well short of overflowing the S16 bus (511 full
+   volume voices); longer lists are clipped into dst between passes */
+#define MIX_BUS_SOURCES 256
+
+/* Whether samples in each byte order must be swapped on this CPU */
+#define MIX_SWAP_LSB (SDL_BYTEORDER == SDL_BIG_ENDIAN)
+#define MIX_SWAP_MSB (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+
+typedef union
+{
+    Sint32 s32[MIX_BUS_SAMPLES];
+    float f32[MIX_BUS_SAMPLES];
+#ifdef __SSE2__
+    __m128 align_sse;
+#endif
+} SDL_MixBus;
+
+static __inline__ float
+SDL_MixLoadSampleF32(const Uint32 * src, const int swap)
+{
+    union
+    {
+        Uint32 u32;
+        float f32;
+    } x;
+
+    x.u32 = swap ? SDL_Swap32(*src) : *src;
+    return x.f32;
+}
+
+static __inline__ void
+SDL_MixStoreSampleF32(Uint32 * dst, const float sample, const int swap)
+{
+    union
+    {
+        Uint32 u32;
+        float f32;
+    } x;
+
+    x.f32 = sample;
+    *dst = swap ? SDL_Swap32(x.u32) : x.u32;
+}
+
+#ifdef __SSE2__
+static __inline__ __m128i
+SDL_MixSwap16Vec_SSE2(const __m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static __inline__ __m128i
+SDL_MixSwap32Vec_SSE2(__m128i v)
+{
+    v = SDL_MixSwap16Vec_SSE2(v);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/* These return how many samples they did; the rest are done in C */
+static int
+SDL_MixAddS16_SSE2(Sint32 * bus, const Uint8 * src, const int swap,
+                   const int volume, const int samples)
+{
+    const __m128i zero = _mm_setzero_si128();
+    /* madd of (sample, 0) pairs with (volume, 0) is sample * volume */
+    const __m128i vol = _mm_set1_epi32(volume);
+    const int count = samples & ~7;
+    int i;
+
+    for (i = 0; i < count; i += 8) {
+        __m128i *out = (__m128i *) (bus + i);
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + i * 2));
+        if (swap) {
+            v = SDL_MixSwap16Vec_SSE2(v);
+        }
+        out[0] = _mm_add_epi32(out[0],
+                               _mm_madd_epi16(_mm_unpacklo_epi16(v, zero),
+                                              vol));
+        out[1] = _mm_add_epi32(out[1],
+                               _mm_madd_epi16(_mm_unpackhi_epi16(v, zero),
+                                              vol));
+    }
+    return count;
+}
+
+static int
+SDL_MixStoreS16_SSE2(const Sint32 * bus, Uint8 * dst, const int swap,
+                     const int samples)
+{
+    const int count = samples & ~7;
+    int i;
+
+    for (i = 0; i < count; i += 8) {
+        const __m128i *in = (const __m128i *) (bus + i);
+        __m128i v = _mm_packs_epi32(_mm_srai_epi32(in[0], 7),
+                                    _mm_srai_epi32(in[1], 7));
+        if (swap) {
+            v = SDL_MixSwap16Vec_SSE2(v);
+        }
+        _mm_storeu_si128((__m128i *) (dst + i * 2), v);
+    }
+    return count;
+}
+
+static int
+SDL_MixAddF32_SSE2(float *bus, const Uint8 * src, const int swap,
+                   const float volume, const int samples)
+{
+    const __m128 vol = _mm_set1_ps(volume);
+    const int count = samples & ~3;
+    int i;
+
+    for (i = 0; i < count; i += 4) {
+        __m128 *out = (__m128 *) (bus + i);
+        __m128 v;
+        if (swap) {
+            v = _mm_castsi128_ps(SDL_MixSwap32Vec_SSE2(
+                _mm_loadu_si128((const __m128i *) (src + i * 4))));
+        } else {
+            v = _mm_loadu_ps((const float *) (src + i * 4));
+        }
+        *out = _mm_add_ps(*out, _mm_mul_ps(v, vol));
+    }
+    return count;
+}
+
+static int
+SDL_MixStoreF32_SSE2(const float *bus, Uint8 * dst, const int swap,
+                     const int samples)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minus_one = _mm_set1_ps(-1.0f);
+    const int count = samples & ~3;
+    int i;
+
+    for (i = 0; i < count; i += 4) {
+        const __m128 v = _mm_max_ps(_mm_min_ps(*(const __m128 *) (bus + i),
+                                               one), minus_one);
+        if (swap) {
+            _mm_storeu_si128((__m128i *) (dst + i * 4),
+                             SDL_MixSwap32Vec_SSE2(_mm_castps_si128(v)));
+        } else {
+            _mm_storeu_ps((float *) (dst + i * 4), v);
+        }
+    }
+    return count;
+}
+#endif /* __SSE2__ */
+
+static void
+SDL_MixAddS16(Sint32 * bus, const Uint8 * src, const int swap,
+              const int volume, const int samples, const Uint32 features)
+{
+    const Sint16 *src16 = (const Sint16 *) src;
+    int i = 0;
+
+#ifdef __SSE2__
+    if (features & SDL_AUDIO_CPU_SSE2) {
+        i = SDL_MixAddS16_SSE2(bus, src, swap, volume, samples);
+    }
+#endif
+    for (; i < samples; ++i) {
+        const Sint16 sample =
+            swap ? (Sint16) SDL_Swap16((Uint16) src16[i]) : src16[i];
+        bus[i] += sample * volume;
+    }
+}
+
+static void
+SDL_MixStoreS16(const Sint32 * bus, Uint8 * dst, const int swap,
+                const int samples, const Uint32 features)
+{
+    Sint16 *dst16 = (Sint16 *) dst;
+    int i = 0;
+
+#ifdef __SSE2__
+    if (features & SDL_AUDIO_CPU_SSE2) {
+        i = SDL_MixStoreS16_SSE2(bus, dst, swap, samples);
+    }
+#endif
+    for (; i < samples; ++i) {
+        Sint32 sample = bus[i] >> 7;
+        if (sample > 32767) {
+            sample = 32767;
+        } else if (sample < -32768) {
+            sample = -32768;
+        }
+        dst16[i] = swap ? (Sint16) SDL_Swap16((Uint16) sample)
+            : (Sint16) sample;
+    }
+}
+
+static void
+SDL_MixAddF32(float *bus, const Uint8 * src, const int swap,
+              const float volume, const int samples, const Uint32 features)
+{
+    const Uint32 *src32 = (const Uint32 *) src;
+    int i = 0;
+
+#ifdef __SSE2__
+    if (features & SDL_AUDIO_CPU_SSE2) {
+        i = SDL_MixAddF32_SSE2(bus, src, swap, volume, samples);
+    }
+#endif
+    for (; i < samples; ++i) {
+        bus[i] += SDL_MixLoadSampleF32(&src32[i], swap) * volume;
+    }
+}
+
+static void
+SDL_MixStoreF32(const float *bus, Uint8 * dst, const int swap,
+                const int samples, const Uint32 features)
+{
+    Uint32 *dst32 = (Uint32 *) dst;
+    int i = 0;
+
+#ifdef __SSE2__
+    if (features & SDL_AUDIO_CPU_SSE2) {
+        i = SDL_MixStoreF32_SSE2(bus, dst, swap, samples);
+    }
+#endif
+    for (; i < samples; ++i) {
+        float sample = bus[i];
+        if (sample > 1.0f) {
+            sample = 1.0f;
+        } else if (sample < -1.0f) {
+            sample = -1.0f;
+        }
+        SDL_MixStoreSampleF32(&dst32[i], sample, swap);
+    }
+}
+
+/* Mix one block of up to MIX_BUS_SAMPLES samples, starting at offset */
+static void
+SDL_MixBlock(Uint8 * dst, const SDL_AudioMixSource * sources,
+             int num_sources, SDL_AudioFormat format, int offset,
+             int samples, Uint32 features)
+{
+    const int swap = SDL_AUDIO_ISBIGENDIAN(format) ? MIX_SWAP_MSB
+        : MIX_SWAP_LSB;
+    SDL_MixBus bus;
+    int i;
+
+    if (SDL_AUDIO_ISFLOAT(format)) {
+        SDL_memset(bus.f32, 0, samples * sizeof(float));
+        SDL_MixAddF32(bus.f32, dst + offset, swap, 1.0f, samples, features);
+        for (i = 0; i < num_sources; ++i) {
+            int volume = sources[i].volume;
+            if (volume <= 0) {
+                continue;
+            }
+            if (volume > SDL_MIX_MAXVOLUME) {
+                volume = SDL_MIX_MAXVOLUME;
+            }
+            SDL_MixAddF32(bus.f32, sources[i].buf + offset, swap,
+                          volume / (float) SDL_MIX_MAXVOLUME, samples,
+                          features);
+        }
+        SDL_MixStoreF32(bus.f32, dst + offset, swap, samples, features);
+    } else {
+        SDL_memset(bus.s32, 0, samples * sizeof(Sint32));
+        SDL_MixAddS16(bus.s32, dst + offset, swap, SDL_MIX_MAXVOLUME,
+                      samples, features);
+        for (i = 0; i < num_sources; ++i) {
+            int volume = sources[i].volume;
+            if (volume <= 0) {
+                continue;
+            }
+            if (volume > SDL_MIX_MAXVOLUME) {
+                volume = SDL_MIX_MAXVOLUME;
+            }
+            SDL_MixAddS16(bus.s32, sources[i].buf + offset, swap, volume,
+                          samples, features);
+        }
+        SDL_MixStoreS16(bus.s32, dst + offset, swap, samples, features);
+    }
+}
+
+void
+SDL_MixAudioSources(Uint8 * dst, const SDL_AudioMixSource * sources,
+                    int num_sources, SDL_AudioFormat format, Uint32 len)
+{
+    Uint32 features;
+    int samples, offset, count, first;
+    int i;
+
+    switch (format) {
+    case AUDIO_S16LSB:
+    case AUDIO_S16MSB:
+    case AUDIO_F32LSB:
+    case AUDIO_F32MSB:
+        break;
+
+    default:
+        /* No bus for these; mix them one at a time */
+        for (i = 0; i < num_sources; ++i) {
+            if (sources[i].volume > 0) {
+                SDL_MixAudioFormat(dst, sources[i].buf, format, len,
+                                   sources[i].volume);
+            }
+        }
+        return;
+    }
+
+    features = SDL_GetAudioCPUFeatures();
+    samples = len / (SDL_AUDIO_BITSIZE(format) / 8);
+    for (first = 0; first < num_sources; first += MIX_BUS_SOURCES) {
+        const int voices = SDL_min(num_sources - first, MIX_BUS_SOURCES);
+        for (offset = 0; offset < samples; offset += count) {
+            count = SDL_min(samples - offset, MIX_BUS_SAMPLES);
+            SDL_MixBlock(dst, sources + first, voices, format,
+                         offset * (SDL_AUDIO_BITSIZE(format) / 8), count,
+                         features);
+        }
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
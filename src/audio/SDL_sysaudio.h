@@ -24,6 +24,7 @@
 #ifndef _SDL_sysaudio_h
 #define _SDL_sysaudio_h
 
+#include "SDL_atomic.h"
 #include "SDL_mutex.h"
 #include "SDL_thread.h"
 
@@ -52,6 +53,7 @@ typedef struct SDL_AudioDriverImpl
     int HasCaptureSupport:1;
     int OnlyHasDefaultOutputDevice:1;
     int OnlyHasDefaultInputDevice:1;
+    int CanFreewheel:1;         /* nothing is lost by not waiting */
 } SDL_AudioDriverImpl;
 
 
@@ -69,15 +71,6 @@ typedef struct SDL_AudioDriver
 } SDL_AudioDriver;
 
 
-/* Streamer */
-typedef struct
-{
-    Uint8 *buffer;
-    int max_len;                /* the maximum length in bytes */
-    int read_pos, write_pos;    /* the position of the write and read heads in bytes */
-} SDL_AudioStreamer;
-
-
 /* Define the SDL audio driver structure */
 struct SDL_AudioDevice
 {
@@ -92,7 +85,26 @@ struct SDL_AudioDevice
 
     /* The streamer, if sample rate conversion necessitates it */
     int use_streamer;
-    SDL_AudioStreamer streamer;
+    SDL_AudioStream *streamer;
+    Uint8 *streamer_buf;        /* callback data, in the app's format */
+    int streamer_len;
+
+    /* Pushed audio, in the app's format, if it opened without a callback.
+       One thread queues and the audio thread plays, without any lock. */
+    Uint8 *queue;
+    Uint32 queue_size;          /* a power of two */
+    volatile Uint32 queue_head; /* bytes ever queued, only the app writes */
+    volatile Uint32 queue_tail; /* bytes ever played, only we write */
+    int queue_framesize;
+    Uint8 queue_silence;
+
+    /* Offline rendering, as set by SDL_AUDIO_FREEWHEEL(_FRAMES) */
+    int freewheel;              /* never wait for the device */
+    Uint64 freewheel_frames;    /* stop after this many, or 0 */
+
+    /* Only the audio thread writes these, holding stats_lock */
+    SDL_AudioDeviceStats stats;
+    SDL_SpinLock stats_lock;
 
     /* Current state flags */
     int iscapture;
@@ -24,10 +24,29 @@
 /* Microsoft WAVE file loading routines */
 
 #include "SDL_audio.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_thread.h"
 #include "SDL_wave.h"
 
 
-static int ReadChunk(SDL_RWops * src, Chunk * chunk);
+static int ReadChunkHeader(SDL_RWops * src, Chunk * chunk);
+static int ReadChunkData(SDL_RWops * src, Chunk * chunk);
+static int SkipChunk(SDL_RWops * src, Chunk * chunk);
+
+/* How the data chunk turns into samples; wavefmt is in native byte order */
+typedef struct WaveDecoder
+{
+    WaveFMT wavefmt;
+    Uint16 wSamplesPerBlock;    /* ADPCM only */
+    Uint16 wNumCoef;            /* MS ADPCM only */
+    Sint16 aCoeff[7][2];        /* MS ADPCM only */
+    /* Decodes one block of wavefmt.blockalign bytes, NULL for PCM */
+    int (*DecodeBlock) (const struct WaveDecoder * decoder,
+                        const Uint8 * encoded, Uint8 * decoded);
+} WaveDecoder;
+
+/* An ADPCM block index meaning none */
+#define WAVE_NO_BLOCK 0xFFFFFFFF
 
 struct MS_ADPCM_decodestate
 {
@@ -36,56 +55,57 @@ struct MS_ADPCM_decodestate
     Sint16 iSamp1;
     Sint16 iSamp2;
 };
-static struct MS_ADPCM_decoder
-{
-    WaveFMT wavefmt;
-    Uint16 wSamplesPerBlock;
-    Uint16 wNumCoef;
-    Sint16 aCoeff[7][2];
-    /* * * */
-    struct MS_ADPCM_decodestate state[2];
-} MS_ADPCM_state;
 
+static int MS_ADPCM_decode_block(const WaveDecoder * decoder,
+                                 const Uint8 * encoded, Uint8 * decoded);
+
+/* (rogue_feel) is the (extra_len) bytes of the format chunk after WaveFMT */
 static int
-InitMS_ADPCM(WaveFMT * format)
+InitMS_ADPCM(WaveDecoder * decoder, const Uint8 * rogue_feel,
+             Uint32 extra_len)
 {
-    Uint8 *rogue_feel;
-    Uint16 extra_info;
+    const Uint16 channels = decoder->wavefmt.channels;
     int i;
 
-    /* Set the rogue pointer to the MS_ADPCM specific data */
-    MS_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    MS_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    MS_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    MS_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    MS_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    MS_ADPCM_state.wavefmt.bitspersample =
-        SDL_SwapLE16(format->bitspersample);
-    rogue_feel = (Uint8 *) format + sizeof(*format);
-    if (sizeof(*format) == 16) {
-        extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]);
-        rogue_feel += sizeof(Uint16);
+    /* cbSize, wSamplesPerBlock, wNumCoef and then the coefficients */
+    if (extra_len < (3 + 7 * 2) * sizeof(Uint16)) {
+        SDL_SetError("MS ADPCM format chunk is too short");
+        return (-1);
     }
-    MS_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    MS_ADPCM_state.wNumCoef = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    if (MS_ADPCM_state.wNumCoef != 7) {
+    decoder->wNumCoef = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    rogue_feel += sizeof(Uint16);
+    if (decoder->wNumCoef != 7) {
         SDL_SetError("Unknown set of MS_ADPCM coefficients");
         return (-1);
     }
-    for (i = 0; i < MS_ADPCM_state.wNumCoef; ++i) {
-        MS_ADPCM_state.aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    for (i = 0; i < decoder->wNumCoef; ++i) {
+        decoder->aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
-        MS_ADPCM_state.aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+        decoder->aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
     }
+
+    if (channels > 2) {
+        SDL_SetError("MS ADPCM decoder can only handle %d channels", 2);
+        return (-1);
+    }
+    /* 7 header bytes per channel, then a nibble for each other sample */
+    if ((decoder->wSamplesPerBlock < 2) ||
+        ((7 * channels + ((decoder->wSamplesPerBlock - 2) * channels + 1) / 2)
+         > decoder->wavefmt.blockalign)) {
+        SDL_SetError("Invalid MS ADPCM block size");
+        return (-1);
+    }
+    decoder->DecodeBlock = MS_ADPCM_decode_block;
     return (0);
 }
 
 static Sint32
 MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
-                Uint8 nybble, Sint16 * coeff)
+                Uint8 nybble, const Sint16 * coeff)
 {
     const Sint32 max_audioval = ((1 << (16 - 1)) - 1);
     const Sint32 min_audioval = -(1 << (16 - 1));
@@ -117,103 +137,95 @@ MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
     return (new_sample);
 }
 
+/* Decode one block into wSamplesPerBlock little-endian Sint16 frames */
 static int
-MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+MS_ADPCM_decode_block(const WaveDecoder * decoder, const Uint8 * encoded,
+                      Uint8 * decoded)
 {
+    struct MS_ADPCM_decodestate states[2];
     struct MS_ADPCM_decodestate *state[2];
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
-    Sint8 nybble, stereo;
-    Sint16 *coeff[2];
+    const Sint16 *coeff[2];
+    Sint32 samplesleft;
+    Uint8 nybble;
+    Sint8 stereo;
     Sint32 new_sample;
 
-    /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
-    *audio_len = (encoded_len / MS_ADPCM_state.wavefmt.blockalign) *
-        MS_ADPCM_state.wSamplesPerBlock *
-        MS_ADPCM_state.wavefmt.channels * sizeof(Sint16);
-    *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
-    if (*audio_buf == NULL) {
-        SDL_Error(SDL_ENOMEM);
+    /* Grab the initial information for this block */
+    stereo = (decoder->wavefmt.channels == 2);
+    state[0] = &states[0];
+    state[1] = &states[stereo];
+    state[0]->hPredictor = *encoded++;
+    if (stereo) {
+        state[1]->hPredictor = *encoded++;
+    }
+    if ((state[0]->hPredictor >= decoder->wNumCoef) ||
+        (state[1]->hPredictor >= decoder->wNumCoef)) {
+        SDL_SetError("Invalid MS ADPCM predictor");
         return (-1);
     }
-    decoded = *audio_buf;
-
-    /* Get ready... Go! */
-    stereo = (MS_ADPCM_state.wavefmt.channels == 2);
-    state[0] = &MS_ADPCM_state.state[0];
-    state[1] = &MS_ADPCM_state.state[stereo];
-    while (encoded_len >= MS_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
-        state[0]->hPredictor = *encoded++;
-        if (stereo) {
-            state[1]->hPredictor = *encoded++;
-        }
-        state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        coeff[0] = MS_ADPCM_state.aCoeff[state[0]->hPredictor];
-        coeff[1] = MS_ADPCM_state.aCoeff[state[1]->hPredictor];
-
-        /* Store the two initial samples we start with */
-        decoded[0] = state[0]->iSamp2 & 0xFF;
-        decoded[1] = state[0]->iSamp2 >> 8;
+    }
+    coeff[0] = decoder->aCoeff[state[0]->hPredictor];
+    coeff[1] = decoder->aCoeff[state[1]->hPredictor];
+
+    /* Store the two initial samples we start with */
+    decoded[0] = state[0]->iSamp2 & 0xFF;
+    decoded[1] = state[0]->iSamp2 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp2 & 0xFF;
+        decoded[1] = state[1]->iSamp2 >> 8;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp2 & 0xFF;
-            decoded[1] = state[1]->iSamp2 >> 8;
-            decoded += 2;
-        }
-        decoded[0] = state[0]->iSamp1 & 0xFF;
-        decoded[1] = state[0]->iSamp1 >> 8;
+    }
+    decoded[0] = state[0]->iSamp1 & 0xFF;
+    decoded[1] = state[0]->iSamp1 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp1 & 0xFF;
+        decoded[1] = state[1]->iSamp1 >> 8;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp1 & 0xFF;
-            decoded[1] = state[1]->iSamp1 >> 8;
-            decoded += 2;
-        }
+    }
 
-        /* Decode and store the other samples in this block */
-        samplesleft = (MS_ADPCM_state.wSamplesPerBlock - 2) *
-            MS_ADPCM_state.wavefmt.channels;
-        while (samplesleft > 0) {
-            nybble = (*encoded) >> 4;
-            new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
-            decoded[0] = new_sample & 0xFF;
-            new_sample >>= 8;
-            decoded[1] = new_sample & 0xFF;
-            decoded += 2;
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 2) *
+        decoder->wavefmt.channels;
+    while (samplesleft > 0) {
+        nybble = (*encoded) >> 4;
+        new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
+        decoded[0] = new_sample & 0xFF;
+        new_sample >>= 8;
+        decoded[1] = new_sample & 0xFF;
+        decoded += 2;
 
+        /* An odd mono block leaves the last low nibble unused */
+        if (samplesleft > 1) {
             nybble = (*encoded) & 0x0F;
             new_sample = MS_ADPCM_nibble(state[1], nybble, coeff[1]);
             decoded[0] = new_sample & 0xFF;
             new_sample >>= 8;
             decoded[1] = new_sample & 0xFF;
             decoded += 2;
-
-            ++encoded;
-            samplesleft -= 2;
         }
-        encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
+
+        ++encoded;
+        samplesleft -= 2;
     }
-    SDL_free(freeable);
     return (0);
 }
 
@@ -222,34 +234,38 @@ struct IMA_ADPCM_decodestate
     Sint32 sample;
     Sint8 index;
 };
-static struct IMA_ADPCM_decoder
-{
-    WaveFMT wavefmt;
-    Uint16 wSamplesPerBlock;
-    /* * * */
-    struct IMA_ADPCM_decodestate state[2];
-} IMA_ADPCM_state;
 
+static int IMA_ADPCM_decode_block(const WaveDecoder * decoder,
+                                  const Uint8 * encoded, Uint8 * decoded);
+
+/* (rogue_feel) is the (extra_len) bytes of the format chunk after WaveFMT */
 static int
-InitIMA_ADPCM(WaveFMT * format)
+InitIMA_ADPCM(WaveDecoder * decoder, const Uint8 * rogue_feel,
+              Uint32 extra_len)
 {
-    Uint8 *rogue_feel;
-    Uint16 extra_info;
-
-    /* Set the rogue pointer to the IMA_ADPCM specific data */
-    IMA_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    IMA_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    IMA_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    IMA_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    IMA_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    IMA_ADPCM_state.wavefmt.bitspersample =
-        SDL_SwapLE16(format->bitspersample);
-    rogue_feel = (Uint8 *) format + sizeof(*format);
-    if (sizeof(*format) == 16) {
-        extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]);
-        rogue_feel += sizeof(Uint16);
+    const Uint16 channels = decoder->wavefmt.channels;
+
+    /* cbSize and wSamplesPerBlock */
+    if (extra_len < 2 * sizeof(Uint16)) {
+        SDL_SetError("IMA ADPCM format chunk is too short");
+        return (-1);
+    }
+    rogue_feel += sizeof(Uint16);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+
+    if (channels > 2) {
+        SDL_SetError("IMA ADPCM decoder can only handle %d channels", 2);
+        return (-1);
     }
-    IMA_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    /* 4 header bytes per channel, then groups of 8 nibbles per channel */
+    if ((decoder->wSamplesPerBlock < 1) ||
+        (((decoder->wSamplesPerBlock - 1) % 8) != 0) ||
+        ((4 * channels + (decoder->wSamplesPerBlock - 1) / 2 * channels)
+         > decoder->wavefmt.blockalign)) {
+        SDL_SetError("Invalid IMA ADPCM block size");
+        return (-1);
+    }
+    decoder->DecodeBlock = IMA_ADPCM_decode_block;
     return (0);
 }
 
@@ -308,7 +324,7 @@ IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state, Uint8 nybble)
 
 /* Fill the decode buffer with a channel block of data (8 samples) */
 static void
-Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
+Fill_IMA_ADPCM_block(Uint8 * decoded, const Uint8 * encoded,
                      int channel, int numchannels,
                      struct IMA_ADPCM_decodestate *state)
 {
@@ -336,191 +352,304 @@ Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
     }
 }
 
+/* Decode one block into wSamplesPerBlock little-endian Sint16 frames */
 static int
-IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+IMA_ADPCM_decode_block(const WaveDecoder * decoder, const Uint8 * encoded,
+                       Uint8 * decoded)
 {
-    struct IMA_ADPCM_decodestate *state;
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
+    struct IMA_ADPCM_decodestate state[2];
+    Sint32 samplesleft;
     unsigned int c, channels;
 
-    /* Check to make sure we have enough variables in the state array */
-    channels = IMA_ADPCM_state.wavefmt.channels;
-    if (channels > SDL_arraysize(IMA_ADPCM_state.state)) {
-        SDL_SetError("IMA ADPCM decoder can only handle %d channels",
-                     SDL_arraysize(IMA_ADPCM_state.state));
-        return (-1);
+    /* Grab the initial information for this block */
+    channels = decoder->wavefmt.channels;
+    for (c = 0; c < channels; ++c) {
+        /* Fill the state information for this block */
+        state[c].sample = ((encoded[1] << 8) | encoded[0]);
+        encoded += 2;
+        if (state[c].sample & 0x8000) {
+            state[c].sample -= 0x10000;
+        }
+        state[c].index = *encoded++;
+        if ((state[c].index < 0) || (state[c].index > 88)) {
+            SDL_SetError("Invalid IMA ADPCM step index");
+            return (-1);
+        }
+        /* Reserved byte in buffer header, should be 0 */
+        if (*encoded++ != 0) {
+            /* Uh oh, corrupt data?  Buggy code? */ ;
+        }
+
+        /* Store the initial sample we start with */
+        decoded[0] = (Uint8) (state[c].sample & 0xFF);
+        decoded[1] = (Uint8) (state[c].sample >> 8);
+        decoded += 2;
+    }
+
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 1) * channels;
+    while (samplesleft > 0) {
+        for (c = 0; c < channels; ++c) {
+            Fill_IMA_ADPCM_block(decoded, encoded, c, channels, &state[c]);
+            encoded += 4;
+            samplesleft -= 8;
+        }
+        decoded += (channels * 8 * 2);
+    }
+    return (0);
+}
+
+/* A thread won't be started for fewer ADPCM blocks than this */
+#define ADPCM_BLOCKS_PER_THREAD 16
+#define ADPCM_MAX_THREADS 16
+
+/* A run of blocks decoded by one thread, in place in the shared buffers */
+typedef struct ADPCM_slice
+{
+    const WaveDecoder *decoder;
+    const Uint8 *encoded;
+    Uint8 *decoded;
+    Uint32 first;
+    Uint32 count;
+    Uint32 failed;              /* the first block that failed to decode */
+} ADPCM_slice;
+
+static int SDLCALL
+ADPCM_decode_slice(void *data)
+{
+    ADPCM_slice *slice = (ADPCM_slice *) data;
+    const WaveDecoder *decoder = slice->decoder;
+    const Uint32 blockalign = decoder->wavefmt.blockalign;
+    const Uint32 blocksize = decoder->wSamplesPerBlock *
+        decoder->wavefmt.channels * sizeof(Sint16);
+    Uint32 i;
+
+    /* Every block starts afresh, so each one's place is known up front */
+    slice->failed = WAVE_NO_BLOCK;
+    for (i = slice->first; i < slice->first + slice->count; ++i) {
+        if (decoder->DecodeBlock(decoder, slice->encoded + i * blockalign,
+                                 slice->decoded + i * blocksize) < 0) {
+            slice->failed = i;
+            return (-1);
+        }
     }
-    state = IMA_ADPCM_state.state;
+    return (0);
+}
+
+/* How many threads to decode (blocks) with, SDL_WAVE_THREADS overrides
+   it and 0 or less means one per CPU */
+static int
+ADPCM_decode_threads(Uint32 blocks)
+{
+    const char *hint = SDL_getenv("SDL_WAVE_THREADS");
+    int threads = (hint && *hint) ? SDL_atoi(hint) : 0;
+
+    if (threads <= 0) {
+        threads = SDL_GetCPUCount();
+    }
+    if ((Uint32) threads > blocks / ADPCM_BLOCKS_PER_THREAD) {
+        threads = (int) (blocks / ADPCM_BLOCKS_PER_THREAD);
+    }
+    return SDL_max(1, SDL_min(threads, ADPCM_MAX_THREADS));
+}
+
+static SDL_Thread *
+ADPCM_create_thread(ADPCM_slice * slice)
+{
+/* !!! FIXME: this is nasty. */
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC)
+#undef SDL_CreateThread
+    return SDL_CreateThread(ADPCM_decode_slice, slice, NULL, NULL);
+#else
+    return SDL_CreateThread(ADPCM_decode_slice, slice);
+#endif
+}
+
+/* Replace (audio_buf) with its whole blocks decoded */
+static int
+ADPCM_decode(const WaveDecoder * decoder, Uint8 ** audio_buf,
+             Uint32 * audio_len)
+{
+    const Uint32 blockalign = decoder->wavefmt.blockalign;
+    const Uint32 blocksize = decoder->wSamplesPerBlock *
+        decoder->wavefmt.channels * sizeof(Sint16);
+    const Uint32 blocks = *audio_len / blockalign;
+    ADPCM_slice slices[ADPCM_MAX_THREADS];
+    SDL_Thread *threads[ADPCM_MAX_THREADS];
+    Uint8 *freeable;
+    int i, nslices;
 
     /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
     freeable = *audio_buf;
-    *audio_len = (encoded_len / IMA_ADPCM_state.wavefmt.blockalign) *
-        IMA_ADPCM_state.wSamplesPerBlock *
-        IMA_ADPCM_state.wavefmt.channels * sizeof(Sint16);
+    *audio_len = blocks * blocksize;
     *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
     if (*audio_buf == NULL) {
+        SDL_free(freeable);
         SDL_Error(SDL_ENOMEM);
         return (-1);
     }
-    decoded = *audio_buf;
-
-    /* Get ready... Go! */
-    while (encoded_len >= IMA_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
-        for (c = 0; c < channels; ++c) {
-            /* Fill the state information for this block */
-            state[c].sample = ((encoded[1] << 8) | encoded[0]);
-            encoded += 2;
-            if (state[c].sample & 0x8000) {
-                state[c].sample -= 0x10000;
-            }
-            state[c].index = *encoded++;
-            /* Reserved byte in buffer header, should be 0 */
-            if (*encoded++ != 0) {
-                /* Uh oh, corrupt data?  Buggy code? */ ;
-            }
 
-            /* Store the initial sample we start with */
-            decoded[0] = (Uint8) (state[c].sample & 0xFF);
-            decoded[1] = (Uint8) (state[c].sample >> 8);
-            decoded += 2;
+    /* Split the blocks evenly; this thread takes the first share */
+    nslices = ADPCM_decode_threads(blocks);
+    for (i = 0; i < nslices; ++i) {
+        slices[i].decoder = decoder;
+        slices[i].encoded = freeable;
+        slices[i].decoded = *audio_buf;
+        slices[i].first = (Uint32) (((Uint64) blocks * i) / nslices);
+        slices[i].count = (Uint32) (((Uint64) blocks * (i + 1)) / nslices) -
+            slices[i].first;
+    }
+    for (i = 1; i < nslices; ++i) {
+        threads[i] = ADPCM_create_thread(&slices[i]);
+    }
+    ADPCM_decode_slice(&slices[0]);
+    for (i = 1; i < nslices; ++i) {
+        if (threads[i] != NULL) {
+            SDL_WaitThread(threads[i], NULL);
+        } else {
+            ADPCM_decode_slice(&slices[i]);
         }
+    }
 
-        /* Decode and store the other samples in this block */
-        samplesleft = (IMA_ADPCM_state.wSamplesPerBlock - 1) * channels;
-        while (samplesleft > 0) {
-            for (c = 0; c < channels; ++c) {
-                Fill_IMA_ADPCM_block(decoded, encoded,
-                                     c, channels, &state[c]);
-                encoded += 4;
-                samplesleft -= 8;
-            }
-            decoded += (channels * 8 * 2);
+    for (i = 0; i < nslices; ++i) {
+        const Uint32 failed = slices[i].failed;
+        if (failed != WAVE_NO_BLOCK) {
+            /* Errors are per thread, so set it again on this one */
+            decoder->DecodeBlock(decoder, freeable + failed * blockalign,
+                                 *audio_buf + failed * blocksize);
+            SDL_free(*audio_buf);
+            *audio_buf = NULL;
+            SDL_free(freeable);
+            return (-1);
         }
-        encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
     }
     SDL_free(freeable);
     return (0);
 }
 
-SDL_AudioSpec *
-SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
-               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
+/*
+ * Parse the RIFF header and the format chunk, leaving (src) at the first
+ * byte of the data chunk's samples.  (riff_end) is set to the offset just
+ * past the RIFF chunk as soon as the header has been recognised.
+ */
+static int
+ReadWaveHeader(SDL_RWops * src, SDL_AudioSpec * spec, WaveDecoder * decoder,
+               Uint32 * data_len, long *riff_end)
 {
-    int was_error;
     Chunk chunk;
-    int lenread;
-    int IEEE_float_encoded, MS_ADPCM_encoded, IMA_ADPCM_encoded;
-    int samplesize;
+    WaveFMT *format;
+    int was_error;
+    long start;
 
     /* WAV magic header */
     Uint32 RIFFchunk;
-    Uint32 wavelen = 0;
+    Uint32 wavelen;
     Uint32 WAVEmagic;
-    Uint32 headerDiff = 0;
-
-    /* FMT chunk */
-    WaveFMT *format = NULL;
-
-    /* Make sure we are passed a valid data source */
-    was_error = 0;
-    if (src == NULL) {
-        was_error = 1;
-        goto done;
-    }
 
     /* Check the magic header */
+    start = SDL_RWtell(src);
     RIFFchunk = SDL_ReadLE32(src);
     wavelen = SDL_ReadLE32(src);
     if (wavelen == WAVE) {      /* The RIFFchunk has already been read */
         WAVEmagic = wavelen;
         wavelen = RIFFchunk;
         RIFFchunk = RIFF;
+        start -= sizeof(Uint32);
     } else {
         WAVEmagic = SDL_ReadLE32(src);
     }
     if ((RIFFchunk != RIFF) || (WAVEmagic != WAVE)) {
         SDL_SetError("Unrecognized file type (not WAVE)");
-        was_error = 1;
-        goto done;
+        return (-1);
     }
-    headerDiff += sizeof(Uint32);       /* for WAVE */
+    *riff_end = start + 2 * sizeof(Uint32) + wavelen;
 
-    /* Read the audio data format chunk */
-    chunk.data = NULL;
-    do {
-        if (chunk.data != NULL) {
-            SDL_free(chunk.data);
-            chunk.data = NULL;
+    /* Read the audio data format chunk, skipping any others before it */
+    for (;;) {
+        if (ReadChunkHeader(src, &chunk) < 0) {
+            return (-1);
         }
-        lenread = ReadChunk(src, &chunk);
-        if (lenread < 0) {
-            was_error = 1;
-            goto done;
+        if (chunk.magic == FMT) {
+            break;
         }
-        /* 2 Uint32's for chunk header+len, plus the lenread */
-        headerDiff += lenread + 2 * sizeof(Uint32);
-    } while ((chunk.magic == FACT) || (chunk.magic == LIST));
+        if (chunk.magic == DATA) {
+            SDL_SetError("Complex WAVE files not supported");
+            return (-1);
+        }
+        if (SkipChunk(src, &chunk) < 0) {
+            return (-1);
+        }
+    }
+    if (chunk.length < sizeof(*format)) {
+        SDL_SetError("WAVE format chunk is too short");
+        return (-1);
+    }
+    if (ReadChunkData(src, &chunk) < 0) {
+        return (-1);
+    }
 
     /* Decode the audio data format */
     format = (WaveFMT *) chunk.data;
-    if (chunk.magic != FMT) {
-        SDL_SetError("Complex WAVE files not supported");
+    SDL_zerop(decoder);
+    decoder->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+    decoder->wavefmt.channels = SDL_SwapLE16(format->channels);
+    decoder->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+    decoder->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+    decoder->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+    decoder->wavefmt.bitspersample = SDL_SwapLE16(format->bitspersample);
+    was_error = 0;
+    if (decoder->wavefmt.channels == 0) {
+        SDL_SetError("WAVE file has no channels");
         was_error = 1;
-        goto done;
-    }
-    IEEE_float_encoded = MS_ADPCM_encoded = IMA_ADPCM_encoded = 0;
-    switch (SDL_SwapLE16(format->encoding)) {
-    case PCM_CODE:
-        /* We can understand this */
-        break;
-    case IEEE_FLOAT_CODE:
-        IEEE_float_encoded = 1;
-        /* We can understand this */
-        break;
-    case MS_ADPCM_CODE:
-        /* Try to understand this */
-        if (InitMS_ADPCM(format) < 0) {
+    } else {
+        switch (decoder->wavefmt.encoding) {
+        case PCM_CODE:
+        case IEEE_FLOAT_CODE:
+            /* We can understand this */
+            break;
+        case MS_ADPCM_CODE:
+            /* Try to understand this */
+            if (InitMS_ADPCM(decoder, chunk.data + sizeof(*format),
+                             chunk.length - sizeof(*format)) < 0) {
+                was_error = 1;
+            }
+            break;
+        case IMA_ADPCM_CODE:
+            /* Try to understand this */
+            if (InitIMA_ADPCM(decoder, chunk.data + sizeof(*format),
+                              chunk.length - sizeof(*format)) < 0) {
+                was_error = 1;
+            }
+            break;
+        case MP3_CODE:
+            SDL_SetError("MPEG Layer 3 data not supported");
             was_error = 1;
-            goto done;
-        }
-        MS_ADPCM_encoded = 1;
-        break;
-    case IMA_ADPCM_CODE:
-        /* Try to understand this */
-        if (InitIMA_ADPCM(format) < 0) {
+            break;
+        default:
+            SDL_SetError("Unknown WAVE data format: 0x%.4x",
+                         decoder->wavefmt.encoding);
             was_error = 1;
-            goto done;
+            break;
         }
-        IMA_ADPCM_encoded = 1;
-        break;
-    case MP3_CODE:
-        SDL_SetError("MPEG Layer 3 data not supported",
-                     SDL_SwapLE16(format->encoding));
-        was_error = 1;
-        goto done;
-    default:
-        SDL_SetError("Unknown WAVE data format: 0x%.4x",
-                     SDL_SwapLE16(format->encoding));
-        was_error = 1;
-        goto done;
     }
+    SDL_free(chunk.data);
+    if (was_error) {
+        return (-1);
+    }
+
     SDL_memset(spec, 0, (sizeof *spec));
-    spec->freq = SDL_SwapLE32(format->frequency);
+    spec->freq = decoder->wavefmt.frequency;
 
-    if (IEEE_float_encoded) {
-        if ((SDL_SwapLE16(format->bitspersample)) != 32) {
+    if (decoder->wavefmt.encoding == IEEE_FLOAT_CODE) {
+        if (decoder->wavefmt.bitspersample != 32) {
             was_error = 1;
         } else {
             spec->format = AUDIO_F32;
         }
     } else {
-        switch (SDL_SwapLE16(format->bitspersample)) {
+        switch (decoder->wavefmt.bitspersample) {
         case 4:
-            if (MS_ADPCM_encoded || IMA_ADPCM_encoded) {
+            if (decoder->DecodeBlock != NULL) {
                 spec->format = AUDIO_S16;
             } else {
                 was_error = 1;
@@ -543,39 +672,61 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
 
     if (was_error) {
         SDL_SetError("Unknown %d-bit PCM data format",
-                     SDL_SwapLE16(format->bitspersample));
-        goto done;
+                     decoder->wavefmt.bitspersample);
+        return (-1);
     }
-    spec->channels = (Uint8) SDL_SwapLE16(format->channels);
+    spec->channels = (Uint8) decoder->wavefmt.channels;
     spec->samples = 4096;       /* Good default buffer size */
 
-    /* Read the audio data chunk */
-    *audio_buf = NULL;
-    do {
-        if (*audio_buf != NULL) {
-            SDL_free(*audio_buf);
-            *audio_buf = NULL;
+    /* Find the audio data chunk */
+    for (;;) {
+        if (ReadChunkHeader(src, &chunk) < 0) {
+            return (-1);
         }
-        lenread = ReadChunk(src, &chunk);
-        if (lenread < 0) {
-            was_error = 1;
-            goto done;
+        if (chunk.magic == DATA) {
+            break;
         }
-        *audio_len = lenread;
-        *audio_buf = chunk.data;
-        if (chunk.magic != DATA)
-            headerDiff += lenread + 2 * sizeof(Uint32);
-    } while (chunk.magic != DATA);
-    headerDiff += 2 * sizeof(Uint32);   /* for the data chunk and len */
-
-    if (MS_ADPCM_encoded) {
-        if (MS_ADPCM_decode(audio_buf, audio_len) < 0) {
-            was_error = 1;
-            goto done;
+        if (SkipChunk(src, &chunk) < 0) {
+            return (-1);
         }
     }
-    if (IMA_ADPCM_encoded) {
-        if (IMA_ADPCM_decode(audio_buf, audio_len) < 0) {
+    *data_len = chunk.length;
+    return (0);
+}
+
+SDL_AudioSpec *
+SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
+               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
+{
+    int was_error;
+    WaveDecoder decoder;
+    Chunk chunk;
+    long riff_end = -1;
+    int samplesize;
+
+    /* Make sure we are passed a valid data source */
+    was_error = 0;
+    if (src == NULL) {
+        was_error = 1;
+        goto done;
+    }
+
+    if (ReadWaveHeader(src, spec, &decoder, &chunk.length, &riff_end) < 0) {
+        was_error = 1;
+        goto done;
+    }
+
+    /* Read the audio data chunk */
+    chunk.magic = DATA;
+    if (ReadChunkData(src, &chunk) < 0) {
+        was_error = 1;
+        goto done;
+    }
+    *audio_buf = chunk.data;
+    *audio_len = chunk.length;
+
+    if (decoder.DecodeBlock != NULL) {
+        if (ADPCM_decode(&decoder, audio_buf, audio_len) < 0) {
             was_error = 1;
             goto done;
         }
@@ -586,15 +737,12 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     *audio_len &= ~(samplesize - 1);
 
   done:
-    if (format != NULL) {
-        SDL_free(format);
-    }
     if (src) {
         if (freesrc) {
             SDL_RWclose(src);
-        } else {
+        } else if (riff_end >= 0) {
             /* seek to the end of the file (given by the RIFF chunk) */
-            SDL_RWseek(src, wavelen - chunk.length - headerDiff, RW_SEEK_CUR);
+            SDL_RWseek(src, riff_end, RW_SEEK_SET);
         }
     }
     if (was_error) {
@@ -603,6 +751,202 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     return (spec);
 }
 
+struct SDL_WAVStream
+{
+    SDL_RWops *src;
+    int freesrc;
+    WaveDecoder decoder;
+    long data_start;            /* offset of the data chunk's samples */
+    int framesize;              /* bytes in a decoded sample frame */
+    Uint32 frames;              /* sample frames in the data chunk */
+    Uint32 position;            /* the next sample frame read */
+    Uint8 *encoded;             /* one ADPCM block as read... */
+    Uint8 *decoded;             /* ...and decoded */
+    Uint32 decoded_block;       /* the block held in (decoded) */
+    Uint32 next_block;          /* the block (src) is at */
+};
+
+SDL_WAVStream *
+SDL_OpenWAVStream_RW(SDL_RWops * src, int freesrc, SDL_AudioSpec * spec)
+{
+    SDL_WAVStream *stream;
+    Uint32 data_len;
+    long riff_end;
+
+    /* Make sure we are passed a valid data source */
+    if (src == NULL) {
+        return NULL;
+    }
+    stream = (SDL_WAVStream *) SDL_calloc(1, sizeof(*stream));
+    if (stream == NULL) {
+        SDL_Error(SDL_ENOMEM);
+        goto error;
+    }
+
+    if (ReadWaveHeader(src, spec, &stream->decoder, &data_len, &riff_end) <
+        0) {
+        goto error;
+    }
+    stream->src = src;
+    stream->freesrc = freesrc;
+    stream->data_start = SDL_RWtell(src);
+    stream->framesize =
+        (SDL_AUDIO_BITSIZE(spec->format) / 8) * spec->channels;
+    stream->decoded_block = stream->next_block = WAVE_NO_BLOCK;
+
+    if (stream->decoder.DecodeBlock != NULL) {
+        /* Only one block is ever held in memory */
+        const Uint16 blockalign = stream->decoder.wavefmt.blockalign;
+        stream->frames = (data_len / blockalign) *
+            stream->decoder.wSamplesPerBlock;
+        stream->encoded = (Uint8 *) SDL_malloc(blockalign);
+        stream->decoded = (Uint8 *) SDL_malloc(stream->framesize *
+                                               stream->decoder.
+                                               wSamplesPerBlock);
+        if ((stream->encoded == NULL) || (stream->decoded == NULL)) {
+            SDL_Error(SDL_ENOMEM);
+            goto error;
+        }
+        stream->next_block = 0;
+    } else {
+        stream->frames = data_len / stream->framesize;
+    }
+    return stream;
+
+  error:
+    if (stream != NULL) {
+        SDL_free(stream->encoded);
+        SDL_free(stream->decoded);
+        SDL_free(stream);
+    }
+    if (freesrc) {
+        SDL_RWclose(src);
+    }
+    return NULL;
+}
+
+/* Read and decode an ADPCM block, unless it's already decoded */
+static int
+WAVStreamDecodeBlock(SDL_WAVStream * stream, Uint32 block)
+{
+    const Uint16 blockalign = stream->decoder.wavefmt.blockalign;
+
+    if (block == stream->decoded_block) {
+        return (0);
+    }
+    stream->decoded_block = WAVE_NO_BLOCK;
+    if (block != stream->next_block) {
+        if (SDL_RWseek(stream->src,
+                       stream->data_start + (long) block * blockalign,
+                       RW_SEEK_SET) < 0) {
+            stream->next_block = WAVE_NO_BLOCK;
+            return (-1);
+        }
+    }
+    if (SDL_RWread(stream->src, stream->encoded, blockalign, 1) != 1) {
+        SDL_Error(SDL_EFREAD);
+        stream->next_block = WAVE_NO_BLOCK;
+        return (-1);
+    }
+    stream->next_block = block + 1;
+
+    if (stream->decoder.DecodeBlock(&stream->decoder, stream->encoded,
+                                    stream->decoded) < 0) {
+        return (-1);
+    }
+    stream->decoded_block = block;
+    return (0);
+}
+
+int
+SDL_WAVStreamRead(SDL_WAVStream * stream, void *buf, int len)
+{
+    Uint8 *dst = (Uint8 *) buf;
+    Uint32 frames;
+
+    if ((stream == NULL) || (buf == NULL) || (len < 0)) {
+        SDL_SetError("Invalid WAV stream parameters");
+        return -1;
+    }
+    frames = SDL_min((Uint32) len / stream->framesize,
+                     stream->frames - stream->position);
+
+    /* PCM goes straight from the file to the caller */
+    if (stream->decoder.DecodeBlock == NULL) {
+        if (frames > 0) {
+            frames = (Uint32) SDL_RWread(stream->src, dst,
+                                         stream->framesize, frames);
+            stream->position += frames;
+        }
+        return (int) (frames * stream->framesize);
+    }
+
+    while (frames > 0) {
+        const Uint32 perblock = stream->decoder.wSamplesPerBlock;
+        const Uint32 offset = stream->position % perblock;
+        const Uint32 count = SDL_min(frames, perblock - offset);
+
+        if (WAVStreamDecodeBlock(stream, stream->position / perblock) < 0) {
+            /* hand back what was decoded before the error */
+            if (dst == (Uint8 *) buf) {
+                return -1;
+            }
+            break;
+        }
+        SDL_memcpy(dst, stream->decoded + offset * stream->framesize,
+                   count * stream->framesize);
+        dst += count * stream->framesize;
+        stream->position += count;
+        frames -= count;
+    }
+    return (int) (dst - (Uint8 *) buf);
+}
+
+int
+SDL_WAVStreamSeek(SDL_WAVStream * stream, Uint32 frame)
+{
+    if ((stream == NULL) || (frame > stream->frames)) {
+        SDL_SetError("Invalid WAV stream parameters");
+        return -1;
+    }
+
+    /* ADPCM seeks lazily, to the block the next read needs */
+    if (stream->decoder.DecodeBlock == NULL) {
+        if (SDL_RWseek(stream->src,
+                       stream->data_start + (long) frame * stream->framesize,
+                       RW_SEEK_SET) < 0) {
+            return -1;
+        }
+    }
+    stream->position = frame;
+    return 0;
+}
+
+Uint32
+SDL_WAVStreamTell(SDL_WAVStream * stream)
+{
+    return (stream != NULL) ? stream->position : 0;
+}
+
+Uint32
+SDL_WAVStreamLength(SDL_WAVStream * stream)
+{
+    return (stream != NULL) ? stream->frames : 0;
+}
+
+void
+SDL_CloseWAVStream(SDL_WAVStream * stream)
+{
+    if (stream != NULL) {
+        if (stream->freesrc) {
+            SDL_RWclose(stream->src);
+        }
+        SDL_free(stream->encoded);
+        SDL_free(stream->decoded);
+        SDL_free(stream);
+    }
+}
+
 /* Since the WAV memory is allocated in the shared library, it must also
    be freed here.  (Necessary under Win32, VC++)
  */
@@ -615,16 +959,30 @@ SDL_FreeWAV(Uint8 * audio_buf)
 }
 
 static int
-ReadChunk(SDL_RWops * src, Chunk * chunk)
+ReadChunkHeader(SDL_RWops * src, Chunk * chunk)
+{
+    Uint32 header[2];
+
+    if (SDL_RWread(src, header, sizeof(header), 1) != 1) {
+        SDL_Error(SDL_EFREAD);
+        return (-1);
+    }
+    chunk->magic = SDL_SwapLE32(header[0]);
+    chunk->length = SDL_SwapLE32(header[1]);
+    chunk->data = NULL;
+    return (0);
+}
+
+static int
+ReadChunkData(SDL_RWops * src, Chunk * chunk)
 {
-    chunk->magic = SDL_ReadLE32(src);
-    chunk->length = SDL_ReadLE32(src);
     chunk->data = (Uint8 *) SDL_malloc(chunk->length);
     if (chunk->data == NULL) {
         SDL_Error(SDL_ENOMEM);
         return (-1);
     }
-    if (SDL_RWread(src, chunk->data, chunk->length, 1) != 1) {
+    if ((chunk->length > 0) &&
+        (SDL_RWread(src, chunk->data, chunk->length, 1) != 1)) {
         SDL_Error(SDL_EFREAD);
         SDL_free(chunk->data);
         chunk->data = NULL;
@@ -633,4 +991,16 @@ ReadChunk(SDL_RWops * src, Chunk * chunk)
     return (chunk->length);
 }
 
+/* Chunks are padded to an even length */
+static int
+SkipChunk(SDL_RWops * src, Chunk * chunk)
+{
+    if (SDL_RWseek(src, (long) (chunk->length + (chunk->length & 1)),
+                   RW_SEEK_CUR) < 0) {
+        SDL_Error(SDL_EFSEEK);
+        return (-1);
+    }
+    return (0);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
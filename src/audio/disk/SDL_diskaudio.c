@@ -67,14 +67,24 @@ DISKAUD_WaitDevice(_THIS)
 static void
 DISKAUD_PlayDevice(_THIS)
 {
+    size_t len = this->hidden->mixlen;
     size_t written;
 
+    /* A fixed length render ends partway through the last buffer */
+    if (this->freewheel_frames) {
+        const size_t framesize = len / this->spec.samples;
+        const Uint64 left = this->freewheel_frames - this->stats.frames;
+        if (left < this->spec.samples) {
+            len = (size_t) left * framesize;
+        }
+    }
+
     /* Write the audio data */
     written = SDL_RWwrite(this->hidden->output,
-                          this->hidden->mixbuf, 1, this->hidden->mixlen);
+                          this->hidden->mixbuf, 1, len);
 
     /* If we couldn't write, assume fatal error for now */
-    if (written != this->hidden->mixlen) {
+    if (written != len) {
         this->enabled = 0;
     }
 #ifdef DEBUG_AUDIO
@@ -127,6 +137,7 @@ DISKAUD_OpenDevice(_THIS, const char *devname, int iscapture)
     }
 
     /* Allocate mixing buffer */
+    this->hidden->mixlen = this->spec.size;
     this->hidden->mixbuf = (Uint8 *) SDL_AllocAudioMem(this->hidden->mixlen);
     if (this->hidden->mixbuf == NULL) {
         DISKAUD_CloseDevice(this);
@@ -134,7 +145,6 @@ DISKAUD_OpenDevice(_THIS, const char *devname, int iscapture)
     }
     SDL_memset(this->hidden->mixbuf, this->spec.silence, this->spec.size);
 
-    this->hidden->mixlen = this->spec.size;
     this->hidden->write_delay =
         (envr) ? SDL_atoi(envr) : DISKDEFAULT_WRITEDELAY;
 
@@ -157,6 +167,7 @@ DISKAUD_Init(SDL_AudioDriverImpl * impl)
     impl->PlayDevice = DISKAUD_PlayDevice;
     impl->GetDeviceBuf = DISKAUD_GetDeviceBuf;
     impl->CloseDevice = DISKAUD_CloseDevice;
+    impl->CanFreewheel = 1;
 
     return 1;   /* this audio target is available. */
 }
@@ -25,138 +25,244 @@
 
 /* Output audio to PSL1GHT */
 
-#include "SDL.h"
-
+#include <sys/errno.h>
 
+#include "SDL.h"
 #include "SDL_audio.h"
 #include "../SDL_audio_c.h"
 #include "SDL_psl1ghtaudio.h"
+#include "../../video/psl1ght/SDL_PSL1GHTtrace_c.h"
 
-#define SHW64(X) (u32)(((u64)X)>>32), (u32)(((u64)X)&0xFFFFFFFF)
+/* Blocks of AUDIO_BLOCK_SAMPLES frames the hardware has not played yet,
+   counting the one it is playing right now */
+static u32
+PSL1GHT_AUD_Queued(_THIS)
+{
+	u32 blocks = _config.numBlocks;
+	return (_next_block + blocks - (u32) *_read_index) % blocks;
+}
 
-#define AUDIO_DEBUG
+/* Silence the blocks the hardware is done with, so that an underrun or a
+   paused device replays silence instead of stale samples */
+static void
+PSL1GHT_AUD_ClearPlayed(_THIS)
+{
+	u32 playing = (u32) *_read_index;
 
-#ifdef AUDIO_DEBUG
-#define deprintf(...) printf(__VA_ARGS__)
-#else
-#define deprintf(...)
-#endif
+	while (_last_read != playing) {
+		SDL_memset(_ring + _last_read * this->spec.size, 0, this->spec.size);
+		_last_read = (_last_read + 1) % _config.numBlocks;
+	}
+}
 
 static int
 PSL1GHT_AUD_OpenDevice(_THIS, const char *devname, int iscapture)
 {
-	deprintf( "PSL1GHT_AUD_OpenDevice(%08X.%08X, %s, %d)\n", SHW64(this), devname, iscapture);
-    SDL_AudioFormat test_format = SDL_FirstAudioFormat(this->spec.format);
-    int valid_datatype = 0;
-
-    this->hidden = SDL_malloc(sizeof(*(this->hidden)));
-    if (!this->hidden) {
-        SDL_OutOfMemory();
-        return 0;
-    }
-    SDL_memset(this->hidden, 0, (sizeof *this->hidden));
-
-
-	// PS3 Libaudio only handles floats
-    while ((!valid_datatype) && (test_format)) {
-        this->spec.format = test_format;
-        switch (test_format) {
-        //case AUDIO_F32LSB: // FIXME maybe the float is MSB ?
-        case AUDIO_F32SYS: // FIXME maybe the float is MSB ?
-            valid_datatype = 1;
-            break;
-        default:
-            test_format = SDL_NextAudioFormat();
-            break;
-        }
-    }
-
-    int ret=audioInit();
-
-	//set some parameters we want
-	//either 2 or 8 channel
-	_params.numChannels = AUDIO_PORT_2CH;
-	//8 16 or 32 block buffer
-	_params.numBlocks = AUDIO_BLOCK_8;
+	const char *env;
+	u32 blocks, depth;
+	s32 ret;
+
+	this->hidden = SDL_malloc(sizeof(*(this->hidden)));
+	if (!this->hidden) {
+		SDL_OutOfMemory();
+		return 0;
+	}
+	SDL_memset(this->hidden, 0, (sizeof *this->hidden));
+
+	// Either 2 or 8 channels, SDL converts whatever the application mixes.
+	// Surround goes to an 8 channel port rather than being folded to stereo.
+	_params.numChannels = (this->spec.channels >= 6) ? AUDIO_PORT_8CH : AUDIO_PORT_2CH;
+	env = SDL_getenv("SDL_AUDIO_PSL1GHT_CHANNELS");
+	if (env) {
+		_params.numChannels = (SDL_atoi(env) == 8) ? AUDIO_PORT_8CH : AUDIO_PORT_2CH;
+	}
+
+	// Keep as many blocks queued as the application asked samples for
+	depth = (this->spec.samples + AUDIO_BLOCK_SAMPLES - 1) / AUDIO_BLOCK_SAMPLES;
+	if (depth < 2) {
+		depth = 2;
+	}
+
+	// 8 16 or 32 block ring, with room for one block more than the queue
+	env = SDL_getenv("SDL_AUDIO_PSL1GHT_BLOCKS");
+	blocks = env ? SDL_atoi(env) : 0;
+	if (blocks != AUDIO_BLOCK_8 && blocks != AUDIO_BLOCK_16 && blocks != AUDIO_BLOCK_32) {
+		if (depth < AUDIO_BLOCK_8) {
+			blocks = AUDIO_BLOCK_8;
+		} else if (depth < AUDIO_BLOCK_16) {
+			blocks = AUDIO_BLOCK_16;
+		} else {
+			blocks = AUDIO_BLOCK_32;
+		}
+	}
+	if (depth > blocks - 1) {
+		depth = blocks - 1;
+	}
+	_params.numBlocks = blocks;
 	//extended attributes
 	_params.attr = 0;
 	//sound level (1 is default)
 	_params.level = 1;
 
-	ret=audioPortOpen(&_params, &_portNum);
-	deprintf("audioPortOpen: %d\n",ret);
-	deprintf("  portNum: %d\n",_portNum);
-
-	ret=audioGetPortConfig(_portNum, &_config);
-	deprintf("audioGetPortConfig: %d\n",ret);
-	deprintf("  readIndex: 0x%8X\n",_config.readIndex);
-	deprintf("  status: %d\n",_config.status);
-	deprintf("  channelCount: %ld\n",_config.channelCount);
-	deprintf("  numBlocks: %ld\n",_config.numBlocks);
-	deprintf("  portSize: %d\n",_config.portSize);
-	deprintf("  audioDataStart: 0x%8X\n",_config.audioDataStart);
+	ret = audioInit();
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioInit", ret, 0);
+	if (ret != 0) {
+		SDL_free(this->hidden);
+		SDL_SetError("audioInit failed");
+		return 0;
+	}
+
+	ret = audioPortOpen(&_params, &_portNum);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioPortOpen", ret, _portNum);
+	if (ret != 0) {
+		audioQuit();
+		SDL_free(this->hidden);
+		SDL_SetError("audioPortOpen failed");
+		return 0;
+	}
+
+	ret = audioGetPortConfig(_portNum, &_config);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioGetPortConfig", ret, _config.portSize);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "PortLayout",
+	              _config.channelCount, _config.numBlocks);
 
 	// create an event queue that will tell when a block is read
-	ret=audioCreateNotifyEventQueue( &_snd_queue, &_snd_queue_key);
-	printf("audioCreateNotifyEventQueue: %d\n",ret);
+	if (ret == 0) {
+		ret = audioCreateNotifyEventQueue(&_snd_queue, &_snd_queue_key);
+		PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioCreateNotifyEventQueue", ret, 0);
+	}
+	if (ret != 0) {
+		audioPortClose(_portNum);
+		audioQuit();
+		SDL_free(this->hidden);
+		SDL_SetError("Couldn't get the PSL1GHT audio port configuration");
+		return 0;
+	}
 
 	// Set it to the sprx
 	ret = audioSetNotifyEventQueue(_snd_queue_key);
-	printf("audioSetNotifyEventQueue: %d\n",ret);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioSetNotifyEventQueue", ret, 0);
+	if (ret != 0) {
+		sys_event_queue_destroy(_snd_queue, 0);
+		audioPortClose(_portNum);
+		audioQuit();
+		SDL_free(this->hidden);
+		SDL_SetError("audioSetNotifyEventQueue failed");
+		return 0;
+	}
 
 	// clears the event queue
 	ret = sys_event_queue_drain(_snd_queue);
-	printf("sys_event_queue_drain: %d\n",ret);
-
-	ret=audioPortStart(_portNum);
-	deprintf("audioPortStart: %d\n",ret);
-
-	_last_filled_buf = 1;
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "sys_event_queue_drain", ret, 0);
 
-	this->spec.format = test_format;
-	this->spec.size = sizeof(float) * AUDIO_BLOCK_SAMPLES * _config.channelCount;
+	// PS3 Libaudio only handles floats
+	this->spec.format = AUDIO_F32SYS;
 	this->spec.freq = 48000;
 	this->spec.samples = AUDIO_BLOCK_SAMPLES;
 	this->spec.channels = _config.channelCount;
+	SDL_CalculateAudioSpec(&this->spec);
+
+	_read_index = (volatile u64 *)(u64)_config.readIndex;
+	_ring = (Uint8 *)(u64)_config.audioDataStart;
+	_queue_depth = depth;
+	SDL_memset(_ring, 0, _config.portSize);
+
+	ret = audioPortStart(_portNum);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioPortStart", ret, 0);
+
+	// Start filling right behind the block the hardware plays first
+	_last_read = (u32) *_read_index;
+	_next_block = (_last_read + 1) % _config.numBlocks;
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "LatencyUsec",
+	              (Sint64) depth * AUDIO_BLOCK_SAMPLES * 1000000 / this->spec.freq,
+	              depth);
 
-    return ret == 0;
+	return 1;
 }
 
 static void
 PSL1GHT_AUD_PlayDevice(_THIS)
 {
-	deprintf( "PSL1GHT_AUD_PlayDevice(%08X.%08X)\n", SHW64(this));
-	
-	/*
-	while( _config.readIndex == _last_filled_buf) // FIXME this is a mess to remove when queued event will me integrated
-	{
-		deprintf( "\tplaying too fast... waiting a ms\n");
-		//sleep(1);
-	}*/
-    /*TransferSoundData *sound = SDL_malloc(sizeof(TransferSoundData));
-    if (!sound) {
-        SDL_OutOfMemory();
-    }
-
-    playGenericSound(this->hidden->mixbuf, this->hidden->mixlen);*/
+	_next_block = (_next_block + 1) % _config.numBlocks;
 }
 
+/* This function waits until it is possible to write a full sound buffer */
+static void
+PSL1GHT_AUD_WaitDevice(_THIS)
+{
+	/* Wake up at most twice per trip of the ring before checking again */
+	const u64 timeout = (u64) _config.numBlocks * AUDIO_BLOCK_SAMPLES * 1000000 /
+	                    this->spec.freq * 2;
+	sys_event_t event;
+	u32 queued;
+	s32 ret;
+
+	for (;;) {
+		PSL1GHT_AUD_ClearPlayed(this);
+		queued = PSL1GHT_AUD_Queued(this);
+		if (queued == 0 || queued > _queue_depth) {
+			/* The hardware caught up with us: start again behind it */
+			++_underruns;
+			_next_block = ((u32) *_read_index + 1) % _config.numBlocks;
+			PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "Underrun", _underruns, queued);
+			return;
+		}
+		if (queued < _queue_depth) {
+			/* Fill every free block before sleeping again */
+			PSL1GHT_TRACE(2, PSL1GHT_TRACE_AUDIO, "Queued", queued, _next_block);
+			return;
+		}
+		ret = sys_event_queue_receive(_snd_queue, &event, timeout);
+		PSL1GHT_TRACE(2, PSL1GHT_TRACE_AUDIO, "sys_event_queue_receive", ret, 0);
+		if (ret != 0 && ret != ETIMEDOUT) {
+			return;
+		}
+	}
+}
+
+/* Let the queued blocks play out before the port is stopped */
+static void
+PSL1GHT_AUD_WaitDone(_THIS)
+{
+	u32 blocks = _queue_depth + 1;
+	sys_event_t event;
+
+	while (blocks-- && PSL1GHT_AUD_Queued(this) > 0) {
+		if (sys_event_queue_receive(_snd_queue, &event, 100 * 1000) != 0) {
+			break;
+		}
+	}
+}
 
 static void
 PSL1GHT_AUD_CloseDevice(_THIS)
 {
-	deprintf( "PSL1GHT_AUD_CloseDevice(%08X.%08X)\n", SHW64(this));
 	int ret = 0;
 	ret=audioPortStop(_portNum);
-	deprintf("audioPortStop: %d\n",ret);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioPortStop", ret, _underruns);
+	if (ret != 0) {
+		SDL_SetError("audioPortStop failed");
+	}
 	ret=audioRemoveNotifyEventQueue(_snd_queue_key);
-	deprintf("audioRemoveNotifyEventQueue: %d\n",ret);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioRemoveNotifyEventQueue", ret, 0);
+	if (ret != 0) {
+		SDL_SetError("audioRemoveNotifyEventQueue failed");
+	}
 	ret=audioPortClose(_portNum);
-	deprintf("audioPortClose: %d\n",ret);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioPortClose", ret, 0);
+	if (ret != 0) {
+		SDL_SetError("audioPortClose failed");
+	}
 	ret=sys_event_queue_destroy(_snd_queue, 0);
-	deprintf("sys_event_queue_destroy: %d\n",ret);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "sys_event_queue_destroy", ret, 0);
+	if (ret != 0) {
+		SDL_SetError("Couldn't destroy the PSL1GHT audio event queue");
+	}
 	ret=audioQuit();
-	deprintf("audioQuit: %d\n",ret);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_AUDIO, "audioQuit", ret, 0);
+	if (ret != 0) {
+		SDL_SetError("audioQuit failed");
+	}
 
     SDL_free(this->hidden);
 }
@@ -164,41 +270,18 @@ PSL1GHT_AUD_CloseDevice(_THIS)
 static Uint8 *
 PSL1GHT_AUD_GetDeviceBuf(_THIS)
 {
-	
-	//deprintf( "PSL1GHT_AUD_GetDeviceBuf(%08X.%08X) at %d ms\n", SHW64(this), SDL_GetTicks());
-
-    //int playing = _config.readIndex;
-    int playing = *((u64*)(u64)_config.readIndex);
-    int filling = (playing + 1) % _config.numBlocks;
-	Uint8 * dma_buf = (Uint8 *)(u64)_config.audioDataStart;
-	//deprintf( "\tWriting to buffer %d \n", filling);
-	// deprintf( "\tbuffer address (%08X.%08X => %08X.%08X)\n", SHW64(_config.audioDataStart), SHW64(dma_buf));
-
-	_last_filled_buf = filling;
-    return (dma_buf + (filling * this->spec.size));
+	PSL1GHT_TRACE(2, PSL1GHT_TRACE_AUDIO, "GetDeviceBuf", *_read_index, _next_block);
+	return _ring + _next_block * this->spec.size;
 }
 
-/* This function waits until it is possible to write a full sound buffer */
-static void
-ALSA_WaitDevice(_THIS)
-{
-    /* We're in blocking mode, so there's nothing to do here */
-	//deprintf( "ALSA_WaitDevice(%08X.%08X)\n", SHW64(this));
-	
-	sys_event_t event;
-	s32 ret = sys_event_queue_receive( _snd_queue, &event, 20 * 1000);
-	//deprintf( "sys_event_queue_receive: %08X\n", ret);
-}
-
-
-	static int
+static int
 PSL1GHT_AUD_Init(SDL_AudioDriverImpl * impl)
 {
-	deprintf( "PSL1GHT_AUD_Init(%08X.%08X)\n", SHW64(impl));
 	/* Set the function pointers */
 	impl->OpenDevice = PSL1GHT_AUD_OpenDevice;
-	//impl->PlayDevice = PSL1GHT_AUD_PlayDevice;
-    impl->WaitDevice = ALSA_WaitDevice;
+	impl->PlayDevice = PSL1GHT_AUD_PlayDevice;
+	impl->WaitDevice = PSL1GHT_AUD_WaitDevice;
+	impl->WaitDone = PSL1GHT_AUD_WaitDone;
 	impl->CloseDevice = PSL1GHT_AUD_CloseDevice;
 	impl->GetDeviceBuf = PSL1GHT_AUD_GetDeviceBuf;
 
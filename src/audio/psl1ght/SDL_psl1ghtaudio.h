@@ -26,18 +26,23 @@
 #include "../SDL_sysaudio.h"
 
 #include <audio/audio.h>
+#include <sys/event_queue.h>
+
 /* Hidden "this" pointer for the audio functions */
 #define _THIS	SDL_AudioDevice *this
 
+/* The port plays a ring of blocks of AUDIO_BLOCK_SAMPLES float frames */
 struct SDL_PrivateAudioData
 {
-    //:TransferSoundData *sound;
-    /* The file descriptor for the audio device */
-
 	AudioPortParam params;
 	AudioPortConfig config;
 	u32 portNum;
-	u32 last_filled_buf;
+	volatile u64 *read_index;   // Block the hardware is playing
+	Uint8 *ring;                // First block of the port
+	u32 next_block;             // Block GetDeviceBuf hands out next
+	u32 last_read;              // Oldest block not silenced since it played
+	u32 queue_depth;            // Blocks to keep ahead of the hardware
+	u32 underruns;              // Times the hardware caught up with us
 	sys_event_queue_t snd_queue; // Queue identifier
 	u64	snd_queue_key; // Queue Key
 };
@@ -45,7 +50,12 @@ struct SDL_PrivateAudioData
 #define _params this->hidden->params
 #define _config this->hidden->config
 #define _portNum this->hidden->portNum
-#define _last_filled_buf this->hidden->last_filled_buf
+#define _read_index this->hidden->read_index
+#define _ring this->hidden->ring
+#define _next_block this->hidden->next_block
+#define _last_read this->hidden->last_read
+#define _queue_depth this->hidden->queue_depth
+#define _underruns this->hidden->underruns
 #define _snd_queue  this->hidden->snd_queue 
 #define _snd_queue_key this->hidden->snd_queue_key
 
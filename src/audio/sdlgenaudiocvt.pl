@@ -567,13 +567,14 @@ EOF
     my $endcomparison = '!=';
 
     # Upsampling (growing the buffer) needs to work backwards, since we
-    #  overwrite the buffer as we go.
+    #  overwrite the buffer as we go. Each pass writes $multiple frames.
     if ($upsample) {
+        my $dstframe = $channels * $multiple;
         $endcomparison = '>';  # dst > target
         print <<EOF;
-    $fctype *dst = (($fctype *) (cvt->buf + dstsize)) - $channels;
+    $fctype *dst = (($fctype *) (cvt->buf + dstsize)) - $dstframe;
     const $fctype *src = (($fctype *) (cvt->buf + cvt->len_cvt)) - $channels;
-    const $fctype *target = ((const $fctype *) cvt->buf) - $channels;
+    const $fctype *target = ((const $fctype *) cvt->buf) - $dstframe;
 EOF
     } else {
         $endcomparison = '<';  # dst < target
@@ -32,21 +32,42 @@
 
 #include <io/pad.h>
 
-#define pdprintf(x) printf(x)
+#include "../../video/psl1ght/SDL_PSL1GHTtrace_c.h"
 
 #define NAMESIZE 10
 
+/* Axis values closer to rest than this are reported as rest, so that
+   resting sticks and sensors don't flood the event queue.
+   Overridden by SDL_JOYSTICK_PSL1GHT_DEADZONE. */
+#define PSL1GHT_DEFAULT_DEADZONE 0x0400
+
+/* Sticks, pressure sensitive buttons and sixaxis */
+#define PSL1GHT_NUM_AXES 20
+#define PSL1GHT_NUM_BUTTONS 16
+
 typedef struct SDL_PSL1GHT_JoyData
 {
 	char name[NAMESIZE];
+	PadData pad_data;	// Last state read from the pad
+	int fresh;			// pad_data was read in the current poll
 } SDL_PSL1GHT_JoyData;
 
 struct joystick_hwdata
 {
-	PadData old_pad_data;
+	Uint16 buttons;		// Button bits as last reported
 };
 
 static SDL_PSL1GHT_JoyData joy_data[MAX_PADS];
+static Sint16 joy_deadzone;
+
+/* Word of PadData.button[] holding each axis */
+static const Uint8 axis_words[PSL1GHT_NUM_AXES] = {
+	6, 7, 4, 5,		// ANA_L_H, ANA_L_V, ANA_R_H, ANA_R_V
+	8, 9, 10, 11,	// PRE_RIGHT, PRE_LEFT, PRE_UP, PRE_DOWN
+	12, 13, 14, 15,	// PRE_TRIANGLE, PRE_CIRCLE, PRE_CROSS, PRE_SQUARE
+	16, 17, 18, 19,	// PRE_L1, PRE_R1, PRE_L2, PRE_R2
+	20, 21, 22, 23	// SENSOR_X, SENSOR_Y, SENSOR_Z, SENSOR_G
+};
 
 
 
@@ -62,14 +83,15 @@ SDL_SYS_JoystickInit(void)
     SDL_numjoysticks = MAX_PADS;
 	PadInfo padinfo;
 
-	pdprintf("SDL_SYS_JoystickInit\n");
-
 	SDL_zero( joy_data);
+	joy_deadzone = PSL1GHT_DEFAULT_DEADZONE;
+	if (SDL_getenv("SDL_JOYSTICK_PSL1GHT_DEADZONE"))
+		joy_deadzone = SDL_atoi(SDL_getenv("SDL_JOYSTICK_PSL1GHT_DEADZONE"));
 
 	if( iReturn == 0)
 	{
 		iReturn =  ioPadInit( MAX_PADS) ;
-		pdprintf("\tPad initialized\n");
+		PSL1GHT_TRACE(1, PSL1GHT_TRACE_JOYSTICK, "ioPadInit", iReturn, 0);
 		if( iReturn != 0)
 		{
 			SDL_SetError("SDL_SYS_JoystickInit() : Couldn't initialize PS3 pads");
@@ -80,7 +102,7 @@ SDL_SYS_JoystickInit(void)
 	if( iReturn == 0)
 	{
 		iReturn = ioPadGetInfo(&padinfo);
-		pdprintf("\tGot info\n");
+		PSL1GHT_TRACE(1, PSL1GHT_TRACE_JOYSTICK, "ioPadGetInfo", iReturn, padinfo.connected);
 		if( iReturn != 0)
 		{
 			SDL_SetError("SDL_SYS_JoystickInit() : Couldn't get PS3 pads information ");
@@ -94,6 +116,13 @@ SDL_SYS_JoystickInit(void)
 
 		for(i = 0; i < padinfo.connected; i++)
 		{
+			// Until a pad reports, its sticks and sensors are at rest
+			PadData *pad_data = &joy_data[i].pad_data;
+			pad_data->ANA_L_H = pad_data->ANA_L_V = 0x80;
+			pad_data->ANA_R_H = pad_data->ANA_R_V = 0x80;
+			pad_data->SENSOR_X = pad_data->SENSOR_Y = 512;
+			pad_data->SENSOR_Z = pad_data->SENSOR_G = 512;
+
 			if( padinfo.status[i])
 			{
 				sprintf( joy_data[i].name, "PAD%02X", i);
@@ -123,32 +152,62 @@ SDL_SYS_JoystickName(int index)
 int
 SDL_SYS_JoystickOpen(SDL_Joystick * joystick)
 {
-    if (!(joystick->hwdata = SDL_malloc(sizeof(struct joystick_hwdata))))
+    if (!(joystick->hwdata = SDL_malloc(sizeof(struct joystick_hwdata)))) {
+        SDL_OutOfMemory();
         return -1;
+    }
 
-	joystick->naxes = 4;
-	joystick->nhats = 0;
-	joystick->nballs = 0;
-	joystick->nbuttons = 16;
+    SDL_zerop(joystick->hwdata);
+
+    joystick->naxes = PSL1GHT_NUM_AXES;
+    joystick->nhats = 0;
+    joystick->nballs = 0;
+    joystick->nbuttons = PSL1GHT_NUM_BUTTONS;
+
+    // Pressure and sixaxis values are only sent once asked for
+    ioPadSetPressMode(joystick->index, PAD_PRESS_MODE_ON);
+    ioPadSetSensorMode(joystick->index, PAD_SENSOR_MODE_ON);
 
     return 0;
 }
 
-#define CheckPSL1GHTAxis( btn, bnum) \
-	if( new_pad_data.btn != joystick->hwdata->old_pad_data.btn) {\
-		SDL_PrivateJoystickAxis( joystick, (bnum), ((new_pad_data.btn-0x80)<<8)|new_pad_data.btn); \
-	} \
-	joystick->hwdata->old_pad_data.btn = new_pad_data.btn;
+/* Read every connected pad in one go, once per SDL_JoystickUpdate().
+   A pad that has not changed keeps the state it had. */
+static void
+PSL1GHT_PollPads(void)
+{
+	PadData pad_data;
+	int i;
 
-#define CheckPSL1GHTButton( btn, bnum) \
-	if( new_pad_data.btn != joystick->hwdata->old_pad_data.btn) {\
-		if( new_pad_data.btn == 0) \
-		SDL_PrivateJoystickButton( joystick, (bnum), SDL_RELEASED); \
-		else \
-		SDL_PrivateJoystickButton( joystick, (bnum), SDL_PRESSED); \
-	} \
-	joystick->hwdata->old_pad_data.btn = new_pad_data.btn;
+	for (i = 0; i < SDL_numjoysticks; i++) {
+		if (ioPadGetData(i, &pad_data) == 0 && pad_data.len >= 8) {
+			PSL1GHT_TRACE(2, PSL1GHT_TRACE_JOYSTICK, "PadData", i, pad_data.len);
+			joy_data[i].pad_data = pad_data;
+		}
+		joy_data[i].fresh = 1;
+	}
+}
 
+/* Scale an axis word to the Sint16 range and apply the deadzone */
+static Sint16
+PSL1GHT_AxisValue(int axis, Uint16 raw)
+{
+	Sint32 value;
+
+	if (axis < 4) {
+		// Sticks, 0..255 centred on 0x80
+		value = ((raw - 0x80) * 256) | raw;
+	} else if (axis < 16) {
+		// Pressure, 0..255 released at 0
+		value = (raw << 7) | (raw >> 1);
+	} else {
+		// Sixaxis, 0..1023 centred on 512
+		value = ((raw - 512) * 64) | ((raw >> 4) & 0x3F);
+	}
+	if (value > -joy_deadzone && value < joy_deadzone)
+		value = 0;
+	return (Sint16) value;
+}
 
 /* Function to update the state of a joystick - called as a device poll.
  * This function shouldn't update the joystick structure directly,
@@ -158,37 +217,30 @@ SDL_SYS_JoystickOpen(SDL_Joystick * joystick)
 void
 SDL_SYS_JoystickUpdate(SDL_Joystick * joystick)
 {
-	PadData new_pad_data;
-	if( ioPadGetData(joystick->index, &new_pad_data) != 0)
-		SDL_SetError("No joystick available with that index");
-	else if(new_pad_data.len >= 8)
-	{
-		// Update axes
-		CheckPSL1GHTAxis( ANA_L_H, 0);
-		CheckPSL1GHTAxis( ANA_L_V, 1);
-		CheckPSL1GHTAxis( ANA_R_H, 2);
-		CheckPSL1GHTAxis( ANA_R_V, 3);
-		
-		// Update buttons
-		CheckPSL1GHTButton( BTN_LEFT, 0);
-		CheckPSL1GHTButton( BTN_DOWN, 1);
-		CheckPSL1GHTButton( BTN_RIGHT, 2);
-		CheckPSL1GHTButton( BTN_UP, 3);
-
-		CheckPSL1GHTButton( BTN_START, 4);
-		CheckPSL1GHTButton( BTN_R3, 5);
-		CheckPSL1GHTButton( BTN_L3, 6);
-		CheckPSL1GHTButton( BTN_SELECT, 7);
-
-		CheckPSL1GHTButton( BTN_SQUARE, 8);
-		CheckPSL1GHTButton( BTN_CROSS, 9);
-		CheckPSL1GHTButton( BTN_CIRCLE, 10);
-		CheckPSL1GHTButton( BTN_TRIANGLE, 11);
-
-		CheckPSL1GHTButton( BTN_R1, 12);
-		CheckPSL1GHTButton( BTN_L1, 13);
-		CheckPSL1GHTButton( BTN_R2, 14);
-		CheckPSL1GHTButton( BTN_L2, 15);
+	SDL_PSL1GHT_JoyData *joy = &joy_data[joystick->index];
+	Uint16 buttons, changed;
+	int i;
+
+	if (!joy->fresh)
+		PSL1GHT_PollPads();
+	joy->fresh = 0;
+
+	// The two button words, button 0 (LEFT) in the top bit
+	buttons = ((joy->pad_data.button[2] & 0xFF) << 8) |
+		(joy->pad_data.button[3] & 0xFF);
+	changed = buttons ^ joystick->hwdata->buttons;
+	while (changed) {
+		const int bit = 31 - __builtin_clz(changed);
+		SDL_PrivateJoystickButton(joystick, 15 - bit,
+		                          (buttons & (1 << bit)) ? SDL_PRESSED : SDL_RELEASED);
+		changed &= ~(1 << bit);
+	}
+	joystick->hwdata->buttons = buttons;
+
+	for (i = 0; i < PSL1GHT_NUM_AXES; i++) {
+		const Sint16 value = PSL1GHT_AxisValue(i, joy->pad_data.button[axis_words[i]]);
+		if (value != joystick->axes[i])
+			SDL_PrivateJoystickAxis(joystick, i, value);
 	}
 
     return;
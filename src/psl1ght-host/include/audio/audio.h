@@ -0,0 +1,89 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: libaudio ports.
+ *
+ * Like on the console, readIndex and audioDataStart are 32-bit addresses;
+ * the stand-in allocates the port memory below 4GB so that drivers can
+ * keep casting them straight to pointers.
+ */
+
+#ifndef _PSL1GHT_HOST_AUDIO_AUDIO_H
+#define _PSL1GHT_HOST_AUDIO_AUDIO_H
+
+#include <psl1ght/types.h>
+#include <sys/event_queue.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_BLOCK_SAMPLES 256
+
+#define AUDIO_PORT_2CH  2
+#define AUDIO_PORT_8CH  8
+
+#define AUDIO_BLOCK_8   8
+#define AUDIO_BLOCK_16  16
+#define AUDIO_BLOCK_32  32
+
+#define AUDIO_STATUS_READY  1
+#define AUDIO_STATUS_RUN    2
+#define AUDIO_STATUS_CLOSE  0x1010
+
+typedef struct _AudioPortParam
+{
+    u64 numChannels;
+    u64 numBlocks;
+    u64 attr;
+    f32 level;
+} AudioPortParam;
+
+typedef struct _AudioPortConfig
+{
+    u32 readIndex;              /* address of the u64 block being played */
+    u32 status;
+    u64 channelCount;
+    u64 numBlocks;
+    u32 portSize;
+    u32 audioDataStart;         /* address of the float ring buffer */
+} AudioPortConfig;
+
+extern s32 audioInit(void);
+extern s32 audioQuit(void);
+extern s32 audioPortOpen(AudioPortParam * param, u32 * portNum);
+extern s32 audioPortStart(u32 portNum);
+extern s32 audioPortStop(u32 portNum);
+extern s32 audioPortClose(u32 portNum);
+extern s32 audioGetPortConfig(u32 portNum, AudioPortConfig * config);
+extern s32 audioCreateNotifyEventQueue(sys_event_queue_t * queue,
+                                       sys_ipc_key_t * key);
+extern s32 audioSetNotifyEventQueue(sys_ipc_key_t key);
+extern s32 audioRemoveNotifyEventQueue(sys_ipc_key_t key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_AUDIO_AUDIO_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,158 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: controller pads.
+ *
+ * The digital buttons keep the bit positions they have in button[2] and
+ * button[3] on the console, whatever the host byte order is.
+ */
+
+#ifndef _PSL1GHT_HOST_IO_PAD_H
+#define _PSL1GHT_HOST_IO_PAD_H
+
+#include <psl1ght/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_PADS        127
+#define MAX_PAD_CODES   64
+
+#define PAD_PRESS_MODE_OFF      0
+#define PAD_PRESS_MODE_ON       1
+#define PAD_SENSOR_MODE_OFF     0
+#define PAD_SENSOR_MODE_ON      1
+
+typedef struct _PadInfo
+{
+    u32 max;
+    u32 connected;
+    u32 info;
+    u16 vendor_id[MAX_PADS];
+    u16 product_id[MAX_PADS];
+    u8 status[MAX_PADS];
+} PadInfo;
+
+typedef struct _PadData
+{
+    s32 len;
+    union
+    {
+        u16 button[MAX_PAD_CODES];
+        struct
+        {
+            u16 zeroes;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            u16:8;
+            u16 seven:4;
+            u16 halflen:4;
+
+            u16:8;
+            u16 BTN_LEFT:1;
+            u16 BTN_DOWN:1;
+            u16 BTN_RIGHT:1;
+            u16 BTN_UP:1;
+            u16 BTN_START:1;
+            u16 BTN_R3:1;
+            u16 BTN_L3:1;
+            u16 BTN_SELECT:1;
+
+            u16:8;
+            u16 BTN_SQUARE:1;
+            u16 BTN_CROSS:1;
+            u16 BTN_CIRCLE:1;
+            u16 BTN_TRIANGLE:1;
+            u16 BTN_R1:1;
+            u16 BTN_L1:1;
+            u16 BTN_R2:1;
+            u16 BTN_L2:1;
+#else
+            u16 halflen:4;
+            u16 seven:4;
+            u16:8;
+
+            u16 BTN_SELECT:1;
+            u16 BTN_L3:1;
+            u16 BTN_R3:1;
+            u16 BTN_START:1;
+            u16 BTN_UP:1;
+            u16 BTN_RIGHT:1;
+            u16 BTN_DOWN:1;
+            u16 BTN_LEFT:1;
+            u16:8;
+
+            u16 BTN_L2:1;
+            u16 BTN_R2:1;
+            u16 BTN_L1:1;
+            u16 BTN_R1:1;
+            u16 BTN_TRIANGLE:1;
+            u16 BTN_CIRCLE:1;
+            u16 BTN_CROSS:1;
+            u16 BTN_SQUARE:1;
+            u16:8;
+#endif
+            /* Analog sticks, 0..255 with 0x80 at rest */
+            u16 ANA_R_H;
+            u16 ANA_R_V;
+            u16 ANA_L_H;
+            u16 ANA_L_V;
+
+            /* Pressure sensitive buttons, 0..255 */
+            u16 PRE_RIGHT;
+            u16 PRE_LEFT;
+            u16 PRE_UP;
+            u16 PRE_DOWN;
+            u16 PRE_TRIANGLE;
+            u16 PRE_CIRCLE;
+            u16 PRE_CROSS;
+            u16 PRE_SQUARE;
+            u16 PRE_L1;
+            u16 PRE_R1;
+            u16 PRE_L2;
+            u16 PRE_R2;
+
+            /* Sixaxis, 0..1023 with 512 at rest */
+            u16 SENSOR_X;
+            u16 SENSOR_Y;
+            u16 SENSOR_Z;
+            u16 SENSOR_G;
+        };
+    };
+} PadData;
+
+extern s32 ioPadInit(u32 max);
+extern s32 ioPadEnd(void);
+extern s32 ioPadGetInfo(PadInfo * info);
+/* len is 0 when nothing changed since the previous call for that port */
+extern s32 ioPadGetData(u32 port, PadData * data);
+/* Pressure and sixaxis values are only reported once their mode is on */
+extern s32 ioPadSetPressMode(u32 port, u32 mode);
+extern s32 ioPadSetSensorMode(u32 port, u32 mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_IO_PAD_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,86 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Control interface of the host PSL1GHT stand-in.
+ *
+ * This has no console equivalent: it lets test and benchmark programs
+ * linked against a --enable-psl1ght-host build inspect what the emulated
+ * hardware did and feed it input.  The stand-in also reads these
+ * environment variables at startup:
+ *
+ *   PSL1GHT_HOST_RESOLUTION  1080, 720, 576 or 480 (default 1080)
+ *   PSL1GHT_HOST_VBLANK_HZ   simulated refresh rate (default 60)
+ *   PSL1GHT_HOST_PADS        number of connected pads (default 1)
+ *   PSL1GHT_HOST_LOCAL_MB    size of the RSX local memory (default 256)
+ *   PSL1GHT_HOST_SPUS        number of raw SPUs available (default 5)
+ */
+
+#ifndef _PSL1GHT_HOST_H
+#define _PSL1GHT_HOST_H
+
+#include <psl1ght/types.h>
+#include <io/pad.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PSL1GHT_HOST_API __attribute__ ((visibility("default")))
+
+typedef struct _psl1ghtHostStats
+{
+    u64 vblanks;                /* simulated vertical blanks */
+    u64 flips;                  /* buffers actually sent to scan-out */
+    u64 flip_wait_usec;         /* sum of queued-to-displayed flip delays */
+    u64 rsx_commands;           /* command words consumed by the RSX */
+    u64 audio_blocks;           /* audio blocks consumed by running ports */
+    u64 pad_reads;              /* calls to ioPadGetData() */
+    u64 spu_dma_bytes;          /* bytes moved by SPU mfc_get/mfc_put */
+} psl1ghtHostStats;
+
+/* Snapshot of the counters above, all cumulative since startup */
+extern PSL1GHT_HOST_API void psl1ghtHostGetStats(psl1ghtHostStats * stats);
+
+/* Describe the buffer currently being scanned out, -1 if there is none */
+extern PSL1GHT_HOST_API s32 psl1ghtHostGetDisplayBuffer(void **pixels,
+                                                        u32 * pitch,
+                                                        u32 * width,
+                                                        u32 * height);
+
+/* Block until the emulated RSX has consumed every flushed command */
+extern PSL1GHT_HOST_API void psl1ghtHostWaitRSXIdle(void);
+
+/* Pad state as returned by the next ioPadGetData() on that port */
+extern PSL1GHT_HOST_API void psl1ghtHostSetPadCount(u32 count);
+extern PSL1GHT_HOST_API void psl1ghtHostSetPadData(u32 port,
+                                                   const PadData * data);
+
+/* Queue a sysutil event for the next sysCheckCallback() */
+extern PSL1GHT_HOST_API void psl1ghtHostPostSysEvent(u64 status, u64 param);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
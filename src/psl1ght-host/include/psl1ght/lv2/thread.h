@@ -0,0 +1,54 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: lv2 PPU threads, backed by pthreads */
+
+#ifndef _PSL1GHT_HOST_LV2_THREAD_H
+#define _PSL1GHT_HOST_LV2_THREAD_H
+
+#include <psl1ght/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define THREAD_JOINABLE     1
+#define THREAD_INTERRUPT    2
+
+typedef u64 sys_ppu_thread_t;
+
+extern s32 sys_ppu_thread_create(sys_ppu_thread_t * threadid,
+                                 void (*entry) (u64 arg), u64 arg,
+                                 s32 priority, u64 stacksize, u64 flags,
+                                 const char *threadname);
+extern void sys_ppu_thread_exit(u64 val) __attribute__ ((noreturn));
+extern s32 sys_ppu_thread_join(sys_ppu_thread_t threadid, u64 * retval);
+extern s32 sys_ppu_thread_get_id(sys_ppu_thread_t * threadid);
+extern s32 sys_ppu_thread_yield(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_LV2_THREAD_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
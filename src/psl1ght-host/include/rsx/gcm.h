@@ -0,0 +1,94 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: RSX command context and flip control.
+ *
+ * On the console the context fields are 32-bit effective addresses; the
+ * host version uses native pointers since nothing outside the stand-in
+ * touches them directly.
+ */
+
+#ifndef _PSL1GHT_HOST_RSX_GCM_H
+#define _PSL1GHT_HOST_RSX_GCM_H
+
+#include <psl1ght/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GCM_FLIP_HSYNC  1
+#define GCM_FLIP_VSYNC  2
+
+#define GCM_MAX_DISPLAY_BUFFERS 8
+
+typedef struct _gcmContextData gcmContextData;
+
+/* Called when a command does not fit between current and end */
+typedef s32 (*gcmContextCallback) (gcmContextData * context, u32 count);
+
+struct _gcmContextData
+{
+    u32 *begin;
+    u32 *end;
+    u32 *current;
+    gcmContextCallback callback;
+};
+
+/* FIFO registers: put and get are offsets into the command buffer, ref
+   is the last value written by a SET_REFERENCE command */
+typedef struct _gcmControlRegister
+{
+    vu32 put;
+    vu32 get;
+    vu32 ref;
+} gcmControlRegister;
+
+typedef struct _gcmConfiguration
+{
+    void *localAddress;
+    void *ioAddress;
+    u32 localSize;
+    u32 ioSize;
+    u32 memoryFrequency;
+    u32 coreFrequency;
+} gcmConfiguration;
+
+extern s32 gcmSetFlip(gcmContextData * context, s32 bufferId);
+extern void gcmSetWaitFlip(gcmContextData * context);
+extern void gcmSetFlipMode(s32 mode);
+extern s32 gcmSetDisplayBuffer(u32 bufferId, u32 offset, u32 pitch,
+                               u32 width, u32 height);
+extern u32 gcmGetFlipStatus(void);
+extern void gcmResetFlipStatus(void);
+extern void gcmSetFlipHandler(void (*handler) (const u32 head));
+extern void gcmSetVBlankHandler(void (*handler) (const u32 head));
+extern s32 gcmGetConfiguration(gcmConfiguration * config);
+extern gcmControlRegister *gcmGetControlRegister(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_RSX_GCM_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,50 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: RSX initialisation and local memory */
+
+#ifndef _PSL1GHT_HOST_RSX_REALITY_H
+#define _PSL1GHT_HOST_RSX_REALITY_H
+
+#include <psl1ght/types.h>
+#include <rsx/gcm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern gcmContextData *realityInit(u32 bufferSize, u32 ioSize,
+                                   void *ioAddress);
+extern void realityFlushBuffer(gcmContextData * context);
+extern s32 realityAddressToOffset(void *address, u32 * offset);
+
+extern void *rsxMemAlign(u32 alignment, u32 size);
+extern void *rsxMalloc(u32 size);
+extern void rsxFree(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_RSX_REALITY_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
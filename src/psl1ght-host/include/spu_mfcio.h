@@ -0,0 +1,99 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the SPU side of the SDK: mailboxes and MFC DMA.
+ *
+ * SPU programs are compiled into the host library and run on the thread
+ * of the raw SPU they were loaded into.  Their main() is made static, and
+ * PSL1GHT_HOST_SPU_IMAGE(name) then defines the symbol a console build
+ * gets from embedding the SPU executable, so the PPU code importing the
+ * image is the same for both.
+ *
+ * DMA completes immediately, but is checked against the MFC size and
+ * alignment rules: a transfer the console would fault on aborts.
+ */
+
+#ifndef _PSL1GHT_HOST_SPU_MFCIO_H
+#define _PSL1GHT_HOST_SPU_MFCIO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MFC_MAX_DMA_SIZE    16384
+#define MFC_TAG_MAX         32
+
+typedef struct _psl1ghtHostSpuProgram
+{
+    uint32_t magic;
+    int (*entry) (uint64_t speid, uint64_t argp, uint64_t envp);
+} psl1ghtHostSpuProgram;
+
+#define PSL1GHT_HOST_SPU_MAGIC  0x7f535055
+
+extern uint32_t psl1ghtHostSpuReadInMbox(void);
+extern void psl1ghtHostSpuWriteOutMbox(uint32_t data);
+extern void psl1ghtHostSpuDMA(volatile void *ls, uint64_t ea, uint32_t size,
+                              uint32_t tag, int put);
+
+#define spu_read_in_mbox()          psl1ghtHostSpuReadInMbox()
+#define spu_write_out_mbox(data)    psl1ghtHostSpuWriteOutMbox(data)
+
+#define mfc_get(ls, ea, size, tag, tid, rid) \
+    psl1ghtHostSpuDMA(ls, ea, size, tag, 0)
+#define mfc_put(ls, ea, size, tag, tid, rid) \
+    psl1ghtHostSpuDMA(ls, ea, size, tag, 1)
+
+/* Transfers are done by the time they are issued */
+static __inline__ void
+mfc_write_tag_mask(uint32_t mask)
+{
+}
+
+static __inline__ uint32_t
+mfc_read_tag_status_all(void)
+{
+    return ~0U;
+}
+
+/* Everything below is for the SPU programs, not the stand-in itself */
+#ifndef PSL1GHT_HOST_SPU_RUNTIME
+
+static int psl1ghtHostSpuMain(uint64_t speid, uint64_t argp, uint64_t envp);
+#define main psl1ghtHostSpuMain
+
+#define PSL1GHT_HOST_SPU_IMAGE(name) \
+    const psl1ghtHostSpuProgram name = { \
+        PSL1GHT_HOST_SPU_MAGIC, psl1ghtHostSpuMain \
+    };
+
+#endif /* PSL1GHT_HOST_SPU_RUNTIME */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_SPU_MFCIO_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,69 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: lv2 event queues */
+
+#ifndef _PSL1GHT_HOST_SYS_EVENT_QUEUE_H
+#define _PSL1GHT_HOST_SYS_EVENT_QUEUE_H
+
+#include <psl1ght/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYS_EVENT_QUEUE_DESTROY_FORCE   1
+
+typedef u32 sys_event_queue_t;
+typedef u64 sys_ipc_key_t;
+
+typedef struct _sys_event
+{
+    u64 source;
+    u64 data_1;
+    u64 data_2;
+    u64 data_3;
+} sys_event_t;
+
+typedef struct _sys_event_queue_attr
+{
+    u32 attr_protocol;
+    s32 type;
+    char name[8];
+} sys_event_queue_attr_t;
+
+extern s32 sys_event_queue_create(sys_event_queue_t * queue,
+                                  sys_event_queue_attr_t * attr,
+                                  sys_ipc_key_t key, s32 size);
+extern s32 sys_event_queue_destroy(sys_event_queue_t queue, s32 mode);
+/* timeout is in microseconds, 0 waits forever */
+extern s32 sys_event_queue_receive(sys_event_queue_t queue,
+                                   sys_event_t * event, u64 timeout);
+extern s32 sys_event_queue_drain(sys_event_queue_t queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_SYS_EVENT_QUEUE_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
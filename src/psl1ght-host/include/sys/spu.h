@@ -0,0 +1,83 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: raw SPUs.
+ *
+ * A raw SPU runs its image on a host thread once 1 is written to its
+ * SPU_RunCntl register; the mailboxes are reached through the problem
+ * state registers as on the console.  SPU images are not ELF files here,
+ * see <spu_mfcio.h> for how the programs themselves are built.
+ */
+
+#ifndef _PSL1GHT_HOST_SYS_SPU_H
+#define _PSL1GHT_HOST_SYS_SPU_H
+
+#include <psl1ght/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Problem state register offsets */
+#define SPU_Out_MBox        0x4004
+#define SPU_In_MBox         0x400C
+#define SPU_MBox_Status     0x4014
+#define SPU_RunCntl         0x401C
+#define SPU_Status          0x4024
+
+/* SPU_MBox_Status fields */
+#define SPU_MBOX_OUT_COUNT(status)  ((status) & 0xff)
+#define SPU_MBOX_IN_FREE(status)    (((status) >> 8) & 0xff)
+
+/* SPU_Status bits */
+#define SPU_STATUS_RUNNING  0x01
+#define SPU_STATUS_STOPPED  0x02
+
+#define SPU_IMAGE_TYPE_USER     0
+#define SPU_IMAGE_TYPE_KERNEL   1
+
+typedef struct _sysSpuImage
+{
+    u32 type;
+    u32 entryPoint;
+    u32 segments;
+    u32 segmentCount;
+} sysSpuImage;
+
+extern s32 sysSpuInitialize(u32 spus, u32 rawspus);
+extern s32 sysSpuImageImport(sysSpuImage * image, const void *elf,
+                             u32 type);
+extern s32 sysSpuImageClose(sysSpuImage * image);
+/* EBUSY once every raw SPU is taken */
+extern s32 sysSpuRawCreate(u32 * spu, void *attributes);
+extern s32 sysSpuRawDestroy(u32 spu);
+extern s32 sysSpuRawImageLoad(u32 spu, sysSpuImage * image);
+extern void sysSpuRawWriteProblemStorage(u32 spu, u32 offset, u32 value);
+extern u32 sysSpuRawReadProblemStorage(u32 spu, u32 offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_SYS_SPU_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
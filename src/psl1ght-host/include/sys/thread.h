@@ -0,0 +1,70 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: lv2 threads and semaphores.
+ *
+ * Errors are reported with the host errno values (EBUSY, ETIMEDOUT, ...)
+ * so <sys/errno.h> keeps working for the callers.
+ */
+
+#ifndef _PSL1GHT_HOST_SYS_THREAD_H
+#define _PSL1GHT_HOST_SYS_THREAD_H
+
+#include <psl1ght/types.h>
+#include <psl1ght/lv2/thread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEMAPHORE_ATTR_PROTOCOL 0x0002
+#define SEMAPHORE_ATTR_PSHARED  0x0200
+
+typedef u32 sys_semaphore_t;
+
+typedef struct _sys_semaphore_attribute
+{
+    u32 attr_protocol;
+    u32 attr_pshared;
+    u64 key;
+    s32 flags;
+    u32 pad;
+    char name[8];
+} sys_semaphore_attribute_t;
+
+extern s32 sys_semaphore_create(sys_semaphore_t * sem,
+                                sys_semaphore_attribute_t * attr,
+                                s32 initial_val, s32 max_val);
+extern s32 sys_semaphore_destroy(sys_semaphore_t sem);
+/* timeout is in microseconds, 0 waits forever */
+extern s32 sys_semaphore_wait(sys_semaphore_t sem, u64 timeout);
+extern s32 sys_semaphore_trywait(sys_semaphore_t sem);
+extern s32 sys_semaphore_post(sys_semaphore_t sem, s32 val);
+extern s32 sys_semaphore_get_value(sys_semaphore_t sem, s32 * val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_SYS_THREAD_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,61 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: system utility callbacks */
+
+#ifndef _PSL1GHT_HOST_SYSUTIL_EVENTS_H
+#define _PSL1GHT_HOST_SYSUTIL_EVENTS_H
+
+#include <psl1ght/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_REQUEST_EXITAPP   0x0101
+#define EVENT_DRAWING_BEGIN     0x0121
+#define EVENT_DRAWING_END       0x0122
+#define EVENT_MENU_OPEN         0x0131
+#define EVENT_MENU_CLOSE        0x0132
+
+typedef enum
+{
+    EVENT_SLOT0,
+    EVENT_SLOT1,
+    EVENT_SLOT2,
+    EVENT_SLOT3
+} sysEventSlot;
+
+typedef void (*sysEventCallback) (u64 status, u64 param, void *userdata);
+
+extern s32 sysCheckCallback(void);
+extern s32 sysRegisterCallback(sysEventSlot slot, sysEventCallback func,
+                               void *userdata);
+extern s32 sysUnregisterCallback(sysEventSlot slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_SYSUTIL_EVENTS_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,95 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the PSL1GHT SDK: video output configuration */
+
+#ifndef _PSL1GHT_HOST_SYSUTIL_VIDEO_H
+#define _PSL1GHT_HOST_SYSUTIL_VIDEO_H
+
+#include <psl1ght/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VIDEO_RESOLUTION_1080   1
+#define VIDEO_RESOLUTION_720    2
+#define VIDEO_RESOLUTION_480    4
+#define VIDEO_RESOLUTION_576    5
+
+#define VIDEO_BUFFER_FORMAT_XRGB    0
+#define VIDEO_BUFFER_FORMAT_XBGR    1
+#define VIDEO_BUFFER_FORMAT_FLOAT   2
+
+#define VIDEO_ASPECT_AUTO   0
+#define VIDEO_ASPECT_4_3    1
+#define VIDEO_ASPECT_16_9   2
+
+#define VIDEO_PRIMARY   0
+
+typedef struct _VideoResolution
+{
+    u16 width;
+    u16 height;
+} VideoResolution;
+
+typedef struct _VideoDisplayMode
+{
+    u8 resolution;
+    u8 scanMode;
+    u8 conversion;
+    u8 aspect;
+    u8 padding[2];
+    u16 refreshRates;
+} VideoDisplayMode;
+
+/* state is 0 when the output is enabled, 3 while it is being reconfigured */
+typedef struct _VideoState
+{
+    u8 state;
+    u8 colorSpace;
+    u8 padding[6];
+    VideoDisplayMode displayMode;
+} VideoState;
+
+typedef struct _VideoConfiguration
+{
+    u8 resolution;
+    u8 format;
+    u8 aspect;
+    u8 padding[9];
+    u32 pitch;
+} VideoConfiguration;
+
+extern s32 videoGetState(s32 videoOut, s32 deviceIndex, VideoState * state);
+extern s32 videoGetResolution(s32 resolutionId,
+                              VideoResolution * resolution);
+extern s32 videoConfigure(s32 videoOut, VideoConfiguration * config,
+                          void *option, s32 blocking);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PSL1GHT_HOST_SYSUTIL_VIDEO_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
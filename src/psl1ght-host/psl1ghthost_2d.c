@@ -0,0 +1,402 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the RSX 2D objects.
+ *
+ * Only what the SDL renderer drives is modelled: the surface 2D object
+ * (NV3062) as blit destination and the scaled image from memory object
+ * (NV3089) as source, with the SRCCOPY, BLEND_AND and BLEND_PREMULT
+ * operations.  Both interpolators sample the nearest texel.  Called from
+ * the RSX thread.
+ */
+
+#include <rsx/gcm.h>
+
+#include "psl1ghthost_c.h"
+
+/* NV3062 methods, relative to the subchannel */
+#define SURFACE2D_SET_CONTEXT_DMA_IMAGE_SOURCE  0x0184
+#define SURFACE2D_SET_CONTEXT_DMA_IMAGE_DESTIN  0x0188
+#define SURFACE2D_SET_COLOR_FORMAT              0x0300
+#define SURFACE2D_SET_PITCH                     0x0304
+#define SURFACE2D_SET_OFFSET_SOURCE             0x0308
+#define SURFACE2D_SET_OFFSET_DESTIN             0x030c
+
+#define SURFACE2D_FORMAT_R5G6B5     0x04
+#define SURFACE2D_FORMAT_X8R8G8B8   0x06
+#define SURFACE2D_FORMAT_A8R8G8B8   0x0a
+
+/* NV3089 methods, relative to the subchannel */
+#define SIFM_SET_CONTEXT_DMA_IMAGE  0x0184
+#define SIFM_SET_CONTEXT_SURFACE    0x0198
+#define SIFM_SET_COLOR_CONVERSION   0x02fc
+#define SIFM_SET_COLOR_FORMAT       0x0300
+#define SIFM_SET_OPERATION          0x0304
+#define SIFM_CLIP_POINT             0x0308
+#define SIFM_CLIP_SIZE              0x030c
+#define SIFM_IMAGE_OUT_POINT        0x0310
+#define SIFM_IMAGE_OUT_SIZE         0x0314
+#define SIFM_DS_DX                  0x0318
+#define SIFM_DT_DY                  0x031c
+#define SIFM_IMAGE_IN_SIZE          0x0400
+#define SIFM_IMAGE_IN_FORMAT        0x0404
+#define SIFM_IMAGE_IN_OFFSET        0x0408
+#define SIFM_IMAGE_IN               0x040c
+
+#define SIFM_FORMAT_A8R8G8B8    0x03
+#define SIFM_FORMAT_X8R8G8B8    0x04
+#define SIFM_FORMAT_R5G6B5      0x07
+
+#define SIFM_OPERATION_BLEND_AND    0x02
+#define SIFM_OPERATION_SRCCOPY      0x03
+#define SIFM_OPERATION_BLEND_PREMULT 0x05
+
+#define SIFM_BLENDS(op) \
+    ((op) == SIFM_OPERATION_BLEND_AND || (op) == SIFM_OPERATION_BLEND_PREMULT)
+
+static struct
+{
+    u32 dma_destin;
+    u32 format;
+    u32 pitch;
+    u32 offset;
+} surface = {
+RSX_DMA_MEMORY_LOCAL};
+
+static struct
+{
+    u32 dma;
+    u32 format;
+    u32 operation;
+    u32 clip_point;
+    u32 clip_size;
+    u32 out_point;
+    u32 out_size;
+    u32 dsdx;
+    u32 dtdy;
+    u32 in_size;
+    u32 in_format;
+    u32 in_offset;
+} sifm = {
+RSX_DMA_MEMORY_LOCAL};
+
+static int
+psl1ghtHostSurfaceBpp(u32 format)
+{
+    switch (format) {
+    case SURFACE2D_FORMAT_R5G6B5:
+        return 2;
+    case SURFACE2D_FORMAT_X8R8G8B8:
+    case SURFACE2D_FORMAT_A8R8G8B8:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static int
+psl1ghtHostImageBpp(u32 format)
+{
+    switch (format) {
+    case SIFM_FORMAT_R5G6B5:
+        return 2;
+    case SIFM_FORMAT_X8R8G8B8:
+    case SIFM_FORMAT_A8R8G8B8:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static u32
+psl1ghtHostFetch(const u8 * p, u32 format)
+{
+    u32 pixel;
+
+    switch (format) {
+    case SIFM_FORMAT_R5G6B5:
+        pixel = *(const u16 *) p;
+        return 0xff000000 |
+            ((pixel & 0xf800) << 8) | ((pixel & 0xe000) << 3) |
+            ((pixel & 0x07e0) << 5) | ((pixel & 0x0600) >> 1) |
+            ((pixel & 0x001f) << 3) | ((pixel & 0x001c) >> 2);
+    case SIFM_FORMAT_X8R8G8B8:
+        return *(const u32 *) p | 0xff000000;
+    default:
+        return *(const u32 *) p;
+    }
+}
+
+static u32
+psl1ghtHostLoad(const u8 * p, u32 format)
+{
+    if (format == SURFACE2D_FORMAT_R5G6B5) {
+        return psl1ghtHostFetch(p, SIFM_FORMAT_R5G6B5);
+    }
+    return *(const u32 *) p;
+}
+
+static void
+psl1ghtHostStore(u8 * p, u32 format, u32 argb)
+{
+    if (format == SURFACE2D_FORMAT_R5G6B5) {
+        *(u16 *) p = (u16) (((argb >> 8) & 0xf800) |
+                            ((argb >> 5) & 0x07e0) | ((argb >> 3) & 0x001f));
+    } else {
+        *(u32 *) p = argb;
+    }
+}
+
+/* Source over destination, the operation libgcm calls BLEND_AND, or
+   with the source colour already multiplied by its alpha for BLEND_PREMULT */
+static u32
+psl1ghtHostBlend(u32 src, u32 dst)
+{
+    u32 a = src >> 24, inv = 255 - a;
+    u32 r, g, b, da;
+
+    if (sifm.operation == SIFM_OPERATION_BLEND_PREMULT) {
+        r = ((src >> 16) & 0xff) + (((dst >> 16) & 0xff) * inv) / 255;
+        g = ((src >> 8) & 0xff) + (((dst >> 8) & 0xff) * inv) / 255;
+        b = (src & 0xff) + ((dst & 0xff) * inv) / 255;
+        da = a + ((dst >> 24) * inv) / 255;
+        return (da << 24) | ((r > 0xff ? 0xff : r) << 16) |
+            ((g > 0xff ? 0xff : g) << 8) | (b > 0xff ? 0xff : b);
+    }
+    r = (((src >> 16) & 0xff) * a + ((dst >> 16) & 0xff) * inv) / 255;
+    g = (((src >> 8) & 0xff) * a + ((dst >> 8) & 0xff) * inv) / 255;
+    b = ((src & 0xff) * a + (dst & 0xff) * inv) / 255;
+    da = a + ((dst >> 24) * inv) / 255;
+    return (da << 24) | (r << 16) | (g << 8) | b;
+}
+
+static void
+psl1ghtHostSolidFill(u8 * out, s32 x0, s32 x1, s32 rows, int dst_bpp,
+                     u32 src)
+{
+    u32 *row;
+    s32 x, y;
+
+    if (SIFM_BLENDS(sifm.operation) && (src >> 24) != 0xff) {
+        if (src == 0 || ((src >> 24) == 0 &&
+                         sifm.operation == SIFM_OPERATION_BLEND_AND)) {
+            return;
+        }
+        for (y = 0; y < rows; ++y, out += surface.pitch) {
+            for (x = x0; x < x1; ++x) {
+                psl1ghtHostStore(out + x * dst_bpp, surface.format,
+                                 psl1ghtHostBlend(src,
+                                                  psl1ghtHostLoad(out +
+                                                                  x * dst_bpp,
+                                                                  surface.
+                                                                  format)));
+            }
+        }
+        return;
+    }
+    if (dst_bpp != 4) {
+        for (y = 0; y < rows; ++y, out += surface.pitch) {
+            for (x = x0; x < x1; ++x) {
+                psl1ghtHostStore(out + x * dst_bpp, surface.format, src);
+            }
+        }
+        return;
+    }
+    for (y = 0; y < rows; ++y, out += surface.pitch) {
+        row = (u32 *) out;
+        for (x = x0; x < x1; ++x) {
+            row[x] = src;
+        }
+    }
+}
+
+static void
+psl1ghtHostScaledImage(u32 in_point)
+{
+    int dst_bpp = psl1ghtHostSurfaceBpp(surface.format);
+    int src_bpp = psl1ghtHostImageBpp(sifm.format);
+    s32 x0, y0, x1, y1, out_x, out_y, x, y;
+    u32 in_w, in_h, in_pitch, u, v, row, col, src, dst;
+    u8 *in, *out;
+
+    if (!dst_bpp || !src_bpp || !sifm.dsdx || !sifm.dtdy) {
+        return;
+    }
+
+    /* Output rectangle clipped against the clip rectangle */
+    out_x = (s16) (sifm.out_point & 0xffff);
+    out_y = (s16) (sifm.out_point >> 16);
+    x0 = (s16) (sifm.clip_point & 0xffff);
+    y0 = (s16) (sifm.clip_point >> 16);
+    x1 = x0 + (s32) (sifm.clip_size & 0xffff);
+    y1 = y0 + (s32) (sifm.clip_size >> 16);
+    if (x0 < out_x) {
+        x0 = out_x;
+    }
+    if (y0 < out_y) {
+        y0 = out_y;
+    }
+    if (x1 > out_x + (s32) (sifm.out_size & 0xffff)) {
+        x1 = out_x + (s32) (sifm.out_size & 0xffff);
+    }
+    if (y1 > out_y + (s32) (sifm.out_size >> 16)) {
+        y1 = out_y + (s32) (sifm.out_size >> 16);
+    }
+    if (x0 < 0) {
+        x0 = 0;
+    }
+    if (y0 < 0) {
+        y0 = 0;
+    }
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    in_w = sifm.in_size & 0xffff;
+    in_h = sifm.in_size >> 16;
+    in_pitch = sifm.in_format & 0xffff;
+    if (!in_w || !in_h) {
+        return;
+    }
+    in = (u8 *) psl1ghtHostRSXAddress(sifm.dma, sifm.in_offset,
+                                      (in_h - 1) * in_pitch + in_w * src_bpp);
+    out = (u8 *) psl1ghtHostRSXAddress(surface.dma_destin,
+                                       surface.offset +
+                                       (u32) y0 * surface.pitch,
+                                       (u32) (y1 - y0 - 1) * surface.pitch +
+                                       (u32) x1 * dst_bpp);
+    if (!in || !out) {
+        return;
+    }
+
+    /* A single texel is a solid fill, which is what rectangles come as */
+    if (in_w == 1 && in_h == 1) {
+        psl1ghtHostSolidFill(out, x0, x1, y1 - y0, dst_bpp,
+                             psl1ghtHostFetch(in, sifm.format));
+        return;
+    }
+
+    /* Texel coordinates are 12.4 in IMAGE_IN, steps are 12.20 */
+    for (y = y0; y < y1; ++y) {
+        v = ((in_point >> 16) << 16) + (u32) (y - out_y) * sifm.dtdy;
+        row = v >> 20;
+        if (row >= in_h) {
+            row = in_h - 1;
+        }
+        for (x = x0; x < x1; ++x) {
+            u = ((in_point & 0xffff) << 16) + (u32) (x - out_x) * sifm.dsdx;
+            col = u >> 20;
+            if (col >= in_w) {
+                col = in_w - 1;
+            }
+            src = psl1ghtHostFetch(in + row * in_pitch + col * src_bpp,
+                                   sifm.format);
+            if (SIFM_BLENDS(sifm.operation)) {
+                if (src == 0 || ((src >> 24) == 0 &&
+                                 sifm.operation == SIFM_OPERATION_BLEND_AND)) {
+                    continue;
+                }
+                if ((src >> 24) != 0xff) {
+                    dst = psl1ghtHostLoad(out + x * dst_bpp, surface.format);
+                    src = psl1ghtHostBlend(src, dst);
+                }
+            }
+            psl1ghtHostStore(out + x * dst_bpp, surface.format, src);
+        }
+        out += surface.pitch;
+    }
+}
+
+void
+psl1ghtHost2DMethod(u32 method, u32 arg)
+{
+    u32 subchannel = RSX_SUBCHANNEL(method);
+
+    method &= 0x1fff;
+    if (subchannel == RSX_SUBCHANNEL_SURFACE2D) {
+        switch (method) {
+        case SURFACE2D_SET_CONTEXT_DMA_IMAGE_DESTIN:
+            surface.dma_destin = arg;
+            break;
+        case SURFACE2D_SET_COLOR_FORMAT:
+            surface.format = arg;
+            break;
+        case SURFACE2D_SET_PITCH:
+            /* Source pitch in the low half, destination in the high one */
+            surface.pitch = arg >> 16;
+            break;
+        case SURFACE2D_SET_OFFSET_DESTIN:
+            surface.offset = arg;
+            break;
+        default:
+            break;
+        }
+        return;
+    }
+
+    switch (method) {
+    case SIFM_SET_CONTEXT_DMA_IMAGE:
+        sifm.dma = arg;
+        break;
+    case SIFM_SET_COLOR_FORMAT:
+        sifm.format = arg;
+        break;
+    case SIFM_SET_OPERATION:
+        sifm.operation = arg;
+        break;
+    case SIFM_CLIP_POINT:
+        sifm.clip_point = arg;
+        break;
+    case SIFM_CLIP_SIZE:
+        sifm.clip_size = arg;
+        break;
+    case SIFM_IMAGE_OUT_POINT:
+        sifm.out_point = arg;
+        break;
+    case SIFM_IMAGE_OUT_SIZE:
+        sifm.out_size = arg;
+        break;
+    case SIFM_DS_DX:
+        sifm.dsdx = arg;
+        break;
+    case SIFM_DT_DY:
+        sifm.dtdy = arg;
+        break;
+    case SIFM_IMAGE_IN_SIZE:
+        sifm.in_size = arg;
+        break;
+    case SIFM_IMAGE_IN_FORMAT:
+        sifm.in_format = arg;
+        break;
+    case SIFM_IMAGE_IN_OFFSET:
+        sifm.in_offset = arg;
+        break;
+    case SIFM_IMAGE_IN:
+        psl1ghtHostScaledImage(arg);
+        break;
+    default:
+        /* Context objects and conversion are fixed in the stand-in */
+        break;
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,330 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for libaudio.
+ *
+ * A single clock thread plays the part of the audio hardware: every
+ * AUDIO_BLOCK_SAMPLES frames at 48kHz it moves the read index of each
+ * running port to the next block and posts one event to every notify
+ * queue, which is what the console does as well.
+ */
+
+#include <errno.h>
+
+#include <audio/audio.h>
+
+#include "psl1ghthost_c.h"
+
+#define HOST_AUDIO_RATE         48000
+#define HOST_AUDIO_PORTS        8
+#define HOST_AUDIO_NOTIFY_MAX   4
+#define HOST_AUDIO_KEY_BASE     0x0000000041554400ULL
+
+typedef struct
+{
+    int used;
+    int running;
+    u32 channels;
+    u32 blocks;
+    u32 size;
+    u64 *read_index;
+    float *data;
+} HostAudioPort;
+
+static pthread_mutex_t audio_lock = PTHREAD_MUTEX_INITIALIZER;
+static int audio_initialized;
+static int audio_quit;
+static pthread_t audio_thread;
+static HostAudioPort ports[HOST_AUDIO_PORTS];
+static sys_ipc_key_t notify_keys[HOST_AUDIO_NOTIFY_MAX];
+static u64 next_key;
+
+static void *
+psl1ghtHostAudioThread(void *unused)
+{
+    u64 start = psl1ghtHostTime();
+    u64 tick = 0;
+    sys_ipc_key_t keys[HOST_AUDIO_NOTIFY_MAX];
+    int i, running;
+
+    for (;;) {
+        ++tick;
+        psl1ghtHostSleepUntil(start +
+                              tick * AUDIO_BLOCK_SAMPLES * 1000000ULL /
+                              HOST_AUDIO_RATE);
+
+        pthread_mutex_lock(&audio_lock);
+        if (audio_quit) {
+            pthread_mutex_unlock(&audio_lock);
+            break;
+        }
+        running = 0;
+        for (i = 0; i < HOST_AUDIO_PORTS; ++i) {
+            if (ports[i].used && ports[i].running) {
+                *ports[i].read_index =
+                    (*ports[i].read_index + 1) % ports[i].blocks;
+                ++running;
+            }
+        }
+        for (i = 0; i < HOST_AUDIO_NOTIFY_MAX; ++i) {
+            keys[i] = notify_keys[i];
+        }
+        pthread_mutex_unlock(&audio_lock);
+
+        if (running) {
+            pthread_mutex_lock(&psl1ghtHostStatsLock);
+            psl1ghtHostCounters.audio_blocks += running;
+            pthread_mutex_unlock(&psl1ghtHostStatsLock);
+            for (i = 0; i < HOST_AUDIO_NOTIFY_MAX; ++i) {
+                if (keys[i]) {
+                    psl1ghtHostSendEvent(keys[i], 0, 0, 0, 0);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+s32
+audioInit(void)
+{
+    pthread_mutex_lock(&audio_lock);
+    if (!audio_initialized) {
+        audio_quit = 0;
+        if (pthread_create(&audio_thread, NULL, psl1ghtHostAudioThread,
+                           NULL) != 0) {
+            pthread_mutex_unlock(&audio_lock);
+            return EAGAIN;
+        }
+        audio_initialized = 1;
+    }
+    pthread_mutex_unlock(&audio_lock);
+    return 0;
+}
+
+s32
+audioQuit(void)
+{
+    int i;
+
+    pthread_mutex_lock(&audio_lock);
+    if (!audio_initialized) {
+        pthread_mutex_unlock(&audio_lock);
+        return 0;
+    }
+    audio_quit = 1;
+    pthread_mutex_unlock(&audio_lock);
+    pthread_join(audio_thread, NULL);
+
+    pthread_mutex_lock(&audio_lock);
+    for (i = 0; i < HOST_AUDIO_PORTS; ++i) {
+        if (ports[i].used) {
+            psl1ghtHostFreeLow(ports[i].read_index, sizeof(u64));
+            psl1ghtHostFreeLow(ports[i].data, ports[i].size);
+            ports[i].used = 0;
+        }
+    }
+    for (i = 0; i < HOST_AUDIO_NOTIFY_MAX; ++i) {
+        notify_keys[i] = 0;
+    }
+    audio_initialized = 0;
+    pthread_mutex_unlock(&audio_lock);
+    return 0;
+}
+
+s32
+audioPortOpen(AudioPortParam * param, u32 * portNum)
+{
+    HostAudioPort *port;
+    int i;
+
+    if (param->numChannels != AUDIO_PORT_2CH &&
+        param->numChannels != AUDIO_PORT_8CH) {
+        return EINVAL;
+    }
+    if (param->numBlocks != AUDIO_BLOCK_8 &&
+        param->numBlocks != AUDIO_BLOCK_16 &&
+        param->numBlocks != AUDIO_BLOCK_32) {
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&audio_lock);
+    if (!audio_initialized) {
+        pthread_mutex_unlock(&audio_lock);
+        return EPERM;
+    }
+    for (i = 0; i < HOST_AUDIO_PORTS; ++i) {
+        if (!ports[i].used) {
+            break;
+        }
+    }
+    if (i == HOST_AUDIO_PORTS) {
+        pthread_mutex_unlock(&audio_lock);
+        return EBUSY;
+    }
+    port = &ports[i];
+    port->channels = (u32) param->numChannels;
+    port->blocks = (u32) param->numBlocks;
+    port->size = port->channels * port->blocks * AUDIO_BLOCK_SAMPLES *
+        sizeof(float);
+    port->read_index = (u64 *) psl1ghtHostAllocLow(sizeof(u64));
+    port->data = (float *) psl1ghtHostAllocLow(port->size);
+    if (!port->read_index || !port->data) {
+        psl1ghtHostFreeLow(port->read_index, sizeof(u64));
+        psl1ghtHostFreeLow(port->data, port->size);
+        pthread_mutex_unlock(&audio_lock);
+        return ENOMEM;
+    }
+    port->running = 0;
+    port->used = 1;
+    pthread_mutex_unlock(&audio_lock);
+
+    *portNum = (u32) i;
+    return 0;
+}
+
+static HostAudioPort *
+psl1ghtHostGetPort(u32 portNum)
+{
+    if (portNum >= HOST_AUDIO_PORTS || !ports[portNum].used) {
+        return NULL;
+    }
+    return &ports[portNum];
+}
+
+static s32
+psl1ghtHostSetPortRunning(u32 portNum, int running)
+{
+    HostAudioPort *port;
+
+    pthread_mutex_lock(&audio_lock);
+    port = psl1ghtHostGetPort(portNum);
+    if (!port) {
+        pthread_mutex_unlock(&audio_lock);
+        return EINVAL;
+    }
+    port->running = running;
+    pthread_mutex_unlock(&audio_lock);
+    return 0;
+}
+
+s32
+audioPortStart(u32 portNum)
+{
+    return psl1ghtHostSetPortRunning(portNum, 1);
+}
+
+s32
+audioPortStop(u32 portNum)
+{
+    return psl1ghtHostSetPortRunning(portNum, 0);
+}
+
+s32
+audioPortClose(u32 portNum)
+{
+    HostAudioPort *port;
+
+    pthread_mutex_lock(&audio_lock);
+    port = psl1ghtHostGetPort(portNum);
+    if (!port) {
+        pthread_mutex_unlock(&audio_lock);
+        return EINVAL;
+    }
+    psl1ghtHostFreeLow(port->read_index, sizeof(u64));
+    psl1ghtHostFreeLow(port->data, port->size);
+    port->read_index = NULL;
+    port->data = NULL;
+    port->used = 0;
+    pthread_mutex_unlock(&audio_lock);
+    return 0;
+}
+
+s32
+audioGetPortConfig(u32 portNum, AudioPortConfig * config)
+{
+    HostAudioPort *port;
+
+    pthread_mutex_lock(&audio_lock);
+    port = psl1ghtHostGetPort(portNum);
+    if (!port) {
+        pthread_mutex_unlock(&audio_lock);
+        return EINVAL;
+    }
+    config->readIndex = (u32) (size_t) port->read_index;
+    config->status = port->running ? AUDIO_STATUS_RUN : AUDIO_STATUS_READY;
+    config->channelCount = port->channels;
+    config->numBlocks = port->blocks;
+    config->portSize = port->size;
+    config->audioDataStart = (u32) (size_t) port->data;
+    pthread_mutex_unlock(&audio_lock);
+    return 0;
+}
+
+s32
+audioCreateNotifyEventQueue(sys_event_queue_t * queue, sys_ipc_key_t * key)
+{
+    s32 result;
+
+    pthread_mutex_lock(&audio_lock);
+    *key = HOST_AUDIO_KEY_BASE + (++next_key);
+    pthread_mutex_unlock(&audio_lock);
+
+    result = sys_event_queue_create(queue, NULL, *key, 32);
+    return result;
+}
+
+s32
+audioSetNotifyEventQueue(sys_ipc_key_t key)
+{
+    int i;
+
+    pthread_mutex_lock(&audio_lock);
+    for (i = 0; i < HOST_AUDIO_NOTIFY_MAX; ++i) {
+        if (!notify_keys[i]) {
+            notify_keys[i] = key;
+            pthread_mutex_unlock(&audio_lock);
+            return 0;
+        }
+    }
+    pthread_mutex_unlock(&audio_lock);
+    return EBUSY;
+}
+
+s32
+audioRemoveNotifyEventQueue(sys_ipc_key_t key)
+{
+    int i;
+
+    pthread_mutex_lock(&audio_lock);
+    for (i = 0; i < HOST_AUDIO_NOTIFY_MAX; ++i) {
+        if (notify_keys[i] == key) {
+            notify_keys[i] = 0;
+            pthread_mutex_unlock(&audio_lock);
+            return 0;
+        }
+    }
+    pthread_mutex_unlock(&audio_lock);
+    return EINVAL;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
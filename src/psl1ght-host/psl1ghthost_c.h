@@ -0,0 +1,94 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Internal definitions shared by the host PSL1GHT stand-in.
+ *
+ * The stand-in sits underneath SDL's own thread and timer layers, so it
+ * only uses libc and pthreads, never SDL functions.
+ */
+
+#ifndef _psl1ghthost_c_h
+#define _psl1ghthost_c_h
+
+#include <pthread.h>
+
+#include <psl1ght/types.h>
+#include <psl1ght/host.h>
+#include <sys/event_queue.h>
+
+/* Command header layout, same as the NV40 FIFO: count in bits 18-28 */
+#define RSX_METHOD(method, count)   (((u32)(count) << 18) | (u32)(method))
+#define RSX_METHOD_COUNT(header)    (((header) >> 18) & 0x7ff)
+#define RSX_METHOD_ID(header)       ((header) & 0x1fffc)
+
+#define RSX_METHOD_NOP          0x0100
+/* Host only: queue buffer args[0] for scan-out at the next vblank */
+#define RSX_METHOD_FLIP         0xfe00
+/* Host only: stall the command stream until no flip is pending */
+#define RSX_METHOD_WAIT_FLIP    0xfe04
+
+/* Subchannel 0 channel method: publish args[0] in the ref register */
+#define RSX_METHOD_SET_REFERENCE    0x0050
+
+/* 2D objects, bound to the same subchannels as libgcm binds them */
+#define RSX_SUBCHANNEL(method)      (((method) >> 13) & 7)
+#define RSX_SUBCHANNEL_SURFACE2D    3
+#define RSX_SUBCHANNEL_SCALEDIMAGE  6
+
+/* DMA contexts for local (video) and IO mapped main memory */
+#define RSX_DMA_MEMORY_LOCAL    0xfeed0000
+#define RSX_DMA_MEMORY_MAIN     0xfeed0001
+
+/* Host address of size bytes at offset in the given DMA context, or NULL
+   when the range is outside of it */
+extern void *psl1ghtHostRSXAddress(u32 dma, u32 offset, u32 size);
+
+/* Execute a method of the surface 2D or scaled image object */
+extern void psl1ghtHost2DMethod(u32 method, u32 arg);
+
+/* Monotonic clock in microseconds and an absolute sleep on it */
+extern u64 psl1ghtHostTime(void);
+extern void psl1ghtHostSleepUntil(u64 usec);
+
+/* Integer from the environment, or def when unset or malformed */
+extern int psl1ghtHostGetEnv(const char *name, int def);
+
+/* Zeroed memory whose address fits in 32 bits, for SDK structures that
+   carry effective addresses as u32 */
+extern void *psl1ghtHostAllocLow(size_t size);
+extern void psl1ghtHostFreeLow(void *ptr, size_t size);
+
+/* Post an event to the queue created with the given key */
+extern s32 psl1ghtHostSendEvent(sys_ipc_key_t key, u64 source, u64 data_1,
+                                u64 data_2, u64 data_3);
+
+/* Length of one simulated frame, from PSL1GHT_HOST_VBLANK_HZ */
+extern u64 psl1ghtHostFramePeriod(void);
+
+/* Counters updated by the audio and pad emulation, read by
+   psl1ghtHostGetStats() */
+extern pthread_mutex_t psl1ghtHostStatsLock;
+extern psl1ghtHostStats psl1ghtHostCounters;
+
+#endif /* _psl1ghthost_c_h */
+
+/* vi: set ts=4 sw=4 expandtab: */
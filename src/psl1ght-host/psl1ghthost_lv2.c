@@ -0,0 +1,555 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the lv2 kernel: PPU threads, semaphores, event queues */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <psl1ght/lv2/thread.h>
+#include <sys/thread.h>
+#include <sys/event_queue.h>
+
+#include "psl1ghthost_c.h"
+
+/* PPU threads are given 16K stacks; x86-64 frames and glibc need more */
+#define HOST_MIN_STACK_SIZE (256 * 1024)
+
+#define HOST_MAX_SEMAPHORES     256
+#define HOST_MAX_EVENT_QUEUES   32
+#define HOST_EVENT_QUEUE_DEPTH  127
+
+pthread_mutex_t psl1ghtHostStatsLock = PTHREAD_MUTEX_INITIALIZER;
+psl1ghtHostStats psl1ghtHostCounters;
+
+u64
+psl1ghtHostTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+void
+psl1ghtHostSleepUntil(u64 usec)
+{
+    struct timespec when;
+    when.tv_sec = usec / 1000000;
+    when.tv_nsec = (usec % 1000000) * 1000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, NULL) ==
+           EINTR) {
+    }
+}
+
+int
+psl1ghtHostGetEnv(const char *name, int def)
+{
+    const char *value = getenv(name);
+    char *end;
+    long result;
+
+    if (!value || !*value) {
+        return def;
+    }
+    result = strtol(value, &end, 10);
+    if (*end != '\0') {
+        return def;
+    }
+    return (int) result;
+}
+
+u64
+psl1ghtHostFramePeriod(void)
+{
+    static u64 period;
+    if (!period) {
+        int hz = psl1ghtHostGetEnv("PSL1GHT_HOST_VBLANK_HZ", 60);
+        if (hz <= 0) {
+            hz = 60;
+        }
+        period = 1000000 / hz;
+    }
+    return period;
+}
+
+void *
+psl1ghtHostAllocLow(size_t size)
+{
+    void *ptr;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_32BIT
+    flags |= MAP_32BIT;
+    ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+#else
+    /* No MAP_32BIT here, hint the kernel towards the low 4GB */
+    ptr = mmap((void *) 0x10000000, size, PROT_READ | PROT_WRITE, flags,
+               -1, 0);
+#endif
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+    if ((u64) (size_t) ptr + size > 0xFFFFFFFFULL) {
+        munmap(ptr, size);
+        return NULL;
+    }
+    return ptr;
+}
+
+void
+psl1ghtHostFreeLow(void *ptr, size_t size)
+{
+    if (ptr) {
+        munmap(ptr, size);
+    }
+}
+
+static void
+psl1ghtHostDeadline(struct timespec *when, u64 timeout)
+{
+    u64 usec = psl1ghtHostTime() + timeout;
+    when->tv_sec = usec / 1000000;
+    when->tv_nsec = (usec % 1000000) * 1000;
+}
+
+static void
+psl1ghtHostInitCond(pthread_cond_t * cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/* PPU threads */
+
+typedef struct
+{
+    void (*entry) (u64 arg);
+    u64 arg;
+} HostThreadStart;
+
+static void *
+psl1ghtHostThreadMain(void *data)
+{
+    HostThreadStart start = *(HostThreadStart *) data;
+    free(data);
+    start.entry(start.arg);
+    return NULL;
+}
+
+s32
+sys_ppu_thread_create(sys_ppu_thread_t * threadid, void (*entry) (u64 arg),
+                      u64 arg, s32 priority, u64 stacksize, u64 flags,
+                      const char *threadname)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+    HostThreadStart *start;
+    int result;
+
+    /* The lv2 priority has no meaning for the host scheduler */
+    (void) priority;
+    (void) threadname;
+
+    start = (HostThreadStart *) malloc(sizeof(*start));
+    if (!start) {
+        return ENOMEM;
+    }
+    start->entry = entry;
+    start->arg = arg;
+
+    if (stacksize < HOST_MIN_STACK_SIZE) {
+        stacksize = HOST_MIN_STACK_SIZE;
+    }
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, (size_t) stacksize);
+    if (!(flags & THREAD_JOINABLE)) {
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    }
+    result = pthread_create(&thread, &attr, psl1ghtHostThreadMain, start);
+    pthread_attr_destroy(&attr);
+    if (result != 0) {
+        free(start);
+        return EAGAIN;
+    }
+    *threadid = (sys_ppu_thread_t) thread;
+    return 0;
+}
+
+void
+sys_ppu_thread_exit(u64 val)
+{
+    pthread_exit((void *) (size_t) val);
+}
+
+s32
+sys_ppu_thread_join(sys_ppu_thread_t threadid, u64 * retval)
+{
+    void *result;
+    if (pthread_join((pthread_t) threadid, &result) != 0) {
+        return ESRCH;
+    }
+    if (retval) {
+        *retval = (u64) (size_t) result;
+    }
+    return 0;
+}
+
+s32
+sys_ppu_thread_get_id(sys_ppu_thread_t * threadid)
+{
+    *threadid = (sys_ppu_thread_t) pthread_self();
+    return 0;
+}
+
+s32
+sys_ppu_thread_yield(void)
+{
+    sched_yield();
+    return 0;
+}
+
+/* Semaphores, identified by their slot index plus one */
+
+typedef struct
+{
+    int used;
+    s32 count;
+    s32 max;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} HostSemaphore;
+
+static pthread_mutex_t semaphores_lock = PTHREAD_MUTEX_INITIALIZER;
+static HostSemaphore semaphores[HOST_MAX_SEMAPHORES];
+
+static HostSemaphore *
+psl1ghtHostGetSemaphore(sys_semaphore_t sem)
+{
+    if (sem == 0 || sem > HOST_MAX_SEMAPHORES || !semaphores[sem - 1].used) {
+        return NULL;
+    }
+    return &semaphores[sem - 1];
+}
+
+s32
+sys_semaphore_create(sys_semaphore_t * sem, sys_semaphore_attribute_t * attr,
+                     s32 initial_val, s32 max_val)
+{
+    int i;
+
+    (void) attr;
+    pthread_mutex_lock(&semaphores_lock);
+    for (i = 0; i < HOST_MAX_SEMAPHORES; ++i) {
+        if (!semaphores[i].used) {
+            break;
+        }
+    }
+    if (i == HOST_MAX_SEMAPHORES) {
+        pthread_mutex_unlock(&semaphores_lock);
+        return EAGAIN;
+    }
+    semaphores[i].used = 1;
+    semaphores[i].count = initial_val;
+    /* Recorded for sys_semaphore_get_value() callers, not enforced */
+    semaphores[i].max = max_val;
+    pthread_mutex_init(&semaphores[i].lock, NULL);
+    psl1ghtHostInitCond(&semaphores[i].cond);
+    pthread_mutex_unlock(&semaphores_lock);
+
+    *sem = i + 1;
+    return 0;
+}
+
+s32
+sys_semaphore_destroy(sys_semaphore_t sem)
+{
+    HostSemaphore *s;
+
+    pthread_mutex_lock(&semaphores_lock);
+    s = psl1ghtHostGetSemaphore(sem);
+    if (!s) {
+        pthread_mutex_unlock(&semaphores_lock);
+        return ESRCH;
+    }
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->cond);
+    s->used = 0;
+    pthread_mutex_unlock(&semaphores_lock);
+    return 0;
+}
+
+s32
+sys_semaphore_wait(sys_semaphore_t sem, u64 timeout)
+{
+    HostSemaphore *s = psl1ghtHostGetSemaphore(sem);
+    struct timespec deadline;
+    int result = 0;
+
+    if (!s) {
+        return ESRCH;
+    }
+    if (timeout) {
+        psl1ghtHostDeadline(&deadline, timeout);
+    }
+    pthread_mutex_lock(&s->lock);
+    while (s->count <= 0 && result == 0) {
+        if (timeout) {
+            result = pthread_cond_timedwait(&s->cond, &s->lock, &deadline);
+        } else {
+            result = pthread_cond_wait(&s->cond, &s->lock);
+        }
+    }
+    if (s->count > 0) {
+        --s->count;
+        result = 0;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return result ? ETIMEDOUT : 0;
+}
+
+s32
+sys_semaphore_trywait(sys_semaphore_t sem)
+{
+    HostSemaphore *s = psl1ghtHostGetSemaphore(sem);
+    s32 result = EBUSY;
+
+    if (!s) {
+        return ESRCH;
+    }
+    pthread_mutex_lock(&s->lock);
+    if (s->count > 0) {
+        --s->count;
+        result = 0;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return result;
+}
+
+s32
+sys_semaphore_post(sys_semaphore_t sem, s32 val)
+{
+    HostSemaphore *s = psl1ghtHostGetSemaphore(sem);
+
+    if (!s) {
+        return ESRCH;
+    }
+    if (val <= 0) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&s->lock);
+    s->count += val;
+    if (val == 1) {
+        pthread_cond_signal(&s->cond);
+    } else {
+        pthread_cond_broadcast(&s->cond);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+s32
+sys_semaphore_get_value(sys_semaphore_t sem, s32 * val)
+{
+    HostSemaphore *s = psl1ghtHostGetSemaphore(sem);
+
+    if (!s) {
+        return ESRCH;
+    }
+    pthread_mutex_lock(&s->lock);
+    *val = s->count;
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+/* Event queues, identified by their slot index plus one */
+
+typedef struct
+{
+    int used;
+    sys_ipc_key_t key;
+    int head;
+    int count;
+    sys_event_t events[HOST_EVENT_QUEUE_DEPTH];
+    pthread_cond_t cond;
+} HostEventQueue;
+
+static pthread_mutex_t queues_lock = PTHREAD_MUTEX_INITIALIZER;
+static HostEventQueue queues[HOST_MAX_EVENT_QUEUES];
+
+static HostEventQueue *
+psl1ghtHostGetQueue(sys_event_queue_t queue)
+{
+    if (queue == 0 || queue > HOST_MAX_EVENT_QUEUES || !queues[queue - 1].used) {
+        return NULL;
+    }
+    return &queues[queue - 1];
+}
+
+s32
+sys_event_queue_create(sys_event_queue_t * queue,
+                       sys_event_queue_attr_t * attr, sys_ipc_key_t key,
+                       s32 size)
+{
+    int i;
+
+    (void) attr;
+    (void) size;
+    pthread_mutex_lock(&queues_lock);
+    for (i = 0; i < HOST_MAX_EVENT_QUEUES; ++i) {
+        if (!queues[i].used) {
+            break;
+        }
+    }
+    if (i == HOST_MAX_EVENT_QUEUES) {
+        pthread_mutex_unlock(&queues_lock);
+        return EAGAIN;
+    }
+    queues[i].used = 1;
+    queues[i].key = key;
+    queues[i].head = 0;
+    queues[i].count = 0;
+    psl1ghtHostInitCond(&queues[i].cond);
+    pthread_mutex_unlock(&queues_lock);
+
+    *queue = i + 1;
+    return 0;
+}
+
+s32
+sys_event_queue_destroy(sys_event_queue_t queue, s32 mode)
+{
+    HostEventQueue *q;
+
+    (void) mode;
+    pthread_mutex_lock(&queues_lock);
+    q = psl1ghtHostGetQueue(queue);
+    if (!q) {
+        pthread_mutex_unlock(&queues_lock);
+        return ESRCH;
+    }
+    q->used = 0;
+    q->key = 0;
+    /* Receivers notice the queue is gone and return ECANCELED */
+    pthread_cond_broadcast(&q->cond);
+    pthread_mutex_unlock(&queues_lock);
+    return 0;
+}
+
+s32
+sys_event_queue_receive(sys_event_queue_t queue, sys_event_t * event,
+                        u64 timeout)
+{
+    HostEventQueue *q;
+    struct timespec deadline;
+    int result = 0;
+
+    if (timeout) {
+        psl1ghtHostDeadline(&deadline, timeout);
+    }
+    pthread_mutex_lock(&queues_lock);
+    q = psl1ghtHostGetQueue(queue);
+    if (!q) {
+        pthread_mutex_unlock(&queues_lock);
+        return ESRCH;
+    }
+    while (q->used && q->count == 0 && result == 0) {
+        if (timeout) {
+            result = pthread_cond_timedwait(&q->cond, &queues_lock, &deadline);
+        } else {
+            result = pthread_cond_wait(&q->cond, &queues_lock);
+        }
+    }
+    if (!q->used) {
+        pthread_mutex_unlock(&queues_lock);
+        return ECANCELED;
+    }
+    if (q->count == 0) {
+        pthread_mutex_unlock(&queues_lock);
+        return ETIMEDOUT;
+    }
+    *event = q->events[q->head];
+    q->head = (q->head + 1) % HOST_EVENT_QUEUE_DEPTH;
+    --q->count;
+    pthread_mutex_unlock(&queues_lock);
+    return 0;
+}
+
+s32
+sys_event_queue_drain(sys_event_queue_t queue)
+{
+    HostEventQueue *q;
+
+    pthread_mutex_lock(&queues_lock);
+    q = psl1ghtHostGetQueue(queue);
+    if (!q) {
+        pthread_mutex_unlock(&queues_lock);
+        return ESRCH;
+    }
+    q->head = 0;
+    q->count = 0;
+    pthread_mutex_unlock(&queues_lock);
+    return 0;
+}
+
+s32
+psl1ghtHostSendEvent(sys_ipc_key_t key, u64 source, u64 data_1, u64 data_2,
+                     u64 data_3)
+{
+    HostEventQueue *q = NULL;
+    sys_event_t *event;
+    int i;
+
+    pthread_mutex_lock(&queues_lock);
+    for (i = 0; i < HOST_MAX_EVENT_QUEUES; ++i) {
+        if (queues[i].used && queues[i].key == key) {
+            q = &queues[i];
+            break;
+        }
+    }
+    if (!q) {
+        pthread_mutex_unlock(&queues_lock);
+        return ESRCH;
+    }
+    if (q->count == HOST_EVENT_QUEUE_DEPTH) {
+        /* lv2 drops events sent to a full queue */
+        pthread_mutex_unlock(&queues_lock);
+        return EBUSY;
+    }
+    event = &q->events[(q->head + q->count) % HOST_EVENT_QUEUE_DEPTH];
+    event->source = source;
+    event->data_1 = data_1;
+    event->data_2 = data_2;
+    event->data_3 = data_3;
+    ++q->count;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&queues_lock);
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,212 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for libio pads: state is set through psl1ght/host.h */
+
+#include <errno.h>
+#include <string.h>
+
+#include <io/pad.h>
+
+#include "psl1ghthost_c.h"
+
+/* Number of halfwords a DualShock 3 reports */
+#define HOST_PAD_DATA_LEN   24
+
+static pthread_mutex_t pad_lock = PTHREAD_MUTEX_INITIALIZER;
+static int pad_initialized;
+static u32 pad_max;
+static u32 pad_connected;
+static int pad_connected_set;
+static int pad_state_ready;
+static PadData pad_state[MAX_PADS];
+static u8 pad_changed[MAX_PADS];
+static u8 pad_press_mode[MAX_PADS];
+static u8 pad_sensor_mode[MAX_PADS];
+
+/* Called with pad_lock held: every pad starts centred and released */
+static void
+psl1ghtHostInitPads(void)
+{
+    PadData *data;
+    u32 i;
+
+    if (pad_state_ready) {
+        return;
+    }
+    for (i = 0; i < MAX_PADS; ++i) {
+        data = &pad_state[i];
+        memset(data, 0, sizeof(*data));
+        data->seven = 7;
+        data->halflen = HOST_PAD_DATA_LEN / 2;
+        data->ANA_R_H = data->ANA_R_V = 0x80;
+        data->ANA_L_H = data->ANA_L_V = 0x80;
+        data->SENSOR_X = data->SENSOR_Y = data->SENSOR_Z = 512;
+        data->SENSOR_G = 512;
+        pad_changed[i] = 1;
+    }
+    pad_state_ready = 1;
+}
+
+s32
+ioPadInit(u32 max)
+{
+    int count;
+
+    if (max == 0 || max > MAX_PADS) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&pad_lock);
+    if (!pad_connected_set) {
+        count = psl1ghtHostGetEnv("PSL1GHT_HOST_PADS", 1);
+        if (count < 0) {
+            count = 0;
+        }
+        pad_connected = (u32) count;
+        pad_connected_set = 1;
+    }
+    psl1ghtHostInitPads();
+    pad_max = max;
+    if (pad_connected > pad_max) {
+        pad_connected = pad_max;
+    }
+    pad_initialized = 1;
+    pthread_mutex_unlock(&pad_lock);
+    return 0;
+}
+
+s32
+ioPadEnd(void)
+{
+    pthread_mutex_lock(&pad_lock);
+    pad_initialized = 0;
+    pthread_mutex_unlock(&pad_lock);
+    return 0;
+}
+
+s32
+ioPadGetInfo(PadInfo * info)
+{
+    u32 i;
+
+    pthread_mutex_lock(&pad_lock);
+    if (!pad_initialized) {
+        pthread_mutex_unlock(&pad_lock);
+        return EPERM;
+    }
+    memset(info, 0, sizeof(*info));
+    info->max = pad_max;
+    info->connected = pad_connected;
+    for (i = 0; i < pad_connected; ++i) {
+        info->vendor_id[i] = 0x054C;
+        info->product_id[i] = 0x0268;
+        info->status[i] = 1;
+    }
+    pthread_mutex_unlock(&pad_lock);
+    return 0;
+}
+
+s32
+ioPadGetData(u32 port, PadData * data)
+{
+    pthread_mutex_lock(&pad_lock);
+    if (!pad_initialized || port >= pad_connected) {
+        pthread_mutex_unlock(&pad_lock);
+        return EINVAL;
+    }
+    if (pad_changed[port]) {
+        *data = pad_state[port];
+        data->len = HOST_PAD_DATA_LEN;
+        if (!pad_press_mode[port]) {
+            memset(&data->PRE_RIGHT, 0, 12 * sizeof(u16));
+        }
+        if (!pad_sensor_mode[port]) {
+            data->SENSOR_X = data->SENSOR_Y = data->SENSOR_Z = 512;
+            data->SENSOR_G = 512;
+        }
+        pad_changed[port] = 0;
+    } else {
+        data->len = 0;
+    }
+    pthread_mutex_unlock(&pad_lock);
+
+    pthread_mutex_lock(&psl1ghtHostStatsLock);
+    ++psl1ghtHostCounters.pad_reads;
+    pthread_mutex_unlock(&psl1ghtHostStatsLock);
+    return 0;
+}
+
+static s32
+psl1ghtHostSetPadMode(u8 * modes, u32 port, u32 mode)
+{
+    pthread_mutex_lock(&pad_lock);
+    if (!pad_initialized || port >= pad_connected) {
+        pthread_mutex_unlock(&pad_lock);
+        return EINVAL;
+    }
+    modes[port] = (mode != 0);
+    pad_changed[port] = 1;
+    pthread_mutex_unlock(&pad_lock);
+    return 0;
+}
+
+s32
+ioPadSetPressMode(u32 port, u32 mode)
+{
+    return psl1ghtHostSetPadMode(pad_press_mode, port, mode);
+}
+
+s32
+ioPadSetSensorMode(u32 port, u32 mode)
+{
+    return psl1ghtHostSetPadMode(pad_sensor_mode, port, mode);
+}
+
+void
+psl1ghtHostSetPadCount(u32 count)
+{
+    pthread_mutex_lock(&pad_lock);
+    if (count > MAX_PADS) {
+        count = MAX_PADS;
+    }
+    if (pad_initialized && count > pad_max) {
+        count = pad_max;
+    }
+    pad_connected = count;
+    pad_connected_set = 1;
+    pthread_mutex_unlock(&pad_lock);
+}
+
+void
+psl1ghtHostSetPadData(u32 port, const PadData * data)
+{
+    if (port >= MAX_PADS) {
+        return;
+    }
+    pthread_mutex_lock(&pad_lock);
+    psl1ghtHostInitPads();
+    pad_state[port] = *data;
+    pad_changed[port] = 1;
+    pthread_mutex_unlock(&pad_lock);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,561 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for the RSX: local memory, command buffer and scan-out.
+ *
+ * The command buffer is consumed by an "RSX" thread, which executes
+ * every command instantly except the flip ones: flips are latched and
+ * only take effect on the next tick of a simulated vblank thread, so
+ * gcmGetFlipStatus() and friends behave like on a real 60 Hz display.
+ * The 2D objects are executed by psl1ghthost_2d.c.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <rsx/gcm.h>
+#include <rsx/reality.h>
+
+#include "psl1ghthost_c.h"
+
+typedef struct HostRSXBlock
+{
+    u32 offset;
+    u32 size;
+    struct HostRSXBlock *next;
+} HostRSXBlock;
+
+typedef struct
+{
+    u32 offset;
+    u32 pitch;
+    u32 width;
+    u32 height;
+} HostDisplayBuffer;
+
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        /* put, get or flip state changed */
+    int initialized;
+
+    gcmContextData context;
+    gcmControlRegister control;
+    u32 *get;                   /* next word the RSX will read */
+    u32 *put;                   /* end of the flushed commands */
+
+    u8 *local;
+    u32 local_size;
+    u8 *io;
+    u32 io_size;
+    HostRSXBlock *blocks;       /* allocated local memory, by offset */
+
+    HostDisplayBuffer display[GCM_MAX_DISPLAY_BUFFERS];
+    s32 displayed;
+    s32 pending;
+    u64 pending_time;
+    u32 flip_status;
+    s32 flip_mode;
+    void (*flip_handler) (const u32 head);
+    void (*vblank_handler) (const u32 head);
+
+    pthread_t rsx_thread;
+    pthread_t vblank_thread;
+} rsx = {
+PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static pthread_mutex_t alloc_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Called with rsx.lock held; returns with it held */
+static void
+psl1ghtHostPresent(s32 bufferId, u64 now)
+{
+    void (*handler) (const u32 head);
+
+    rsx.displayed = bufferId;
+    rsx.flip_status = 0;
+    rsx.pending = -1;
+    pthread_mutex_lock(&psl1ghtHostStatsLock);
+    ++psl1ghtHostCounters.flips;
+    psl1ghtHostCounters.flip_wait_usec += now - rsx.pending_time;
+    pthread_mutex_unlock(&psl1ghtHostStatsLock);
+    pthread_cond_broadcast(&rsx.cond);
+
+    handler = rsx.flip_handler;
+    if (handler) {
+        pthread_mutex_unlock(&rsx.lock);
+        handler(0);
+        pthread_mutex_lock(&rsx.lock);
+    }
+}
+
+static void *
+psl1ghtHostVBlankThread(void *unused)
+{
+    u64 period = psl1ghtHostFramePeriod();
+    u64 next = psl1ghtHostTime() + period;
+    void (*handler) (const u32 head);
+
+    for (;;) {
+        psl1ghtHostSleepUntil(next);
+        next += period;
+
+        pthread_mutex_lock(&rsx.lock);
+        pthread_mutex_lock(&psl1ghtHostStatsLock);
+        ++psl1ghtHostCounters.vblanks;
+        pthread_mutex_unlock(&psl1ghtHostStatsLock);
+        if (rsx.pending >= 0) {
+            psl1ghtHostPresent(rsx.pending, psl1ghtHostTime());
+        }
+        handler = rsx.vblank_handler;
+        pthread_mutex_unlock(&rsx.lock);
+
+        if (handler) {
+            handler(0);
+        }
+    }
+    return NULL;
+}
+
+/* Called with rsx.lock held; returns with it held */
+static void
+psl1ghtHostExecute(u32 method, u32 arg)
+{
+    switch (RSX_SUBCHANNEL(method)) {
+    case RSX_SUBCHANNEL_SURFACE2D:
+    case RSX_SUBCHANNEL_SCALEDIMAGE:
+        psl1ghtHost2DMethod(method, arg);
+        return;
+    default:
+        break;
+    }
+
+    switch (method) {
+    case RSX_METHOD_SET_REFERENCE:
+        /* Everything written so far must be visible to whoever polls */
+        __sync_synchronize();
+        rsx.control.ref = arg;
+        break;
+    case RSX_METHOD_FLIP:
+        rsx.pending = (s32) arg;
+        rsx.pending_time = psl1ghtHostTime();
+        if (rsx.flip_mode == GCM_FLIP_HSYNC) {
+            psl1ghtHostPresent(rsx.pending, rsx.pending_time);
+        }
+        break;
+    case RSX_METHOD_WAIT_FLIP:
+        while (rsx.pending >= 0) {
+            pthread_cond_wait(&rsx.cond, &rsx.lock);
+        }
+        break;
+    default:
+        /* NOP and anything the stand-in does not model */
+        break;
+    }
+}
+
+static void *
+psl1ghtHostRSXThread(void *unused)
+{
+    u32 header, method, count, i;
+    u64 executed;
+
+    pthread_mutex_lock(&rsx.lock);
+    for (;;) {
+        while (rsx.get == rsx.put) {
+            pthread_cond_wait(&rsx.cond, &rsx.lock);
+        }
+        /* Run up to the put pointer, then tell the waiters in one go */
+        executed = 0;
+        while (rsx.get != rsx.put) {
+            /* A header with count n writes n consecutive registers */
+            header = rsx.get[0];
+            method = RSX_METHOD_ID(header);
+            count = RSX_METHOD_COUNT(header);
+            for (i = 0; i < count; ++i) {
+                psl1ghtHostExecute(method + i * 4, rsx.get[1 + i]);
+            }
+            rsx.get += 1 + count;
+            rsx.control.get =
+                (u32) ((u8 *) rsx.get - (u8 *) rsx.context.begin);
+            executed += 1 + count;
+        }
+
+        pthread_mutex_lock(&psl1ghtHostStatsLock);
+        psl1ghtHostCounters.rsx_commands += executed;
+        pthread_mutex_unlock(&psl1ghtHostStatsLock);
+        pthread_cond_broadcast(&rsx.cond);
+    }
+    return NULL;
+}
+
+static void
+psl1ghtHostWaitIdleLocked(void)
+{
+    while (rsx.get != rsx.put) {
+        pthread_cond_wait(&rsx.cond, &rsx.lock);
+    }
+}
+
+/* The command buffer is full: drain it and start again from the top */
+static s32
+psl1ghtHostContextCallback(gcmContextData * context, u32 count)
+{
+    if (context->begin + count > context->end) {
+        return -1;
+    }
+    pthread_mutex_lock(&rsx.lock);
+    rsx.put = context->current;
+    pthread_cond_broadcast(&rsx.cond);
+    psl1ghtHostWaitIdleLocked();
+    rsx.get = rsx.put = context->begin;
+    rsx.control.get = rsx.control.put = 0;
+    context->current = context->begin;
+    pthread_mutex_unlock(&rsx.lock);
+    return 0;
+}
+
+static void
+psl1ghtHostEmit(gcmContextData * context, u32 method, u32 arg)
+{
+    if (context->current + 2 > context->end) {
+        context->callback(context, 2);
+    }
+    *context->current++ = RSX_METHOD(method, 1);
+    *context->current++ = arg;
+}
+
+gcmContextData *
+realityInit(u32 bufferSize, u32 ioSize, void *ioAddress)
+{
+    int local_mb;
+
+    pthread_mutex_lock(&rsx.lock);
+    if (rsx.initialized) {
+        pthread_mutex_unlock(&rsx.lock);
+        return &rsx.context;
+    }
+    if (!ioAddress || bufferSize > ioSize || bufferSize < 64) {
+        pthread_mutex_unlock(&rsx.lock);
+        return NULL;
+    }
+
+    local_mb = psl1ghtHostGetEnv("PSL1GHT_HOST_LOCAL_MB", 256);
+    if (local_mb <= 0 || local_mb > 2048) {
+        local_mb = 256;
+    }
+    rsx.local_size = (u32) local_mb * 1024 * 1024;
+    rsx.local = (u8 *) mmap(NULL, rsx.local_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1,
+                            0);
+    if (rsx.local == (u8 *) MAP_FAILED) {
+        rsx.local = NULL;
+        pthread_mutex_unlock(&rsx.lock);
+        return NULL;
+    }
+    rsx.io = (u8 *) ioAddress;
+    rsx.io_size = ioSize;
+
+    /* The command buffer lives at the start of the IO memory */
+    rsx.context.begin = (u32 *) ioAddress;
+    rsx.context.end = rsx.context.begin + bufferSize / sizeof(u32);
+    rsx.context.current = rsx.context.begin;
+    rsx.context.callback = psl1ghtHostContextCallback;
+    rsx.get = rsx.put = rsx.context.begin;
+
+    rsx.displayed = -1;
+    rsx.pending = -1;
+    rsx.flip_status = 1;
+    rsx.flip_mode = GCM_FLIP_VSYNC;
+
+    pthread_create(&rsx.rsx_thread, NULL, psl1ghtHostRSXThread, NULL);
+    pthread_create(&rsx.vblank_thread, NULL, psl1ghtHostVBlankThread, NULL);
+    rsx.initialized = 1;
+    pthread_mutex_unlock(&rsx.lock);
+    return &rsx.context;
+}
+
+void
+realityFlushBuffer(gcmContextData * context)
+{
+    pthread_mutex_lock(&rsx.lock);
+    rsx.put = context->current;
+    rsx.control.put = (u32) ((u8 *) rsx.put - (u8 *) context->begin);
+    pthread_cond_broadcast(&rsx.cond);
+    pthread_mutex_unlock(&rsx.lock);
+}
+
+void *
+psl1ghtHostRSXAddress(u32 dma, u32 offset, u32 size)
+{
+    switch (dma) {
+    case RSX_DMA_MEMORY_LOCAL:
+        if ((u64) offset + size <= rsx.local_size) {
+            return rsx.local + offset;
+        }
+        break;
+    case RSX_DMA_MEMORY_MAIN:
+        if ((u64) offset + size <= rsx.io_size) {
+            return rsx.io + offset;
+        }
+        break;
+    default:
+        break;
+    }
+    return NULL;
+}
+
+s32
+realityAddressToOffset(void *address, u32 * offset)
+{
+    u8 *ptr = (u8 *) address;
+
+    if (rsx.local && ptr >= rsx.local && ptr < rsx.local + rsx.local_size) {
+        *offset = (u32) (ptr - rsx.local);
+        return 0;
+    }
+    /* Main memory mapped for the RSX uses offsets into the IO region */
+    if (rsx.io && ptr >= rsx.io && ptr < rsx.io + rsx.io_size) {
+        *offset = (u32) (ptr - rsx.io);
+        return 0;
+    }
+    return -1;
+}
+
+void *
+rsxMemAlign(u32 alignment, u32 size)
+{
+    HostRSXBlock *block, *prev, *next;
+    u32 start;
+
+    if (!rsx.local || size == 0) {
+        return NULL;
+    }
+    if (alignment < 16) {
+        alignment = 16;
+    }
+    block = (HostRSXBlock *) malloc(sizeof(*block));
+    if (!block) {
+        return NULL;
+    }
+
+    /* First fit over the gaps between the allocated blocks */
+    pthread_mutex_lock(&alloc_lock);
+    prev = NULL;
+    next = rsx.blocks;
+    start = 0;
+    for (;;) {
+        start = (start + alignment - 1) / alignment * alignment;
+        if (next == NULL) {
+            if ((u64) start + size > rsx.local_size) {
+                pthread_mutex_unlock(&alloc_lock);
+                free(block);
+                return NULL;
+            }
+            break;
+        }
+        if ((u64) start + size <= next->offset) {
+            break;
+        }
+        start = next->offset + next->size;
+        prev = next;
+        next = next->next;
+    }
+    block->offset = start;
+    block->size = size;
+    block->next = next;
+    if (prev) {
+        prev->next = block;
+    } else {
+        rsx.blocks = block;
+    }
+    pthread_mutex_unlock(&alloc_lock);
+
+    return rsx.local + start;
+}
+
+void *
+rsxMalloc(u32 size)
+{
+    return rsxMemAlign(16, size);
+}
+
+void
+rsxFree(void *ptr)
+{
+    HostRSXBlock *block, *prev = NULL;
+    u32 offset;
+
+    if (realityAddressToOffset(ptr, &offset) != 0) {
+        return;
+    }
+    pthread_mutex_lock(&alloc_lock);
+    for (block = rsx.blocks; block; prev = block, block = block->next) {
+        if (block->offset == offset) {
+            if (prev) {
+                prev->next = block->next;
+            } else {
+                rsx.blocks = block->next;
+            }
+            free(block);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&alloc_lock);
+}
+
+s32
+gcmSetFlip(gcmContextData * context, s32 bufferId)
+{
+    if (bufferId < 0 || bufferId >= GCM_MAX_DISPLAY_BUFFERS) {
+        return -1;
+    }
+    psl1ghtHostEmit(context, RSX_METHOD_FLIP, (u32) bufferId);
+    return 0;
+}
+
+void
+gcmSetWaitFlip(gcmContextData * context)
+{
+    psl1ghtHostEmit(context, RSX_METHOD_WAIT_FLIP, 0);
+}
+
+void
+gcmSetFlipMode(s32 mode)
+{
+    pthread_mutex_lock(&rsx.lock);
+    rsx.flip_mode = mode;
+    pthread_mutex_unlock(&rsx.lock);
+}
+
+s32
+gcmSetDisplayBuffer(u32 bufferId, u32 offset, u32 pitch, u32 width,
+                    u32 height)
+{
+    if (bufferId >= GCM_MAX_DISPLAY_BUFFERS) {
+        return -1;
+    }
+    if ((u64) offset + (u64) pitch * height > rsx.local_size) {
+        return -1;
+    }
+    pthread_mutex_lock(&rsx.lock);
+    rsx.display[bufferId].offset = offset;
+    rsx.display[bufferId].pitch = pitch;
+    rsx.display[bufferId].width = width;
+    rsx.display[bufferId].height = height;
+    pthread_mutex_unlock(&rsx.lock);
+    return 0;
+}
+
+u32
+gcmGetFlipStatus(void)
+{
+    u32 status;
+    pthread_mutex_lock(&rsx.lock);
+    status = rsx.flip_status;
+    pthread_mutex_unlock(&rsx.lock);
+    return status;
+}
+
+void
+gcmResetFlipStatus(void)
+{
+    pthread_mutex_lock(&rsx.lock);
+    rsx.flip_status = 1;
+    pthread_mutex_unlock(&rsx.lock);
+}
+
+void
+gcmSetFlipHandler(void (*handler) (const u32 head))
+{
+    pthread_mutex_lock(&rsx.lock);
+    rsx.flip_handler = handler;
+    pthread_mutex_unlock(&rsx.lock);
+}
+
+void
+gcmSetVBlankHandler(void (*handler) (const u32 head))
+{
+    pthread_mutex_lock(&rsx.lock);
+    rsx.vblank_handler = handler;
+    pthread_mutex_unlock(&rsx.lock);
+}
+
+s32
+gcmGetConfiguration(gcmConfiguration * config)
+{
+    if (!rsx.initialized) {
+        return -1;
+    }
+    config->localAddress = rsx.local;
+    config->ioAddress = rsx.io;
+    config->localSize = rsx.local_size;
+    config->ioSize = rsx.io_size;
+    config->memoryFrequency = 650000000;
+    config->coreFrequency = 500000000;
+    return 0;
+}
+
+gcmControlRegister *
+gcmGetControlRegister(void)
+{
+    return &rsx.control;
+}
+
+void
+psl1ghtHostGetStats(psl1ghtHostStats * stats)
+{
+    pthread_mutex_lock(&psl1ghtHostStatsLock);
+    *stats = psl1ghtHostCounters;
+    pthread_mutex_unlock(&psl1ghtHostStatsLock);
+}
+
+s32
+psl1ghtHostGetDisplayBuffer(void **pixels, u32 * pitch, u32 * width,
+                            u32 * height)
+{
+    HostDisplayBuffer *buffer;
+
+    pthread_mutex_lock(&rsx.lock);
+    if (rsx.displayed < 0) {
+        pthread_mutex_unlock(&rsx.lock);
+        return -1;
+    }
+    buffer = &rsx.display[rsx.displayed];
+    *pixels = rsx.local + buffer->offset;
+    *pitch = buffer->pitch;
+    *width = buffer->width;
+    *height = buffer->height;
+    pthread_mutex_unlock(&rsx.lock);
+    return 0;
+}
+
+void
+psl1ghtHostWaitRSXIdle(void)
+{
+    pthread_mutex_lock(&rsx.lock);
+    psl1ghtHostWaitIdleLocked();
+    pthread_mutex_unlock(&rsx.lock);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,367 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for raw SPUs: each one runs its program on a thread */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/spu.h>
+#define PSL1GHT_HOST_SPU_RUNTIME
+#include <spu_mfcio.h>
+
+#include "psl1ghthost_c.h"
+
+#define HOST_SPU_MAX            6
+#define HOST_SPU_IMAGES         16
+#define HOST_SPU_IN_MBOX_DEPTH  4
+
+typedef struct
+{
+    int used;
+    u32 id;
+    const psl1ghtHostSpuProgram *program;
+    int running;                /* the thread is in the program */
+    int started;                /* the thread has to be joined */
+    pthread_t thread;
+    pthread_cond_t cond;        /* mailbox or running state changed */
+    u32 in_mbox[HOST_SPU_IN_MBOX_DEPTH];
+    int in_head;
+    int in_count;
+    u32 out_mbox;
+    int out_count;
+} HostSpu;
+
+static pthread_mutex_t spu_lock = PTHREAD_MUTEX_INITIALIZER;
+static HostSpu spus[HOST_SPU_MAX];
+static int spu_available = -1;
+static const psl1ghtHostSpuProgram *images[HOST_SPU_IMAGES];
+static __thread HostSpu *spu_self;
+
+static HostSpu *
+psl1ghtHostGetSpu(u32 id)
+{
+    if (id >= HOST_SPU_MAX || !spus[id].used) {
+        return NULL;
+    }
+    return &spus[id];
+}
+
+static void *
+psl1ghtHostSpuThread(void *arg)
+{
+    HostSpu *spu = (HostSpu *) arg;
+
+    spu_self = spu;
+    spu->program->entry(spu->id, 0, 0);
+
+    pthread_mutex_lock(&spu_lock);
+    spu->running = 0;
+    pthread_cond_broadcast(&spu->cond);
+    pthread_mutex_unlock(&spu_lock);
+    return NULL;
+}
+
+s32
+sysSpuInitialize(u32 total, u32 rawspus)
+{
+    int count;
+
+    if (total > HOST_SPU_MAX || rawspus > total) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&spu_lock);
+    count = psl1ghtHostGetEnv("PSL1GHT_HOST_SPUS", 5);
+    if (count < 0) {
+        count = 0;
+    }
+    if (count > (int) rawspus) {
+        count = (int) rawspus;
+    }
+    spu_available = count;
+    pthread_mutex_unlock(&spu_lock);
+    return 0;
+}
+
+s32
+sysSpuImageImport(sysSpuImage * image, const void *elf, u32 type)
+{
+    const psl1ghtHostSpuProgram *program =
+        (const psl1ghtHostSpuProgram *) elf;
+    int i;
+
+    if (!program || program->magic != PSL1GHT_HOST_SPU_MAGIC) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&spu_lock);
+    for (i = 0; i < HOST_SPU_IMAGES; ++i) {
+        if (!images[i] || images[i] == program) {
+            break;
+        }
+    }
+    if (i == HOST_SPU_IMAGES) {
+        pthread_mutex_unlock(&spu_lock);
+        return ENOMEM;
+    }
+    images[i] = program;
+    pthread_mutex_unlock(&spu_lock);
+
+    memset(image, 0, sizeof(*image));
+    image->type = type;
+    image->segments = (u32) i;
+    image->segmentCount = 1;
+    return 0;
+}
+
+s32
+sysSpuImageClose(sysSpuImage * image)
+{
+    /* Programs live as long as the library, keep the slot for reuse */
+    memset(image, 0, sizeof(*image));
+    return 0;
+}
+
+s32
+sysSpuRawCreate(u32 * spu, void *attributes)
+{
+    int i, used = 0;
+
+    pthread_mutex_lock(&spu_lock);
+    if (spu_available < 0) {
+        pthread_mutex_unlock(&spu_lock);
+        return EPERM;
+    }
+    for (i = 0; i < HOST_SPU_MAX; ++i) {
+        used += spus[i].used;
+    }
+    if (used >= spu_available) {
+        pthread_mutex_unlock(&spu_lock);
+        return EBUSY;
+    }
+    for (i = 0; spus[i].used; ++i) {
+    }
+    memset(&spus[i], 0, sizeof(spus[i]));
+    spus[i].used = 1;
+    spus[i].id = (u32) i;
+    pthread_cond_init(&spus[i].cond, NULL);
+    pthread_mutex_unlock(&spu_lock);
+
+    *spu = (u32) i;
+    return 0;
+}
+
+s32
+sysSpuRawDestroy(u32 id)
+{
+    HostSpu *spu;
+
+    pthread_mutex_lock(&spu_lock);
+    spu = psl1ghtHostGetSpu(id);
+    if (!spu) {
+        pthread_mutex_unlock(&spu_lock);
+        return EINVAL;
+    }
+    /* A thread can't be stopped from outside, the program has to end */
+    if (spu->running) {
+        pthread_mutex_unlock(&spu_lock);
+        return EBUSY;
+    }
+    pthread_mutex_unlock(&spu_lock);
+
+    if (spu->started) {
+        pthread_join(spu->thread, NULL);
+    }
+    pthread_mutex_lock(&spu_lock);
+    pthread_cond_destroy(&spu->cond);
+    spu->used = 0;
+    pthread_mutex_unlock(&spu_lock);
+    return 0;
+}
+
+s32
+sysSpuRawImageLoad(u32 id, sysSpuImage * image)
+{
+    HostSpu *spu;
+
+    pthread_mutex_lock(&spu_lock);
+    spu = psl1ghtHostGetSpu(id);
+    if (!spu || spu->running || image->segments >= HOST_SPU_IMAGES ||
+        !images[image->segments]) {
+        pthread_mutex_unlock(&spu_lock);
+        return EINVAL;
+    }
+    spu->program = images[image->segments];
+    pthread_mutex_unlock(&spu_lock);
+    return 0;
+}
+
+void
+sysSpuRawWriteProblemStorage(u32 id, u32 offset, u32 value)
+{
+    HostSpu *spu;
+
+    pthread_mutex_lock(&spu_lock);
+    spu = psl1ghtHostGetSpu(id);
+    if (!spu) {
+        pthread_mutex_unlock(&spu_lock);
+        return;
+    }
+    switch (offset) {
+    case SPU_In_MBox:
+        /* The console overwrites the newest entry, block instead */
+        while (spu->in_count == HOST_SPU_IN_MBOX_DEPTH) {
+            pthread_cond_wait(&spu->cond, &spu_lock);
+        }
+        spu->in_mbox[(spu->in_head + spu->in_count) %
+                     HOST_SPU_IN_MBOX_DEPTH] = value;
+        ++spu->in_count;
+        pthread_cond_broadcast(&spu->cond);
+        break;
+    case SPU_RunCntl:
+        if ((value & 1) && !spu->running && spu->program) {
+            pthread_t old = spu->thread;
+            int joined = spu->started;
+
+            spu->running = 1;
+            spu->started = 1;
+            pthread_mutex_unlock(&spu_lock);
+            if (joined) {
+                pthread_join(old, NULL);
+            }
+            if (pthread_create(&spu->thread, NULL, psl1ghtHostSpuThread,
+                               spu) != 0) {
+                pthread_mutex_lock(&spu_lock);
+                spu->running = 0;
+                spu->started = 0;
+                break;
+            }
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    pthread_mutex_unlock(&spu_lock);
+}
+
+u32
+sysSpuRawReadProblemStorage(u32 id, u32 offset)
+{
+    HostSpu *spu;
+    u32 value = 0;
+
+    pthread_mutex_lock(&spu_lock);
+    spu = psl1ghtHostGetSpu(id);
+    if (!spu) {
+        pthread_mutex_unlock(&spu_lock);
+        return 0;
+    }
+    switch (offset) {
+    case SPU_Out_MBox:
+        value = spu->out_mbox;
+        if (spu->out_count) {
+            spu->out_count = 0;
+            pthread_cond_broadcast(&spu->cond);
+        }
+        break;
+    case SPU_MBox_Status:
+        value = (u32) spu->out_count |
+            ((u32) (HOST_SPU_IN_MBOX_DEPTH - spu->in_count) << 8);
+        break;
+    case SPU_Status:
+        value = spu->running ? SPU_STATUS_RUNNING : SPU_STATUS_STOPPED;
+        break;
+    default:
+        break;
+    }
+    pthread_mutex_unlock(&spu_lock);
+    return value;
+}
+
+uint32_t
+psl1ghtHostSpuReadInMbox(void)
+{
+    HostSpu *spu = spu_self;
+    u32 value;
+
+    pthread_mutex_lock(&spu_lock);
+    while (spu->in_count == 0) {
+        pthread_cond_wait(&spu->cond, &spu_lock);
+    }
+    value = spu->in_mbox[spu->in_head];
+    spu->in_head = (spu->in_head + 1) % HOST_SPU_IN_MBOX_DEPTH;
+    --spu->in_count;
+    pthread_cond_broadcast(&spu->cond);
+    pthread_mutex_unlock(&spu_lock);
+    return value;
+}
+
+void
+psl1ghtHostSpuWriteOutMbox(uint32_t data)
+{
+    HostSpu *spu = spu_self;
+
+    pthread_mutex_lock(&spu_lock);
+    while (spu->out_count) {
+        pthread_cond_wait(&spu->cond, &spu_lock);
+    }
+    spu->out_mbox = data;
+    spu->out_count = 1;
+    pthread_cond_broadcast(&spu->cond);
+    pthread_mutex_unlock(&spu_lock);
+}
+
+void
+psl1ghtHostSpuDMA(volatile void *ls, uint64_t ea, uint32_t size,
+                  uint32_t tag, int put)
+{
+    u64 lsa = (u64) (size_t) ls;
+    int valid;
+
+    if (size < 16) {
+        valid = (size == 1 || size == 2 || size == 4 || size == 8) &&
+            (lsa & 15) == (ea & 15) && (ea & (size - 1)) == 0;
+    } else {
+        valid = size <= MFC_MAX_DMA_SIZE && (size & 15) == 0 &&
+            (lsa & 15) == 0 && (ea & 15) == 0;
+    }
+    if (!valid || tag >= MFC_TAG_MAX) {
+        fprintf(stderr, "psl1ght-host: SPU %u DMA fault: %s ls=%p "
+                "ea=0x%llx size=%u tag=%u\n", spu_self ? spu_self->id : 0,
+                put ? "put" : "get", (void *) (size_t) lsa,
+                (unsigned long long) ea, size, tag);
+        abort();
+    }
+    if (put) {
+        memcpy((void *) (size_t) ea, (const void *) (size_t) lsa, size);
+    } else {
+        memcpy((void *) (size_t) lsa, (const void *) (size_t) ea, size);
+    }
+
+    pthread_mutex_lock(&psl1ghtHostStatsLock);
+    psl1ghtHostCounters.spu_dma_bytes += size;
+    pthread_mutex_unlock(&psl1ghtHostStatsLock);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,218 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Host stand-in for sysutil: video output state and system callbacks */
+
+#include <errno.h>
+
+#include <sysutil/video.h>
+#include <sysutil/events.h>
+
+#include "psl1ghthost_c.h"
+
+/* A real output takes a few frames to resync after videoConfigure() */
+#define HOST_RECONFIGURE_FRAMES 3
+
+#define HOST_MAX_SYSEVENTS  16
+#define HOST_MAX_SLOTS      4
+
+static pthread_mutex_t video_lock = PTHREAD_MUTEX_INITIALIZER;
+static u8 video_resolution;
+static u8 video_aspect = VIDEO_ASPECT_16_9;
+static u64 video_busy_until;
+
+static u8
+psl1ghtHostDefaultResolution(void)
+{
+    switch (psl1ghtHostGetEnv("PSL1GHT_HOST_RESOLUTION", 1080)) {
+    case 720:
+        return VIDEO_RESOLUTION_720;
+    case 576:
+        return VIDEO_RESOLUTION_576;
+    case 480:
+        return VIDEO_RESOLUTION_480;
+    default:
+        return VIDEO_RESOLUTION_1080;
+    }
+}
+
+s32
+videoGetResolution(s32 resolutionId, VideoResolution * resolution)
+{
+    switch (resolutionId) {
+    case VIDEO_RESOLUTION_1080:
+        resolution->width = 1920;
+        resolution->height = 1080;
+        break;
+    case VIDEO_RESOLUTION_720:
+        resolution->width = 1280;
+        resolution->height = 720;
+        break;
+    case VIDEO_RESOLUTION_576:
+        resolution->width = 720;
+        resolution->height = 576;
+        break;
+    case VIDEO_RESOLUTION_480:
+        resolution->width = 720;
+        resolution->height = 480;
+        break;
+    default:
+        return EINVAL;
+    }
+    return 0;
+}
+
+s32
+videoGetState(s32 videoOut, s32 deviceIndex, VideoState * state)
+{
+    if (videoOut != VIDEO_PRIMARY || deviceIndex != 0) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&video_lock);
+    if (!video_resolution) {
+        video_resolution = psl1ghtHostDefaultResolution();
+    }
+    state->state = (psl1ghtHostTime() < video_busy_until) ? 3 : 0;
+    state->colorSpace = 1;
+    state->displayMode.resolution = video_resolution;
+    state->displayMode.scanMode = 1;
+    state->displayMode.conversion = 0;
+    state->displayMode.aspect = video_aspect;
+    state->displayMode.refreshRates = 1;
+    pthread_mutex_unlock(&video_lock);
+    return 0;
+}
+
+s32
+videoConfigure(s32 videoOut, VideoConfiguration * config, void *option,
+               s32 blocking)
+{
+    VideoResolution res;
+    u64 busy_until;
+
+    (void) option;
+    if (videoOut != VIDEO_PRIMARY) {
+        return EINVAL;
+    }
+    if (videoGetResolution(config->resolution, &res) != 0) {
+        return EINVAL;
+    }
+    if (config->pitch < res.width * 4u) {
+        return EINVAL;
+    }
+
+    busy_until = psl1ghtHostTime() +
+        HOST_RECONFIGURE_FRAMES * psl1ghtHostFramePeriod();
+    pthread_mutex_lock(&video_lock);
+    video_resolution = config->resolution;
+    if (config->aspect != VIDEO_ASPECT_AUTO) {
+        video_aspect = config->aspect;
+    }
+    video_busy_until = busy_until;
+    pthread_mutex_unlock(&video_lock);
+
+    if (blocking) {
+        psl1ghtHostSleepUntil(busy_until);
+    }
+    return 0;
+}
+
+/* System callbacks */
+
+typedef struct
+{
+    u64 status;
+    u64 param;
+} HostSysEvent;
+
+static pthread_mutex_t sysutil_lock = PTHREAD_MUTEX_INITIALIZER;
+static HostSysEvent sysevents[HOST_MAX_SYSEVENTS];
+static int sysevents_head, sysevents_count;
+static struct
+{
+    sysEventCallback func;
+    void *userdata;
+} slots[HOST_MAX_SLOTS];
+
+s32
+sysRegisterCallback(sysEventSlot slot, sysEventCallback func, void *userdata)
+{
+    if ((unsigned) slot >= HOST_MAX_SLOTS) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&sysutil_lock);
+    slots[slot].func = func;
+    slots[slot].userdata = userdata;
+    pthread_mutex_unlock(&sysutil_lock);
+    return 0;
+}
+
+s32
+sysUnregisterCallback(sysEventSlot slot)
+{
+    return sysRegisterCallback(slot, NULL, NULL);
+}
+
+s32
+sysCheckCallback(void)
+{
+    HostSysEvent event;
+    sysEventCallback func;
+    void *userdata;
+    int i;
+
+    pthread_mutex_lock(&sysutil_lock);
+    while (sysevents_count > 0) {
+        event = sysevents[sysevents_head];
+        sysevents_head = (sysevents_head + 1) % HOST_MAX_SYSEVENTS;
+        --sysevents_count;
+        for (i = 0; i < HOST_MAX_SLOTS; ++i) {
+            func = slots[i].func;
+            userdata = slots[i].userdata;
+            if (func) {
+                pthread_mutex_unlock(&sysutil_lock);
+                func(event.status, event.param, userdata);
+                pthread_mutex_lock(&sysutil_lock);
+            }
+        }
+    }
+    pthread_mutex_unlock(&sysutil_lock);
+    return 0;
+}
+
+void
+psl1ghtHostPostSysEvent(u64 status, u64 param)
+{
+    HostSysEvent *event;
+
+    pthread_mutex_lock(&sysutil_lock);
+    if (sysevents_count < HOST_MAX_SYSEVENTS) {
+        event = &sysevents[(sysevents_head + sysevents_count) %
+                           HOST_MAX_SYSEVENTS];
+        event->status = status;
+        event->param = param;
+        ++sysevents_count;
+    }
+    pthread_mutex_unlock(&sysutil_lock);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -89,6 +89,7 @@
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
+#include "SDL_pixels_c.h"
 #include "SDL_RLEaccel_c.h"
 
 #ifndef MAX
@@ -577,6 +578,22 @@ SDL_RLEBlit(SDL_Surface * src, SDL_Rect * srcrect,
 	dst = d1 | d | 0xff000000;				\
     } while(0)
 
+/*
+ * The same for premultiplied colour, which is added to what is left of
+ * the destination; colour above its alpha saturates at 255
+ */
+#define BLIT_TRANSL_888_PREMULTIPLIED(src, dst)			\
+    do {							\
+        Uint32 s = src;						\
+	Uint32 d = dst;						\
+	unsigned inva = 256 - (s >> 24);			\
+	Uint32 d1 = ((d & 0xff00ff) * inva >> 8) & 0xff00ff;	\
+	Uint32 d2 = ((d >> 8) & 0xff) * inva >> 8;		\
+	ADD_SATURATE_0xFF00FF(s & 0xff00ff, d1, d1);		\
+	ADD_SATURATE_0xFF00FF((s >> 8) & 0xff, d2, d2);		\
+	dst = d1 | (d2 << 8) | 0xff000000;			\
+    } while(0)
+
 /*
  * For 16bpp pixels, we have stored the 5 most significant alpha bits in
  * bits 5-10. As before, we can process all 3 RGB components at the same time.
@@ -626,7 +643,7 @@ typedef struct
 /* blit a pixel-alpha RLE surface clipped at the right and/or left edges */
 static void
 RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * dst,
-                 Uint8 * dstbuf, SDL_Rect * srcrect)
+                 Uint8 * dstbuf, SDL_Rect * srcrect, int premultiplied)
 {
     SDL_PixelFormat *df = dst->format;
     /*
@@ -710,7 +727,10 @@ RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * dst,
             RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_555);
         break;
     case 4:
-        RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_888);
+        if (premultiplied)
+            RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_888_PREMULTIPLIED);
+        else
+            RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_888);
         break;
     }
 }
@@ -795,7 +815,8 @@ SDL_RLEAlphaBlit(SDL_Surface * src, SDL_Rect * srcrect,
 
     /* if left or right edge clipping needed, call clip blit */
     if (srcrect->x || srcrect->w != src->w) {
-        RLEAlphaClipBlit(w, srcbuf, dst, dstbuf, srcrect);
+        RLEAlphaClipBlit(w, srcbuf, dst, dstbuf, srcrect,
+                         src->map->info.flags & SDL_COPY_PREMULTIPLIED);
     } else {
 
         /*
@@ -857,7 +878,10 @@ SDL_RLEAlphaBlit(SDL_Surface * src, SDL_Rect * srcrect,
                 RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_555);
             break;
         case 4:
-            RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_888);
+            if (src->map->info.flags & SDL_COPY_PREMULTIPLIED)
+                RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_888_PREMULTIPLIED);
+            else
+                RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_888);
             break;
         }
     }
@@ -1400,10 +1424,16 @@ SDL_RLESurface(SDL_Surface * surface)
     int flags;
 
     /* Clear any previous RLE conversion */
-    if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
+    if (surface->map->info.flags &
+        (SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY)) {
         SDL_UnRLESurface(surface, 1);
     }
 
+    /* Nothing to encode for until the surface is mapped again */
+    if (!surface->map->dst) {
+        return -1;
+    }
+
     /* We don't support RLE encoding of bitmaps */
     if (surface->format->BitsPerPixel < 8) {
         return -1;
@@ -1416,7 +1446,15 @@ SDL_RLESurface(SDL_Surface * surface)
 
     /* If we don't have colorkey or blending, nothing to do... */
     flags = surface->map->info.flags;
-    if (!(flags & (SDL_COPY_COLORKEY | SDL_COPY_BLEND))) {
+    if (!(flags & (SDL_COPY_COLORKEY | SDL_COPY_BLEND |
+                   SDL_COPY_PREMULTIPLIED))) {
+        return -1;
+    }
+
+    /* Premultiplied runs are only blended onto 32bpp destinations */
+    if ((flags & SDL_COPY_PREMULTIPLIED) &&
+        (!surface->format->Amask ||
+         surface->map->dst->format->BytesPerPixel != 4)) {
         return -1;
     }
 
@@ -1429,7 +1467,8 @@ SDL_RLESurface(SDL_Surface * surface)
     }
 
     /* Encode and set up the blit */
-    if (!surface->format->Amask || !(flags & SDL_COPY_BLEND)) {
+    if (!surface->format->Amask ||
+        !(flags & (SDL_COPY_BLEND | SDL_COPY_PREMULTIPLIED))) {
         if (!surface->map->identity) {
             return -1;
         }
@@ -1531,47 +1570,83 @@ UnRLEAlpha(SDL_Surface * surface)
     return (SDL_TRUE);
 }
 
+/* Recreate the pixels of an RLE surface from its current encoding */
+static SDL_bool
+UnRLEPixels(SDL_Surface * surface)
+{
+    if (surface->map->info.flags & SDL_COPY_RLE_COLORKEY) {
+        SDL_Rect full;
+
+        /* re-create the original surface */
+        surface->pixels = SDL_malloc(surface->h * surface->pitch);
+        if (!surface->pixels) {
+            return (SDL_FALSE);
+        }
+
+        /* fill it with the background colour */
+        SDL_FillRect(surface, NULL, surface->map->info.colorkey);
+
+        /* now render the encoded surface */
+        full.x = full.y = 0;
+        full.w = surface->w;
+        full.h = surface->h;
+        SDL_RLEBlit(surface, &full, surface, &full);
+        return (SDL_TRUE);
+    }
+    return UnRLEAlpha(surface);
+}
+
+/*
+ * Give an RLE surface its pixels back but keep the encoding, so it can
+ * be mapped to other destinations and back again without re-encoding.
+ */
+int
+SDL_RestoreRLEPixels(SDL_Surface * surface)
+{
+    Uint32 flags = surface->flags;
+    SDL_bool okay;
+
+    if (surface->pixels) {
+        return 0;
+    }
+
+    /* Decoding draws into the surface, which mustn't lock it */
+    surface->flags &= ~SDL_RLEACCEL;
+    okay = UnRLEPixels(surface);
+    surface->flags = flags;
+    if (!okay) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    return 0;
+}
+
 void
 SDL_UnRLESurface(SDL_Surface * surface, int recode)
 {
     if (surface->flags & SDL_RLEACCEL) {
         surface->flags &= ~SDL_RLEACCEL;
 
-        if (recode && !(surface->flags & SDL_PREALLOC)) {
-            if (surface->map->info.flags & SDL_COPY_RLE_COLORKEY) {
-                SDL_Rect full;
-
-                /* re-create the original surface */
-                surface->pixels = SDL_malloc(surface->h * surface->pitch);
-                if (!surface->pixels) {
+        if (surface->map->info.flags &
+            (SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY)) {
+            if (recode && !surface->pixels) {
+                if (!UnRLEPixels(surface)) {
                     /* Oh crap... */
                     surface->flags |= SDL_RLEACCEL;
                     return;
                 }
+            }
+            surface->map->info.flags &=
+                ~(SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY);
 
-                /* fill it with the background colour */
-                SDL_FillRect(surface, NULL, surface->map->info.colorkey);
-
-                /* now render the encoded surface */
-                full.x = full.y = 0;
-                full.w = surface->w;
-                full.h = surface->h;
-                SDL_RLEBlit(surface, &full, surface, &full);
-            } else {
-                if (!UnRLEAlpha(surface)) {
-                    /* Oh crap... */
-                    surface->flags |= SDL_RLEACCEL;
-                    return;
-                }
+            if (surface->map->data) {
+                SDL_free(surface->map->data);
+                surface->map->data = NULL;
             }
         }
-        surface->map->info.flags &=
-            ~(SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY);
 
-        if (surface->map->data) {
-            SDL_free(surface->map->data);
-            surface->map->data = NULL;
-        }
+        /* Encodings kept for other destinations don't survive either */
+        SDL_InvalidateMapRLE(surface->map);
     }
 }
 
@@ -29,4 +29,5 @@ extern int SDL_RLEBlit(SDL_Surface * src, SDL_Rect * srcrect,
 extern int SDL_RLEAlphaBlit(SDL_Surface * src, SDL_Rect * srcrect,
                             SDL_Surface * dst, SDL_Rect * dstrect);
 extern void SDL_UnRLESurface(SDL_Surface * surface, int recode);
+extern int SDL_RestoreRLEPixels(SDL_Surface * surface);
 /* vi: set ts=4 sw=4 expandtab: */
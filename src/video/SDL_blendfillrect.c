@@ -31,6 +31,7 @@ SDL_BlendFillRect_RGB555(SDL_Surface * dst, const SDL_Rect * rect,
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         FILLRECT(Uint16, DRAW_SETPIXEL_BLEND_RGB555);
         break;
@@ -54,6 +55,7 @@ SDL_BlendFillRect_RGB565(SDL_Surface * dst, const SDL_Rect * rect,
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         FILLRECT(Uint16, DRAW_SETPIXEL_BLEND_RGB565);
         break;
@@ -77,6 +79,7 @@ SDL_BlendFillRect_RGB888(SDL_Surface * dst, const SDL_Rect * rect,
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         FILLRECT(Uint32, DRAW_SETPIXEL_BLEND_RGB888);
         break;
@@ -100,6 +103,7 @@ SDL_BlendFillRect_ARGB8888(SDL_Surface * dst, const SDL_Rect * rect,
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         FILLRECT(Uint32, DRAW_SETPIXEL_BLEND_ARGB8888);
         break;
@@ -126,6 +130,7 @@ SDL_BlendFillRect_RGB(SDL_Surface * dst, const SDL_Rect * rect,
     switch (fmt->BytesPerPixel) {
     case 2:
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             FILLRECT(Uint16, DRAW_SETPIXEL_BLEND_RGB);
             break;
@@ -142,6 +147,7 @@ SDL_BlendFillRect_RGB(SDL_Surface * dst, const SDL_Rect * rect,
         return 0;
     case 4:
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             FILLRECT(Uint32, DRAW_SETPIXEL_BLEND_RGB);
             break;
@@ -172,6 +178,7 @@ SDL_BlendFillRect_RGBA(SDL_Surface * dst, const SDL_Rect * rect,
     switch (fmt->BytesPerPixel) {
     case 4:
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             FILLRECT(Uint32, DRAW_SETPIXEL_BLEND_RGBA);
             break;
@@ -47,6 +47,7 @@ SDL_BlendLine_RGB2(SDL_Surface * dst, int x1, int y1, int x2, int y2,
 
     if (y1 == y2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             HLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB, draw_end);
             break;
@@ -62,6 +63,7 @@ SDL_BlendLine_RGB2(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (x1 == x2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             VLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB, draw_end);
             break;
@@ -77,6 +79,7 @@ SDL_BlendLine_RGB2(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB, draw_end);
             break;
@@ -92,6 +95,7 @@ SDL_BlendLine_RGB2(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             AALINE(x1, y1, x2, y2,
                    DRAW_SETPIXELXY2_BLEND_RGB, DRAW_SETPIXELXY2_BLEND_RGB,
@@ -139,6 +143,7 @@ SDL_BlendLine_RGB555(SDL_Surface * dst, int x1, int y1, int x2, int y2,
 
     if (y1 == y2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             HLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB555, draw_end);
             break;
@@ -154,6 +159,7 @@ SDL_BlendLine_RGB555(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (x1 == x2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             VLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB555, draw_end);
             break;
@@ -169,6 +175,7 @@ SDL_BlendLine_RGB555(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB555, draw_end);
             break;
@@ -184,6 +191,7 @@ SDL_BlendLine_RGB555(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             AALINE(x1, y1, x2, y2,
                    DRAW_SETPIXELXY_BLEND_RGB555, DRAW_SETPIXELXY_BLEND_RGB555,
@@ -231,6 +239,7 @@ SDL_BlendLine_RGB565(SDL_Surface * dst, int x1, int y1, int x2, int y2,
 
     if (y1 == y2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             HLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB565, draw_end);
             break;
@@ -246,6 +255,7 @@ SDL_BlendLine_RGB565(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (x1 == x2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             VLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB565, draw_end);
             break;
@@ -261,6 +271,7 @@ SDL_BlendLine_RGB565(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DLINE(Uint16, DRAW_SETPIXEL_BLEND_RGB565, draw_end);
             break;
@@ -276,6 +287,7 @@ SDL_BlendLine_RGB565(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             AALINE(x1, y1, x2, y2,
                    DRAW_SETPIXELXY_BLEND_RGB565, DRAW_SETPIXELXY_BLEND_RGB565,
@@ -323,6 +335,7 @@ SDL_BlendLine_RGB4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
 
     if (y1 == y2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             HLINE(Uint32, DRAW_SETPIXEL_BLEND_RGB, draw_end);
             break;
@@ -338,6 +351,7 @@ SDL_BlendLine_RGB4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (x1 == x2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             VLINE(Uint32, DRAW_SETPIXEL_BLEND_RGB, draw_end);
             break;
@@ -353,6 +367,7 @@ SDL_BlendLine_RGB4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DLINE(Uint32, DRAW_SETPIXEL_BLEND_RGB, draw_end);
             break;
@@ -368,6 +383,7 @@ SDL_BlendLine_RGB4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             AALINE(x1, y1, x2, y2,
                    DRAW_SETPIXELXY4_BLEND_RGB, DRAW_SETPIXELXY4_BLEND_RGB,
@@ -415,6 +431,7 @@ SDL_BlendLine_RGBA4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
 
     if (y1 == y2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             HLINE(Uint32, DRAW_SETPIXEL_BLEND_RGBA, draw_end);
             break;
@@ -430,6 +447,7 @@ SDL_BlendLine_RGBA4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (x1 == x2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             VLINE(Uint32, DRAW_SETPIXEL_BLEND_RGBA, draw_end);
             break;
@@ -445,6 +463,7 @@ SDL_BlendLine_RGBA4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DLINE(Uint32, DRAW_SETPIXEL_BLEND_RGBA, draw_end);
             break;
@@ -460,6 +479,7 @@ SDL_BlendLine_RGBA4(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             AALINE(x1, y1, x2, y2,
                    DRAW_SETPIXELXY4_BLEND_RGBA, DRAW_SETPIXELXY4_BLEND_RGBA,
@@ -507,6 +527,7 @@ SDL_BlendLine_RGB888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
 
     if (y1 == y2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             HLINE(Uint32, DRAW_SETPIXEL_BLEND_RGB888, draw_end);
             break;
@@ -522,6 +543,7 @@ SDL_BlendLine_RGB888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (x1 == x2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             VLINE(Uint32, DRAW_SETPIXEL_BLEND_RGB888, draw_end);
             break;
@@ -537,6 +559,7 @@ SDL_BlendLine_RGB888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DLINE(Uint32, DRAW_SETPIXEL_BLEND_RGB888, draw_end);
             break;
@@ -552,6 +575,7 @@ SDL_BlendLine_RGB888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             AALINE(x1, y1, x2, y2,
                    DRAW_SETPIXELXY_BLEND_RGB888, DRAW_SETPIXELXY_BLEND_RGB888,
@@ -599,6 +623,7 @@ SDL_BlendLine_ARGB8888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
 
     if (y1 == y2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             HLINE(Uint32, DRAW_SETPIXEL_BLEND_ARGB8888, draw_end);
             break;
@@ -614,6 +639,7 @@ SDL_BlendLine_ARGB8888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (x1 == x2) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             VLINE(Uint32, DRAW_SETPIXEL_BLEND_ARGB8888, draw_end);
             break;
@@ -629,6 +655,7 @@ SDL_BlendLine_ARGB8888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DLINE(Uint32, DRAW_SETPIXEL_BLEND_ARGB8888, draw_end);
             break;
@@ -644,6 +671,7 @@ SDL_BlendLine_ARGB8888(SDL_Surface * dst, int x1, int y1, int x2, int y2,
         }
     } else {
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             AALINE(x1, y1, x2, y2,
                    DRAW_SETPIXELXY_BLEND_ARGB8888, DRAW_SETPIXELXY_BLEND_ARGB8888,
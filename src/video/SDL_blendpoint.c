@@ -30,6 +30,7 @@ SDL_BlendPoint_RGB555(SDL_Surface * dst, int x, int y, SDL_BlendMode blendMode,
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         DRAW_SETPIXELXY_BLEND_RGB555(x, y);
         break;
@@ -53,6 +54,7 @@ SDL_BlendPoint_RGB565(SDL_Surface * dst, int x, int y, SDL_BlendMode blendMode,
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         DRAW_SETPIXELXY_BLEND_RGB565(x, y);
         break;
@@ -76,6 +78,7 @@ SDL_BlendPoint_RGB888(SDL_Surface * dst, int x, int y, SDL_BlendMode blendMode,
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         DRAW_SETPIXELXY_BLEND_RGB888(x, y);
         break;
@@ -99,6 +102,7 @@ SDL_BlendPoint_ARGB8888(SDL_Surface * dst, int x, int y, SDL_BlendMode blendMode
     unsigned inva = 0xff - a;
 
     switch (blendMode) {
+    case SDL_BLENDMODE_PREMULTIPLIED:
     case SDL_BLENDMODE_BLEND:
         DRAW_SETPIXELXY_BLEND_ARGB8888(x, y);
         break;
@@ -125,6 +129,7 @@ SDL_BlendPoint_RGB(SDL_Surface * dst, int x, int y, SDL_BlendMode blendMode, Uin
     switch (fmt->BytesPerPixel) {
     case 2:
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DRAW_SETPIXELXY2_BLEND_RGB(x, y);
             break;
@@ -141,6 +146,7 @@ SDL_BlendPoint_RGB(SDL_Surface * dst, int x, int y, SDL_BlendMode blendMode, Uin
         return 0;
     case 4:
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DRAW_SETPIXELXY4_BLEND_RGB(x, y);
             break;
@@ -171,6 +177,7 @@ SDL_BlendPoint_RGBA(SDL_Surface * dst, int x, int y, SDL_BlendMode blendMode, Ui
     switch (fmt->BytesPerPixel) {
     case 4:
         switch (blendMode) {
+        case SDL_BLENDMODE_PREMULTIPLIED:
         case SDL_BLENDMODE_BLEND:
             DRAW_SETPIXELXY4_BLEND_RGBA(x, y);
             break;
@@ -22,6 +22,9 @@
 #include "SDL_config.h"
 
 #include "SDL_video.h"
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_thread.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_blit_auto.h"
@@ -30,6 +33,177 @@
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
 
+/*
+ * Big blits can be split into bands of rows and run on a pool of threads.
+ *  This is opt-in: SDL_BLIT_THREADS sets the number of threads, counting
+ *  the one blitting, or 0 for one per CPU; it never goes above the CPU
+ *  count, as bands taking turns on one CPU are slower than a single blit.
+ *  Only blits of at least SDL_BLIT_THREAD_PIXELS pixels are split, so
+ *  small sprites don't pay for waking the pool. For testing,
+ *  SDL_BLIT_THREADS_FORCE=1 lifts the CPU cap so the bands are run on
+ *  any machine.
+ */
+#define BLIT_MAX_THREADS        16
+#define BLIT_THREAD_PIXELS      65536
+
+typedef struct
+{
+    SDL_Thread *thread;
+    SDL_sem *start;
+    SDL_BlitFunc func;
+    SDL_BlitInfo info;
+} SDL_BlitBand;
+
+static struct
+{
+    SDL_SpinLock setup;
+    int threads;                /* 0 until the hints have been read */
+    int min_pixels;
+    int quit;
+    SDL_mutex *lock;
+    SDL_sem *done;
+    SDL_BlitBand bands[BLIT_MAX_THREADS];
+} blit_pool;
+
+static int SDLCALL
+SDL_BlitBandThread(void *data)
+{
+    SDL_BlitBand *band = (SDL_BlitBand *) data;
+
+    for (;;) {
+        SDL_SemWait(band->start);
+        if (blit_pool.quit) {
+            break;
+        }
+        band->func(&band->info);
+        SDL_SemPost(blit_pool.done);
+    }
+    return 0;
+}
+
+static SDL_Thread *
+SDL_CreateBlitThread(SDL_BlitBand * band)
+{
+/* !!! FIXME: this is nasty. */
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC)
+#undef SDL_CreateThread
+    return SDL_CreateThread(SDL_BlitBandThread, band, NULL, NULL);
+#else
+    return SDL_CreateThread(SDL_BlitBandThread, band);
+#endif
+}
+
+/* Read the hints and start the workers, the first time it's needed */
+static void
+SDL_StartBlitThreads(void)
+{
+    const char *hint;
+    int threads, force, i;
+
+    SDL_AtomicLock(&blit_pool.setup);
+    if (blit_pool.threads) {
+        SDL_AtomicUnlock(&blit_pool.setup);
+        return;
+    }
+
+    hint = SDL_getenv("SDL_BLIT_THREAD_PIXELS");
+    blit_pool.min_pixels = (hint && *hint) ? SDL_atoi(hint) :
+        BLIT_THREAD_PIXELS;
+
+    hint = SDL_getenv("SDL_BLIT_THREADS");
+    threads = (hint && *hint) ? SDL_atoi(hint) : 1;
+    hint = SDL_getenv("SDL_BLIT_THREADS_FORCE");
+    force = (hint && *hint) ? SDL_atoi(hint) : 0;
+    if ((threads <= 0) || (!force && (threads > SDL_GetCPUCount()))) {
+        threads = SDL_GetCPUCount();
+    }
+    threads = SDL_max(1, SDL_min(threads, BLIT_MAX_THREADS));
+
+    if (threads > 1) {
+        blit_pool.quit = 0;
+        blit_pool.lock = SDL_CreateMutex();
+        blit_pool.done = SDL_CreateSemaphore(0);
+        if (!blit_pool.lock || !blit_pool.done) {
+            threads = 1;
+        }
+    }
+
+    /* Band 0 is always blitted by the calling thread */
+    for (i = 1; i < threads; ++i) {
+        SDL_BlitBand *band = &blit_pool.bands[i];
+        band->start = SDL_CreateSemaphore(0);
+        if (band->start) {
+            band->thread = SDL_CreateBlitThread(band);
+        }
+        if (!band->thread) {
+            break;
+        }
+    }
+    blit_pool.threads = i;
+
+    SDL_AtomicUnlock(&blit_pool.setup);
+}
+
+/* Stop the workers, so the hints are read again on the next blit */
+void
+SDL_QuitBlitThreads(void)
+{
+    int i;
+
+    SDL_AtomicLock(&blit_pool.setup);
+    blit_pool.quit = 1;
+    for (i = 1; i < BLIT_MAX_THREADS; ++i) {
+        SDL_BlitBand *band = &blit_pool.bands[i];
+        if (band->thread) {
+            SDL_SemPost(band->start);
+            SDL_WaitThread(band->thread, NULL);
+            band->thread = NULL;
+        }
+        if (band->start) {
+            SDL_DestroySemaphore(band->start);
+            band->start = NULL;
+        }
+    }
+    if (blit_pool.done) {
+        SDL_DestroySemaphore(blit_pool.done);
+        blit_pool.done = NULL;
+    }
+    if (blit_pool.lock) {
+        SDL_DestroyMutex(blit_pool.lock);
+        blit_pool.lock = NULL;
+    }
+    blit_pool.threads = 0;
+    SDL_AtomicUnlock(&blit_pool.setup);
+}
+
+/* Run the blit on the pool, one band of rows per thread */
+static void
+SDL_RunBlitBands(SDL_BlitFunc RunBlit, SDL_BlitInfo * info)
+{
+    const int bands = SDL_min(blit_pool.threads, info->dst_h);
+    int i, y, next;
+
+    SDL_mutexP(blit_pool.lock);
+    for (i = 0, y = 0; i < bands; ++i, y = next) {
+        SDL_BlitBand *band = &blit_pool.bands[i];
+
+        next = (info->dst_h * (i + 1)) / bands;
+        band->func = RunBlit;
+        band->info = *info;
+        band->info.src += y * info->src_pitch;
+        band->info.dst += y * info->dst_pitch;
+        band->info.src_h = band->info.dst_h = next - y;
+        if (i > 0) {
+            SDL_SemPost(band->start);
+        }
+    }
+    RunBlit(&blit_pool.bands[0].info);
+    for (i = 1; i < bands; ++i) {
+        SDL_SemWait(blit_pool.done);
+    }
+    SDL_mutexV(blit_pool.lock);
+}
+
 /* The general purpose software blit routine */
 static int
 SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
@@ -51,9 +225,10 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
             dst_locked = 1;
         }
     }
-    /* Lock the source if it's in hardware */
+    /* Lock the source if it's in hardware; one that's only RLE encoded
+       for other destinations still has its pixels */
     src_locked = 0;
-    if (SDL_MUSTLOCK(src)) {
+    if (SDL_MUSTLOCK(src) && !src->pixels) {
         if (SDL_LockSurface(src) < 0) {
             okay = 0;
         } else {
@@ -85,8 +260,19 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
             info->dst_pitch - info->dst_w * info->dst_fmt->BytesPerPixel;
         RunBlit = (SDL_BlitFunc) src->map->data;
 
-        /* Run the actual software blit */
-        RunBlit(info);
+        /* Run the actual software blit, split up if it's big enough.
+           Scaling and blits within one surface depend on other rows. */
+        if (!blit_pool.threads) {
+            SDL_StartBlitThreads();
+        }
+        if ((blit_pool.threads > 1) && (src != dst) &&
+            (info->src_w == info->dst_w) && (info->src_h == info->dst_h) &&
+            (info->dst_w * info->dst_h >= blit_pool.min_pixels) &&
+            (info->src_fmt->BitsPerPixel >= 8)) {
+            SDL_RunBlitBands(RunBlit, info);
+        } else {
+            RunBlit(info);
+        }
     }
 
     /* We need to unlock the surfaces if they're locked */
@@ -183,7 +369,8 @@ SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
         /* Check blend flags */
         flagcheck =
             (flags &
-             (SDL_COPY_MASK | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD));
+             (SDL_COPY_MASK | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD |
+              SDL_COPY_PREMULTIPLIED));
         if ((flagcheck & entries[i].flags) != flagcheck) {
             continue;
         }
@@ -221,7 +408,7 @@ SDL_CalculateBlit(SDL_Surface * surface)
     SDL_Surface *dst = map->dst;
 
     /* Clean everything out to start */
-    if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
+    if (map->info.flags & (SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY)) {
         SDL_UnRLESurface(surface, 1);
     }
     map->blit = SDL_SoftBlit;
@@ -249,12 +436,13 @@ SDL_CalculateBlit(SDL_Surface * surface)
         blit = SDL_CalculateBlit0(surface);
     } else if (surface->format->BytesPerPixel == 1) {
         blit = SDL_CalculateBlit1(surface);
-    } else if (map->info.flags & SDL_COPY_BLEND) {
+    } else if (map->info.flags & (SDL_COPY_BLEND | SDL_COPY_PREMULTIPLIED)) {
         blit = SDL_CalculateBlitA(surface);
     } else {
         blit = SDL_CalculateBlitN(surface);
     }
     if (blit == NULL) {
+        int flags = map->info.flags;
         Uint32 src_format =
             SDL_MasksToPixelFormatEnum(surface->format->BitsPerPixel,
                                        surface->format->Rmask,
@@ -268,8 +456,13 @@ SDL_CalculateBlit(SDL_Surface * surface)
                                        dst->format->Bmask,
                                        dst->format->Amask);
 
+        /* Without source alpha, premultiplied colour only fades with the
+           alpha modulation, as it does when blending */
+        if ((flags & SDL_COPY_PREMULTIPLIED) && !surface->format->Amask) {
+            flags = (flags & ~SDL_COPY_PREMULTIPLIED) | SDL_COPY_BLEND;
+        }
         blit =
-            SDL_ChooseBlitFunc(src_format, dst_format, map->info.flags,
+            SDL_ChooseBlitFunc(src_format, dst_format, flags,
                                SDL_GeneratedBlitFuncTable);
     }
 #ifndef TEST_SLOW_BLIT
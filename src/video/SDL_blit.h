@@ -58,6 +58,7 @@
 #define SDL_COPY_MOD                0x00000080
 #define SDL_COPY_COLORKEY           0x00000100
 #define SDL_COPY_NEAREST            0x00000200
+#define SDL_COPY_PREMULTIPLIED      0x00000400
 #define SDL_COPY_RLE_DESIRED        0x00001000
 #define SDL_COPY_RLE_COLORKEY       0x00002000
 #define SDL_COPY_RLE_ALPHAKEY       0x00004000
@@ -101,6 +102,21 @@ typedef struct
     SDL_BlitFunc func;
 } SDL_BlitFuncEntry;
 
+/* How many mappings to other destinations a source keeps around */
+#define SDL_BLITMAP_CACHE_SIZE  4
+
+/* A mapping to a destination other than the current one */
+typedef struct
+{
+    SDL_Surface *dst;
+    unsigned int format_version;
+    int identity;
+    SDL_blit blit;
+    void *data;
+    Uint8 *table;
+    int rle_flags;              /* data is RLE encoded if set */
+} SDL_BlitMapEntry;
+
 /* Blit mapping definition */
 typedef struct SDL_BlitMap
 {
@@ -113,10 +129,15 @@ typedef struct SDL_BlitMap
     /* the version count matches the destination; mismatch indicates
        an invalid mapping */
     unsigned int format_version;
+
+    /* earlier mappings, so alternating destinations doesn't rebuild them */
+    SDL_BlitMapEntry cache[SDL_BLITMAP_CACHE_SIZE];
+    int cache_next;
 } SDL_BlitMap;
 
 /* Functions found in SDL_blit.c */
 extern int SDL_CalculateBlit(SDL_Surface * surface);
+extern void SDL_QuitBlitThreads(void);
 
 /* Functions found in SDL_blit_*.c */
 extern SDL_BlitFunc SDL_CalculateBlit0(SDL_Surface * surface);
@@ -136,6 +157,9 @@ extern SDL_BlitFunc SDL_CalculateBlitA(SDL_Surface * surface);
 #define DECLARE_ALIGNED(t,v,a)  t v
 #endif
 
+/* x / 255 without dividing, exact for any product of two bytes */
+#define DIV255(x)   (((x) + 1 + ((x) >> 8)) >> 8)
+
 #define FORMAT_EQUAL(A, B)						\
     ((A)->BitsPerPixel == (B)->BitsPerPixel				\
      && ((A)->Rmask == (B)->Rmask) && ((A)->Amask == (B)->Amask))
@@ -457,6 +481,15 @@ do {						\
 	dB = ((((int)(sB-dB)*(int)A)/255)+dB);	\
 } while(0)
 
+/* Add two pairs of 8-bit components held as 0x00ff00ff, clamping each
+   to 255 rather than letting it carry into the next */
+#define ADD_SATURATE_0xFF00FF(a, b, sum)		\
+do {							\
+	Uint32 _sum = (a) + (b);			\
+	Uint32 _carry = _sum & 0x01000100;		\
+	sum = (_sum | (_carry - (_carry >> 8))) & 0x00ff00ff;	\
+} while(0)
+
 
 /* This is a very useful loop for optimizing blitters */
 #if defined(_MSC_VER) && (_MSC_VER == 1300)
@@ -1338,6 +1338,49 @@ BlitRGBtoRGBPixelAlpha(SDL_BlitInfo * info)
     }
 }
 
+/* fast ARGB888->(A)RGB888 blending with premultiplied pixel alpha */
+static void
+BlitRGBtoRGBPixelAlphaPremultiplied(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    /* the top byte of a destination without alpha is left alone */
+    Uint32 keep = ~(0x00ffffff | info->dst_fmt->Amask);
+
+    while (height--) {
+	    /* *INDENT-OFF* */
+	    DUFFS_LOOP4({
+		Uint32 s = *srcp;
+		Uint32 alpha = s >> 24;
+		if(alpha == SDL_ALPHA_OPAQUE) {
+		  *dstp = (s & ~keep) | (*dstp & keep);
+		} else if(s) {
+		  /*
+		   * dst = src + dst * (1 - alpha), two components at a
+		   * time and alpha with the rest; colour above its
+		   * alpha saturates rather than carrying over.
+		   */
+		  Uint32 d = *dstp;
+		  Uint32 inva = 256 - alpha;
+		  Uint32 d1 = ((d & 0xff00ff) * inva >> 8) & 0xff00ff;
+		  Uint32 d2 = (((d >> 8) & 0xff00ff) * inva >> 8) & 0xff00ff;
+		  ADD_SATURATE_0xFF00FF(s & 0xff00ff, d1, d1);
+		  ADD_SATURATE_0xFF00FF((s >> 8) & 0xff00ff, d2, d2);
+		  *dstp = ((d1 | (d2 << 8)) & ~keep) | (d & keep);
+		}
+		++srcp;
+		++dstp;
+	    }, width);
+	    /* *INDENT-ON* */
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
 #ifdef __3dNOW__
 /* fast (as in MMX with prefetch) ARGB888->(A)RGB888 blending with pixel alpha */
 static void
@@ -2247,6 +2290,16 @@ SDL_CalculateBlitA(SDL_Surface * surface)
         }
         break;
 
+    case SDL_COPY_PREMULTIPLIED:
+        /* Per-pixel premultiplied alpha blits */
+        if (df->BytesPerPixel == 4 && sf->BytesPerPixel == 4
+            && sf->Rmask == df->Rmask
+            && sf->Gmask == df->Gmask
+            && sf->Bmask == df->Bmask && sf->Amask == 0xff000000) {
+            return BlitRGBtoRGBPixelAlphaPremultiplied;
+        }
+        break;
+
     case SDL_COPY_COLORKEY | SDL_COPY_MODULATE_ALPHA | SDL_COPY_BLEND:
         if (sf->Amask == 0) {
             if (df->BytesPerPixel == 1)
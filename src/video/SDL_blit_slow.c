@@ -108,9 +108,15 @@ SDL_Blit_Slow(SDL_BlitInfo * info)
             }
             if (flags & SDL_COPY_MODULATE_ALPHA) {
                 srcA = (srcA * modulateA) / 255;
+                if (flags & SDL_COPY_PREMULTIPLIED) {
+                    /* The colour already carries the alpha, so it fades too */
+                    srcR = (srcR * modulateA) / 255;
+                    srcG = (srcG * modulateA) / 255;
+                    srcB = (srcB * modulateA) / 255;
+                }
             }
             if (flags & (SDL_COPY_BLEND | SDL_COPY_ADD)) {
-                /* This goes away if we ever use premultiplied alpha */
+                /* SDL_BLENDMODE_PREMULTIPLIED skips this */
                 if (srcA < 255) {
                     srcR = (srcR * srcA) / 255;
                     srcG = (srcG * srcA) / 255;
@@ -119,7 +125,7 @@ SDL_Blit_Slow(SDL_BlitInfo * info)
             }
             switch (flags &
                     (SDL_COPY_MASK | SDL_COPY_BLEND | SDL_COPY_ADD |
-                     SDL_COPY_MOD)) {
+                     SDL_COPY_MOD | SDL_COPY_PREMULTIPLIED)) {
             case 0:
                 dstR = srcR;
                 dstG = srcG;
@@ -138,6 +144,18 @@ SDL_Blit_Slow(SDL_BlitInfo * info)
                 dstG = srcG + ((255 - srcA) * dstG) / 255;
                 dstB = srcB + ((255 - srcA) * dstB) / 255;
                 break;
+            case SDL_COPY_PREMULTIPLIED:
+                dstR = srcR + ((255 - srcA) * dstR) / 255;
+                if (dstR > 255)
+                    dstR = 255;
+                dstG = srcG + ((255 - srcA) * dstG) / 255;
+                if (dstG > 255)
+                    dstG = 255;
+                dstB = srcB + ((255 - srcA) * dstB) / 255;
+                if (dstB > 255)
+                    dstB = 255;
+                dstA = srcA + ((255 - srcA) * dstA) / 255;
+                break;
             case SDL_COPY_ADD:
                 dstR = srcR + dstR;
                 if (dstR > 255)
@@ -25,6 +25,8 @@
 
 /* This code assumes that r, g, b, a are the source color,
  * and in the blend and add case, the RGB values are premultiplied by a.
+ * SDL_BLENDMODE_PREMULTIPLIED draws with the blend macros and a color
+ * the caller has already premultiplied.
  */
 
 #define DRAW_MUL(_a, _b) (((unsigned)(_a)*(_b))/255)
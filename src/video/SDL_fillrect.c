@@ -314,6 +314,7 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
 {
     SDL_Rect clipped;
     Uint8 *pixels;
+    int locked = 0;
 
     if (!dst) {
         SDL_SetError("Passed NULL destination surface");
@@ -337,8 +338,19 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
         rect = &dst->clip_rect;
     }
 
+    /* RLE encodings of the surface have to be redone after drawing */
+    if (SDL_MUSTLOCK(dst)) {
+        if (SDL_LockSurface(dst) < 0) {
+            return (-1);
+        }
+        locked = 1;
+    }
+
     /* Perform software fill */
     if (!dst->pixels) {
+        if (locked) {
+            SDL_UnlockSurface(dst);
+        }
         SDL_SetError("SDL_FillRect(): You must lock the surface");
         return (-1);
     }
@@ -412,6 +424,10 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
         }
     }
 
+    if (locked) {
+        SDL_UnlockSurface(dst);
+    }
+
     /* We're done! */
     return 0;
 }
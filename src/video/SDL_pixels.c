@@ -869,9 +869,23 @@ SDL_AllocBlitMap(void)
     return (map);
 }
 
+static void
+SDL_FreeBlitMapEntry(SDL_BlitMapEntry * entry)
+{
+    if (entry->table) {
+        SDL_free(entry->table);
+    }
+    if (entry->rle_flags && entry->data) {
+        SDL_free(entry->data);
+    }
+    SDL_zerop(entry);
+}
+
 void
 SDL_InvalidateMap(SDL_BlitMap * map)
 {
+    int i;
+
     if (!map) {
         return;
     }
@@ -881,6 +895,77 @@ SDL_InvalidateMap(SDL_BlitMap * map)
         SDL_free(map->info.table);
         map->info.table = NULL;
     }
+    for (i = 0; i < SDL_BLITMAP_CACHE_SIZE; ++i) {
+        SDL_FreeBlitMapEntry(&map->cache[i]);
+    }
+}
+
+/*
+ * Drop the RLE encodings kept for other destinations, they go stale
+ * as soon as the pixels are written to
+ */
+void
+SDL_InvalidateMapRLE(SDL_BlitMap * map)
+{
+    int i;
+
+    for (i = 0; i < SDL_BLITMAP_CACHE_SIZE; ++i) {
+        if (map->cache[i].rle_flags) {
+            SDL_FreeBlitMapEntry(&map->cache[i]);
+        }
+    }
+}
+
+/* Move the current mapping of a surface into a cache entry */
+static int
+SDL_SaveMapping(SDL_Surface * src, SDL_BlitMapEntry * entry)
+{
+    SDL_BlitMap *map = src->map;
+    int rle_flags =
+        map->info.flags & (SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY);
+
+    /* Other destinations need the pixels, but the encoding is kept */
+    if (rle_flags && SDL_RestoreRLEPixels(src) < 0) {
+        return -1;
+    }
+
+    entry->dst = map->dst;
+    entry->format_version = map->format_version;
+    entry->identity = map->identity;
+    entry->blit = map->blit;
+    entry->data = map->data;
+    entry->table = map->info.table;
+    entry->rle_flags = rle_flags;
+
+    map->dst = NULL;
+    map->format_version = (unsigned int) -1;
+    map->data = NULL;
+    map->info.table = NULL;
+    map->info.flags &= ~rle_flags;
+    return 0;
+}
+
+/* Make a cached mapping the current one again */
+static void
+SDL_LoadMapping(SDL_Surface * src, SDL_BlitMapEntry * entry)
+{
+    SDL_BlitMap *map = src->map;
+    SDL_Surface *dst = entry->dst;
+
+    map->dst = dst;
+    map->format_version = entry->format_version;
+    map->identity = entry->identity;
+    map->blit = entry->blit;
+    map->data = entry->data;
+    map->info.table = entry->table;
+    map->info.src_fmt = src->format;
+    map->info.src_pitch = src->pitch;
+    map->info.dst_fmt = dst->format;
+    map->info.dst_pitch = dst->pitch;
+    if (entry->rle_flags) {
+        map->info.flags |= entry->rle_flags;
+        src->flags |= SDL_RLEACCEL;
+    }
 }
 
 int
@@ -889,13 +974,61 @@ SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst)
     SDL_PixelFormat *srcfmt;
     SDL_PixelFormat *dstfmt;
     SDL_BlitMap *map;
+    SDL_BlitMapEntry *entry;
+    SDL_BlitMapEntry cached;
+    int i;
 
-    /* Clear out any previous mapping */
+    /* See if we've mapped to this destination before */
     map = src->map;
-    if ((src->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
+    entry = NULL;
+    SDL_zero(cached);
+    for (i = 0; i < SDL_BLITMAP_CACHE_SIZE; ++i) {
+        if (map->cache[i].dst == dst &&
+            map->cache[i].format_version == dst->format_version) {
+            entry = &map->cache[i];
+            cached = *entry;
+            SDL_zerop(entry);
+            break;
+        }
+    }
+
+    /* Keep the current mapping, it's likely to be used again */
+    if (map->dst) {
+        if (!entry) {
+            entry = &map->cache[map->cache_next];
+            map->cache_next = (map->cache_next + 1) % SDL_BLITMAP_CACHE_SIZE;
+            SDL_FreeBlitMapEntry(entry);
+        }
+        if (SDL_SaveMapping(src, entry) < 0) {
+            SDL_FreeBlitMapEntry(&cached);
+            return (-1);
+        }
+    }
+    if (cached.dst) {
+        SDL_LoadMapping(src, &cached);
+        return (0);
+    }
+
+    /* Clear out any previous mapping */
+    if (map->info.flags & (SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY)) {
         SDL_UnRLESurface(src, 1);
     }
-    SDL_InvalidateMap(map);
+    map->dst = NULL;
+    map->format_version = (unsigned int) -1;
+    if (map->info.table) {
+        SDL_free(map->info.table);
+        map->info.table = NULL;
+    }
+
+    /* Nothing is RLE encoded any more if no cached mapping is */
+    for (i = 0; i < SDL_BLITMAP_CACHE_SIZE; ++i) {
+        if (map->cache[i].rle_flags) {
+            break;
+        }
+    }
+    if (i == SDL_BLITMAP_CACHE_SIZE) {
+        src->flags &= ~SDL_RLEACCEL;
+    }
 
     /* Figure out what kind of mapping we're doing */
     map->identity = 0;
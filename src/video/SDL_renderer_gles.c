@@ -111,7 +111,8 @@ SDL_RenderDriver GL_ES_RenderDriver = {
      (SDL_TEXTUREMODULATE_NONE | SDL_TEXTUREMODULATE_COLOR |
       SDL_TEXTUREMODULATE_ALPHA),
      (SDL_BLENDMODE_NONE | SDL_BLENDMODE_MASK |
-      SDL_BLENDMODE_BLEND | SDL_BLENDMODE_ADD | SDL_BLENDMODE_MOD),
+      SDL_BLENDMODE_BLEND | SDL_BLENDMODE_ADD | SDL_BLENDMODE_MOD |
+      SDL_BLENDMODE_PREMULTIPLIED),
      (SDL_SCALEMODE_NONE | SDL_SCALEMODE_FAST | SDL_SCALEMODE_SLOW), 6,
      {
       /* OpenGL ES 1.x supported formats list */
@@ -523,6 +524,7 @@ GLES_SetTextureBlendMode(SDL_Renderer * renderer, SDL_Texture * texture)
     case SDL_BLENDMODE_BLEND:
     case SDL_BLENDMODE_ADD:
     case SDL_BLENDMODE_MOD:
+    case SDL_BLENDMODE_PREMULTIPLIED:
         return 0;
     default:
         SDL_Unsupported();
@@ -641,6 +643,11 @@ GLES_SetBlendMode(GLES_RenderData * data, int blendMode, int isprimitive)
             data->glEnable(GL_BLEND);
             data->glBlendFunc(GL_ZERO, GL_SRC_COLOR);
             break;
+        case SDL_BLENDMODE_PREMULTIPLIED:
+            data->glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+            data->glEnable(GL_BLEND);
+            data->glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            break;
         }
         data->blendMode = blendMode;
     }
@@ -849,7 +856,14 @@ GLES_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
 
     data->glBindTexture(texturedata->type, texturedata->texture);
 
-    if (texture->modMode) {
+    if (texture->modMode &&
+        texture->blendMode == SDL_BLENDMODE_PREMULTIPLIED) {
+        /* The texels already carry their alpha, so they fade with it too */
+        const GLfloat a = (GLfloat) texture->a * inv255f;
+        data->glColor4f((GLfloat) texture->r * inv255f * a,
+                        (GLfloat) texture->g * inv255f * a,
+                        (GLfloat) texture->b * inv255f * a, a);
+    } else if (texture->modMode) {
         data->glColor4f((GLfloat) texture->r * inv255f,
                         (GLfloat) texture->g * inv255f,
                         (GLfloat) texture->b * inv255f,
@@ -89,7 +89,8 @@ SDL_RenderDriver SW_RenderDriver = {
      (SDL_TEXTUREMODULATE_NONE | SDL_TEXTUREMODULATE_COLOR |
       SDL_TEXTUREMODULATE_ALPHA),
      (SDL_BLENDMODE_NONE | SDL_BLENDMODE_MASK |
-      SDL_BLENDMODE_BLEND | SDL_BLENDMODE_ADD | SDL_BLENDMODE_MOD),
+      SDL_BLENDMODE_BLEND | SDL_BLENDMODE_ADD | SDL_BLENDMODE_MOD |
+      SDL_BLENDMODE_PREMULTIPLIED),
      (SDL_SCALEMODE_NONE | SDL_SCALEMODE_FAST),
      14,
      {
@@ -25,6 +25,7 @@
 #include "SDL_compat.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
+#include "SDL_alphamult.h"
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
 #include "SDL_leaks.h"
@@ -449,7 +450,8 @@ SDL_SetSurfaceBlendMode(SDL_Surface * surface, SDL_BlendMode blendMode)
     status = 0;
     flags = surface->map->info.flags;
     surface->map->info.flags &=
-        ~(SDL_COPY_MASK | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD);
+        ~(SDL_COPY_MASK | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD |
+          SDL_COPY_PREMULTIPLIED);
     switch (blendMode) {
     case SDL_BLENDMODE_NONE:
         break;
@@ -465,6 +467,9 @@ SDL_SetSurfaceBlendMode(SDL_Surface * surface, SDL_BlendMode blendMode)
     case SDL_BLENDMODE_MOD:
         surface->map->info.flags |= SDL_COPY_MOD;
         break;
+    case SDL_BLENDMODE_PREMULTIPLIED:
+        surface->map->info.flags |= SDL_COPY_PREMULTIPLIED;
+        break;
     default:
         SDL_Unsupported();
         status = -1;
@@ -498,7 +503,7 @@ SDL_GetSurfaceBlendMode(SDL_Surface * surface, SDL_BlendMode *blendMode)
 
     switch (surface->map->
             info.flags & (SDL_COPY_MASK | SDL_COPY_BLEND | SDL_COPY_ADD |
-                          SDL_COPY_MOD)) {
+                          SDL_COPY_MOD | SDL_COPY_PREMULTIPLIED)) {
     case SDL_COPY_MASK:
         *blendMode = SDL_BLENDMODE_MASK;
         break;
@@ -511,6 +516,9 @@ SDL_GetSurfaceBlendMode(SDL_Surface * surface, SDL_BlendMode *blendMode)
     case SDL_COPY_MOD:
         *blendMode = SDL_BLENDMODE_MOD;
         break;
+    case SDL_COPY_PREMULTIPLIED:
+        *blendMode = SDL_BLENDMODE_PREMULTIPLIED;
+        break;
     default:
         *blendMode = SDL_BLENDMODE_NONE;
         break;
@@ -518,6 +526,74 @@ SDL_GetSurfaceBlendMode(SDL_Surface * surface, SDL_BlendMode *blendMode)
     return 0;
 }
 
+int
+SDL_PremultiplySurfaceAlpha(SDL_Surface * surface)
+{
+    SDL_PixelFormat *fmt;
+
+    if (!surface) {
+        return -1;
+    }
+
+    /* The blend mode is all that records the pixels were converted */
+    if (surface->map->info.flags & SDL_COPY_PREMULTIPLIED) {
+        return 0;
+    }
+
+    fmt = surface->format;
+    if (fmt->Amask && fmt->BytesPerPixel >= 2) {
+        if (SDL_LockSurface(surface) < 0) {
+            return -1;
+        }
+        switch (SDL_MasksToPixelFormatEnum(fmt->BitsPerPixel, fmt->Rmask,
+                                           fmt->Gmask, fmt->Bmask,
+                                           fmt->Amask)) {
+        case SDL_PIXELFORMAT_ARGB8888:
+            SDL_PreMultiplyAlphaARGB8888(surface->w, surface->h,
+                                         surface->pixels, surface->pitch);
+            break;
+        case SDL_PIXELFORMAT_RGBA8888:
+            SDL_PreMultiplyAlphaRGBA8888(surface->w, surface->h,
+                                         surface->pixels, surface->pitch);
+            break;
+        case SDL_PIXELFORMAT_ABGR8888:
+            SDL_PreMultiplyAlphaABGR8888(surface->w, surface->h,
+                                         surface->pixels, surface->pitch);
+            break;
+        case SDL_PIXELFORMAT_BGRA8888:
+            SDL_PreMultiplyAlphaBGRA8888(surface->w, surface->h,
+                                         surface->pixels, surface->pitch);
+            break;
+        default:
+            {
+                const int bpp = fmt->BytesPerPixel;
+                Uint8 *row = (Uint8 *) surface->pixels;
+                int x, y;
+
+                for (y = 0; y < surface->h; ++y) {
+                    Uint8 *pixel = row;
+                    for (x = 0; x < surface->w; ++x) {
+                        Uint32 value;
+                        unsigned r, g, b, a;
+
+                        DISEMBLE_RGBA(pixel, bpp, fmt, value, r, g, b, a);
+                        r = (r * a) / 255;
+                        g = (g * a) / 255;
+                        b = (b * a) / 255;
+                        ASSEMBLE_RGBA(pixel, bpp, fmt, r, g, b, a);
+                        pixel += bpp;
+                    }
+                    row += surface->pitch;
+                }
+            }
+            break;
+        }
+        SDL_UnlockSurface(surface);
+    }
+
+    return SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_PREMULTIPLIED);
+}
+
 int
 SDL_SetSurfaceScaleMode(SDL_Surface * surface, SDL_ScaleMode scaleMode)
 {
@@ -639,29 +715,17 @@ SDL_LowerBlit(SDL_Surface * src, SDL_Rect * srcrect,
 }
 
 
-int
-SDL_UpperBlit(SDL_Surface * src, const SDL_Rect * srcrect,
-              SDL_Surface * dst, SDL_Rect * dstrect)
+/*
+ * Clip a blit against the source surface and the destination clip
+ * rectangle.  The destination rectangle is updated, the source one is
+ * returned in 'sr'.  Returns 0 if nothing is left to blit.
+ */
+static __inline__ int
+SDL_ClipBlit(SDL_Surface * src, const SDL_Rect * srcrect,
+             SDL_Surface * dst, SDL_Rect * dstrect, SDL_Rect * sr)
 {
-    SDL_Rect fulldst;
     int srcx, srcy, w, h;
 
-    /* Make sure the surfaces aren't locked */
-    if (!src || !dst) {
-        SDL_SetError("SDL_UpperBlit: passed a NULL surface");
-        return (-1);
-    }
-    if (src->locked || dst->locked) {
-        SDL_SetError("Surfaces must not be locked during blit");
-        return (-1);
-    }
-
-    /* If the destination rectangle is NULL, use the entire dest surface */
-    if (dstrect == NULL) {
-        fulldst.x = fulldst.y = 0;
-        dstrect = &fulldst;
-    }
-
     /* clip the source rectangle to the source surface */
     if (srcrect) {
         int maxw, maxh;
@@ -721,17 +785,109 @@ SDL_UpperBlit(SDL_Surface * src, const SDL_Rect * srcrect,
     }
 
     if (w > 0 && h > 0) {
-        SDL_Rect sr;
-        sr.x = srcx;
-        sr.y = srcy;
-        sr.w = dstrect->w = w;
-        sr.h = dstrect->h = h;
-        return SDL_LowerBlit(src, &sr, dst, dstrect);
+        sr->x = srcx;
+        sr->y = srcy;
+        sr->w = dstrect->w = w;
+        sr->h = dstrect->h = h;
+        return 1;
     }
     dstrect->w = dstrect->h = 0;
     return 0;
 }
 
+int
+SDL_UpperBlit(SDL_Surface * src, const SDL_Rect * srcrect,
+              SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    SDL_Rect fulldst;
+    SDL_Rect sr;
+
+    /* Make sure the surfaces aren't locked */
+    if (!src || !dst) {
+        SDL_SetError("SDL_UpperBlit: passed a NULL surface");
+        return (-1);
+    }
+    if (src->locked || dst->locked) {
+        SDL_SetError("Surfaces must not be locked during blit");
+        return (-1);
+    }
+
+    /* If the destination rectangle is NULL, use the entire dest surface */
+    if (dstrect == NULL) {
+        fulldst.x = fulldst.y = 0;
+        dstrect = &fulldst;
+    }
+
+    if (SDL_ClipBlit(src, srcrect, dst, dstrect, &sr)) {
+        return SDL_LowerBlit(src, &sr, dst, dstrect);
+    }
+    return 0;
+}
+
+int
+SDL_UpperBlits(SDL_Surface ** srcs, const SDL_Rect ** srcrects,
+               SDL_Surface * dst, SDL_Rect ** dstrects, int count)
+{
+    SDL_Rect fulldst;
+    SDL_Rect sr;
+    int dst_locked;
+    int status = 0;
+    int i;
+
+    /* Make sure the surfaces aren't locked, all at once */
+    if (!srcs || !dst) {
+        SDL_SetError("SDL_UpperBlits: passed a NULL surface");
+        return (-1);
+    }
+    if (dst->locked) {
+        SDL_SetError("Surfaces must not be locked during blit");
+        return (-1);
+    }
+    dst_locked = SDL_MUSTLOCK(dst);
+    for (i = 0; i < count; ++i) {
+        if (!srcs[i]) {
+            SDL_SetError("SDL_UpperBlits: passed a NULL surface");
+            return (-1);
+        }
+        if (srcs[i]->locked) {
+            SDL_SetError("Surfaces must not be locked during blit");
+            return (-1);
+        }
+        /* Blitting within the destination needs it unlocked to map it */
+        if (srcs[i] == dst) {
+            dst_locked = 0;
+        }
+    }
+
+    /* Lock the destination once, instead of around every blit, so an
+       RLE encoded one isn't decoded and encoded again each time. The
+       sources are left to SDL_LowerBlit(): locking an RLE one here would
+       decode it before it's mapped, and grouping the blits by source
+       would change which one ends up on top. */
+    if (dst_locked && SDL_LockSurface(dst) < 0) {
+        return (-1);
+    }
+
+    for (i = 0; i < count; ++i) {
+        SDL_Rect *dstrect = dstrects ? dstrects[i] : NULL;
+
+        if (dstrect == NULL) {
+            fulldst.x = fulldst.y = 0;
+            dstrect = &fulldst;
+        }
+        if (SDL_ClipBlit(srcs[i], srcrects ? srcrects[i] : NULL,
+                         dst, dstrect, &sr) &&
+            SDL_LowerBlit(srcs[i], &sr, dst, dstrect) < 0) {
+            status = -1;
+        }
+    }
+
+    if (dst_locked) {
+        SDL_UnlockSurface(dst);
+    }
+    return status;
+}
+
 /*
  * Lock a surface to directly access the pixels
  */
@@ -849,9 +1005,11 @@ SDL_ConvertSurface(SDL_Surface * surface, SDL_PixelFormat * format,
     SDL_SetClipRect(convert, &surface->clip_rect);
 
     /* Enable alpha blending by default if the new surface has an
-     * alpha channel or alpha modulation */
-    if ((surface->format->Amask && format->Amask) ||
-        (copy_flags & (SDL_COPY_COLORKEY|SDL_COPY_MODULATE_ALPHA))) {
+     * alpha channel or alpha modulation, unless the pixels were
+     * premultiplied, which the copy above kept as they were */
+    if (!(copy_flags & SDL_COPY_PREMULTIPLIED) &&
+        ((surface->format->Amask && format->Amask) ||
+         (copy_flags & (SDL_COPY_COLORKEY|SDL_COPY_MODULATE_ALPHA)))) {
         SDL_SetSurfaceBlendMode(convert, SDL_BLENDMODE_BLEND);
     }
     if ((copy_flags & SDL_COPY_RLE_DESIRED) || (flags & SDL_RLEACCEL)) {
@@ -35,16 +35,17 @@
 static void eventHandle(u64 status, u64 param, void * userdata) {
     _THIS = userdata;
     if(status == EVENT_REQUEST_EXITAPP){
-	printf("Quit game requested\n");
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "RequestExitApp", 0, 0);
 	SDL_SendQuit();
     }else if(status == EVENT_MENU_OPEN){
 	//xmb opened, should prob pause game or something :P
+	PSL1GHT_TraceDump();
     }else if(status == EVENT_MENU_CLOSE){
 	//xmb closed, and then resume
     }else if(status == EVENT_DRAWING_BEGIN){
     }else if(status == EVENT_DRAWING_END){
     }else{
-	printf("Unhandled event: %08llX\n", (unsigned long long int)status);
+	PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "UnhandledSysEvent", status, param);
     }
 }
 
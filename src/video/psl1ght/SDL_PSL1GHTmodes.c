@@ -23,17 +23,72 @@
 
 #include "SDL_PSL1GHTvideo.h"
 #include "../SDL_sysvideo.h"
-#include "SDL_timer.h"
+#include "SDL_mutex.h"
 
 #include <rsx/reality.h>
 #include <sysutil/video.h>
 
 #include <assert.h>
 
+/* Vblanks to wait for the output to come back after videoConfigure() */
+#define PSL1GHT_MODE_SWITCH_VBLANKS 60
+
+/* Posted once per vblank while a mode switch is waited on */
+static SDL_sem *vblank_sem = NULL;
+
+static void vblankHandler(const u32 head)
+{
+    SDL_SemPost(vblank_sem);
+}
+
+/*
+ * Reconfigure the output and sleep until it is enabled again. The state
+ * is checked on each vblank instead of polling on a timer, so the caller
+ * gets the display back on the first frame it is usable.
+ */
+static int
+PSL1GHT_ConfigureDisplay(VideoConfiguration *vconfig)
+{
+    VideoState state;
+    int vblanks;
+
+    vblank_sem = SDL_CreateSemaphore(0);
+    if (!vblank_sem) {
+        return -1;
+    }
+    gcmSetVBlankHandler(vblankHandler);
+
+    if (videoConfigure(0, vconfig, NULL, 0) != 0) {
+        gcmSetVBlankHandler(NULL);
+        SDL_DestroySemaphore(vblank_sem);
+        vblank_sem = NULL;
+        SDL_SetError("Could not set PS3FB_MODE");
+        return -1;
+    }
+    for (vblanks = 0; vblanks < PSL1GHT_MODE_SWITCH_VBLANKS; ++vblanks) {
+        if (videoGetState(0, 0, &state) != 0 || state.state != 3) {
+            break;
+        }
+        // A missing vblank is no reason to hang: check again anyway
+        SDL_SemWaitTimeout(vblank_sem, 100);
+    }
+
+    gcmSetVBlankHandler(NULL);
+    SDL_DestroySemaphore(vblank_sem);
+    vblank_sem = NULL;
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "ConfigureDisplay",
+                  vconfig->resolution, vblanks);
+
+    if (vblanks == PSL1GHT_MODE_SWITCH_VBLANKS || state.state != 0) {
+        SDL_SetError("Display did not come back after a mode switch");
+        return -1;
+    }
+    return 0;
+}
+
 void
 PSL1GHT_InitModes(_THIS)
 {
-    deprintf(1, "+PSL1GHT_InitModes()\n");
     SDL_DisplayMode mode;
     PSL1GHT_DisplayModeData *modedata;
     VideoState state;
@@ -42,6 +97,7 @@ PSL1GHT_InitModes(_THIS)
     if (!modedata) {
         return;
     }
+    SDL_zerop(modedata);
 
     assert(videoGetState(0, 0, &state) == 0); // Get the state of the display
     assert(state.state == 0); // Make sure display is enabled
@@ -62,18 +118,14 @@ PSL1GHT_InitModes(_THIS)
     mode.driverdata = modedata;
 
     /* Setup the display to it's  default mode */
-    assert(videoConfigure(0, &modedata->vconfig, NULL, 1) == 0);
-
-	// Wait until RSX is ready
-	do{
-		SDL_Delay(10);
-		assert( videoGetState(0, 0, &state) == 0);
-	}while ( state.state == 3);
+    if (PSL1GHT_ConfigureDisplay(&modedata->vconfig) != 0) {
+        SDL_free(modedata);
+        return;
+    }
 
     /* Set display's videomode and add it */
     SDL_AddBasicVideoDisplay(&mode);
-
-    deprintf(1, "-PSL1GHT_InitModes()\n");
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "InitModes", mode.w, mode.h);
 }
 
 /* DisplayModes available on the PS3 */
@@ -113,7 +165,6 @@ static PSL1GHT_DisplayModeData ps3fb_data[] = {
 void
 PSL1GHT_GetDisplayModes(_THIS, SDL_VideoDisplay * display)
 {
-    deprintf(1, "+PSL1GHT_GetDisplayModes()\n");
     unsigned int nummodes;
 
     nummodes = sizeof(ps3fb_modedb) / sizeof(SDL_DisplayMode);
@@ -124,43 +175,36 @@ PSL1GHT_GetDisplayModes(_THIS, SDL_VideoDisplay * display)
         ps3fb_modedb[n].driverdata = &ps3fb_data[n];
 
         /* Add DisplayMode to list */
-        deprintf(2, "Adding resolution %u x %u\n", ps3fb_modedb[n].w, ps3fb_modedb[n].h);
+        PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "AddDisplayMode",
+                      ps3fb_modedb[n].w, ps3fb_modedb[n].h);
         SDL_AddDisplayMode(display, &ps3fb_modedb[n]);
     }
-    deprintf(1, "-PSL1GHT_GetDisplayModes()\n");
 }
 
 int
 PSL1GHT_SetDisplayMode(_THIS, SDL_VideoDisplay * display, SDL_DisplayMode * mode)
 {
-    deprintf(1, "+PSL1GHT_SetDisplayMode()\n");
     PSL1GHT_DisplayModeData *dispdata = (PSL1GHT_DisplayModeData *) mode->driverdata;
 	VideoState state;
 
-    /* Set the new DisplayMode */
-    deprintf(2, "Setting PS3_MODE to %u\n", dispdata->vconfig.resolution);
-    if ( videoConfigure(0, &dispdata->vconfig, NULL, 0) != 0)
-	{
-        deprintf(2, "Could not set PS3FB_MODE\n");
-        SDL_SetError("Could not set PS3FB_MODE\n");
-        return -1;
+    /* The desktop mode and its ps3fb_modedb twin are the same output:
+       don't make the TV resync for nothing */
+    if (videoGetState(0, 0, &state) == 0 && state.state == 0 &&
+        state.displayMode.resolution == dispdata->vconfig.resolution) {
+        PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "SetDisplayMode",
+                      dispdata->vconfig.resolution, 1);
+        return 0;
     }
 
-	// Wait until RSX is ready
-	do{
-		SDL_Delay(10);
-		assert( videoGetState(0, 0, &state) == 0);
-	}while ( state.state == 3);
-
-    deprintf(1, "-PSL1GHT_SetDisplayMode()\n");
-    return 0;
+    /* Set the new DisplayMode */
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "SetDisplayMode",
+                  dispdata->vconfig.resolution, 0);
+    return PSL1GHT_ConfigureDisplay(&dispdata->vconfig);
 }
 
 void
 PSL1GHT_QuitModes(_THIS)
 {
-    deprintf(1, "+PSL1GHT_QuitModes()\n");
-
     /* There was no mem allocated for driverdata */
     int i, j;
     for (i = 0; i < SDL_GetNumVideoDisplays(); ++i) {
@@ -169,8 +213,6 @@ PSL1GHT_QuitModes(_THIS)
             display->display_modes[j].driverdata = NULL;
         }
     }
-
-    deprintf(1, "-PSL1GHT_QuitModes()\n");
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -22,14 +22,14 @@
 #include "SDL_config.h"
 
 #include "SDL_video.h"
+#include "SDL_thread.h"
 #include "../SDL_sysvideo.h"
 #include "../SDL_yuv_sw_c.h"
-#include "../SDL_renderer_sw.h"
 
 #include "SDL_PSL1GHTvideo.h"
+#include "SDL_PSL1GHTrsx_c.h"
 
 #include <rsx/reality.h>
-#include <unistd.h>
 #include <assert.h>
 
 
@@ -60,6 +60,20 @@ static int SDL_PSL1GHT_RenderWritePixels(SDL_Renderer * renderer,
 static void SDL_PSL1GHT_RenderPresent(SDL_Renderer * renderer);
 static void SDL_PSL1GHT_DestroyRenderer(SDL_Renderer * renderer);
 
+/* Texture */
+static int PSL1GHT_CreateTexture(SDL_Renderer * renderer, SDL_Texture * texture);
+static int PSL1GHT_QueryTexturePixels(SDL_Renderer * renderer, SDL_Texture * texture, void **pixels, int *pitch);
+static int PSL1GHT_SetTexturePalette(SDL_Renderer * renderer, SDL_Texture * texture, const SDL_Color * colors, int firstcolor, int ncolors);
+static int PSL1GHT_GetTexturePalette(SDL_Renderer * renderer, SDL_Texture * texture, SDL_Color * colors, int firstcolor, int ncolors);
+static int PSL1GHT_SetTextureColorMod(SDL_Renderer * renderer, SDL_Texture * texture);
+static int PSL1GHT_SetTextureAlphaMod(SDL_Renderer * renderer, SDL_Texture * texture);
+static int PSL1GHT_SetTextureBlendMode(SDL_Renderer * renderer, SDL_Texture * texture);
+static int PSL1GHT_SetTextureScaleMode(SDL_Renderer * renderer, SDL_Texture * texture);
+static int PSL1GHT_UpdateTexture(SDL_Renderer * renderer, SDL_Texture * texture, const SDL_Rect * rect, const void *pixels, int pitch);
+static int PSL1GHT_LockTexture(SDL_Renderer * renderer, SDL_Texture * texture, const SDL_Rect * rect, int markDirty, void **pixels, int *pitch);
+static void PSL1GHT_UnlockTexture(SDL_Renderer * renderer, SDL_Texture * texture);
+static void PSL1GHT_DestroyTexture(SDL_Renderer * renderer, SDL_Texture * texture);
+
 
 SDL_RenderDriver SDL_PSL1GHT_RenderDriver = {
     SDL_PSL1GHT_CreateRenderer,
@@ -70,31 +84,312 @@ SDL_RenderDriver SDL_PSL1GHT_RenderDriver = {
          SDL_RENDERER_PRESENTVSYNC |
          SDL_RENDERER_PRESENTCOPY |
          SDL_RENDERER_PRESENTFLIP2 | 
-//         SDL_RENDERER_PRESENTFLIP3 |
-         SDL_RENDERER_PRESENTDISCARD
+         SDL_RENDERER_PRESENTFLIP3 |
+         SDL_RENDERER_PRESENTDISCARD |
+         SDL_RENDERER_ACCELERATED
         ),
+        (SDL_TEXTUREMODULATE_NONE | SDL_TEXTUREMODULATE_COLOR |
+         SDL_TEXTUREMODULATE_ALPHA),
+        (SDL_BLENDMODE_NONE | SDL_BLENDMODE_MASK |
+         SDL_BLENDMODE_BLEND | SDL_BLENDMODE_ADD | SDL_BLENDMODE_MOD |
+         SDL_BLENDMODE_PREMULTIPLIED),
+        /* The RSX filters linearly, the CPU path samples the nearest */
+        (SDL_SCALEMODE_NONE | SDL_SCALEMODE_FAST | SDL_SCALEMODE_SLOW),
+        14,
+        {
+         /* Blitted by the RSX */
+         SDL_PIXELFORMAT_ARGB8888,
+         SDL_PIXELFORMAT_RGB888,
+         SDL_PIXELFORMAT_RGB565,
+         /* Blitted by the CPU, straight out of RSX memory */
+         SDL_PIXELFORMAT_INDEX8,
+         SDL_PIXELFORMAT_RGB555,
+         SDL_PIXELFORMAT_BGR888,
+         SDL_PIXELFORMAT_RGBA8888,
+         SDL_PIXELFORMAT_ABGR8888,
+         SDL_PIXELFORMAT_BGRA8888,
+         SDL_PIXELFORMAT_YV12,
+         SDL_PIXELFORMAT_IYUV,
+         SDL_PIXELFORMAT_YUY2,
+         SDL_PIXELFORMAT_UYVY,
+         SDL_PIXELFORMAT_YVYU},
+        4096,
+        4096
     }
 };
 
 typedef struct
 {
     int current_screen;
+    int num_screens;
+    Uint32 flips_queued;    // Flips handed to the RSX so far
+    Uint32 flips_done;      // Flips we have seen completing
+    SDL_sem *flip_sem;      // Posted once per completed flip
     SDL_Surface *screens[3];
+    u32 offsets[3];         // RSX offsets of the screens
+    SDL_Surface *logical;   // Drawn into instead of the screens, or NULL
+    u32 logical_offset;     // RSX offset of the logical screen
+    SDL_Rect viewport;      // Where Present scales the logical screen to
+    int rsx_screen;         // Screen the 2D engine draws into, or -1
+    int rsx_pending;        // RSX commands queued since the last sync
+    Uint32 reference;       // Last value passed to the ref register
+    Uint8 *swatches;        // Ring of fill colours the 2D engine reads
+    u32 swatches_offset;    // RSX offset of the ring
+    int swatch;             // Next free swatch in the ring
+    int fill_ready;         // The 2D engine is set up to fill with...
+    Uint32 fill_color;      // ...this ARGB colour...
+    Uint32 fill_operation;  // ...and this operation
     gcmContextData *context; // Context to keep track of the RSX buffer.    
+    SDL_VideoDevice *device; // Owner of the SPE pool
 } SDL_PSL1GHT_RenderData;
 
-static void flip( gcmContextData *context, int current_screen)
+typedef struct
+{
+    void *pixels;           // RSX local memory
+    SDL_Surface *surface;   // Wraps pixels for the CPU blitters
+    PSL1GHT_RSXImage image; // Format is zero when the RSX can't read it
+    SDL_SW_YUVTexture *yuv; // YUV is converted on the SPEs or the PPU
+} PSL1GHT_TextureData;
+
+/* Fill colours are 1x1 images; a swatch is only reused after a sync */
+#define PSL1GHT_SWATCHES        1024
+#define PSL1GHT_SWATCH_PITCH    64
+
+/* rsx_screen value while the 2D engine draws into the logical screen */
+#define PSL1GHT_LOGICAL_SCREEN  3
+
+/*
+ * GCM has a single flip handler and passes it no context, so completed
+ * flips are reported to the renderer that owns the flip chain.
+ */
+static SDL_PSL1GHT_RenderData *flip_owner = NULL;
+
+static void flipHandler(const u32 head)
+{
+    SDL_PSL1GHT_RenderData *data = flip_owner;
+
+    if (data) {
+        SDL_SemPost(data->flip_sem);
+    }
+}
+
+static int flip( gcmContextData *context, int current_screen)
 {
-    assert(gcmSetFlip(context, current_screen) == 0);
+    // Only one flip can be latched: the RSX holds this one until the
+    // previous flip is done, but the draws queued after it run at once.
+    gcmSetWaitFlip(context);
+    if (gcmSetFlip(context, current_screen) != 0) {
+        SDL_SetError("Couldn't queue a flip to screen %d", current_screen);
+        return -1;
+    }
     realityFlushBuffer(context);
-    gcmSetWaitFlip(context); // Prevent the RSX from continuing until the flip has finished.
+    return 0;
+}
+
+/* Sleep until no more than 'pending' flips are still queued */
+static void waitFlips(SDL_PSL1GHT_RenderData *data, Uint32 pending)
+{
+    /* A renderer that lost the flip chain hears of no more flips */
+    if (data != flip_owner) {
+        data->flips_done = data->flips_queued;
+        return;
+    }
+    while (data->flips_queued - data->flips_done > pending) {
+        SDL_SemWait(data->flip_sem);
+        ++data->flips_done;
+    }
+}
+
+/*
+ * Return the surface to draw into, once it is no longer on screen.
+ * Flip k shows screens[k % n], so the back buffer is free as soon as at
+ * most n - 2 flips are outstanding. The logical screen is never scanned
+ * out, so drawing into it doesn't wait for flips at all.
+ */
+static SDL_Surface *
+getTarget(SDL_PSL1GHT_RenderData *data)
+{
+    /* YUV conversions still running on the SPEs go in first */
+    PSL1GHT_SPEFinish(data->device);
+    if (data->logical) {
+        return data->logical;
+    }
+    waitFlips(data, data->num_screens - 2);
+    return data->screens[data->current_screen];
+}
+
+/* Wait for the RSX and the SPEs to finish the work queued so far */
+static void syncRSX(SDL_PSL1GHT_RenderData *data)
+{
+    PSL1GHT_SPEFinish(data->device);
+    if (data->rsx_pending) {
+        PSL1GHT_RSXSetReference(data->context, ++data->reference);
+        realityFlushBuffer(data->context);
+        PSL1GHT_RSXWaitReference(data->reference);
+        data->rsx_pending = 0;
+    }
+}
+
+/* The target, once the CPU may write to it */
+static SDL_Surface *
+lockTarget(SDL_PSL1GHT_RenderData *data)
+{
+    SDL_Surface *target = getTarget(data);
+
+    syncRSX(data);
+    return target;
+}
+
+/* The target, with the 2D engine pointed at it */
+static SDL_Surface *
+rsxTarget(SDL_PSL1GHT_RenderData *data)
+{
+    SDL_Surface *target = getTarget(data);
+
+    if (data->logical) {
+        if (data->rsx_screen != PSL1GHT_LOGICAL_SCREEN) {
+            PSL1GHT_RSXSetSurface(data->context, RSX_SURFACE_FORMAT_A8R8G8B8,
+                                  data->logical_offset, target->pitch);
+            data->rsx_screen = PSL1GHT_LOGICAL_SCREEN;
+        }
+    } else if (data->rsx_screen != data->current_screen) {
+        PSL1GHT_RSXSetSurface(data->context, RSX_SURFACE_FORMAT_A8R8G8B8,
+                              data->offsets[data->current_screen],
+                              target->pitch);
+        data->rsx_screen = data->current_screen;
+    }
+    return target;
+}
+
+/* A cleared surface of the display format with its pixels in RSX memory */
+static SDL_Surface *
+createRSXSurface(SDL_DisplayMode *displayMode, int w, int h, u32 *offset)
+{
+    SDL_Surface *surface;
+    int bpp;
+    Uint32 Rmask, Gmask, Bmask, Amask;
+
+    SDL_PixelFormatEnumToMasks(displayMode->format, &bpp, &Rmask, &Gmask,
+                               &Bmask, &Amask);
+    surface = SDL_CreateRGBSurface(0, w, h, bpp, Rmask, Gmask, Bmask, Amask);
+    if (!surface) {
+        return NULL;
+    }
+
+    SDL_free(surface->pixels);
+    surface->pixels = rsxMemAlign(16, surface->h * surface->pitch);
+    if (!surface->pixels ||
+        realityAddressToOffset(surface->pixels, offset) != 0) {
+        if (surface->pixels) {
+            rsxFree(surface->pixels);
+        }
+        surface->pixels = NULL;
+        SDL_FreeSurface(surface);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    SDL_memset(surface->pixels, 0, surface->h * surface->pitch);
+    return surface;
+}
+
+/*
+ * The largest rect of the logical screen's aspect ratio that fits the
+ * display, centred. What is left around it stays black.
+ */
+static void
+getViewport(int w, int h, int display_w, int display_h, SDL_Rect *viewport)
+{
+    if (w * display_h > h * display_w) {
+        viewport->w = display_w;
+        viewport->h = h * display_w / w;
+    } else {
+        viewport->w = w * display_h / h;
+        viewport->h = display_h;
+    }
+    viewport->x = (display_w - viewport->w) / 2;
+    viewport->y = (display_h - viewport->h) / 2;
+}
+
+/* Have the RSX scale the logical screen onto the screen about to flip */
+static void
+scaleLogical(SDL_PSL1GHT_RenderData *data)
+{
+    SDL_Surface *screen;
+    PSL1GHT_RSXImage image;
+    SDL_Rect srcrect;
+
+    /* The scaled copy lands in a screen, which must be off display */
+    waitFlips(data, data->num_screens - 2);
+    screen = data->screens[data->current_screen];
+    PSL1GHT_RSXSetSurface(data->context, RSX_SURFACE_FORMAT_A8R8G8B8,
+                          data->offsets[data->current_screen], screen->pitch);
+    data->rsx_screen = data->current_screen;
+
+    image.format = RSX_IMAGE_FORMAT_A8R8G8B8;
+    image.offset = data->logical_offset;
+    image.pitch = data->logical->pitch;
+    image.bpp = 4;
+    srcrect.x = srcrect.y = 0;
+    srcrect.w = data->logical->w;
+    srcrect.h = data->logical->h;
+    PSL1GHT_RSXScaledImage(data->context, &image, &srcrect, &data->viewport,
+                           RSX_OPERATION_SRCCOPY, RSX_FILTER_LINEAR);
+    data->rsx_pending = 1;
+    data->fill_ready = 0;
+}
+
+/*
+ * Set the 2D engine up to fill with an ARGB colour. Fills sharing the
+ * colour and operation go into the command buffer back to back, only a
+ * change of state hands the batch queued so far over to the RSX.
+ */
+static SDL_Surface *
+beginFill(SDL_PSL1GHT_RenderData *data, Uint32 color, Uint32 operation)
+{
+    SDL_Surface *target = rsxTarget(data);
+    PSL1GHT_RSXImage image;
+    SDL_Rect texel;
+
+    if (data->fill_ready && data->fill_color == color &&
+        data->fill_operation == operation) {
+        return target;
+    }
+    if (data->swatch == PSL1GHT_SWATCHES) {
+        /* The RSX may still be reading any of them */
+        syncRSX(data);
+        data->swatch = 0;
+    }
+    *(Uint32 *) (data->swatches + data->swatch * PSL1GHT_SWATCH_PITCH) =
+        color;
+    image.format = RSX_IMAGE_FORMAT_A8R8G8B8;
+    image.offset = data->swatches_offset +
+        data->swatch * PSL1GHT_SWATCH_PITCH;
+    image.pitch = PSL1GHT_SWATCH_PITCH;
+    image.bpp = 4;
+    ++data->swatch;
+
+    realityFlushBuffer(data->context);
+    texel.x = texel.y = 0;
+    texel.w = texel.h = 1;
+    PSL1GHT_RSXSetImage(data->context, &image, &texel, operation,
+                        RSX_FILTER_NEAREST);
+    data->fill_ready = 1;
+    data->fill_color = color;
+    data->fill_operation = operation;
+    return target;
 }
 
-static void waitFlip()
+/* Queue a fill of rect, clipped to the target, with the current colour */
+static void
+fillRect(SDL_PSL1GHT_RenderData *data, SDL_Surface *target,
+         const SDL_Rect *rect)
 {
-    while(gcmGetFlipStatus() != 0)
-      usleep(200);
-    gcmResetFlipStatus();
+    SDL_Rect clipped;
+
+    if (SDL_IntersectRect(rect, &target->clip_rect, &clipped)) {
+        PSL1GHT_RSXStretchImage(data->context, 1, 1, &clipped);
+        data->rsx_pending = 1;
+    }
 }
 
 SDL_Renderer *
@@ -104,38 +399,34 @@ SDL_PSL1GHT_CreateRenderer(SDL_Window * window, Uint32 flags)
     SDL_DisplayMode *displayMode = &display->current_mode;
     SDL_Renderer *renderer;
     SDL_PSL1GHT_RenderData *data;
-    int i, n;
+    int i, n, w, h;
     int bpp;
     Uint32 Rmask, Gmask, Bmask, Amask;
 
-    printf( "SDL_PSL1GHT_CreateRenderer( %016X, %08X)\n", (unsigned long long) window, flags);
 
     if (!SDL_PixelFormatEnumToMasks
         (displayMode->format, &bpp, &Rmask, &Gmask, &Bmask, &Amask)) {
-        printf("ERROR\n");
         SDL_SetError("Unknown display format");
         return NULL;
     }
 
     renderer = (SDL_Renderer *) SDL_calloc(1, sizeof(*renderer));
     if (!renderer) {
-        printf("ERROR\n");
         SDL_OutOfMemory();
         return NULL;
     }
 
     data = (SDL_PSL1GHT_RenderData *) SDL_malloc(sizeof(*data));
     if (!data) {
-        printf("ERROR\n");
         SDL_PSL1GHT_DestroyRenderer(renderer);
         SDL_OutOfMemory();
         return NULL;
     }
     SDL_zerop(data);
     
-    printf("\tMem allocated\n");
     // Get a copy of the command buffer
     data->context = ((SDL_DeviceData*) window->display->device->driverdata)->_CommandBuffer;
+    data->device = window->display->device;
 
     renderer->RenderDrawPoints = SDL_PSL1GHT_RenderDrawPoints;
     renderer->RenderDrawLines = SDL_PSL1GHT_RenderDrawLines;
@@ -146,100 +437,482 @@ SDL_PSL1GHT_CreateRenderer(SDL_Window * window, Uint32 flags)
     renderer->RenderWritePixels = SDL_PSL1GHT_RenderWritePixels;
     renderer->RenderPresent = SDL_PSL1GHT_RenderPresent;
     renderer->DestroyRenderer = SDL_PSL1GHT_DestroyRenderer;
-    renderer->info.name = SDL_PSL1GHT_RenderDriver.info.name;
-    renderer->info.flags = 0;
+    renderer->CreateTexture = PSL1GHT_CreateTexture;
+    renderer->QueryTexturePixels = PSL1GHT_QueryTexturePixels;
+    renderer->SetTexturePalette = PSL1GHT_SetTexturePalette;
+    renderer->GetTexturePalette = PSL1GHT_GetTexturePalette;
+    renderer->SetTextureColorMod = PSL1GHT_SetTextureColorMod;
+    renderer->SetTextureAlphaMod = PSL1GHT_SetTextureAlphaMod;
+    renderer->SetTextureBlendMode = PSL1GHT_SetTextureBlendMode;
+    renderer->SetTextureScaleMode = PSL1GHT_SetTextureScaleMode;
+    renderer->UpdateTexture = PSL1GHT_UpdateTexture;
+    renderer->LockTexture = PSL1GHT_LockTexture;
+    renderer->UnlockTexture = PSL1GHT_UnlockTexture;
+    renderer->DestroyTexture = PSL1GHT_DestroyTexture;
+    renderer->info = SDL_PSL1GHT_RenderDriver.info;
+    renderer->info.flags = SDL_RENDERER_ACCELERATED;
     renderer->window = window;
     renderer->driverdata = data;
-    printf( "\tSetup_SoftwareRenderer()\n");
-    Setup_SoftwareRenderer(renderer);
+    data->rsx_screen = -1;
+    /* Count on from whatever an earlier renderer left in there */
+    data->reference = gcmGetControlRegister()->ref;
 
-/*
-    if (flags & SDL_RENDERER_PRESENTFLIP2) {
-        renderer->info.flags |= SDL_RENDERER_PRESENTFLIP2;
-        n = 2;
-    } else if (flags & SDL_RENDERER_PRESENTFLIP3) {
+    /* The display always scans out of a flip chain, so default to two */
+    if (flags & SDL_RENDERER_PRESENTFLIP3) {
         renderer->info.flags |= SDL_RENDERER_PRESENTFLIP3;
         n = 3;
     } else {
-        renderer->info.flags |= SDL_RENDERER_PRESENTCOPY;
-        n = 1;
+        renderer->info.flags |= SDL_RENDERER_PRESENTFLIP2;
+        n = 2;
+    }
+    data->num_screens = n;
+
+    /* Without vsync the RSX flips as soon as it reaches the command */
+    if (flags & SDL_RENDERER_PRESENTVSYNC) {
+        renderer->info.flags |= SDL_RENDERER_PRESENTVSYNC;
+        gcmSetFlipMode(GCM_FLIP_VSYNC);
+    } else {
+        gcmSetFlipMode(GCM_FLIP_HSYNC);
     }
-*/
-    n = 2;
-    printf("\tCreate the %d screen(s):\n", n);
+
+    data->flip_sem = SDL_CreateSemaphore(0);
+    if (!data->flip_sem) {
+        SDL_PSL1GHT_DestroyRenderer(renderer);
+        return NULL;
+    }
+    /* Take the flip chain over once an earlier renderer's flips landed */
+    if (flip_owner) {
+        waitFlips(flip_owner, 0);
+    }
+    flip_owner = data;
+    gcmSetFlipHandler(flipHandler);
+
     for (i = 0; i < n; ++i) {
-        printf( "\t\tSDL_CreateRGBSurface( w: %d, h: %d)\n", displayMode->w, displayMode->h);
-        data->screens[i] =
-            SDL_CreateRGBSurface(0, displayMode->w, displayMode->h, bpp, Rmask, Gmask,
-                                 Bmask, Amask);
-        if (!data->screens[i]) {
-            printf("ERROR\n");
-            SDL_PSL1GHT_DestroyRenderer(renderer);
-            return NULL;
-        }
+        u32 offset = 0;
 
-        printf( "\t\tAllocate RSX memory for pixels\n");
         /* Allocate RSX memory for pixels */
-        SDL_free(data->screens[i]->pixels);
-        data->screens[i]->pixels = rsxMemAlign(16, data->screens[i]->h * data->screens[i]->pitch);
-        if (!data->screens[i]->pixels) {
-            printf("ERROR\n");
-            SDL_FreeSurface(data->screens[i]);
-            SDL_OutOfMemory();
+        data->screens[i] = createRSXSurface(displayMode, displayMode->w,
+                                            displayMode->h, &offset);
+        if (!data->screens[i]) {
+            SDL_PSL1GHT_DestroyRenderer(renderer);
             return NULL;
         }
 
-        u32 offset = 0;
-        printf( "\t\tPrepare RSX offsets (%16X, %08X) \n", (unsigned int) data->screens[i]->pixels, (unsigned int) &offset);
-        if ( realityAddressToOffset(data->screens[i]->pixels, &offset) != 0) {
-            printf("ERROR\n");
-//            SDL_FreeSurface(data->screens[i]);
-            SDL_OutOfMemory();
-            return NULL;
-        }
-        printf( "\t\tSetup the display buffers\n");
         // Setup the display buffers
         if ( gcmSetDisplayBuffer(i, offset, data->screens[i]->pitch, data->screens[i]->w,data->screens[i]->h) != 0) {
-            printf("ERROR\n");
-//            SDL_FreeSurface(data->screens[i]);
-            SDL_OutOfMemory();
+            SDL_PSL1GHT_DestroyRenderer(renderer);
+            SDL_SetError("Couldn't set up display buffer %d", i);
             return NULL;
         }
-        printf( "\t\tSDL_SetSurfacePalette()\n");
+        data->offsets[i] = offset;
+        PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "CreateScreen", i, offset);
         SDL_SetSurfacePalette(data->screens[i], display->palette);
     }
-    data->current_screen = 0;
 
-    printf( "\tReset Flip Status\n");
-    gcmResetFlipStatus();
-    printf( "\tFinished\n");
-    flip(data->context, data->current_screen);
-    waitFlip();
+    /*
+     * A window smaller than the display mode is drawn at its own size and
+     * scaled up by the RSX on Present, which costs one scaled copy per
+     * frame instead of filling every display pixel. Fullscreen windows
+     * normally get a matching mode from ps3fb_modedb instead, which the
+     * TV scales for free.
+     */
+    w = SDL_min(window->w, displayMode->w);
+    h = SDL_min(window->h, displayMode->h);
+    if (w > 0 && h > 0 && (w != displayMode->w || h != displayMode->h)) {
+        data->logical = createRSXSurface(displayMode, w, h,
+                                         &data->logical_offset);
+        if (!data->logical) {
+            SDL_PSL1GHT_DestroyRenderer(renderer);
+            return NULL;
+        }
+        SDL_SetSurfacePalette(data->logical, display->palette);
+        getViewport(w, h, displayMode->w, displayMode->h, &data->viewport);
+        PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "LogicalScreen", w, h);
+    }
+    data->swatches = (Uint8 *) rsxMemAlign(PSL1GHT_SWATCH_PITCH,
+                                           PSL1GHT_SWATCHES *
+                                           PSL1GHT_SWATCH_PITCH);
+    if (!data->swatches ||
+        realityAddressToOffset(data->swatches, &data->swatches_offset) != 0) {
+        SDL_PSL1GHT_DestroyRenderer(renderer);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "CreateRenderer", flags, n);
+    /* Put the first screen up and start drawing into the next one */
+    if (flip(data->context, 0) < 0) {
+        SDL_PSL1GHT_DestroyRenderer(renderer);
+        return NULL;
+    }
+    data->flips_queued = 1;
+    data->current_screen = 1 % n;
     return renderer;
 }
 
+static int
+PSL1GHT_CreateTexture(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    PSL1GHT_TextureData *data;
+    int bpp, pitch;
+    Uint32 Rmask, Gmask, Bmask, Amask;
+
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "CreateTexture",
+                  texture->w, texture->h);
+    data = (PSL1GHT_TextureData *) SDL_calloc(1, sizeof(*data));
+    if (!data) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    texture->driverdata = data;
+
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        data->yuv =
+            SDL_SW_CreateYUVTexture(texture->format, texture->w, texture->h);
+        if (!data->yuv) {
+            PSL1GHT_DestroyTexture(renderer, texture);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (!SDL_PixelFormatEnumToMasks
+        (texture->format, &bpp, &Rmask, &Gmask, &Bmask, &Amask)) {
+        SDL_SetError("Unknown texture format");
+        PSL1GHT_DestroyTexture(renderer, texture);
+        return -1;
+    }
+
+    /* The RSX wants rows on a 64 byte boundary */
+    pitch = (texture->w * SDL_BYTESPERPIXEL(texture->format) + 63) & ~63;
+    data->pixels = rsxMemAlign(64, texture->h * pitch);
+    if (!data->pixels) {
+        PSL1GHT_DestroyTexture(renderer, texture);
+        SDL_OutOfMemory();
+        return -1;
+    }
+    data->surface =
+        SDL_CreateRGBSurfaceFrom(data->pixels, texture->w, texture->h, bpp,
+                                 pitch, Rmask, Gmask, Bmask, Amask);
+    if (!data->surface) {
+        PSL1GHT_DestroyTexture(renderer, texture);
+        return -1;
+    }
+    SDL_SetSurfaceColorMod(data->surface, texture->r, texture->g,
+                           texture->b);
+    SDL_SetSurfaceAlphaMod(data->surface, texture->a);
+    SDL_SetSurfaceBlendMode(data->surface, texture->blendMode);
+    PSL1GHT_SetTextureScaleMode(renderer, texture);
+
+    switch (texture->format) {
+    case SDL_PIXELFORMAT_ARGB8888:
+        data->image.format = RSX_IMAGE_FORMAT_A8R8G8B8;
+        break;
+    case SDL_PIXELFORMAT_RGB888:
+        data->image.format = RSX_IMAGE_FORMAT_X8R8G8B8;
+        break;
+    case SDL_PIXELFORMAT_RGB565:
+        data->image.format = RSX_IMAGE_FORMAT_R5G6B5;
+        break;
+    default:
+        /* Only the CPU blitters read this one */
+        break;
+    }
+    if (data->image.format) {
+        realityAddressToOffset(data->pixels, &data->image.offset);
+        data->image.pitch = pitch;
+        data->image.bpp = SDL_BYTESPERPIXEL(texture->format);
+    }
+    return 0;
+}
+
+static int
+PSL1GHT_QueryTexturePixels(SDL_Renderer * renderer, SDL_Texture * texture,
+                           void **pixels, int *pitch)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        return SDL_SW_QueryYUVTexturePixels(data->yuv, pixels, pitch);
+    }
+    *pixels = data->pixels;
+    *pitch = data->surface->pitch;
+    return 0;
+}
+
+static int
+PSL1GHT_SetTexturePalette(SDL_Renderer * renderer, SDL_Texture * texture,
+                          const SDL_Color * colors, int firstcolor,
+                          int ncolors)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        SDL_SetError("YUV textures don't have a palette");
+        return -1;
+    }
+    return SDL_SetPaletteColors(data->surface->format->palette, colors,
+                                firstcolor, ncolors);
+}
+
+static int
+PSL1GHT_GetTexturePalette(SDL_Renderer * renderer, SDL_Texture * texture,
+                          SDL_Color * colors, int firstcolor, int ncolors)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        SDL_SetError("YUV textures don't have a palette");
+        return -1;
+    }
+    SDL_memcpy(colors, &data->surface->format->palette->colors[firstcolor],
+               ncolors * sizeof(*colors));
+    return 0;
+}
+
+/* Modulation and blending state feeds the CPU path; the RSX path checks
+   the texture itself in getOperation() */
+static int
+PSL1GHT_SetTextureColorMod(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (!data->surface) {
+        return 0;
+    }
+    return SDL_SetSurfaceColorMod(data->surface, texture->r, texture->g,
+                                  texture->b);
+}
+
+static int
+PSL1GHT_SetTextureAlphaMod(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (!data->surface) {
+        return 0;
+    }
+    return SDL_SetSurfaceAlphaMod(data->surface, texture->a);
+}
+
+static int
+PSL1GHT_SetTextureBlendMode(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (!data->surface) {
+        return 0;
+    }
+    return SDL_SetSurfaceBlendMode(data->surface, texture->blendMode);
+}
+
+static int
+PSL1GHT_SetTextureScaleMode(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (!data->surface) {
+        return 0;
+    }
+    /* The CPU blitters only know how to pick the nearest pixel */
+    if (texture->scaleMode == SDL_SCALEMODE_NONE) {
+        return SDL_SetSurfaceScaleMode(data->surface, SDL_SCALEMODE_NONE);
+    }
+    return SDL_SetSurfaceScaleMode(data->surface, SDL_SCALEMODE_FAST);
+}
+
+static int
+PSL1GHT_UpdateTexture(SDL_Renderer * renderer, SDL_Texture * texture,
+                      const SDL_Rect * rect, const void *pixels, int pitch)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+    Uint8 *src, *dst;
+    int row;
+    size_t length;
+
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "UpdateTexture", rect->w, rect->h);
+
+    /* Queued blits may still read the old pixels */
+    syncRSX((SDL_PSL1GHT_RenderData *) renderer->driverdata);
+
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        return SDL_SW_UpdateYUVTexture(data->yuv, rect, pixels, pitch);
+    }
+
+    src = (Uint8 *) pixels;
+    dst = (Uint8 *) data->pixels + rect->y * data->surface->pitch +
+        rect->x * SDL_BYTESPERPIXEL(texture->format);
+    length = rect->w * SDL_BYTESPERPIXEL(texture->format);
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        src += pitch;
+        dst += data->surface->pitch;
+    }
+    return 0;
+}
+
+static int
+PSL1GHT_LockTexture(SDL_Renderer * renderer, SDL_Texture * texture,
+                    const SDL_Rect * rect, int markDirty, void **pixels,
+                    int *pitch)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "LockTexture", rect->w, rect->h);
+
+    syncRSX((SDL_PSL1GHT_RenderData *) renderer->driverdata);
+
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        return SDL_SW_LockYUVTexture(data->yuv, rect, markDirty, pixels,
+                                     pitch);
+    }
+    *pixels = (void *) ((Uint8 *) data->pixels +
+                        rect->y * data->surface->pitch +
+                        rect->x * SDL_BYTESPERPIXEL(texture->format));
+    *pitch = data->surface->pitch;
+    return 0;
+}
+
+static void
+PSL1GHT_UnlockTexture(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        SDL_SW_UnlockYUVTexture(data->yuv);
+    }
+}
+
+static void
+PSL1GHT_DestroyTexture(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    PSL1GHT_TextureData *data = (PSL1GHT_TextureData *) texture->driverdata;
+
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "DestroyTexture",
+                  texture->w, texture->h);
+    if (!data) {
+        return;
+    }
+    syncRSX((SDL_PSL1GHT_RenderData *) renderer->driverdata);
+    if (data->yuv) {
+        SDL_SW_DestroyYUVTexture(data->yuv);
+    }
+    if (data->surface) {
+        SDL_FreeSurface(data->surface);
+    }
+    if (data->pixels) {
+        rsxFree(data->pixels);
+    }
+    SDL_free(data);
+    texture->driverdata = NULL;
+}
+
+/* The 2D engine fills with a copy or an alpha blend of the draw colour,
+   which SDL_BLENDMODE_PREMULTIPLIED takes as already premultiplied */
+static int
+getFillOperation(SDL_Renderer * renderer, Uint32 * color,
+                 Uint32 * operation)
+{
+    *color = ((Uint32) renderer->a << 24) | ((Uint32) renderer->r << 16) |
+        ((Uint32) renderer->g << 8) | renderer->b;
+    switch (renderer->blendMode) {
+    case SDL_BLENDMODE_NONE:
+    case SDL_BLENDMODE_MASK:
+        *operation = RSX_OPERATION_SRCCOPY;
+        return 1;
+    case SDL_BLENDMODE_BLEND:
+        *operation = (renderer->a == 0xFF) ? RSX_OPERATION_SRCCOPY :
+            RSX_OPERATION_BLEND_AND;
+        return 1;
+    case SDL_BLENDMODE_PREMULTIPLIED:
+        *operation = (renderer->a == 0xFF) ? RSX_OPERATION_SRCCOPY :
+            RSX_OPERATION_BLEND_PREMULT;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Whether every segment of a polyline is horizontal or vertical */
+static int
+isStraight(const SDL_Point * points, int count)
+{
+    int i;
+
+    for (i = 1; i < count; ++i) {
+        if (points[i-1].x != points[i].x && points[i-1].y != points[i].y) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Queue a straight polyline as fills covering the pixels SDL_DrawLines()
+ * would: segments stop short of their end point and the last point
+ * closes an open line.
+ */
+static void
+fillLines(SDL_PSL1GHT_RenderData *data, SDL_Surface *target,
+          const SDL_Point * points, int count)
+{
+    SDL_Rect rect;
+    int i, x1, y1, x2, y2;
+
+    for (i = 1; i < count; ++i) {
+        x1 = points[i-1].x;
+        y1 = points[i-1].y;
+        x2 = points[i].x;
+        y2 = points[i].y;
+        if (y1 == y2) {
+            rect.x = (x1 < x2) ? x1 : x2 + 1;
+            rect.w = (x1 < x2) ? x2 - x1 : x1 - x2;
+            rect.y = y1;
+            rect.h = 1;
+        } else {
+            rect.x = x1;
+            rect.w = 1;
+            rect.y = (y1 < y2) ? y1 : y2 + 1;
+            rect.h = (y1 < y2) ? y2 - y1 : y1 - y2;
+        }
+        fillRect(data, target, &rect);
+    }
+    if (points[0].x != points[count-1].x || points[0].y != points[count-1].y) {
+        rect.x = points[count-1].x;
+        rect.y = points[count-1].y;
+        rect.w = rect.h = 1;
+        fillRect(data, target, &rect);
+    }
+}
+
 static int
 SDL_PSL1GHT_RenderDrawPoints(SDL_Renderer * renderer,
                            const SDL_Point * points, int count)
 {
     SDL_PSL1GHT_RenderData *data =
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
-    SDL_Surface *target = data->screens[data->current_screen];
-
-    printf( "SDL_PSL1GHT_RenderDrawPoints () \n");
+    SDL_Surface *target;
+    SDL_Rect rect;
+    Uint32 color, operation;
+    int i;
 
-    if (renderer->blendMode == SDL_BLENDMODE_NONE ||
-        renderer->blendMode == SDL_BLENDMODE_MASK) {
-        Uint32 color = SDL_MapRGBA(target->format,
-                                   renderer->r, renderer->g, renderer->b,
-                                   renderer->a);
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "RenderDrawPoints",
+                  count, renderer->blendMode);
 
-        return SDL_DrawPoints(target, points, count, color);
-    } else {
-        return SDL_BlendPoints(target, points, count, renderer->blendMode,
-                               renderer->r, renderer->g, renderer->b,
-                               renderer->a);
+    if (getFillOperation(renderer, &color, &operation)) {
+        target = beginFill(data, color, operation);
+        rect.w = rect.h = 1;
+        for (i = 0; i < count; ++i) {
+            rect.x = points[i].x;
+            rect.y = points[i].y;
+            fillRect(data, target, &rect);
+        }
+        return 0;
     }
+
+    target = lockTarget(data);
+    return SDL_BlendPoints(target, points, count, renderer->blendMode,
+                           renderer->r, renderer->g, renderer->b,
+                           renderer->a);
 }
 
 static int
@@ -248,21 +921,31 @@ SDL_PSL1GHT_RenderDrawLines(SDL_Renderer * renderer,
 {
     SDL_PSL1GHT_RenderData *data =
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
-    SDL_Surface *target = data->screens[data->current_screen];
+    SDL_Surface *target;
+    Uint32 color, operation;
 
-    printf( "SDL_PSL1GHT_RenderDrawLines()\n");
-    if (renderer->blendMode == SDL_BLENDMODE_NONE ||
-        renderer->blendMode == SDL_BLENDMODE_MASK) {
-        Uint32 color = SDL_MapRGBA(target->format,
-                                   renderer->r, renderer->g, renderer->b,
-                                   renderer->a);
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "RenderDrawLines",
+                  count, renderer->blendMode);
 
-        return SDL_DrawLines(target, points, count, color);
+    if (getFillOperation(renderer, &color, &operation)) {
+        if (isStraight(points, count)) {
+            target = beginFill(data, color, operation);
+            fillLines(data, target, points, count);
+            return 0;
+        }
+        /* Diagonals are left to the CPU */
+        target = lockTarget(data);
+        color = SDL_MapRGBA(target->format, renderer->r, renderer->g,
+                            renderer->b, renderer->a);
+        if (operation == RSX_OPERATION_SRCCOPY) {
+            return SDL_DrawLines(target, points, count, color);
+        }
     } else {
-        return SDL_BlendLines(target, points, count, renderer->blendMode,
-                              renderer->r, renderer->g, renderer->b,
-                              renderer->a);
+        target = lockTarget(data);
     }
+    return SDL_BlendLines(target, points, count, renderer->blendMode,
+                          renderer->r, renderer->g, renderer->b,
+                          renderer->a);
 }
 
 static int
@@ -271,24 +954,40 @@ SDL_PSL1GHT_RenderDrawRects(SDL_Renderer * renderer, const SDL_Rect ** rects,
 {
     SDL_PSL1GHT_RenderData *data =
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
-    SDL_Surface *target = data->screens[data->current_screen];
+    SDL_Surface *target;
+    SDL_Point points[5];
+    Uint32 color, operation;
+    int i;
 
-    printf( "SDL_PSL1GHT_RenderDrawRects()\n");
-    if (renderer->blendMode == SDL_BLENDMODE_NONE ||
-        renderer->blendMode == SDL_BLENDMODE_MASK) {
-        Uint32 color = SDL_MapRGBA(target->format,
-                                   renderer->r, renderer->g, renderer->b,
-                                   renderer->a);
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "RenderDrawRects",
+                  count, renderer->blendMode);
 
-        printf("\tSDL_DrawRects()\n");
-        return SDL_DrawRects(target, rects, count, color);
-    } else {
-        printf("\tSDL_BlendRects()\n");
-        return SDL_BlendRects(target, rects, count,
-                              renderer->blendMode,
-                              renderer->r, renderer->g, renderer->b,
-                              renderer->a);
+    if (getFillOperation(renderer, &color, &operation)) {
+        /* Outlined the way SDL_DrawRect() does it */
+        target = beginFill(data, color, operation);
+        for (i = 0; i < count; ++i) {
+            const SDL_Rect *rect = rects[i];
+
+            points[0].x = rect->x;
+            points[0].y = rect->y;
+            points[1].x = rect->x+rect->w-1;
+            points[1].y = rect->y;
+            points[2].x = rect->x+rect->w-1;
+            points[2].y = rect->y+rect->h-1;
+            points[3].x = rect->x;
+            points[3].y = rect->y+rect->h-1;
+            points[4].x = rect->x;
+            points[4].y = rect->y;
+            fillLines(data, target, points, 5);
+        }
+        return 0;
     }
+
+    target = lockTarget(data);
+    return SDL_BlendRects(target, rects, count,
+                          renderer->blendMode,
+                          renderer->r, renderer->g, renderer->b,
+                          renderer->a);
 }
 
 static int
@@ -297,24 +996,51 @@ SDL_PSL1GHT_RenderFillRects(SDL_Renderer * renderer, const SDL_Rect ** rects,
 {
     SDL_PSL1GHT_RenderData *data =
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
-    SDL_Surface *target = data->screens[data->current_screen];
+    SDL_Surface *target;
+    Uint32 color, operation;
+    int i;
 
-    printf( "SDL_PSL1GHT_RenderFillRects()\n");
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "RenderFillRects",
+                  count, renderer->blendMode);
 
-    if (renderer->blendMode == SDL_BLENDMODE_NONE ||
-        renderer->blendMode == SDL_BLENDMODE_MASK) {
-        Uint32 color = SDL_MapRGBA(target->format,
-                                   renderer->r, renderer->g, renderer->b,
-                                   renderer->a);
-        printf("\tSDL_FillRects()\n");
+    if (getFillOperation(renderer, &color, &operation)) {
+        target = beginFill(data, color, operation);
+        for (i = 0; i < count; ++i) {
+            fillRect(data, target, rects[i]);
+        }
+        return 0;
+    }
 
-        return SDL_FillRects(target, rects, count, color);
-    } else {
-        printf("\tSDL_BlendFillRects()\n");
-        return SDL_BlendFillRects(target, rects, count,
-                                  renderer->blendMode,
-                                  renderer->r, renderer->g, renderer->b,
-                                  renderer->a);
+    target = lockTarget(data);
+    return SDL_BlendFillRects(target, rects, count,
+                              renderer->blendMode,
+                              renderer->r, renderer->g, renderer->b,
+                              renderer->a);
+}
+
+/* The 2D engine copies and alpha blends; it has no modulation */
+static int
+getOperation(SDL_Texture * texture, Uint32 * operation)
+{
+    PSL1GHT_TextureData *texturedata =
+        (PSL1GHT_TextureData *) texture->driverdata;
+
+    if (!texturedata->image.format ||
+        texture->modMode != SDL_TEXTUREMODULATE_NONE) {
+        return 0;
+    }
+    switch (texture->blendMode) {
+    case SDL_BLENDMODE_NONE:
+        *operation = RSX_OPERATION_SRCCOPY;
+        return 1;
+    case SDL_BLENDMODE_BLEND:
+        *operation = RSX_OPERATION_BLEND_AND;
+        return 1;
+    case SDL_BLENDMODE_PREMULTIPLIED:
+        *operation = RSX_OPERATION_BLEND_PREMULT;
+        return 1;
+    default:
+        return 0;
     }
 }
 
@@ -324,47 +1050,55 @@ SDL_PSL1GHT_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
 {
     SDL_PSL1GHT_RenderData *data =
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
+    PSL1GHT_TextureData *texturedata =
+        (PSL1GHT_TextureData *) texture->driverdata;
     SDL_Window *window = renderer->window;
     SDL_VideoDisplay *display = window->display;
+    SDL_Surface *target;
+    Uint32 operation;
 
-    printf( "SDL_PSL1GHT_RenderCopy()\n");
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "RenderCopy",
+                  dstrect->w, dstrect->h);
 
     if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
-        SDL_Surface *target = data->screens[data->current_screen];
+        target = lockTarget(data);
         void *pixels =
             (Uint8 *) target->pixels + dstrect->y * target->pitch +
             dstrect->x * target->format->BytesPerPixel;
-        printf("\tSDL_SW_CopyYUVToRGB()\n");
-        return SDL_SW_CopyYUVToRGB((SDL_SW_YUVTexture *) texture->driverdata,
+        /* Started on the SPEs when one is free, else done on the PPU */
+        if (PSL1GHT_SPECopyYUVToRGB(data->device, texturedata->yuv,
+                                    srcrect, display->current_mode.format,
+                                    dstrect->w, dstrect->h, pixels,
+                                    target->pitch)) {
+            return 0;
+        }
+        return SDL_SW_CopyYUVToRGB(texturedata->yuv,
                                    srcrect, display->current_mode.format,
                                    dstrect->w, dstrect->h, pixels,
                                    target->pitch);
-    } else {
-        Uint8 *src, *dst;
-        int row;
-        size_t length;
-        Uint8 *dstpixels;
-
-        src = (Uint8 *)((SDL_Surface *)texture->driverdata)->pixels;
-        dst = (Uint8 *) data->screens[data->current_screen]->pixels + dstrect->y * data->screens[data->current_screen]->pitch + dstrect->x
-                        * SDL_BYTESPERPIXEL(texture->format);
-        length = dstrect->w * SDL_BYTESPERPIXEL(texture->format);
-        for (row = 0; row < dstrect->h; ++row) {
-            SDL_memcpy(dst, src, length);
-            src += texture->w * SDL_BYTESPERPIXEL(texture->format);
-            dst += data->screens[data->current_screen]->pitch;
+    } else if (getOperation(texture, &operation)) {
+        Uint32 filter = RSX_FILTER_NEAREST;
+
+        rsxTarget(data);
+        if (texture->scaleMode == SDL_SCALEMODE_SLOW ||
+            texture->scaleMode == SDL_SCALEMODE_BEST) {
+            filter = RSX_FILTER_LINEAR;
         }
-		return 0;
-/*        SDL_Surface *surface = (SDL_Surface *) texture->driverdata;
-        SDL_Surface *target = data->screens[data->current_screen];
+        /* Queued only: the RSX gets it with the next flush */
+        PSL1GHT_RSXScaledImage(data->context, &texturedata->image,
+                               srcrect, dstrect, operation, filter);
+        data->rsx_pending = 1;
+        data->fill_ready = 0;
+        return 0;
+    } else {
         SDL_Rect real_srcrect = *srcrect;
         SDL_Rect real_dstrect = *dstrect;
-        printf("\tSDL_LowerBlit( (%d, %d) -> (%d, %d) (pitch %d))\n", srcrect->h, srcrect->w, dstrect->h, dstrect->w, surface->pitch);
-        printf("\t\tmemcpy( %08X, %08X, %d)\n", target->pixels, surface->pixels, srcrect->h * srcrect->w * 4);
 
-        memcpy( target->pixels, surface->pixels, srcrect->h * srcrect->w * 4);
-        return SDL_LowerBlit(surface, &real_srcrect, target, &real_dstrect);
-*/    }
+        /* Modulation and the other blend modes, texture read in place */
+        target = lockTarget(data);
+        return SDL_LowerBlit(texturedata->surface, &real_srcrect, target,
+                             &real_dstrect);
+    }
 }
 
 static int
@@ -375,14 +1109,15 @@ SDL_PSL1GHT_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
     SDL_Window *window = renderer->window;
     SDL_VideoDisplay *display = window->display;
-    SDL_Surface *screen = data->screens[data->current_screen];
+    SDL_Surface *screen = lockTarget(data);
     Uint32 screen_format = display->current_mode.format;
     Uint8 *screen_pixels = (Uint8 *) screen->pixels +
                             rect->y * screen->pitch +
                             rect->x * screen->format->BytesPerPixel;
     int screen_pitch = screen->pitch;
 
-    printf( "SDL_PSL1GHT_RenderReadPixels()\n");
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "RenderReadPixels",
+                  rect->w, rect->h);
 
     return SDL_ConvertPixels(rect->w, rect->h,
                              screen_format, screen_pixels, screen_pitch,
@@ -397,14 +1132,15 @@ SDL_PSL1GHT_RenderWritePixels(SDL_Renderer * renderer, const SDL_Rect * rect,
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
     SDL_Window *window = renderer->window;
     SDL_VideoDisplay *display = window->display;
-    SDL_Surface *screen = data->screens[data->current_screen];
+    SDL_Surface *screen = lockTarget(data);
     Uint32 screen_format = display->current_mode.format;
     Uint8 *screen_pixels = (Uint8 *) screen->pixels +
                             rect->y * screen->pitch +
                             rect->x * screen->format->BytesPerPixel;
     int screen_pitch = screen->pitch;
 
-    printf( "SDL_PSL1GHT_RenderWritePixels()\n");
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "RenderWritePixels",
+                  rect->w, rect->h);
     return SDL_ConvertPixels(rect->w, rect->h,
                              format, pixels, pitch,
                              screen_format, screen_pixels, screen_pitch);
@@ -413,32 +1149,25 @@ SDL_PSL1GHT_RenderWritePixels(SDL_Renderer * renderer, const SDL_Rect * rect,
 static void
 SDL_PSL1GHT_RenderPresent(SDL_Renderer * renderer)
 {
-    static int frame_number;
     SDL_PSL1GHT_RenderData *data =
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
 
-    printf( "SDL_PSL1GHT_RenderPresent()\n");
-
-    printf( "\tRendering to screen %d\n", data->current_screen);
+    PSL1GHT_TRACE(2, PSL1GHT_TRACE_VIDEO, "RenderPresent",
+                  data->current_screen, data->flips_queued - data->flips_done);
 
-    printf( "\tPage flip\n");
-    /* Page flip */
-    flip(data->context, data->current_screen);
+    PSL1GHT_SPEFinish(data->device);
+    if (data->logical) {
+        scaleLogical(data);
+    }
 
-    printf( "\tWait for vsync\n");
-    /* Wait for vsync */
-    //if (renderer->info.flags & SDL_RENDERER_PRESENTVSYNC) {
-        waitFlip();
-    //}
+    /* Page flip, the wait for the next buffer happens on the next draw */
+    if (flip(data->context, data->current_screen) < 0) {
+        /* Keep drawing into this screen, the error is already set */
+        return;
+    }
+    ++data->flips_queued;
 
-    printf( "\tUpdate the flipping chain, if any\n");
-    /* Update the flipping chain, if any */
-    //if (renderer->info.flags & SDL_RENDERER_PRESENTFLIP2) {
-        data->current_screen = (data->current_screen + 1) % 2;
-    /*} else if (renderer->info.flags & SDL_RENDERER_PRESENTFLIP3) {
-        data->current_screen = (data->current_screen + 1) % 3;
-    }*/
-    printf( "\tUpdated the screen to %d\n", data->current_screen);
+    data->current_screen = (data->current_screen + 1) % data->num_screens;
 }
 
 static void
@@ -448,9 +1177,27 @@ SDL_PSL1GHT_DestroyRenderer(SDL_Renderer * renderer)
         (SDL_PSL1GHT_RenderData *) renderer->driverdata;
     int i;
 
-    printf( "SDL_PSL1GHT_DestroyRenderer()\n");
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "DestroyRenderer", 0, 0);
 
     if (data) {
+        if (data->flip_sem) {
+            /* Let the queued work land before anything goes away */
+            syncRSX(data);
+            waitFlips(data, 0);
+            if (flip_owner == data) {
+                gcmSetFlipHandler(NULL);
+                flip_owner = NULL;
+            }
+            SDL_DestroySemaphore(data->flip_sem);
+        }
+        if (data->swatches) {
+            rsxFree(data->swatches);
+        }
+        if (data->logical) {
+            rsxFree(data->logical->pixels);
+            data->logical->pixels = NULL;
+            SDL_FreeSurface(data->logical);
+        }
         for (i = 0; i < SDL_arraysize(data->screens); ++i) {
             if (data->screens[i]) {
              //   SDL_FreeSurface(data->screens[i]);
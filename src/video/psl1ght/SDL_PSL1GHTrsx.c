@@ -0,0 +1,153 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_video.h"
+
+#include "SDL_PSL1GHTrsx_c.h"
+
+/* Command header: count in bits 18-28, subchannel and method below */
+#define RSX_METHOD(method, count)   (((count) << 18) | (method))
+
+/* Channel methods */
+#define NV406E_SET_REFERENCE                    0x00000050
+
+/* Surface 2D object, subchannel 3 */
+#define NV3062_SET_CONTEXT_DMA_IMAGE_SOURCE     0x00006184
+#define NV3062_SET_COLOR_FORMAT                 0x00006300
+
+/* Scaled image from memory object, subchannel 6 */
+#define NV3089_SET_CONTEXT_DMA_IMAGE            0x0000C184
+#define NV3089_SET_CONTEXT_SURFACE              0x0000C198
+#define NV3089_SET_COLOR_CONVERSION             0x0000C2FC
+#define NV3089_CLIP_POINT                       0x0000C308
+#define NV3089_IMAGE_IN_SIZE                    0x0000C400
+#define NV3089_IMAGE_IN                         0x0000C40C
+
+#define NV3089_COLOR_CONVERSION_TRUNCATE        1
+#define NV3089_IMAGE_IN_FORMAT_ORIGIN_CORNER    (2 << 16)
+
+/* Make sure there is room for count more words */
+static u32 *
+reserve(gcmContextData * context, u32 count)
+{
+    if (context->current + count > context->end) {
+        context->callback(context, count);
+    }
+    return context->current;
+}
+
+void
+PSL1GHT_RSXSetSurface(gcmContextData * context, Uint32 format,
+                      Uint32 offset, Uint32 pitch)
+{
+    u32 *p = reserve(context, 8);
+
+    *p++ = RSX_METHOD(NV3062_SET_CONTEXT_DMA_IMAGE_SOURCE, 2);
+    *p++ = RSX_DMA_MEMORY_LOCAL;
+    *p++ = RSX_DMA_MEMORY_LOCAL;
+    *p++ = RSX_METHOD(NV3062_SET_COLOR_FORMAT, 4);
+    *p++ = format;
+    *p++ = (pitch << 16) | pitch;
+    *p++ = offset;
+    *p++ = offset;
+    context->current = p;
+}
+
+void
+PSL1GHT_RSXSetImage(gcmContextData * context,
+                    const PSL1GHT_RSXImage * image, const SDL_Rect * srcrect,
+                    Uint32 operation, Uint32 filter)
+{
+    u32 *p = reserve(context, 12);
+
+    *p++ = RSX_METHOD(NV3089_SET_CONTEXT_DMA_IMAGE, 1);
+    *p++ = RSX_DMA_MEMORY_LOCAL;
+    *p++ = RSX_METHOD(NV3089_SET_CONTEXT_SURFACE, 1);
+    *p++ = RSX_CONTEXT_SURFACE2D;
+    *p++ = RSX_METHOD(NV3089_SET_COLOR_CONVERSION, 3);
+    *p++ = NV3089_COLOR_CONVERSION_TRUNCATE;
+    *p++ = image->format;
+    *p++ = operation;
+    /* The source rectangle starts the image */
+    *p++ = RSX_METHOD(NV3089_IMAGE_IN_SIZE, 3);
+    *p++ = ((u32) srcrect->h << 16) | (u16) srcrect->w;
+    *p++ = image->pitch | NV3089_IMAGE_IN_FORMAT_ORIGIN_CORNER |
+        (filter << 24);
+    *p++ = image->offset + srcrect->y * image->pitch +
+        srcrect->x * image->bpp;
+    context->current = p;
+}
+
+void
+PSL1GHT_RSXStretchImage(gcmContextData * context, int w, int h,
+                        const SDL_Rect * dstrect)
+{
+    u32 *p = reserve(context, 9);
+    u32 dst_point = ((u32) dstrect->y << 16) | (u16) dstrect->x;
+    u32 dst_size = ((u32) dstrect->h << 16) | (u16) dstrect->w;
+
+    /* Clip, output rectangle and steps; IMAGE_IN kicks the blit */
+    *p++ = RSX_METHOD(NV3089_CLIP_POINT, 6);
+    *p++ = dst_point;
+    *p++ = dst_size;
+    *p++ = dst_point;
+    *p++ = dst_size;
+    *p++ = ((u32) w << 20) / dstrect->w;
+    *p++ = ((u32) h << 20) / dstrect->h;
+    *p++ = RSX_METHOD(NV3089_IMAGE_IN, 1);
+    *p++ = 0;
+    context->current = p;
+}
+
+void
+PSL1GHT_RSXScaledImage(gcmContextData * context,
+                       const PSL1GHT_RSXImage * image,
+                       const SDL_Rect * srcrect, const SDL_Rect * dstrect,
+                       Uint32 operation, Uint32 filter)
+{
+    PSL1GHT_RSXSetImage(context, image, srcrect, operation, filter);
+    PSL1GHT_RSXStretchImage(context, srcrect->w, srcrect->h, dstrect);
+}
+
+void
+PSL1GHT_RSXSetReference(gcmContextData * context, Uint32 ref)
+{
+    u32 *p = reserve(context, 2);
+
+    *p++ = RSX_METHOD(NV406E_SET_REFERENCE, 1);
+    *p++ = ref;
+    context->current = p;
+}
+
+void
+PSL1GHT_RSXWaitReference(Uint32 ref)
+{
+    gcmControlRegister *control = gcmGetControlRegister();
+
+    /* Flip waits are queued ahead of the draws, so only blits are left
+       to execute: cheaper to spin than to sleep */
+    while (control->ref != ref) {
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
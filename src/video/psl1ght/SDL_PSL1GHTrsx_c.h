@@ -0,0 +1,92 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_psl1ghtrsx_h
+#define _SDL_psl1ghtrsx_h
+
+#include <rsx/gcm.h>
+
+/* RSX command helpers: blits through the 2D objects and FIFO sync */
+
+/* Objects and DMA contexts libgcm sets up at init */
+#define RSX_CONTEXT_SURFACE2D       0x313371C3
+#define RSX_DMA_MEMORY_LOCAL        0xFEED0000
+#define RSX_DMA_MEMORY_MAIN         0xFEED0001
+
+/* NV3062_SET_COLOR_FORMAT values */
+#define RSX_SURFACE_FORMAT_R5G6B5   0x04
+#define RSX_SURFACE_FORMAT_A8R8G8B8 0x0A
+
+/* NV3089_SET_COLOR_FORMAT values */
+#define RSX_IMAGE_FORMAT_A8R8G8B8   0x03
+#define RSX_IMAGE_FORMAT_X8R8G8B8   0x04
+#define RSX_IMAGE_FORMAT_R5G6B5     0x07
+
+/* NV3089_SET_OPERATION values */
+#define RSX_OPERATION_BLEND_AND     0x02
+#define RSX_OPERATION_SRCCOPY       0x03
+#define RSX_OPERATION_BLEND_PREMULT 0x05
+
+/* NV3089_IMAGE_IN_FORMAT interpolators */
+#define RSX_FILTER_NEAREST          0x00
+#define RSX_FILTER_LINEAR           0x01
+
+/* An image in RSX local memory */
+typedef struct
+{
+    Uint32 format;              /* RSX_IMAGE_FORMAT_* */
+    Uint32 offset;
+    Uint32 pitch;
+    int bpp;
+} PSL1GHT_RSXImage;
+
+/* Make the surface at offset the destination of following blits */
+extern void PSL1GHT_RSXSetSurface(gcmContextData * context, Uint32 format,
+                                  Uint32 offset, Uint32 pitch);
+
+/* Use srcrect of the image as source of following stretches */
+extern void PSL1GHT_RSXSetImage(gcmContextData * context,
+                                const PSL1GHT_RSXImage * image,
+                                const SDL_Rect * srcrect,
+                                Uint32 operation, Uint32 filter);
+
+/* Stretch the w x h source set up last into dstrect of the surface */
+extern void PSL1GHT_RSXStretchImage(gcmContextData * context, int w, int h,
+                                    const SDL_Rect * dstrect);
+
+/* Scale srcrect of the image into dstrect of the current surface */
+extern void PSL1GHT_RSXScaledImage(gcmContextData * context,
+                                   const PSL1GHT_RSXImage * image,
+                                   const SDL_Rect * srcrect,
+                                   const SDL_Rect * dstrect,
+                                   Uint32 operation, Uint32 filter);
+
+/* Have the RSX write ref to its ref register once it gets there */
+extern void PSL1GHT_RSXSetReference(gcmContextData * context, Uint32 ref);
+
+/* Spin until the RSX has executed the matching SetReference */
+extern void PSL1GHT_RSXWaitReference(Uint32 ref);
+
+#endif /* _SDL_psl1ghtrsx_h */
+
+/* vi: set ts=4 sw=4 expandtab: */
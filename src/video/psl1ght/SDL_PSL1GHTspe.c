@@ -0,0 +1,356 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_video.h"
+#include "SDL_atomic.h"
+#include "../SDL_yuv_sw_c.h"
+
+#include "SDL_PSL1GHTvideo.h"
+#include "SDL_PSL1GHTspe_c.h"
+
+#include <malloc.h>
+#include <psl1ght/lv2/thread.h>
+
+/* Bands narrower than this aren't worth a mailbox round trip */
+#define PSL1GHT_SPE_MIN_LINES   16
+
+#if SDL_VIDEO_PSL1GHT_SPE
+/* Built from spu/yuv2argb.c */
+extern const u8 yuv2argb_spu_bin[];
+#endif
+
+/* Create a raw SPU, load the program and wait until it is ready */
+int
+PSL1GHT_SPEBoot(PSL1GHT_SPE * spe)
+{
+    s32 result;
+
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "SPEBoot", 0, 0);
+    result = sysSpuRawCreate(&spe->id, NULL);
+    if (result != 0) {
+        SDL_SetError("[PSL1GHT->SPU] No raw SPU for %s: %d",
+                     spe->program_name, (int) result);
+        return -1;
+    }
+    result = sysSpuImageImport(&spe->image, spe->program, 0);
+    if (result == 0) {
+        result = sysSpuRawImageLoad(spe->id, &spe->image);
+        if (result != 0) {
+            sysSpuImageClose(&spe->image);
+        }
+    }
+    if (result != 0) {
+        sysSpuRawDestroy(spe->id);
+        SDL_SetError("[PSL1GHT->SPU] Failed loading %s: %d",
+                     spe->program_name, (int) result);
+        return -1;
+    }
+    sysSpuRawWriteProblemStorage(spe->id, SPU_RunCntl, 1);
+    spe->booted = 1;
+
+    if (PSL1GHT_SPEWaitForMsg(spe, SPU_READY) < 0) {
+        PSL1GHT_SPEShutdown(spe);
+        return -1;
+    }
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "SPEReady", spe->id, 0);
+    return 0;
+}
+
+/* Send a message to the SPE, block until the mailbox takes it */
+int
+PSL1GHT_SPESendMsg(PSL1GHT_SPE * spe, Uint32 msg)
+{
+    while (SPU_MBOX_IN_FREE(sysSpuRawReadProblemStorage(spe->id,
+                                                        SPU_MBox_Status))
+           == 0) {
+        if (sysSpuRawReadProblemStorage(spe->id, SPU_Status) &
+            SPU_STATUS_STOPPED) {
+            SDL_SetError("[PSL1GHT->SPU] %s has stopped",
+                         spe->program_name);
+            return -1;
+        }
+        sys_ppu_thread_yield();
+    }
+    sysSpuRawWriteProblemStorage(spe->id, SPU_In_MBox, msg);
+    return 0;
+}
+
+/* Read one message from the SPE, block until there is one */
+int
+PSL1GHT_SPEWaitForMsg(PSL1GHT_SPE * spe, Uint32 msg)
+{
+    Uint32 out;
+
+    while (SPU_MBOX_OUT_COUNT(sysSpuRawReadProblemStorage(spe->id,
+                                                          SPU_MBox_Status))
+           == 0) {
+        if (sysSpuRawReadProblemStorage(spe->id, SPU_Status) &
+            SPU_STATUS_STOPPED) {
+            SDL_SetError("[PSL1GHT->SPU] %s has stopped",
+                         spe->program_name);
+            return -1;
+        }
+        sys_ppu_thread_yield();
+    }
+    out = sysSpuRawReadProblemStorage(spe->id, SPU_Out_MBox);
+    if (out != msg) {
+        SDL_SetError("[PSL1GHT->SPU] %s sent %u instead of %u",
+                     spe->program_name, (unsigned) out, (unsigned) msg);
+        return -1;
+    }
+    return 0;
+}
+
+/* Stop the program and release its SPU */
+int
+PSL1GHT_SPEShutdown(PSL1GHT_SPE * spe)
+{
+    if (!spe->booted) {
+        return 0;
+    }
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "SPEShutdown", spe->id, 0);
+    if (PSL1GHT_SPESendMsg(spe, SPU_EXIT) == 0) {
+        while (!(sysSpuRawReadProblemStorage(spe->id, SPU_Status) &
+                 SPU_STATUS_STOPPED)) {
+            sys_ppu_thread_yield();
+        }
+    }
+    spe->booted = 0;
+    sysSpuImageClose(&spe->image);
+    if (sysSpuRawDestroy(spe->id) != 0) {
+        SDL_SetError("[PSL1GHT->SPU] Failed destroying %s",
+                     spe->program_name);
+        return -1;
+    }
+    return 0;
+}
+
+void
+PSL1GHT_InitSPE(_THIS)
+{
+    SDL_DeviceData *devdata = (SDL_DeviceData *) _this->driverdata;
+    PSL1GHT_SPEPool *pool;
+    const char *env;
+
+    pool = (PSL1GHT_SPEPool *) SDL_calloc(1, sizeof(*pool));
+    if (!pool) {
+        /* The PPU path is always there */
+        return;
+    }
+    pool->max_spes = PSL1GHT_DEFAULT_SPES;
+    env = SDL_getenv("SDL_VIDEO_PSL1GHT_SPES");
+    if (env && *env) {
+        pool->max_spes = SDL_atoi(env);
+    }
+    if (pool->max_spes < 0) {
+        pool->max_spes = 0;
+    } else if (pool->max_spes > PSL1GHT_MAX_SPES) {
+        pool->max_spes = PSL1GHT_MAX_SPES;
+    }
+#if !SDL_VIDEO_PSL1GHT_SPE
+    pool->max_spes = 0;
+#endif
+    devdata->spe_pool = pool;
+}
+
+void
+PSL1GHT_QuitSPE(_THIS)
+{
+    SDL_DeviceData *devdata = (SDL_DeviceData *) _this->driverdata;
+    PSL1GHT_SPEPool *pool = devdata->spe_pool;
+    int i;
+
+    if (!pool) {
+        return;
+    }
+    PSL1GHT_SPEFinish(_this);
+    for (i = 0; i < pool->num_spes; ++i) {
+        PSL1GHT_SPEShutdown(&pool->spes[i]);
+    }
+    if (pool->parms) {
+        free(pool->parms);
+    }
+    SDL_free(pool);
+    devdata->spe_pool = NULL;
+}
+
+/* Boot the converters the first time they are needed */
+static int
+bootPool(PSL1GHT_SPEPool * pool)
+{
+#if SDL_VIDEO_PSL1GHT_SPE
+    PSL1GHT_SPE *spe;
+
+    pool->parms = (struct yuv2argb_parms_t *)
+        memalign(128, pool->max_spes * sizeof(*pool->parms));
+    if (!pool->parms) {
+        pool->max_spes = 0;
+        return 0;
+    }
+    /* The application may have done this already, which is fine */
+    sysSpuInitialize(6, PSL1GHT_MAX_SPES);
+    while (pool->num_spes < pool->max_spes) {
+        spe = &pool->spes[pool->num_spes];
+        spe->program_name = "yuv2argb_spu";
+        spe->program = yuv2argb_spu_bin;
+        if (PSL1GHT_SPEBoot(spe) < 0) {
+            break;
+        }
+        ++pool->num_spes;
+    }
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "SPEPool", pool->num_spes,
+                  pool->max_spes);
+#endif
+    /* Don't try again for the ones that were taken */
+    pool->max_spes = pool->num_spes;
+    return pool->num_spes;
+}
+
+/* Start the jobs in pool->parms on the first n SPEs */
+static int
+startJobs(PSL1GHT_SPEPool * pool, int n)
+{
+    Uint64 ea;
+    int i;
+
+    for (i = 0; i < n; ++i) {
+        ea = (Uint64) (size_t) & pool->parms[i];
+        if (PSL1GHT_SPESendMsg(&pool->spes[i], SPU_START) < 0 ||
+            PSL1GHT_SPESendMsg(&pool->spes[i], (Uint32) (ea >> 32)) < 0 ||
+            PSL1GHT_SPESendMsg(&pool->spes[i], (Uint32) ea) < 0) {
+            /* The ones already started still have to be waited for */
+            pool->pending = i;
+            return -1;
+        }
+    }
+    pool->pending = n;
+    return 0;
+}
+
+int
+PSL1GHT_SPEFinish(_THIS)
+{
+    SDL_DeviceData *devdata = (SDL_DeviceData *) _this->driverdata;
+    PSL1GHT_SPEPool *pool = devdata->spe_pool;
+    int i, result = 0;
+
+    if (!pool || !pool->pending) {
+        return 0;
+    }
+    for (i = 0; i < pool->pending; ++i) {
+        if (PSL1GHT_SPEWaitForMsg(&pool->spes[i], SPU_FIN) < 0) {
+            result = -1;
+        }
+    }
+    pool->pending = 0;
+    if (result < 0) {
+        /* Leave the SPEs alone from now on */
+        pool->max_spes = 0;
+    }
+    SDL_AtomicClear32(&pool->busy);
+    return result;
+}
+
+SDL_bool
+PSL1GHT_SPECopyYUVToRGB(_THIS, SDL_SW_YUVTexture * swdata,
+                        const SDL_Rect * srcrect, Uint32 target_format,
+                        int w, int h, void *pixels, int pitch)
+{
+    SDL_DeviceData *devdata = (SDL_DeviceData *) _this->driverdata;
+    PSL1GHT_SPEPool *pool = devdata->spe_pool;
+    struct yuv2argb_parms_t job;
+    int i, n, lines;
+
+    if (!pool || pool->max_spes == 0) {
+        return SDL_FALSE;
+    }
+    if (target_format != SDL_PIXELFORMAT_ARGB8888 &&
+        target_format != SDL_PIXELFORMAT_RGB888) {
+        return SDL_FALSE;
+    }
+    if (w <= 0 || h <= 0 || w > MAX_HDTV_WIDTH ||
+        srcrect->w <= 0 || srcrect->h <= 0 || srcrect->w > MAX_HDTV_WIDTH) {
+        return SDL_FALSE;
+    }
+
+    SDL_zero(job);
+    switch (swdata->format) {
+    case SDL_PIXELFORMAT_YV12:
+        job.format = SPU_YUV_PLANAR;
+        job.planes[1] = (Uint64) (size_t) swdata->planes[2];
+        job.planes[2] = (Uint64) (size_t) swdata->planes[1];
+        job.pitches[1] = swdata->pitches[2];
+        job.pitches[2] = swdata->pitches[1];
+        break;
+    case SDL_PIXELFORMAT_IYUV:
+        job.format = SPU_YUV_PLANAR;
+        job.planes[1] = (Uint64) (size_t) swdata->planes[1];
+        job.planes[2] = (Uint64) (size_t) swdata->planes[2];
+        job.pitches[1] = swdata->pitches[1];
+        job.pitches[2] = swdata->pitches[2];
+        break;
+    case SDL_PIXELFORMAT_YUY2:
+        job.format = SPU_YUV_PACKED;
+        break;
+    default:
+        return SDL_FALSE;
+    }
+    job.planes[0] = (Uint64) (size_t) swdata->planes[0];
+    job.pitches[0] = swdata->pitches[0];
+    job.dst = (Uint64) (size_t) pixels;
+    job.src_x = srcrect->x;
+    job.src_y = srcrect->y;
+    job.src_w = srcrect->w;
+    job.src_h = srcrect->h;
+    job.dst_w = w;
+    job.dst_h = h;
+    job.dst_pitch = pitch;
+
+    /* Another thread has the SPEs, it's the PPU's turn */
+    PSL1GHT_SPEFinish(_this);
+    if (!SDL_AtomicTestThenSet32(&pool->busy)) {
+        return SDL_FALSE;
+    }
+    if (pool->num_spes == 0 && bootPool(pool) == 0) {
+        SDL_AtomicClear32(&pool->busy);
+        return SDL_FALSE;
+    }
+
+    /* One band of lines per SPE */
+    n = SDL_min(pool->num_spes,
+                (h + PSL1GHT_SPE_MIN_LINES - 1) / PSL1GHT_SPE_MIN_LINES);
+    lines = (h + n - 1) / n;
+    for (i = 0; i < n; ++i) {
+        pool->parms[i] = job;
+        pool->parms[i].first_line = i * lines;
+        pool->parms[i].num_lines = SDL_min(lines, h - i * lines);
+    }
+    PSL1GHT_TRACE(3, PSL1GHT_TRACE_VIDEO, "SPECopyYUV", n, h);
+    if (startJobs(pool, n) < 0) {
+        PSL1GHT_SPEFinish(_this);
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,93 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_psl1ghtspe_h
+#define _SDL_psl1ghtspe_h
+
+#include "../SDL_sysvideo.h"
+
+#include <sys/spu.h>
+
+#include "spu/spu_common.h"
+
+/* SPE offload, after the ps3 driver's SDL_ps3spe.c.
+ *
+ * Programs run on raw SPUs in an endless loop driven through the
+ * mailboxes (see spu/spu_common.h): PSL1GHT_SPEBoot() loads and starts
+ * one and waits for SPU_READY, PSL1GHT_SPESendMsg() and
+ * PSL1GHT_SPEWaitForMsg() then run jobs, and PSL1GHT_SPEShutdown() sends
+ * SPU_EXIT and releases the SPU.
+ *
+ * On top of that the video driver keeps a pool of yuv2argb programs,
+ * booted on first use. PSL1GHT_SPECopyYUVToRGB() only starts the
+ * conversion, so the PPU can go on with the frame; PSL1GHT_SPEFinish()
+ * waits for it and has to come before anything else touches the
+ * destination or the texture. Without SDL_VIDEO_PSL1GHT_SPE, or when no
+ * SPU is free, PSL1GHT_SPECopyYUVToRGB() returns SDL_FALSE and the caller
+ * converts on the PPU.
+ */
+
+/* Raw SPUs the driver asks for at most, SDL_VIDEO_PSL1GHT_SPES overrides */
+#define PSL1GHT_MAX_SPES        5
+#define PSL1GHT_DEFAULT_SPES    4
+
+typedef struct
+{
+    const char *program_name;   /* for the trace and errors */
+    const void *program;        /* embedded SPU executable */
+    sysSpuImage image;
+    u32 id;                     /* raw SPU number */
+    int booted;
+} PSL1GHT_SPE;
+
+typedef struct
+{
+    PSL1GHT_SPE spes[PSL1GHT_MAX_SPES];
+    int num_spes;               /* booted so far */
+    int max_spes;               /* to boot on first use */
+    volatile Uint32 busy;       /* a job is running on the pool */
+    int pending;                /* SPEs the running job was given */
+    struct yuv2argb_parms_t *parms;     /* one per SPE */
+} PSL1GHT_SPEPool;
+
+extern int PSL1GHT_SPEBoot(PSL1GHT_SPE * spe);
+extern int PSL1GHT_SPESendMsg(PSL1GHT_SPE * spe, Uint32 msg);
+extern int PSL1GHT_SPEWaitForMsg(PSL1GHT_SPE * spe, Uint32 msg);
+extern int PSL1GHT_SPEShutdown(PSL1GHT_SPE * spe);
+
+extern void PSL1GHT_InitSPE(_THIS);
+extern void PSL1GHT_QuitSPE(_THIS);
+
+/* Start what SDL_SW_CopyYUVToRGB() does, scaling bilinearly on the SPEs */
+struct SDL_SW_YUVTexture;
+extern SDL_bool PSL1GHT_SPECopyYUVToRGB(_THIS,
+                                        struct SDL_SW_YUVTexture * swdata,
+                                        const SDL_Rect * srcrect,
+                                        Uint32 target_format, int w, int h,
+                                        void *pixels, int pitch);
+/* Wait for the conversion started last, if any */
+extern int PSL1GHT_SPEFinish(_THIS);
+
+#endif /* _SDL_psl1ghtspe_h */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,99 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_atomic.h"
+
+#include "SDL_PSL1GHTtrace_c.h"
+
+#if SDL_PSL1GHT_TRACE > 0
+
+#include <stdio.h>
+#include <sys/time.h>
+
+/* Must be a power of two */
+#define PSL1GHT_TRACE_ENTRIES   4096
+
+typedef struct
+{
+    volatile Uint32 sequence;   // Index + 1 once written, 0 while writing
+    int subsystem;
+    Uint64 usec;
+    const char *event;
+    Sint64 args[2];
+} PSL1GHT_TraceEntry;
+
+static PSL1GHT_TraceEntry trace[PSL1GHT_TRACE_ENTRIES];
+static volatile Uint32 trace_next = 0;
+
+static const char *subsystems[] = { "video", "audio", "joystick" };
+
+void
+PSL1GHT_TraceRecord(int subsystem, const char *event, Sint64 a, Sint64 b)
+{
+    Uint32 index = SDL_AtomicFetchThenIncrement32(&trace_next);
+    PSL1GHT_TraceEntry *entry = &trace[index & (PSL1GHT_TRACE_ENTRIES - 1)];
+    struct timeval now;
+
+    /* A writer lapping this one just loses the older of the two events */
+    entry->sequence = 0;
+    __sync_synchronize();
+    gettimeofday(&now, NULL);
+    entry->subsystem = subsystem;
+    entry->usec = (Uint64) now.tv_sec * 1000000 + now.tv_usec;
+    entry->event = event;
+    entry->args[0] = a;
+    entry->args[1] = b;
+    __sync_synchronize();
+    entry->sequence = index + 1;
+}
+
+void
+PSL1GHT_TraceDump(void)
+{
+    Uint32 end = trace_next;
+    Uint32 index = 0;
+    PSL1GHT_TraceEntry entry;
+
+    if (end > PSL1GHT_TRACE_ENTRIES) {
+        index = end - PSL1GHT_TRACE_ENTRIES;
+    }
+    printf("psl1ght trace: %u events, last %u\n", end, end - index);
+    for (; index != end; ++index) {
+        entry = trace[index & (PSL1GHT_TRACE_ENTRIES - 1)];
+        __sync_synchronize();
+        /* Still being written, or already overwritten by a newer event */
+        if (entry.sequence != index + 1 ||
+            trace[index & (PSL1GHT_TRACE_ENTRIES - 1)].sequence !=
+            entry.sequence) {
+            continue;
+        }
+        printf("%llu %s %s %lld %lld\n", (unsigned long long) entry.usec,
+               subsystems[entry.subsystem], entry.event,
+               (long long) entry.args[0], (long long) entry.args[1]);
+    }
+    fflush(stdout);
+}
+
+#endif /* SDL_PSL1GHT_TRACE */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,72 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_psl1ghttrace_h
+#define _SDL_psl1ghttrace_h
+
+/* Tracing for the PSL1GHT video, audio and joystick drivers.
+ *
+ * The level is fixed at compile time, --enable-psl1ght-trace=LEVEL:
+ * 0: off, the trace points compile to nothing
+ * 1: setup and teardown
+ * 2: once per frame, audio block or pad poll
+ * 3: once per render call
+ *
+ * Events are kept in a lock-free ring rather than printed, so tracing
+ * doesn't stall the callers on the TTY. PSL1GHT_TraceDump() prints what
+ * the ring holds; the video driver does it when the XMB opens and at
+ * quit.
+ */
+#ifndef SDL_PSL1GHT_TRACE
+#define SDL_PSL1GHT_TRACE 0
+#endif
+
+#define PSL1GHT_TRACE_VIDEO     0
+#define PSL1GHT_TRACE_AUDIO     1
+#define PSL1GHT_TRACE_JOYSTICK  2
+
+#if SDL_PSL1GHT_TRACE > 0
+
+/* Record an event name, which must be a literal, with two arguments */
+#define PSL1GHT_TRACE(level, subsystem, event, a, b) \
+    do { \
+        if ((level) <= SDL_PSL1GHT_TRACE) { \
+            PSL1GHT_TraceRecord(subsystem, event, (Sint64) (a), \
+                                (Sint64) (b)); \
+        } \
+    } while (0)
+
+extern void PSL1GHT_TraceRecord(int subsystem, const char *event,
+                                Sint64 a, Sint64 b);
+extern void PSL1GHT_TraceDump(void);
+
+#else
+
+#define PSL1GHT_TRACE(level, subsystem, event, a, b)
+#define PSL1GHT_TraceDump()
+
+#endif /* SDL_PSL1GHT_TRACE */
+
+#endif /* _SDL_psl1ghttrace_h */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -66,7 +66,6 @@ PSL1GHT_Available(void)
 static void
 PSL1GHT_DeleteDevice(SDL_VideoDevice * device)
 {
-    printf( "PSL1GHT_DeleteDevice( %16X)\n", device);
     SDL_free(device);
 }
 
@@ -74,7 +73,6 @@ static SDL_VideoDevice *
 PSL1GHT_CreateDevice(int devindex)
 {
     SDL_VideoDevice *device;
-    printf( "PSL1GHT_CreateDevice( %16X)\n", devindex);
 
     /* Initialize all variables that we clean on shutdown */
     device = (SDL_VideoDevice *) SDL_calloc(1, sizeof(SDL_VideoDevice));
@@ -123,6 +121,7 @@ PSL1GHT_VideoInit(_THIS)
 
     initializeGPU(devdata);
     PSL1GHT_InitModes(_this);
+    PSL1GHT_InitSPE(_this);
 
     SDL_AddRenderDriver(&_this->displays[0], &SDL_PSL1GHT_RenderDriver);
 
@@ -136,7 +135,9 @@ PSL1GHT_VideoInit(_THIS)
 void
 PSL1GHT_VideoQuit(_THIS)
 {
-    printf("PSL1GHT_VideoQuit()\n");
+    PSL1GHT_TRACE(1, PSL1GHT_TRACE_VIDEO, "VideoQuit", 0, 0);
+    PSL1GHT_TraceDump();
+    PSL1GHT_QuitSPE(_this);
     PSL1GHT_QuitModes(_this);
     PSL1GHT_QuitSysEvent(_this);
     SDL_free( _this->driverdata);
@@ -145,13 +146,14 @@ PSL1GHT_VideoQuit(_THIS)
 
 void initializeGPU( SDL_DeviceData * devdata)
 {
-    printf("initializeGPU()\n");
    // Allocate a 1Mb buffer, alligned to a 1Mb boundary to be our shared IO memory with the RSX.
     void *host_addr = memalign(1024*1024, 1024*1024);
     assert(host_addr != NULL);
 
-    // Initilise Reality, which sets up the command buffer and shared IO memory
-    devdata->_CommandBuffer = realityInit(0x10000, 1024*1024, host_addr);
+    // Initilise Reality, which sets up the command buffer and shared IO memory.
+    // The buffer holds a frame's worth of batched draws: filling up means
+    // waiting for the RSX to drain it.
+    devdata->_CommandBuffer = realityInit(0x80000, 1024*1024, host_addr);
     assert(devdata->_CommandBuffer != NULL);
 }
 
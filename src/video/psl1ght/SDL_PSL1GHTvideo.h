@@ -29,32 +29,14 @@
 #include <rsx/gcm.h>
 #include <sysutil/video.h>
 
-/* Debugging
- * 0: No debug messages
- * 1: Video debug messages
- * 2: SPE debug messages
- * 3: Memory adresses
- */
-#define VIDEO_DEBUG_LEVEL 3
-
-#ifdef VIDEO_DEBUG_LEVEL
-#define deprintf( level, fmt, args... ) \
-    do \
-{ \
-    if ( (unsigned)(level) <= VIDEO_DEBUG_LEVEL ) \
-    { \
-        fprintf( stdout, fmt, ##args ); \
-        fflush( stdout ); \
-    } \
-} while ( 0 )
-#else
-#define deprintf( level, fmt, args... )
-#endif
+#include "SDL_PSL1GHTtrace_c.h"
+#include "SDL_PSL1GHTspe_c.h"
 
 /* Private RSX data */
 typedef struct SDL_DeviceData
 {
 	gcmContextData *_CommandBuffer; // Context to keep track of the RSX buffer.	
+    PSL1GHT_SPEPool *spe_pool;      // YUV converters, NULL without memory
 } SDL_DeviceData;
 
 typedef struct SDL_DisplayModeData
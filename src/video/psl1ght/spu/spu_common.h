@@ -0,0 +1,81 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* Definitions shared by the PSL1GHT SPU programs and the PPU side.
+ *
+ * The protocol is the one of the ps3 driver's spulibs: the program
+ * announces SPU_READY once, then for every SPU_START it reads the
+ * effective address of its parameters (high word, then low word),
+ * does the job and answers SPU_FIN.  SPU_EXIT makes it return.
+ */
+
+#ifndef _SPU_COMMON_H
+#define _SPU_COMMON_H
+
+#include <stdint.h>
+
+/* Tag management */
+#define DMA_WAIT_TAG(_tag)     \
+    mfc_write_tag_mask(1<<(_tag)); \
+    mfc_read_tag_status_all();
+
+/* SPU mailbox messages */
+#define SPU_READY   0
+#define SPU_START   1
+#define SPU_FIN     2
+#define SPU_EXIT    3
+
+/* Tags: source lines and stores each come in two buffers */
+#define RETR_BUF    0
+#define STR_BUF     2
+#define TAG_INIT    4
+
+/* Widest line a program keeps in local store */
+#define MAX_HDTV_WIDTH  1920
+#define MAX_HDTV_HEIGHT 1080
+
+/* yuv2argb source layouts */
+#define SPU_YUV_PLANAR  0       /* 4:2:0 planes, Y then U then V */
+#define SPU_YUV_PACKED  1       /* 4:2:2 as Y0 U Y1 V */
+
+/* yuv2argb ppu/spu exchange parms.  The SPU converts and bilinearly
+   scales the source rectangle into the destination lines
+   [first_line, first_line + num_lines) of dst_w x dst_h. */
+struct yuv2argb_parms_t {
+    uint64_t planes[3];         /* Y, U, V; planes[0] only when packed */
+    uint64_t dst;               /* first pixel of the destination */
+    uint32_t format;
+    uint32_t pitches[3];
+    uint32_t src_x;
+    uint32_t src_y;
+    uint32_t src_w;
+    uint32_t src_h;
+    uint32_t dst_w;
+    uint32_t dst_h;
+    uint32_t dst_pitch;
+    uint32_t first_line;
+    uint32_t num_lines;
+} __attribute__((aligned(128)));
+
+#endif /* _SPU_COMMON_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
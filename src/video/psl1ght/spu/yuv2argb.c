@@ -0,0 +1,330 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2010 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+/* SPU program: YUV to ARGB8888 conversion with bilinear scaling.
+ *
+ * Does what the ps3 driver's yuv2rgb and bilin_scaler programs did in two
+ * passes in one, line by line: while one destination line is converted,
+ * the source lines of the next one are fetched and the previous one is
+ * stored, each into its own buffer.
+ */
+
+#include <stdint.h>
+#include <spu_mfcio.h>
+
+#include "spu_common.h"
+
+/* A fetched source line: up to two bytes per pixel, plus alignment */
+#define LINE_BYTES  (MAX_HDTV_WIDTH * 2 + 32)
+/* A stored destination line */
+#define OUT_BYTES   (MAX_HDTV_WIDTH * 4 + 32)
+
+/* Colour conversion, the coefficients of SDL_yuv_sw.c in 16.16 */
+#define CR_R    91838
+#define CR_G    46767
+#define CB_G    22571
+#define CB_B    116222
+
+/* Source lines of one destination line */
+typedef struct {
+    uint8_t raw[6][LINE_BYTES] __attribute__((aligned(128)));
+    const uint8_t *y[2];
+    const uint8_t *u[2];
+    const uint8_t *v[2];
+    uint32_t fy;
+    uint32_t fc;
+} lines_t;
+
+/* Everything a job keeps in local store */
+typedef struct {
+    lines_t lines[2];
+    uint8_t out[2][OUT_BYTES] __attribute__((aligned(128)));
+    /* YUY2 lines split into planes */
+    uint8_t unpacked[2][2][MAX_HDTV_WIDTH] __attribute__((aligned(16)));
+    /* Source lines blended to the height of a destination line */
+    uint8_t blended[3][MAX_HDTV_WIDTH + 16] __attribute__((aligned(16)));
+    /* Per destination column: source column and weight */
+    uint16_t lx[MAX_HDTV_WIDTH];
+    uint16_t cx[MAX_HDTV_WIDTH];
+    uint8_t lf[MAX_HDTV_WIDTH];
+    uint8_t cf[MAX_HDTV_WIDTH];
+} job_t;
+
+/* Centre of destination sample i in source space, 16.16 and clamped */
+static int32_t
+source_position(uint32_t i, uint32_t src, uint32_t dst)
+{
+    int64_t pos = ((int64_t) (2 * i + 1) * src << 16) / (2 * dst) - 32768;
+
+    if (pos < 0) {
+        pos = 0;
+    }
+    if (pos > ((int64_t) (src - 1) << 16)) {
+        pos = (int64_t) (src - 1) << 16;
+    }
+    return (int32_t) pos;
+}
+
+/* Chroma samples sit between two luma samples: map a luma position
+   relative to first into chroma space relative to first / 2 */
+static int32_t
+chroma_position(int32_t pos, uint32_t first, uint32_t count)
+{
+    int32_t lo = (int32_t) (first / 2);
+    int32_t hi = (int32_t) ((first + count - 1) / 2);
+    int32_t c = (((int32_t) first << 16) + pos - 32768) / 2;
+
+    if (c < (lo << 16)) {
+        c = lo << 16;
+    }
+    if (c > (hi << 16)) {
+        c = hi << 16;
+    }
+    return c - (lo << 16);
+}
+
+/* Start fetching size bytes at ea, returns where they will land */
+static const uint8_t *
+fetch(uint8_t * buf, uint64_t ea, uint32_t size, uint32_t tag)
+{
+    uint64_t start = ea & ~15ULL;
+    uint32_t len = (uint32_t) ((ea + size - start + 15) & ~15ULL);
+
+    mfc_get(buf, start, len, tag, 0, 0);
+    return buf + (ea - start);
+}
+
+/* Queue the source lines of destination line dy */
+static void
+fetch_lines(const struct yuv2argb_parms_t *parms, lines_t * lines,
+            uint32_t dy, uint32_t tag)
+{
+    int32_t pos = source_position(dy, parms->src_h, parms->dst_h);
+    uint32_t row = parms->src_y + (pos >> 16);
+    uint32_t next = row + ((pos >> 16) < (int32_t) parms->src_h - 1);
+    uint32_t crow, cnext;
+    int32_t cpos;
+
+    lines->fy = (pos >> 8) & 0xff;
+    if (parms->format == SPU_YUV_PACKED) {
+        /* Whole pixel pairs, so every line starts with a U */
+        uint32_t first = parms->src_x & ~1;
+        uint32_t size = ((parms->src_x + parms->src_w + 1) & ~1) - first;
+        uint64_t ea = parms->planes[0] + first * 2;
+
+        lines->y[0] = fetch(lines->raw[0],
+                            ea + row * parms->pitches[0], size * 2, tag);
+        lines->y[1] = fetch(lines->raw[1],
+                            ea + next * parms->pitches[0], size * 2, tag);
+        lines->fc = lines->fy;
+        return;
+    }
+
+    cpos = chroma_position(pos, parms->src_y, parms->src_h);
+    crow = parms->src_y / 2 + (cpos >> 16);
+    cnext = crow + (crow < (parms->src_y + parms->src_h - 1) / 2);
+    lines->fc = (cpos >> 8) & 0xff;
+
+    lines->y[0] = fetch(lines->raw[0], parms->planes[0] +
+                        row * parms->pitches[0] + parms->src_x,
+                        parms->src_w, tag);
+    lines->y[1] = fetch(lines->raw[1], parms->planes[0] +
+                        next * parms->pitches[0] + parms->src_x,
+                        parms->src_w, tag);
+    {
+        uint32_t first = parms->src_x / 2;
+        uint32_t size = (parms->src_x + parms->src_w - 1) / 2 - first + 1;
+
+        lines->u[0] = fetch(lines->raw[2], parms->planes[1] +
+                            crow * parms->pitches[1] + first, size, tag);
+        lines->u[1] = fetch(lines->raw[3], parms->planes[1] +
+                            cnext * parms->pitches[1] + first, size, tag);
+        lines->v[0] = fetch(lines->raw[4], parms->planes[2] +
+                            crow * parms->pitches[2] + first, size, tag);
+        lines->v[1] = fetch(lines->raw[5], parms->planes[2] +
+                            cnext * parms->pitches[2] + first, size, tag);
+    }
+}
+
+/* Split fetched YUY2 lines into the planes the converter reads */
+static void
+unpack_lines(const struct yuv2argb_parms_t *parms, job_t * job,
+             lines_t * lines)
+{
+    uint32_t pairs = (((parms->src_x + parms->src_w + 1) & ~1) -
+                      (parms->src_x & ~1)) / 2;
+    uint32_t i, p;
+
+    for (i = 0; i < 2; ++i) {
+        const uint8_t *src = lines->y[i];
+        uint8_t *y = job->unpacked[i][0];
+        uint8_t *uv = job->unpacked[i][1];
+
+        for (p = 0; p < pairs; ++p) {
+            y[2 * p] = src[4 * p];
+            uv[p] = src[4 * p + 1];
+            y[2 * p + 1] = src[4 * p + 2];
+            uv[MAX_HDTV_WIDTH / 2 + p] = src[4 * p + 3];
+        }
+        /* The columns count from src_x, the pairs from src_x & ~1 */
+        lines->y[i] = y + (parms->src_x & 1);
+        lines->u[i] = uv;
+        lines->v[i] = uv + MAX_HDTV_WIDTH / 2;
+    }
+}
+
+/* Blend two source lines vertically, f / 256 of b, into out */
+static const uint8_t *
+blend_lines(uint8_t * out, const uint8_t * a, const uint8_t * b,
+            uint32_t count, uint32_t f)
+{
+    uint32_t i;
+
+    if (f == 0) {
+        return a;
+    }
+    for (i = 0; i < count; ++i) {
+        out[i] = (uint8_t) ((a[i] * (256 - f) + b[i] * f + 128) >> 8);
+    }
+    return out;
+}
+
+/* The last column has weight 0, so x + 1 may be read past the line */
+static int32_t
+sample(const uint8_t * line, uint32_t x, uint32_t f)
+{
+    return (int32_t) ((line[x] * (256 - f) + line[x + 1] * f + 128) >> 8);
+}
+
+static uint32_t
+clamp(int32_t c)
+{
+    return c < 0 ? 0 : (c > 255 ? 255 : (uint32_t) c);
+}
+
+static void
+convert_line(const struct yuv2argb_parms_t *parms, job_t * job,
+             const lines_t * lines, uint32_t * out)
+{
+    uint32_t chroma = (parms->src_x + parms->src_w - 1) / 2 -
+        parms->src_x / 2 + 1;
+    const uint8_t *ly = blend_lines(job->blended[0], lines->y[0],
+                                    lines->y[1], parms->src_w, lines->fy);
+    const uint8_t *lu = blend_lines(job->blended[1], lines->u[0],
+                                    lines->u[1], chroma, lines->fc);
+    const uint8_t *lv = blend_lines(job->blended[2], lines->v[0],
+                                    lines->v[1], chroma, lines->fc);
+    uint32_t x;
+
+    for (x = 0; x < parms->dst_w; ++x) {
+        int32_t y = sample(ly, job->lx[x], job->lf[x]);
+        int32_t u = sample(lu, job->cx[x], job->cf[x]) - 128;
+        int32_t v = sample(lv, job->cx[x], job->cf[x]) - 128;
+
+        out[x] = 0xff000000 |
+            clamp(y + ((CR_R * v + 32768) >> 16)) << 16 |
+            clamp(y - ((CR_G * v + CB_G * u + 32768) >> 16)) << 8 |
+            clamp(y + ((CB_B * u + 32768) >> 16));
+    }
+}
+
+static void
+convert(const struct yuv2argb_parms_t *parms, job_t * job)
+{
+    uint32_t size = parms->dst_w * 4;
+    uint32_t i, x, b;
+
+    for (x = 0; x < parms->dst_w; ++x) {
+        int32_t pos = source_position(x, parms->src_w, parms->dst_w);
+        int32_t cpos = chroma_position(pos, parms->src_x, parms->src_w);
+
+        job->lx[x] = (uint16_t) (pos >> 16);
+        job->lf[x] = (uint8_t) (pos >> 8);
+        job->cx[x] = (uint16_t) (cpos >> 16);
+        job->cf[x] = (uint8_t) (cpos >> 8);
+    }
+
+    fetch_lines(parms, &job->lines[0], parms->first_line, RETR_BUF);
+    for (i = 0; i < parms->num_lines; ++i) {
+        uint32_t dy = parms->first_line + i;
+        uint64_t ea = parms->dst + (uint64_t) dy * parms->dst_pitch;
+        uint64_t start = ea & ~15ULL;
+        uint32_t len = (uint32_t) ((ea + size - start + 15) & ~15ULL);
+        lines_t *lines;
+
+        b = i & 1;
+        lines = &job->lines[b];
+        if (i + 1 < parms->num_lines) {
+            fetch_lines(parms, &job->lines[b ^ 1], dy + 1,
+                        RETR_BUF + (b ^ 1));
+        }
+        DMA_WAIT_TAG(RETR_BUF + b);
+        DMA_WAIT_TAG(STR_BUF + b);
+        if (parms->format == SPU_YUV_PACKED) {
+            unpack_lines(parms, job, lines);
+        }
+
+        /* Stores are whole quadwords: keep the pixels around the line */
+        if (start != ea || len != size) {
+            mfc_get(job->out[b], start, len, STR_BUF + b, 0, 0);
+            DMA_WAIT_TAG(STR_BUF + b);
+        }
+        convert_line(parms, job, lines,
+                     (uint32_t *) (job->out[b] + (ea - start)));
+        mfc_put(job->out[b], start, len, STR_BUF + b, 0, 0);
+    }
+    DMA_WAIT_TAG(STR_BUF);
+    DMA_WAIT_TAG(STR_BUF + 1);
+}
+
+int
+main(uint64_t speid, uint64_t argp, uint64_t envp)
+{
+    struct yuv2argb_parms_t parms;
+    job_t job;
+    uint64_t ea;
+    uint32_t msg;
+
+    spu_write_out_mbox(SPU_READY);
+    for (;;) {
+        msg = spu_read_in_mbox();
+        if (msg == SPU_EXIT) {
+            break;
+        }
+        if (msg != SPU_START) {
+            continue;
+        }
+        ea = (uint64_t) spu_read_in_mbox() << 32;
+        ea |= spu_read_in_mbox();
+        mfc_get(&parms, ea, sizeof(parms), TAG_INIT, 0, 0);
+        DMA_WAIT_TAG(TAG_INIT);
+        convert(&parms, &job);
+        spu_write_out_mbox(SPU_FIN);
+    }
+    return 0;
+}
+
+#ifdef PSL1GHT_HOST_SPU_IMAGE
+PSL1GHT_HOST_SPU_IMAGE(yuv2argb_spu_bin)
+#endif
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -76,6 +76,87 @@ my %set_rgba_string = (
     "BGRA8888" => "_pixel = ((Uint32)_B << 24) | ((Uint32)_G << 16) | ((Uint32)_R << 8) | _A;",
 );
 
+# Where each channel sits in the pixel value, for the vector kernels.
+# Formats without alpha get the unused byte as their alpha slot.
+my %format_shift = (
+    "RGB888" => { "R" => 16, "G" => 8, "B" => 0, "A" => 24 },
+    "BGR888" => { "B" => 16, "G" => 8, "R" => 0, "A" => 24 },
+    "ARGB8888" => { "A" => 24, "R" => 16, "G" => 8, "B" => 0 },
+    "RGBA8888" => { "R" => 24, "G" => 16, "B" => 8, "A" => 0 },
+    "ABGR8888" => { "A" => 24, "B" => 16, "G" => 8, "R" => 0 },
+    "BGRA8888" => { "B" => 24, "G" => 16, "R" => 8, "A" => 0 },
+);
+
+my %format_has_alpha = (
+    "RGB888" => 0,
+    "BGR888" => 0,
+    "ARGB8888" => 1,
+    "RGBA8888" => 1,
+    "ABGR8888" => 1,
+    "BGRA8888" => 1,
+);
+
+# Every kernel handles exactly one of these, so the inner loops don't branch
+my @blend_modes = ( "", "Mask", "Blend", "Add", "Mod", "Premultiplied" );
+
+# Without source alpha, premultiplied colour only fades with the alpha
+# modulation, which is what Blend does, so those sources don't get their
+# own premultiplied kernels; SDL_CalculateBlit() asks for Blend instead.
+sub blend_modes
+{
+    my $src = shift;
+    if ( !$format_has_alpha{$src} ) {
+        return grep { $_ ne "Premultiplied" } @blend_modes;
+    }
+    return @blend_modes;
+}
+
+my %blend_flag = (
+    "Mask" => "SDL_COPY_MASK",
+    "Blend" => "SDL_COPY_BLEND",
+    "Add" => "SDL_COPY_ADD",
+    "Mod" => "SDL_COPY_MOD",
+    "Premultiplied" => "SDL_COPY_PREMULTIPLIED",
+);
+
+# Vector kernels, 4 pixels at a time, and the CPU features they need.
+# Only kernels that have been checked against the generic ones belong
+# here: the table prefers them whenever the CPU has the feature. There
+# are no AltiVec kernels yet because none has been built and compared on
+# a PPU toolchain; PowerPC uses the generic kernels and the hand-written
+# AltiVec blitters in SDL_blit_N.c and SDL_blit_A.c until then.
+my @vector_cpus = ( "SSE2" );
+
+my %vector_guard = (
+    "SSE2" => "#ifdef __SSE2__",
+);
+
+my %vector_cpu_flags = (
+    "SSE2" => [ "SDL_CPU_SSE2" ],
+);
+
+# The 16-bit lane holding a channel once a pixel is unpacked; SSE2 is
+# little endian
+sub channel_slot
+{
+    my $cpu = shift;
+    my $format = shift;
+    my $channel = shift;
+    return $format_shift{$format}{$channel} / 8;
+}
+
+# The channel in each slot of the destination pixel
+sub dst_channels
+{
+    my $cpu = shift;
+    my $dst = shift;
+    my @channels;
+    foreach my $channel ( "R", "G", "B", "A" ) {
+        $channels[channel_slot($cpu, $dst, $channel)] = $channel;
+    }
+    return @channels;
+}
+
 sub open_file {
     my $name = shift;
     open(FILE, ">$name.new") || die "Cant' open $name.new: $!";
@@ -83,7 +164,7 @@ sub open_file {
 /* DO NOT EDIT!  This file is generated by sdlgenblit.pl */
 /*
     SDL - Simple DirectMedia Layer
-    Copyright (C) 1997-2009 Sam Lantinga
+    Copyright (C) 1997-2010 Sam Lantinga
 
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -139,6 +220,7 @@ sub output_copyfuncname
     my $modulate = shift;
     my $blend = shift;
     my $scale = shift;
+    my $cpu = shift;
     my $args = shift;
     my $suffix = shift;
 
@@ -147,22 +229,41 @@ sub output_copyfuncname
         print FILE "_Modulate";
     }
     if ( $blend ) {
-        print FILE "_Blend";
+        print FILE "_$blend";
     }
     if ( $scale ) {
         print FILE "_Scale";
     }
+    if ( $cpu ) {
+        print FILE "_$cpu";
+    }
     if ( $args ) {
         print FILE "(SDL_BlitInfo *info)";
     }
     print FILE "$suffix";
 }
 
+# Whether a kernel reads the source alpha, so the others never unpack it
+sub uses_src_alpha
+{
+    my $dst = shift;
+    my $blend = shift;
+    if ( $blend ) {
+        return $blend ne "Mod";
+    }
+    return $format_has_alpha{$dst};
+}
+
 sub get_rgba
 {
     my $prefix = shift;
     my $format = shift;
+    my $alpha = shift;
     my $string = $get_rgba_string{$format};
+    if ( !$alpha ) {
+        $string =~ s/ ?_A = [^;]*;//;
+        $string =~ s/^ //;
+    }
     $string =~ s/_/$prefix/g;
     if ( $prefix ne "" ) {
         print FILE <<__EOF__;
@@ -196,6 +297,7 @@ sub output_copycore
     my $dst = shift;
     my $modulate = shift;
     my $blend = shift;
+    my $alpha = uses_src_alpha($dst, $blend);
     my $s = "";
     my $d = "";
 
@@ -208,61 +310,74 @@ __EOF__
     }
 
     if ( $blend ) {
-        get_rgba("src", $src);
-        get_rgba("dst", $dst);
+        get_rgba("src", $src, $alpha);
+        get_rgba("dst", $dst, $format_has_alpha{$dst});
         $s = "src";
         $d = "dst";
     } else {
-        get_rgba("", $src);
+        get_rgba("", $src, $alpha);
     }
 
     if ( $modulate ) {
         print FILE <<__EOF__;
-            if (flags & SDL_COPY_MODULATE_COLOR) {
-                ${s}R = (${s}R * modulateR) / 255;
-                ${s}G = (${s}G * modulateG) / 255;
-                ${s}B = (${s}B * modulateB) / 255;
-            }
-            if (flags & SDL_COPY_MODULATE_ALPHA) {
-                ${s}A = (${s}A * modulateA) / 255;
-            }
+            ${s}R = DIV255(${s}R * modulateR);
+            ${s}G = DIV255(${s}G * modulateG);
+            ${s}B = DIV255(${s}B * modulateB);
 __EOF__
+        if ( $alpha ) {
+            print FILE <<__EOF__;
+            ${s}A = DIV255(${s}A * modulateA);
+__EOF__
+        }
     }
-    if ( $blend ) {
+    if ( $blend eq "Blend" || $blend eq "Add" ) {
         print FILE <<__EOF__;
-            if (flags & (SDL_COPY_BLEND|SDL_COPY_ADD)) {
-                /* This goes away if we ever use premultiplied alpha */
-                if (${s}A < 255) {
-                    ${s}R = (${s}R * ${s}A) / 255;
-                    ${s}G = (${s}G * ${s}A) / 255;
-                    ${s}B = (${s}B * ${s}A) / 255;
-                }
+            /* SDL_BLENDMODE_PREMULTIPLIED skips this */
+            if (${s}A < 255) {
+                ${s}R = DIV255(${s}R * ${s}A);
+                ${s}G = DIV255(${s}G * ${s}A);
+                ${s}B = DIV255(${s}B * ${s}A);
             }
-            switch (flags & (SDL_COPY_MASK|SDL_COPY_BLEND|SDL_COPY_ADD|SDL_COPY_MOD)) {
-            case SDL_COPY_MASK:
-                if (${s}A) {
-                    ${d}R = ${s}R;
-                    ${d}G = ${s}G;
-                    ${d}B = ${s}B;
-                }
-                break;
-            case SDL_COPY_BLEND:
-                ${d}R = ${s}R + ((255 - ${s}A) * ${d}R) / 255;
-                ${d}G = ${s}G + ((255 - ${s}A) * ${d}G) / 255;
-                ${d}B = ${s}B + ((255 - ${s}A) * ${d}B) / 255;
-                break;
-            case SDL_COPY_ADD:
-                ${d}R = ${s}R + ${d}R; if (${d}R > 255) ${d}R = 255;
-                ${d}G = ${s}G + ${d}G; if (${d}G > 255) ${d}G = 255;
-                ${d}B = ${s}B + ${d}B; if (${d}B > 255) ${d}B = 255;
-                break;
-            case SDL_COPY_MOD:
-                ${d}R = (${s}R * ${d}R) / 255;
-                ${d}G = (${s}G * ${d}G) / 255;
-                ${d}B = (${s}B * ${d}B) / 255;
-                break;
+__EOF__
+    }
+    if ( $blend eq "Mask" ) {
+        print FILE <<__EOF__;
+            if (${s}A) {
+                ${d}R = ${s}R;
+                ${d}G = ${s}G;
+                ${d}B = ${s}B;
             }
 __EOF__
+    } elsif ( $blend eq "Blend" ) {
+        print FILE <<__EOF__;
+            ${d}R = ${s}R + DIV255((255 - ${s}A) * ${d}R);
+            ${d}G = ${s}G + DIV255((255 - ${s}A) * ${d}G);
+            ${d}B = ${s}B + DIV255((255 - ${s}A) * ${d}B);
+__EOF__
+    } elsif ( $blend eq "Add" ) {
+        print FILE <<__EOF__;
+            ${d}R = ${s}R + ${d}R; if (${d}R > 255) ${d}R = 255;
+            ${d}G = ${s}G + ${d}G; if (${d}G > 255) ${d}G = 255;
+            ${d}B = ${s}B + ${d}B; if (${d}B > 255) ${d}B = 255;
+__EOF__
+    } elsif ( $blend eq "Mod" ) {
+        print FILE <<__EOF__;
+            ${d}R = DIV255(${s}R * ${d}R);
+            ${d}G = DIV255(${s}G * ${d}G);
+            ${d}B = DIV255(${s}B * ${d}B);
+__EOF__
+    } elsif ( $blend eq "Premultiplied" ) {
+        # Colour above its alpha saturates, as the vector kernels do
+        print FILE <<__EOF__;
+            ${d}R = ${s}R + DIV255((255 - ${s}A) * ${d}R); if (${d}R > 255) ${d}R = 255;
+            ${d}G = ${s}G + DIV255((255 - ${s}A) * ${d}G); if (${d}G > 255) ${d}G = 255;
+            ${d}B = ${s}B + DIV255((255 - ${s}A) * ${d}B); if (${d}B > 255) ${d}B = 255;
+__EOF__
+        if ( $format_has_alpha{$dst} ) {
+            print FILE <<__EOF__;
+            ${d}A = ${s}A + DIV255((255 - ${s}A) * ${d}A);
+__EOF__
+        }
     }
     if ( $blend ) {
         set_rgba("dst", $dst);
@@ -271,40 +386,99 @@ __EOF__
     }
 }
 
-sub output_copyfunc
+# One pixel at a time, while (cond) holds
+sub output_copyloop
 {
     my $src = shift;
     my $dst = shift;
     my $modulate = shift;
     my $blend = shift;
-    my $scale = shift;
+    my $cond = shift;
 
-    output_copyfuncname("static void", $src, $dst, $modulate, $blend, $scale, 1, "\n");
     print FILE <<__EOF__;
+        while ($cond) {
+__EOF__
+    output_copycore($src, $dst, $modulate, $blend);
+    print FILE <<__EOF__;
+            ++src;
+            ++dst;
+        }
+__EOF__
+}
+
+# The modulation flags are folded into the factors, so one kernel does
+# any mix of them without testing the flags per pixel
+sub output_modulatedecls
 {
+    my $modulate = shift;
+    my $blend = shift;
+    my $alpha = shift;
+
+    if ( $modulate && $blend eq "Premultiplied" ) {
+        print FILE <<__EOF__;
     const int flags = info->flags;
+    const Uint32 modulateA = (flags & SDL_COPY_MODULATE_ALPHA) ? info->a : 255;
+    /* The colour already carries the alpha, so it fades with it too */
+    const Uint32 modulateR = DIV255(((flags & SDL_COPY_MODULATE_COLOR) ? info->r : 255) * modulateA);
+    const Uint32 modulateG = DIV255(((flags & SDL_COPY_MODULATE_COLOR) ? info->g : 255) * modulateA);
+    const Uint32 modulateB = DIV255(((flags & SDL_COPY_MODULATE_COLOR) ? info->b : 255) * modulateA);
 __EOF__
-    if ( $modulate ) {
+    } elsif ( $modulate ) {
         print FILE <<__EOF__;
-    const Uint32 modulateR = info->r;
-    const Uint32 modulateG = info->g;
-    const Uint32 modulateB = info->b;
-    const Uint32 modulateA = info->a;
+    const int flags = info->flags;
+    const Uint32 modulateR = (flags & SDL_COPY_MODULATE_COLOR) ? info->r : 255;
+    const Uint32 modulateG = (flags & SDL_COPY_MODULATE_COLOR) ? info->g : 255;
+    const Uint32 modulateB = (flags & SDL_COPY_MODULATE_COLOR) ? info->b : 255;
 __EOF__
+        if ( $alpha ) {
+            print FILE <<__EOF__;
+    const Uint32 modulateA = (flags & SDL_COPY_MODULATE_ALPHA) ? info->a : 255;
+__EOF__
+        }
     }
+}
+
+sub output_copydecls
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+
+    my $alpha = uses_src_alpha($dst, $blend);
+    my $srcA = $alpha ? ", srcA" : "";
+    my $dstA = $format_has_alpha{$dst} ? ", dstA" : "";
+    my $A = $alpha ? ", A" : "";
+
+    output_modulatedecls($modulate, $blend, $alpha);
     if ( $blend ) {
         print FILE <<__EOF__;
     Uint32 srcpixel;
-    Uint32 srcR, srcG, srcB, srcA;
+    Uint32 srcR, srcG, srcB$srcA;
     Uint32 dstpixel;
-    Uint32 dstR, dstG, dstB, dstA;
+    Uint32 dstR, dstG, dstB$dstA;
 __EOF__
     } elsif ( $modulate || $src ne $dst ) {
         print FILE <<__EOF__;
     Uint32 pixel;
-    Uint32 R, G, B, A;
+    Uint32 R, G, B$A;
 __EOF__
     }
+}
+
+sub output_copyfunc
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+    my $scale = shift;
+
+    output_copyfuncname("static void", $src, $dst, $modulate, $blend, $scale, "", 1, "\n");
+    print FILE <<__EOF__;
+{
+__EOF__
+    output_copydecls($src, $dst, $modulate, $blend);
     if ( $scale ) {
         print FILE <<__EOF__;
     int srcy, srcx;
@@ -353,18 +527,229 @@ __EOF__
         $format_type{$src} *src = ($format_type{$src} *)info->src;
         $format_type{$dst} *dst = ($format_type{$dst} *)info->dst;
         int n = info->dst_w;
-        while (n--) {
 __EOF__
-        output_copycore($src, $dst, $modulate, $blend);
+        output_copyloop($src, $dst, $modulate, $blend, "n--");
         print FILE <<__EOF__;
-            ++src;
-            ++dst;
+        info->src += info->src_pitch;
+        info->dst += info->dst_pitch;
+    }
+__EOF__
+    }
+    print FILE <<__EOF__;
+}
+
+__EOF__
+}
+
+# The 16-bit lane values for a pixel pair, lowest lane first
+sub slot_values
+{
+    my $cpu = shift;
+    my $dst = shift;
+    my %values = @_;
+    my @lanes;
+    foreach my $channel ( dst_channels($cpu, $dst) ) {
+        push(@lanes, $values{$channel});
+    }
+    return (@lanes, @lanes);
+}
+
+# Each step on the unpacked pixels, for SSE2
+sub output_vectorhalf_SSE2
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+    my $half = shift;
+    my $v = "${half}";
+    my $swizzle = 0;
+    my $alpha = channel_slot("SSE2", $dst, "A") * 0x55;
+
+    my @channels = dst_channels("SSE2", $dst);
+    for (my $i = 0; $i < 4; ++$i) {
+        $swizzle |= channel_slot("SSE2", $src, $channels[$i]) << (2 * $i);
+    }
+
+    print FILE <<__EOF__;
+            $v = _mm_unpack${half}_epi8(s, zero);
+__EOF__
+    if ( $swizzle != 0xE4 ) {
+        $swizzle = sprintf("0x%02X", $swizzle);
+        print FILE <<__EOF__;
+            $v = _mm_shufflehi_epi16(_mm_shufflelo_epi16($v, $swizzle), $swizzle);
+__EOF__
+    }
+    if ( !$format_has_alpha{$src} ) {
+        print FILE <<__EOF__;
+            $v = _mm_or_si128(_mm_and_si128($v, color), opaque);
+__EOF__
+    }
+    if ( $modulate ) {
+        print FILE <<__EOF__;
+            $v = SDL_Mul255_SSE2($v, modulate);
+__EOF__
+    }
+    if ( !$blend ) {
+        if ( !$format_has_alpha{$dst} ) {
+            print FILE <<__EOF__;
+            $v = _mm_and_si128($v, color);
+__EOF__
+        }
+        return;
+    }
+
+    $alpha = sprintf("0x%02X", $alpha);
+    print FILE <<__EOF__;
+            d${half} = _mm_unpack${half}_epi8(d, zero);
+__EOF__
+    if ( $blend ne "Mod" ) {
+        print FILE <<__EOF__;
+            a = _mm_shufflehi_epi16(_mm_shufflelo_epi16($v, $alpha), $alpha);
+__EOF__
+    }
+    if ( $blend eq "Mask" ) {
+        print FILE <<__EOF__;
+            a = _mm_cmpeq_epi16(a, zero);
+            $v = _mm_or_si128(_mm_and_si128(a, d${half}), _mm_andnot_si128(a, $v));
+__EOF__
+    } elsif ( $blend eq "Blend" ) {
+        print FILE <<__EOF__;
+            $v = SDL_Mul255_SSE2($v, a);
+            $v = _mm_add_epi16($v, SDL_Mul255_SSE2(_mm_sub_epi16(full, a), d${half}));
+__EOF__
+    } elsif ( $blend eq "Add" ) {
+        print FILE <<__EOF__;
+            $v = SDL_Mul255_SSE2($v, a);
+            $v = _mm_min_epi16(_mm_add_epi16($v, d${half}), full);
+__EOF__
+    } elsif ( $blend eq "Mod" ) {
+        print FILE <<__EOF__;
+            $v = SDL_Mul255_SSE2($v, d${half});
+__EOF__
+    } elsif ( $blend eq "Premultiplied" ) {
+        # Alpha goes through the same sum, so it is already the new alpha
+        print FILE <<__EOF__;
+            $v = _mm_add_epi16($v, SDL_Mul255_SSE2(_mm_sub_epi16(full, a), d${half}));
+__EOF__
+        if ( !$format_has_alpha{$dst} ) {
+            print FILE <<__EOF__;
+            $v = _mm_and_si128($v, color);
+__EOF__
+        }
+        return;
+    }
+    if ( $format_has_alpha{$dst} ) {
+        print FILE <<__EOF__;
+            $v = _mm_or_si128(_mm_and_si128($v, color), _mm_andnot_si128(color, d${half}));
+__EOF__
+    } else {
+        print FILE <<__EOF__;
+            $v = _mm_and_si128($v, color);
+__EOF__
+    }
+}
+
+sub output_vectorfunc_SSE2
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+
+    my $color = join(", ", reverse(slot_values("SSE2", $dst,
+        "R" => -1, "G" => -1, "B" => -1, "A" => 0)));
+    print FILE <<__EOF__;
+    const __m128i zero = _mm_setzero_si128();
+__EOF__
+    # Kept for setting or dropping alpha, which only a premultiplied blend
+    # between formats with alpha does without
+    if ( !$format_has_alpha{$src} || !$format_has_alpha{$dst} ||
+         ($blend && $blend ne "Premultiplied") ) {
+        print FILE <<__EOF__;
+    const __m128i color = _mm_set_epi16($color);
+__EOF__
+    }
+    if ( $modulate ) {
+        my $factors = join(", ", reverse(slot_values("SSE2", $dst,
+            "R" => "modulateR", "G" => "modulateG",
+            "B" => "modulateB", "A" => "modulateA")));
+        print FILE <<__EOF__;
+    const __m128i modulate = _mm_set_epi16($factors);
+__EOF__
+    }
+    if ( !$format_has_alpha{$src} ) {
+        my $opaque = join(", ", reverse(slot_values("SSE2", $dst,
+            "R" => 0, "G" => 0, "B" => 0, "A" => 255)));
+        print FILE <<__EOF__;
+    const __m128i opaque = _mm_set_epi16($opaque);
+__EOF__
+    }
+    if ( $blend eq "Blend" || $blend eq "Add" || $blend eq "Premultiplied" ) {
+        print FILE <<__EOF__;
+    const __m128i full = _mm_set1_epi16(255);
+__EOF__
+    }
+    print FILE <<__EOF__;
+    const int width = info->dst_w & ~3;
+    SDL_BlitInfo rest = *info;
+
+    while (info->dst_h--) {
+        const Uint32 *src = (const Uint32 *)info->src;
+        Uint32 *dst = (Uint32 *)info->dst;
+        int n;
+        for (n = width; n; n -= 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *)src);
+__EOF__
+    if ( $blend ) {
+        print FILE <<__EOF__;
+            const __m128i d = _mm_loadu_si128((const __m128i *)dst);
+__EOF__
+        my $a = ($blend ne "Mod") ? "a, " : "";
+        print FILE <<__EOF__;
+            __m128i ${a}dlo, dhi;
+__EOF__
+    }
+    print FILE <<__EOF__;
+            __m128i lo, hi;
+__EOF__
+    output_vectorhalf_SSE2($src, $dst, $modulate, $blend, "lo");
+    output_vectorhalf_SSE2($src, $dst, $modulate, $blend, "hi");
+    print FILE <<__EOF__;
+            _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(lo, hi));
+            src += 4;
+            dst += 4;
         }
         info->src += info->src_pitch;
         info->dst += info->dst_pitch;
     }
+
+    /* The last few columns */
+    if (width < rest.dst_w) {
+        rest.src += width * 4;
+        rest.dst += width * 4;
+        rest.src_w = rest.dst_w = rest.dst_w - width;
 __EOF__
+    output_copyfuncname("       ", $src, $dst, $modulate, $blend, 0, "", 0, "(&rest);\n");
+    print FILE <<__EOF__;
     }
+__EOF__
+}
+
+sub output_vectorfunc
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+    my $cpu = shift;
+
+    output_copyfuncname("static void", $src, $dst, $modulate, $blend, 0, $cpu, 1, "\n");
+    print FILE <<__EOF__;
+{
+__EOF__
+    output_modulatedecls($modulate, $blend, 1);
+    output_vectorfunc_SSE2($src, $dst, $modulate, $blend);
     print FILE <<__EOF__;
 }
 
@@ -382,9 +767,44 @@ sub output_copyinc
 #include "SDL_blit.h"
 #include "SDL_blit_auto.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+/* DIV255() of a product of two bytes in each 16-bit lane */
+static __inline__ __m128i
+SDL_Mul255_SSE2(const __m128i a, const __m128i b)
+{
+    const __m128i x = _mm_mullo_epi16(a, b);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)),
+                                        _mm_srli_epi16(x, 8)), 8);
+}
+#endif /* __SSE2__ */
+
 __EOF__
 }
 
+sub output_copyflags
+{
+    my $modulate = shift;
+    my $blend = shift;
+    my $scale = shift;
+    my @flags;
+
+    if ( $modulate ) {
+        push(@flags, "SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA");
+    }
+    if ( $blend ) {
+        push(@flags, $blend_flag{$blend});
+    }
+    if ( $scale ) {
+        push(@flags, "SDL_COPY_NEAREST");
+    }
+    if ( !@flags ) {
+        push(@flags, "0");
+    }
+    return join(" | ", @flags);
+}
+
 sub output_copyfunctable
 {
     print FILE <<__EOF__;
@@ -394,43 +814,27 @@ __EOF__
         my $src = $src_formats[$i];
         for (my $j = 0; $j <= $#dst_formats; ++$j) {
             my $dst = $dst_formats[$j];
-            for (my $modulate = 0; $modulate <= 1; ++$modulate) {
-                for (my $blend = 0; $blend <= 1; ++$blend) {
+            # The first entry that has all the wanted flags is used, so
+            # each kernel comes before those that do more
+            foreach my $blend (blend_modes($src)) {
+                for (my $modulate = 0; $modulate <= 1; ++$modulate) {
                     for (my $scale = 0; $scale <= 1; ++$scale) {
-                        if ( $modulate || $blend || $scale ) {
-                            print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ";
-                            my $flags = "";
-                            my $flag = "";
-                            if ( $modulate ) {
-                                $flag = "SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA";
-                                if ( $flags eq "" ) {
-                                    $flags = $flag;
-                                } else {
-                                    $flags = "$flags | $flag";
-                                }
-                            }
-                            if ( $blend ) {
-                                $flag = "SDL_COPY_MASK | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD";
-                                if ( $flags eq "" ) {
-                                    $flags = $flag;
-                                } else {
-                                    $flags = "$flags | $flag";
-                                }
-                            }
-                            if ( $scale ) {
-                                $flag = "SDL_COPY_NEAREST";
-                                if ( $flags eq "" ) {
-                                    $flags = $flag;
-                                } else {
-                                    $flags = "$flags | $flag";
+                        if ( !$modulate && !$blend && !$scale ) {
+                            next;
+                        }
+                        my $flags = output_copyflags($modulate, $blend, $scale);
+                        if ( !$scale ) {
+                            foreach my $cpu (@vector_cpus) {
+                                print FILE "$vector_guard{$cpu}\n";
+                                foreach my $cpuflag (@{$vector_cpu_flags{$cpu}}) {
+                                    print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ($flags), $cpuflag,";
+                                    output_copyfuncname("", $src, $dst, $modulate, $blend, $scale, $cpu, 0, " },\n");
                                 }
+                                print FILE "#endif\n";
                             }
-                            if ( $flags eq "" ) {
-                                $flags = "0";
-                            }
-                            print FILE "($flags), SDL_CPU_ANY,";
-                            output_copyfuncname("", $src_formats[$i], $dst_formats[$j], $modulate, $blend, $scale, 0, " },\n");
                         }
+                        print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ($flags), SDL_CPU_ANY,";
+                        output_copyfuncname("", $src, $dst, $modulate, $blend, $scale, "", 0, " },\n");
                     }
                 }
             }
@@ -448,8 +852,8 @@ sub output_copyfunc_c
     my $src = shift;
     my $dst = shift;
 
-    for (my $modulate = 0; $modulate <= 1; ++$modulate) {
-        for (my $blend = 0; $blend <= 1; ++$blend) {
+    foreach my $blend (blend_modes($src)) {
+        for (my $modulate = 0; $modulate <= 1; ++$modulate) {
             for (my $scale = 0; $scale <= 1; ++$scale) {
                 if ( $modulate || $blend || $scale ) {
                     output_copyfunc($src, $dst, $modulate, $blend, $scale);
@@ -457,6 +861,17 @@ sub output_copyfunc_c
             }
         }
     }
+    foreach my $cpu (@vector_cpus) {
+        print FILE "$vector_guard{$cpu}\n\n";
+        foreach my $blend (blend_modes($src)) {
+            for (my $modulate = 0; $modulate <= 1; ++$modulate) {
+                if ( $modulate || $blend ) {
+                    output_vectorfunc($src, $dst, $modulate, $blend, $cpu);
+                }
+            }
+        }
+        print FILE "#endif\n\n";
+    }
 }
 
 open_file("SDL_blit_auto.h");
@@ -68,6 +68,543 @@ static void audio_testOpen (void)
 }
 
 
+/* Enough voices, samples and range to saturate and to cross mixer blocks. */
+#define MIX_SOURCES     40
+#define MIX_SAMPLES     611
+#define MIX_TOLERANCE   0.00001
+
+
+static Uint32 audio_mixSeed = 1;
+
+static int audio_mixRandom( int range )
+{
+   audio_mixSeed = audio_mixSeed * 1103515245 + 12345;
+   return (int) ((audio_mixSeed >> 8) % (Uint32) range);
+}
+
+
+static void audio_mixPut( SDL_AudioFormat format, Uint8 *buf, int i, double v )
+{
+   union { float f; Uint32 u; } x;
+   Uint16 s;
+
+   if (SDL_AUDIO_ISFLOAT(format)) {
+      x.f = (float) v;
+      x.u = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE32(x.u) : SDL_SwapLE32(x.u);
+      SDL_memcpy( buf + i*4, &x.u, 4 );
+   }
+   else {
+      s = (Uint16) (Sint16) v;
+      s = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE16(s) : SDL_SwapLE16(s);
+      SDL_memcpy( buf + i*2, &s, 2 );
+   }
+}
+
+
+static double audio_mixGet( SDL_AudioFormat format, const Uint8 *buf, int i )
+{
+   union { float f; Uint32 u; } x;
+   Uint16 s;
+
+   if (SDL_AUDIO_ISFLOAT(format)) {
+      SDL_memcpy( &x.u, buf + i*4, 4 );
+      x.u = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE32(x.u) : SDL_SwapLE32(x.u);
+      return x.f;
+   }
+   SDL_memcpy( &s, buf + i*2, 2 );
+   s = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE16(s) : SDL_SwapLE16(s);
+   return (Sint16) s;
+}
+
+
+/**
+ * @brief Mixes many sources at once and checks against a plain sum.
+ *
+ * Buffers start off 16 byte alignment on purpose.
+ */
+static int audio_mixFormat( SDL_AudioFormat format, const char *features )
+{
+   SDL_AudioMixSource sources[MIX_SOURCES];
+   Uint8 *mem, *dst, *src[MIX_SOURCES];
+   const int size = SDL_AUDIO_BITSIZE(format) / 8;
+   const int stride = MIX_SAMPLES*size + 16;
+   double want, got;
+   Sint32 sum;
+   int i, j, bad;
+
+   mem = (Uint8*) SDL_malloc( stride * (MIX_SOURCES+1) );
+   if (SDL_ATvassert( mem != NULL, "Out of memory" ))
+      return -1;
+   dst = mem + size;
+   for (j=0; j<MIX_SOURCES; j++) {
+      src[j] = mem + (j+1)*stride + (j % 4)*size;
+      sources[j].buf = src[j];
+      /* A few are silent or out of range; 1 is louder than full volume. */
+      sources[j].volume = audio_mixRandom( SDL_MIX_MAXVOLUME+1 ) - 4;
+   }
+   sources[0].volume = SDL_MIX_MAXVOLUME;
+   sources[1].volume = SDL_MIX_MAXVOLUME * 2;
+
+   for (i=0; i<MIX_SAMPLES; i++) {
+      for (j=0; j<MIX_SOURCES; j++) {
+         if (SDL_AUDIO_ISFLOAT(format))
+            audio_mixPut( format, src[j], i, (audio_mixRandom( 2001 ) - 1000) / 4000.0 );
+         else
+            audio_mixPut( format, src[j], i, audio_mixRandom( 65536 ) - 32768 );
+      }
+      /* A quiet stretch that must not clip. */
+      if (i < 64)
+         for (j=0; j<MIX_SOURCES; j++)
+            audio_mixPut( format, src[j], i, SDL_AUDIO_ISFLOAT(format) ? 0.001 : 3 );
+      audio_mixPut( format, dst, i, SDL_AUDIO_ISFLOAT(format) ? 0.25 : -1000 );
+   }
+
+   SDL_setenv( "SDL_AUDIO_CPU_FEATURES", features, 1 );
+   SDL_MixAudioSources( dst, sources, MIX_SOURCES, format, MIX_SAMPLES*size );
+   SDL_setenv( "SDL_AUDIO_CPU_FEATURES", "", 1 );
+
+   bad = 0;
+   for (i=0; (i<MIX_SAMPLES) && !bad; i++) {
+      got = audio_mixGet( format, dst, i );
+      if (SDL_AUDIO_ISFLOAT(format)) {
+         want = 0.25;
+         for (j=0; j<MIX_SOURCES; j++)
+            if (sources[j].volume > 0)
+               want += audio_mixGet( format, src[j], i ) *
+                     SDL_min( sources[j].volume, SDL_MIX_MAXVOLUME ) / 128.0;
+         want = SDL_max( SDL_min( want, 1.0 ), -1.0 );
+         bad = (SDL_fabs( want - got ) > MIX_TOLERANCE);
+      }
+      else {
+         sum = -1000 * SDL_MIX_MAXVOLUME;
+         for (j=0; j<MIX_SOURCES; j++)
+            if (sources[j].volume > 0)
+               sum += (Sint32) audio_mixGet( format, src[j], i ) *
+                     SDL_min( sources[j].volume, SDL_MIX_MAXVOLUME );
+         /* Rounds down, like an arithmetic shift. */
+         sum = (sum >= 0) ? (sum / 128) : -((-sum + 127) / 128);
+         want = SDL_max( SDL_min( sum, 32767 ), -32768 );
+         bad = (want != got);
+      }
+      if (i < 64)
+         bad |= (got == 32767) || (got == 1.0);
+   }
+   SDL_free( mem );
+
+   if (SDL_ATvassert( !bad, "SDL_MixAudioSources( 0x%04x ) with features '%s': sample %d is %f, not %f",
+            format, features, i-1, got, want ))
+      return -1;
+   return 0;
+}
+
+
+/**
+ * @brief Checks SDL_MixAudioSources() with and without vector units.
+ */
+static void audio_testMix (void)
+{
+   static const SDL_AudioFormat formats[] = {
+      AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_F32LSB, AUDIO_F32MSB
+   };
+   Uint8 mixed[64], sequential[64], src[2][64];
+   SDL_AudioMixSource sources[2];
+   int i;
+
+   /* Begin testcase. */
+   SDL_ATbegin( "Audio Mix Sources" );
+
+   for (i=0; i<SDL_arraysize(formats); i++) {
+      if (audio_mixFormat( formats[i], "0" ))
+         return;
+      if (audio_mixFormat( formats[i], "" ))
+         return;
+   }
+
+   /* Other formats are mixed one source at a time. */
+   for (i=0; i<64; i++) {
+      mixed[i] = sequential[i] = (Uint8) audio_mixRandom( 256 );
+      src[0][i] = (Uint8) audio_mixRandom( 256 );
+      src[1][i] = (Uint8) audio_mixRandom( 256 );
+   }
+   sources[0].buf = src[0];
+   sources[0].volume = SDL_MIX_MAXVOLUME;
+   sources[1].buf = src[1];
+   sources[1].volume = SDL_MIX_MAXVOLUME / 2;
+   SDL_MixAudioSources( mixed, sources, 2, AUDIO_U8, sizeof(mixed) );
+   SDL_MixAudioFormat( sequential, src[0], AUDIO_U8, sizeof(sequential), SDL_MIX_MAXVOLUME );
+   SDL_MixAudioFormat( sequential, src[1], AUDIO_U8, sizeof(sequential), SDL_MIX_MAXVOLUME / 2 );
+   if (SDL_ATassert( "SDL_MixAudioSources( AUDIO_U8 ) differs from SDL_MixAudioFormat()",
+            SDL_memcmp( mixed, sequential, sizeof(mixed) ) == 0 ))
+      return;
+
+   /* End testcase. */
+   SDL_ATend();
+}
+
+
+static void SDLCALL audio_nullCallback( void *userdata, Uint8 *stream, int len )
+{
+   (void) userdata;
+   SDL_memset( stream, 0, len );
+}
+
+
+/**
+ * @brief Pushes audio to a device opened without a callback.
+ */
+static void audio_testQueue (void)
+{
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceID dev;
+   Uint8 *data;
+   Uint32 queued;
+   int ret, i;
+
+   /* Begin testcase. */
+   SDL_ATbegin( "Audio Queue" );
+
+   /* The dummy driver plays in real time without any hardware. */
+   SDL_setenv( "SDL_AUDIODRIVER", "dummy", 1 );
+   SDL_setenv( "SDL_AUDIO_QUEUE_SIZE", "16384", 1 );
+   ret = SDL_Init( SDL_INIT_AUDIO );
+   if (SDL_ATvassert( ret==0, "SDL_Init( SDL_INIT_AUDIO ): %s", SDL_GetError()))
+      return;
+
+   SDL_zero( desired );
+   desired.freq = 44100;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 2;
+   desired.samples = 512;
+   dev = SDL_OpenAudioDevice( NULL, 0, &desired, &obtained, 0 );
+   if (SDL_ATvassert( dev != 0, "SDL_OpenAudioDevice(): %s", SDL_GetError()))
+      goto quit;
+
+   /* Fill it up while paused; the last push only partly fits. */
+   data = (Uint8*) SDL_malloc( 10000 );
+   if (SDL_ATvassert( data != NULL, "Out of memory" ))
+      goto close;
+   SDL_memset( data, 0, 10000 );
+   queued = 0;
+   for (i=0; i<2; i++) {
+      ret = SDL_QueueAudio( dev, data, 10000 );
+      queued += (Uint32) ret;
+   }
+   SDL_free( data );
+   if (SDL_ATvassert( queued == 16384, "Queued %u bytes of 16384", queued ))
+      goto close;
+   if (SDL_ATvassert( ret % 4 == 0, "Queued %d bytes, not whole frames", ret ))
+      goto close;
+   if (SDL_ATvassert( SDL_GetQueuedAudioSize( dev ) == queued,
+            "SDL_GetQueuedAudioSize() is %u, not %u",
+            SDL_GetQueuedAudioSize( dev ), queued ))
+      goto close;
+   if (SDL_ATassert( "SDL_QueueAudio() on a full queue accepted data",
+            SDL_QueueAudio( dev, &queued, 4 ) == 0 ))
+      goto close;
+
+   /* About 93ms of audio; give it a good while to drain. */
+   SDL_PauseAudioDevice( dev, 0 );
+   for (i=0; (i<200) && (SDL_GetQueuedAudioSize( dev ) > 0); i++)
+      SDL_Delay( 10 );
+   if (SDL_ATvassert( SDL_GetQueuedAudioSize( dev ) == 0,
+            "%u bytes still queued", SDL_GetQueuedAudioSize( dev ) ))
+      goto close;
+   SDL_CloseAudioDevice( dev );
+
+   /* Devices with a callback don't queue. */
+   desired.callback = audio_nullCallback;
+   dev = SDL_OpenAudioDevice( NULL, 0, &desired, &obtained, 0 );
+   if (SDL_ATvassert( dev != 0, "SDL_OpenAudioDevice(): %s", SDL_GetError()))
+      goto quit;
+   if (SDL_ATassert( "SDL_QueueAudio() worked on a callback device",
+            SDL_QueueAudio( dev, &queued, 4 ) == -1 ))
+      goto close;
+   SDL_CloseAudioDevice( dev );
+
+   SDL_Quit();
+
+   /* End testcase. */
+   SDL_ATend();
+   return;
+
+close:
+   SDL_CloseAudioDevice( dev );
+quit:
+   SDL_Quit();
+}
+
+
+/**
+ * @brief Builds a stereo IMA ADPCM WAVE file with a LIST chunk of odd
+ *        length before the data, then blocks of 505 frames each.
+ */
+#define AUDIO_WAV_BLOCKS   48
+#define AUDIO_WAV_ALIGN    512
+#define AUDIO_WAV_SIZE     (12 + 8+20 + 8+4 + 8+AUDIO_WAV_BLOCKS*AUDIO_WAV_ALIGN)
+static void audio_wavPut( Uint8 **p, Uint32 v, int bytes )
+{
+   int i;
+   for (i=0; i<bytes; i++) {
+      (*p)[i] = (Uint8) (v >> (8*i));
+   }
+   *p += bytes;
+}
+static void audio_wavBuild( Uint8 *wav )
+{
+   Uint8 *p = wav;
+   int i, c;
+
+   SDL_memcpy( p, "RIFF", 4 ); p += 4;
+   audio_wavPut( &p, AUDIO_WAV_SIZE - 8, 4 );
+   SDL_memcpy( p, "WAVEfmt ", 8 ); p += 8;
+   audio_wavPut( &p, 20, 4 );
+   audio_wavPut( &p, 0x11, 2 );           /* IMA ADPCM */
+   audio_wavPut( &p, 2, 2 );
+   audio_wavPut( &p, 22050, 4 );
+   audio_wavPut( &p, 22050 * AUDIO_WAV_ALIGN / 505, 4 );
+   audio_wavPut( &p, AUDIO_WAV_ALIGN, 2 );
+   audio_wavPut( &p, 4, 2 );
+   audio_wavPut( &p, 2, 2 );
+   audio_wavPut( &p, 505, 2 );
+   SDL_memcpy( p, "LIST", 4 ); p += 4;
+   audio_wavPut( &p, 3, 4 );              /* padded to 4 */
+   audio_wavPut( &p, 0, 4 );
+   SDL_memcpy( p, "data", 4 ); p += 4;
+   audio_wavPut( &p, AUDIO_WAV_BLOCKS * AUDIO_WAV_ALIGN, 4 );
+   for (i=0; i<AUDIO_WAV_BLOCKS * AUDIO_WAV_ALIGN; i++) {
+      p[i] = (Uint8) audio_mixRandom( 256 );
+   }
+   for (i=0; i<AUDIO_WAV_BLOCKS; i++) {
+      for (c=0; c<2; c++) {
+         p[i*AUDIO_WAV_ALIGN + c*4 + 2] = (Uint8) audio_mixRandom( 89 );
+         p[i*AUDIO_WAV_ALIGN + c*4 + 3] = 0;
+      }
+   }
+}
+
+
+/**
+ * @brief Streams a WAVE file and compares it with SDL_LoadWAV_RW().
+ */
+static void audio_testWAVStream (void)
+{
+   static Uint8 wav[AUDIO_WAV_SIZE];
+   static Uint8 streamed[AUDIO_WAV_BLOCKS * 505 * 4];
+   SDL_AudioSpec spec, stream_spec;
+   SDL_WAVStream *stream;
+   Uint8 *loaded;
+   Uint32 loaded_len, frame;
+   int ret, pos;
+
+   /* Begin testcase. */
+   SDL_ATbegin( "Audio WAV Stream" );
+
+   audio_wavBuild( wav );
+   if (SDL_ATvassert( SDL_LoadWAV_RW( SDL_RWFromConstMem( wav, sizeof(wav) ), 1,
+               &spec, &loaded, &loaded_len ) != NULL,
+            "SDL_LoadWAV_RW(): %s", SDL_GetError() ))
+      return;
+   stream = SDL_OpenWAVStream_RW( SDL_RWFromConstMem( wav, sizeof(wav) ), 1,
+         &stream_spec );
+   if (SDL_ATvassert( stream != NULL, "SDL_OpenWAVStream_RW(): %s", SDL_GetError() ))
+      goto free;
+   if (SDL_ATassert( "Stream and loaded specs differ",
+            SDL_memcmp( &spec, &stream_spec, sizeof(spec) ) == 0 ))
+      goto close;
+   if (SDL_ATvassert( SDL_WAVStreamLength( stream ) * 4 == loaded_len,
+            "Stream has %u frames, loaded %u bytes",
+            SDL_WAVStreamLength( stream ), loaded_len ))
+      goto close;
+
+   /* Reads that don't line up with the blocks, nor whole frames. */
+   pos = 0;
+   while ((ret = SDL_WAVStreamRead( stream, streamed + pos, 301 )) > 0)
+      pos += ret;
+   if (SDL_ATvassert( (ret == 0) && (pos == (int) loaded_len),
+            "Streamed %d bytes of %u, last read returned %d", pos, loaded_len, ret ))
+      goto close;
+   if (SDL_ATassert( "Streamed samples differ from loaded samples",
+            SDL_memcmp( streamed, loaded, loaded_len ) == 0 ))
+      goto close;
+
+   /* Into the middle of a block, then back to an earlier one. */
+   for (frame = 700; ; frame = 3) {
+      ret = SDL_WAVStreamSeek( stream, frame );
+      if (SDL_ATvassert( ret == 0, "SDL_WAVStreamSeek( %u ): %s", frame, SDL_GetError() ))
+         goto close;
+      ret = SDL_WAVStreamRead( stream, streamed, 1000 );
+      if (SDL_ATvassert( (ret == 1000) &&
+               (SDL_memcmp( streamed, loaded + frame*4, ret ) == 0),
+               "Read after seeking to frame %u differs", frame ))
+         goto close;
+      if (SDL_ATvassert( SDL_WAVStreamTell( stream ) == frame + 250,
+               "SDL_WAVStreamTell() is %u, not %u",
+               SDL_WAVStreamTell( stream ), frame + 250 ))
+         goto close;
+      if (frame == 3)
+         break;
+   }
+   if (SDL_ATassert( "SDL_WAVStreamSeek() past the end worked",
+            SDL_WAVStreamSeek( stream, SDL_WAVStreamLength( stream ) + 1 ) == -1 ))
+      goto close;
+
+   SDL_CloseWAVStream( stream );
+   SDL_FreeWAV( loaded );
+
+   /* End testcase. */
+   SDL_ATend();
+   return;
+
+close:
+   SDL_CloseWAVStream( stream );
+free:
+   SDL_FreeWAV( loaded );
+}
+
+
+/**
+ * @brief Decodes ADPCM on several threads and compares it with one.
+ */
+static void audio_testWAVThreads (void)
+{
+   static const char *thread_hints[] = { "3", "-1" };
+   static Uint8 wav[AUDIO_WAV_SIZE];
+   SDL_AudioSpec spec;
+   Uint8 *serial, *parallel;
+   Uint32 serial_len, parallel_len;
+   char serial_error[128];
+   int i, ret;
+
+   /* Begin testcase. */
+   SDL_ATbegin( "Audio WAV Threads" );
+
+   /* 48 blocks make three shares of 16. */
+   audio_wavBuild( wav );
+   SDL_setenv( "SDL_WAVE_THREADS", "1", 1 );
+   if (SDL_ATvassert( SDL_LoadWAV_RW( SDL_RWFromConstMem( wav, sizeof(wav) ), 1,
+               &spec, &serial, &serial_len ) != NULL,
+            "SDL_LoadWAV_RW() on one thread: %s", SDL_GetError() ))
+      goto done;
+   /* Three threads, then one per CPU as a negative count asks for. */
+   for (i = 0; i < SDL_arraysize(thread_hints); i++) {
+      SDL_setenv( "SDL_WAVE_THREADS", thread_hints[i], 1 );
+      if (SDL_ATvassert( SDL_LoadWAV_RW( SDL_RWFromConstMem( wav, sizeof(wav) ), 1,
+                  &spec, &parallel, &parallel_len ) != NULL,
+               "SDL_LoadWAV_RW() with SDL_WAVE_THREADS=%s: %s",
+               thread_hints[i], SDL_GetError() )) {
+         SDL_FreeWAV( serial );
+         goto done;
+      }
+      ret = SDL_ATvassert( (serial_len == parallel_len) &&
+            (SDL_memcmp( serial, parallel, serial_len ) == 0),
+            "Decoding with SDL_WAVE_THREADS=%s differs from one thread",
+            thread_hints[i] );
+      SDL_FreeWAV( parallel );
+      if (ret) {
+         SDL_FreeWAV( serial );
+         goto done;
+      }
+   }
+   SDL_FreeWAV( serial );
+
+   /* A bad block in the last share fails the same way as on one thread. */
+   wav[AUDIO_WAV_SIZE - 5*AUDIO_WAV_ALIGN + 2] = 89;
+   SDL_setenv( "SDL_WAVE_THREADS", "1", 1 );
+   if (SDL_ATassert( "SDL_LoadWAV_RW() decoded a bad block on one thread",
+            SDL_LoadWAV_RW( SDL_RWFromConstMem( wav, sizeof(wav) ), 1,
+               &spec, &serial, &serial_len ) == NULL ))
+      goto done;
+   SDL_strlcpy( serial_error, SDL_GetError(), sizeof(serial_error) );
+   SDL_setenv( "SDL_WAVE_THREADS", "3", 1 );
+   if (SDL_ATassert( "SDL_LoadWAV_RW() decoded a bad block on three threads",
+            SDL_LoadWAV_RW( SDL_RWFromConstMem( wav, sizeof(wav) ), 1,
+               &spec, &parallel, &parallel_len ) == NULL ))
+      goto done;
+   if (SDL_ATvassert( SDL_strcmp( serial_error, SDL_GetError() ) == 0,
+            "Errors differ: \"%s\" and \"%s\"", serial_error, SDL_GetError() ))
+      goto done;
+
+   /* End testcase. */
+   SDL_ATend();
+
+done:
+   SDL_setenv( "SDL_WAVE_THREADS", "", 1 );
+}
+
+
+/**
+ * @brief Renders a fixed length offline as fast as possible.
+ */
+static void audio_testFreewheel (void)
+{
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceID dev;
+   SDL_AudioDeviceStats stats;
+   int ret, i;
+
+   /* Begin testcase. */
+   SDL_ATbegin( "Audio Freewheel" );
+
+   /* Ten seconds of audio, which must not take ten seconds. */
+   SDL_setenv( "SDL_AUDIODRIVER", "dummy", 1 );
+   SDL_setenv( "SDL_AUDIO_FREEWHEEL", "1", 1 );
+   SDL_setenv( "SDL_AUDIO_FREEWHEEL_FRAMES", "441000", 1 );
+   ret = SDL_Init( SDL_INIT_AUDIO );
+   if (SDL_ATvassert( ret==0, "SDL_Init( SDL_INIT_AUDIO ): %s", SDL_GetError()))
+      goto done;
+
+   SDL_zero( desired );
+   desired.freq = 44100;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 2;
+   desired.samples = 512;
+   desired.callback = audio_nullCallback;
+   dev = SDL_OpenAudioDevice( NULL, 0, &desired, &obtained, 0 );
+   if (SDL_ATvassert( dev != 0, "SDL_OpenAudioDevice(): %s", SDL_GetError()))
+      goto quit;
+
+   SDL_PauseAudioDevice( dev, 0 );
+   for (i=0; (i<500) && (SDL_GetAudioDeviceStatus( dev ) != SDL_AUDIO_STOPPED); i++)
+      SDL_Delay( 10 );
+   if (SDL_ATassert( "Freewheeling device didn't stop in time",
+            SDL_GetAudioDeviceStatus( dev ) == SDL_AUDIO_STOPPED ))
+      goto close;
+
+   /* The last callback is only partly played. */
+   ret = SDL_GetAudioDeviceStats( dev, &stats );
+   if (SDL_ATvassert( ret==0, "SDL_GetAudioDeviceStats(): %s", SDL_GetError()))
+      goto close;
+   if (SDL_ATvassert( stats.frames == 441000,
+            "Played %u frames of 441000", (Uint32) stats.frames ))
+      goto close;
+   if (SDL_ATvassert( stats.callbacks == 862,
+            "Ran %u callbacks, not 862", stats.callbacks ))
+      goto close;
+   if (SDL_ATassert( "Callback times don't add up",
+            stats.callback_usec_max <= stats.callback_usec_total ))
+      goto close;
+   SDL_CloseAudioDevice( dev );
+
+   if (SDL_ATassert( "SDL_GetAudioDeviceStats() worked on a closed device",
+            SDL_GetAudioDeviceStats( dev, &stats ) == -1 ))
+      goto quit;
+
+   SDL_Quit();
+
+   /* End testcase. */
+   SDL_ATend();
+   goto done;
+
+close:
+   SDL_CloseAudioDevice( dev );
+quit:
+   SDL_Quit();
+done:
+   SDL_setenv( "SDL_AUDIO_FREEWHEEL", "", 1 );
+   SDL_setenv( "SDL_AUDIO_FREEWHEEL_FRAMES", "", 1 );
+}
+
+
 /**
  * @brief Entry point.
  */
@@ -84,6 +621,11 @@ int test_audio (void)
    SDL_ATinit( "SDL_Audio" );
 
    audio_testOpen();
+   audio_testMix();
+   audio_testQueue();
+   audio_testWAVStream();
+   audio_testWAVThreads();
+   audio_testFreewheel();
 
    return SDL_ATfinish();
 }
@@ -29,8 +29,12 @@ static void surface_testLoad( SDL_Surface *testsur );
 static void surface_testPrimitives( SDL_Surface *testsur );
 static void surface_testPrimitivesBlend( SDL_Surface *testsur );
 static void surface_testBlit( SDL_Surface *testsur );
+static void surface_testBlitCache( SDL_Surface *testsur );
+static void surface_testBlitBatch( SDL_Surface *testsur );
 static int surface_testBlitBlendMode( SDL_Surface *testsur, SDL_Surface *face, int mode );
 static void surface_testBlitBlend( SDL_Surface *testsur );
+static void surface_testBlitPremultiplied( void );
+static void surface_testBlitBands( void );
 
 
 /**
@@ -379,6 +383,232 @@ static void surface_testBlit( SDL_Surface *testsur )
 }
 
 
+/**
+ * @brief Tests blitting one RLE surface to several destinations in turn.
+ */
+static void surface_testBlitCache( SDL_Surface *testsur )
+{
+   int ret;
+   SDL_Rect rect;
+   SDL_Surface *face, *rface, *sur16, *sur24, *conv;
+   int i, j, ni, nj;
+
+   SDL_ATbegin( "Blit Destination Cache Test" );
+
+   /* Create face surface. */
+   face = SDL_CreateRGBSurfaceFrom( (void*)img_face.pixel_data,
+         img_face.width, img_face.height, 32, img_face.width*4,
+#if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
+         0xff000000, /* Red bit mask. */
+         0x00ff0000, /* Green bit mask. */
+         0x0000ff00, /* Blue bit mask. */
+         0x000000ff /* Alpha bit mask. */
+#else
+         0x000000ff, /* Red bit mask. */
+         0x0000ff00, /* Green bit mask. */
+         0x00ff0000, /* Blue bit mask. */
+         0xff000000 /* Alpha bit mask. */
+#endif
+         );
+   if (SDL_ATassert( "SDL_CreateRGBSurfaceFrom", face != NULL))
+      return;
+
+   /* Own copy, so RLE encoding releases the pixels. */
+   rface = SDL_ConvertSurface( face, face->format, 0 );
+   if (SDL_ATassert( "SDL_ConvertSurface", rface != NULL))
+      return;
+   ret = SDL_SetSurfaceRLE( rface, 1 );
+   if (SDL_ATassert( "SDL_SetSurfaceRLE", ret == 0))
+      return;
+
+   /* Destinations it is RLE encoded for and one it isn't. */
+   sur16 = SDL_CreateRGBSurface( 0, testsur->w, testsur->h, 16,
+         0xf800, 0x07e0, 0x001f, 0 );
+   if (SDL_ATassert( "SDL_CreateRGBSurface", sur16 != NULL))
+      return;
+   sur24 = SDL_CreateRGBSurface( 0, testsur->w, testsur->h, 24,
+         0xff0000, 0x00ff00, 0x0000ff, 0 );
+   if (SDL_ATassert( "SDL_CreateRGBSurface", sur24 != NULL))
+      return;
+
+   /* Clear surfaces. */
+   ret = SDL_FillRect( testsur, NULL,
+         SDL_MapRGB( testsur->format, 0, 0, 0 ) );
+   if (SDL_ATassert( "SDL_FillRect", ret == 0))
+      return;
+   ret = SDL_FillRect( sur16, NULL, 0 );
+   if (SDL_ATassert( "SDL_FillRect", ret == 0))
+      return;
+   ret = SDL_FillRect( sur24, NULL, 0 );
+   if (SDL_ATassert( "SDL_FillRect", ret == 0))
+      return;
+
+   /* Constant values. */
+   rect.w = face->w;
+   rect.h = face->h;
+   ni     = testsur->w - face->w;
+   nj     = testsur->h - face->h;
+
+   /* Loop blit, switching destination every time. */
+   for (j=0; j <= nj; j+=4) {
+      for (i=0; i <= ni; i+=4) {
+         rect.x = i;
+         rect.y = j;
+         ret = SDL_BlitSurface( rface, NULL, testsur, &rect );
+         if (SDL_ATassert( "SDL_BlitSurface", ret == 0))
+            return;
+         rect.x = i;
+         rect.y = j;
+         ret = SDL_BlitSurface( rface, NULL, sur16, &rect );
+         if (SDL_ATassert( "SDL_BlitSurface", ret == 0))
+            return;
+         rect.x = i;
+         rect.y = j;
+         ret = SDL_BlitSurface( rface, NULL, sur24, &rect );
+         if (SDL_ATassert( "SDL_BlitSurface", ret == 0))
+            return;
+      }
+   }
+
+   /* See if it's the same. */
+   if (SDL_ATassert( "Blitting output not the same (RLE destination).",
+            surface_compare( testsur, &img_blit, ALLOWABLE_ERROR_BLENDED )==0 ))
+      return;
+   conv = SDL_ConvertSurface( sur24, testsur->format, 0 );
+   if (SDL_ATassert( "SDL_ConvertSurface", conv != NULL))
+      return;
+   if (SDL_ATassert( "Blitting output not the same (other destination).",
+            surface_compare( conv, &img_blit, ALLOWABLE_ERROR_BLENDED )==0 ))
+      return;
+   SDL_FreeSurface( conv );
+
+   /* Drawing on the face has to reach every destination. */
+   ret = SDL_FillRect( rface, NULL,
+         SDL_MapRGBA( rface->format, 0, 0, 0, 0 ) );
+   if (SDL_ATassert( "SDL_FillRect", ret == 0))
+      return;
+   ret = SDL_FillRect( testsur, NULL,
+         SDL_MapRGB( testsur->format, 0, 0, 0 ) );
+   if (SDL_ATassert( "SDL_FillRect", ret == 0))
+      return;
+   for (j=0; j <= nj; j+=4) {
+      for (i=0; i <= ni; i+=4) {
+         rect.x = i;
+         rect.y = j;
+         ret = SDL_BlitSurface( rface, NULL, testsur, &rect );
+         if (SDL_ATassert( "SDL_BlitSurface", ret == 0))
+            return;
+         rect.x = i;
+         rect.y = j;
+         ret = SDL_BlitSurface( rface, NULL, sur24, &rect );
+         if (SDL_ATassert( "SDL_BlitSurface", ret == 0))
+            return;
+      }
+   }
+
+   /* The face is transparent now, so it should all still be black. */
+   ret = 0;
+   SDL_LockSurface( testsur );
+   for (j=0; j < testsur->h; j++) {
+      for (i=0; i < testsur->w; i++) {
+         Uint8 r, g, b;
+         SDL_GetRGB( *((Uint32 *) testsur->pixels + j * testsur->pitch / 4 + i),
+               testsur->format, &r, &g, &b );
+         ret |= r | g | b;
+      }
+   }
+   SDL_UnlockSurface( testsur );
+   if (SDL_ATassert( "Blitting output not the same (after drawing).",
+            ret == 0 ))
+      return;
+
+   /* Clean up. */
+   SDL_FreeSurface( sur24 );
+   SDL_FreeSurface( sur16 );
+   SDL_FreeSurface( rface );
+   SDL_FreeSurface( face );
+
+   SDL_ATend();
+}
+
+
+/**
+ * @brief Tests blitting many sprites with one call.
+ */
+static void surface_testBlitBatch( SDL_Surface *testsur )
+{
+   int ret;
+   SDL_Surface *face;
+   SDL_Surface *srcs[256];
+   SDL_Rect rects[256];
+   SDL_Rect *dstrects[256];
+   int i, j, ni, nj, n;
+
+   SDL_ATbegin( "Batched Blit Test" );
+
+   /* Clear surface. */
+   ret = SDL_FillRect( testsur, NULL,
+         SDL_MapRGB( testsur->format, 0, 0, 0 ) );
+   if (SDL_ATassert( "SDL_FillRect", ret == 0))
+      return;
+
+   /* Create face surface. */
+   face = SDL_CreateRGBSurfaceFrom( (void*)img_face.pixel_data,
+         img_face.width, img_face.height, 32, img_face.width*4,
+#if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
+         0xff000000, /* Red bit mask. */
+         0x00ff0000, /* Green bit mask. */
+         0x0000ff00, /* Blue bit mask. */
+         0x000000ff /* Alpha bit mask. */
+#else
+         0x000000ff, /* Red bit mask. */
+         0x0000ff00, /* Green bit mask. */
+         0x00ff0000, /* Blue bit mask. */
+         0xff000000 /* Alpha bit mask. */
+#endif
+         );
+   if (SDL_ATassert( "SDL_CreateRGBSurfaceFrom", face != NULL))
+      return;
+
+   /* Same positions as the blit test, in one batch. */
+   ni = testsur->w - face->w;
+   nj = testsur->h - face->h;
+   n  = 0;
+   for (j=0; j <= nj; j+=4) {
+      for (i=0; i <= ni; i+=4) {
+         srcs[n]     = face;
+         rects[n].x  = i;
+         rects[n].y  = j;
+         dstrects[n] = &rects[n];
+         n++;
+      }
+   }
+   /* And one that is clipped away completely. */
+   srcs[n]     = face;
+   rects[n].x  = testsur->w;
+   rects[n].y  = 0;
+   dstrects[n] = &rects[n];
+   n++;
+
+   ret = SDL_BlitSurfaces( srcs, NULL, testsur, dstrects, n );
+   if (SDL_ATassert( "SDL_BlitSurfaces", ret == 0))
+      return;
+   if (SDL_ATassert( "SDL_BlitSurfaces clipping",
+            (rects[0].w == face->w) && (rects[n-1].w == 0) ))
+      return;
+
+   /* See if it's the same. */
+   if (SDL_ATassert( "Blitting output not the same (batched blit).",
+            surface_compare( testsur, &img_blit, 0 )==0 ))
+      return;
+
+   /* Clean up. */
+   SDL_FreeSurface( face );
+
+   SDL_ATend();
+}
+
+
 /**
  * @brief Tests a blend mode.
  */
@@ -423,6 +653,186 @@ static int surface_testBlitBlendMode( SDL_Surface *testsur, SDL_Surface *face, i
 }
 
 
+/**
+ * @brief Tests that premultiplied colour above its alpha saturates.
+ */
+static void surface_testBlitPremultiplied( void )
+{
+   static const Uint32 src_formats[] = {
+      SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888
+   };
+   static const Uint32 dst_formats[] = {
+      SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB565
+   };
+   int ret;
+   int i, j, rle, x, y, bpp;
+   Uint32 Rmask, Gmask, Bmask, Amask, pixel;
+   Uint8 r, g, b, a;
+   SDL_Surface *src, *dst;
+   SDL_Rect rect;
+
+   SDL_ATbegin( "Blit Premultiplied Saturation Test" );
+
+   for (i=0; i < SDL_arraysize(src_formats); i++) {
+      for (j=0; j < SDL_arraysize(dst_formats); j++) {
+         for (rle=0; rle <= 1; rle++) {
+            /* White at half alpha is more colour than premultiplied
+               pixels can hold; an odd width also covers the tail of
+               the vector kernels. */
+            SDL_PixelFormatEnumToMasks( src_formats[i], &bpp,
+                  &Rmask, &Gmask, &Bmask, &Amask );
+            src = SDL_CreateRGBSurface( 0, 7, 3, bpp,
+                  Rmask, Gmask, Bmask, Amask );
+            if (SDL_ATassert( "SDL_CreateRGBSurface", src != NULL))
+               return;
+            ret = SDL_FillRect( src, NULL,
+                  SDL_MapRGBA( src->format, 255, 255, 255, 128 ) );
+            if (SDL_ATassert( "SDL_FillRect", ret == 0))
+               return;
+            ret = SDL_SetSurfaceBlendMode( src, SDL_BLENDMODE_PREMULTIPLIED );
+            if (SDL_ATassert( "SDL_SetSurfaceBlendMode", ret == 0))
+               return;
+            ret = SDL_SetSurfaceRLE( src, rle );
+            if (SDL_ATassert( "SDL_SetSurfaceRLE", ret == 0))
+               return;
+
+            SDL_PixelFormatEnumToMasks( dst_formats[j], &bpp,
+                  &Rmask, &Gmask, &Bmask, &Amask );
+            dst = SDL_CreateRGBSurface( 0, 9, 5, bpp,
+                  Rmask, Gmask, Bmask, Amask );
+            if (SDL_ATassert( "SDL_CreateRGBSurface", dst != NULL))
+               return;
+            ret = SDL_FillRect( dst, NULL,
+                  SDL_MapRGBA( dst->format, 192, 192, 192, 0 ) );
+            if (SDL_ATassert( "SDL_FillRect", ret == 0))
+               return;
+
+            rect.x = 1;
+            rect.y = 1;
+            ret = SDL_BlitSurface( src, NULL, dst, &rect );
+            if (SDL_ATassert( "SDL_BlitSurface", ret == 0))
+               return;
+
+            /* Every channel saturates, nothing carries into the next
+               one or into alpha (which RLE blits leave opaque). */
+            for (y=rect.y; y < rect.y + rect.h; y++) {
+               for (x=rect.x; x < rect.x + rect.w; x++) {
+                  const Uint8 *p = (const Uint8 *)dst->pixels +
+                        y * dst->pitch + x * dst->format->BytesPerPixel;
+                  if (dst->format->BytesPerPixel == 2)
+                     pixel = *(const Uint16 *)p;
+                  else
+                     pixel = *(const Uint32 *)p;
+                  SDL_GetRGBA( pixel, dst->format, &r, &g, &b, &a );
+                  if (SDL_ATassert( "Premultiplied colour didn't saturate.",
+                           (r == 255) && (g == 255) && (b == 255) ))
+                     return;
+                  if (SDL_ATassert( "Premultiplied colour carried into alpha.",
+                           !dst->format->Amask || rle || (a == 128) ))
+                     return;
+               }
+            }
+
+            SDL_FreeSurface( dst );
+            SDL_FreeSurface( src );
+         }
+      }
+   }
+
+   SDL_ATend();
+}
+
+
+/**
+ * @brief Tests blits whose height doesn't split evenly between threads.
+ */
+static void surface_testBlitBands( void )
+{
+   static const Uint32 dst_formats[] = {
+      SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB565
+   };
+   static const int heights[] = { 61, 59, 2 };
+   int ret;
+   int i, j, x, y, bpp;
+   Uint32 Rmask, Gmask, Bmask, Amask, pixel, expected;
+   Uint8 r, g, b;
+   SDL_Surface *src, *dst;
+   SDL_Rect srcrect, rect;
+
+   SDL_ATbegin( "Blit Bands Test" );
+
+   /* Every pixel is different, so a band blitted from the wrong rows
+      shows up. */
+   src = SDL_CreateRGBSurface( 0, 13, 61, 32,
+         0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 );
+   if (SDL_ATassert( "SDL_CreateRGBSurface", src != NULL))
+      return;
+   ret = SDL_SetSurfaceBlendMode( src, SDL_BLENDMODE_NONE );
+   if (SDL_ATassert( "SDL_SetSurfaceBlendMode", ret == 0))
+      return;
+   for (y=0; y < src->h; y++) {
+      for (x=0; x < src->w; x++) {
+         ((Uint32 *)((Uint8 *)src->pixels + y * src->pitch))[x] =
+               SDL_MapRGBA( src->format, x * 19, y * 4, (x ^ y) * 3, 255 );
+      }
+   }
+
+   for (i=0; i < SDL_arraysize(dst_formats); i++) {
+      for (j=0; j < SDL_arraysize(heights); j++) {
+         SDL_PixelFormatEnumToMasks( dst_formats[i], &bpp,
+               &Rmask, &Gmask, &Bmask, &Amask );
+         dst = SDL_CreateRGBSurface( 0, src->w + 2, src->h + 2, bpp,
+               Rmask, Gmask, Bmask, Amask );
+         if (SDL_ATassert( "SDL_CreateRGBSurface", dst != NULL))
+            return;
+         ret = SDL_FillRect( dst, NULL, 0 );
+         if (SDL_ATassert( "SDL_FillRect", ret == 0))
+            return;
+
+         srcrect.x = 0;
+         srcrect.y = src->h - heights[j];
+         srcrect.w = src->w;
+         srcrect.h = heights[j];
+         rect.x = 1;
+         rect.y = 1;
+         ret = SDL_BlitSurface( src, &srcrect, dst, &rect );
+         if (SDL_ATassert( "SDL_BlitSurface", ret == 0))
+            return;
+
+         /* Each row comes from the matching source row, and the rows
+            either side are left alone. */
+         for (y=0; y < dst->h; y++) {
+            for (x=0; x < dst->w; x++) {
+               const Uint8 *p = (const Uint8 *)dst->pixels +
+                     y * dst->pitch + x * dst->format->BytesPerPixel;
+               if (dst->format->BytesPerPixel == 2)
+                  pixel = *(const Uint16 *)p;
+               else
+                  pixel = *(const Uint32 *)p;
+               expected = 0;
+               if ((x >= rect.x) && (x < rect.x + rect.w) &&
+                     (y >= rect.y) && (y < rect.y + rect.h)) {
+                  SDL_GetRGB( ((const Uint32 *)((const Uint8 *)src->pixels +
+                           (srcrect.y + y - rect.y) * src->pitch))[x - rect.x],
+                        src->format, &r, &g, &b );
+                  expected = SDL_MapRGB( dst->format, r, g, b );
+               }
+               if (SDL_ATassert( "Blitting output not the same (bands).",
+                        pixel == expected ))
+                  return;
+            }
+         }
+
+         SDL_FreeSurface( dst );
+      }
+   }
+
+   SDL_FreeSurface( src );
+
+   SDL_ATend();
+}
+
+
 /**
  * @brief Tests some more blitting routines.
  */
@@ -430,7 +840,8 @@ static void surface_testBlitBlend( SDL_Surface *testsur )
 {
    int ret;
    SDL_Rect rect;
-   SDL_Surface *face;
+   SDL_Surface *face, *premul;
+   SDL_BlendMode blendMode;
    int i, j, ni, nj;
    int mode;
 
@@ -508,6 +919,31 @@ static void surface_testBlitBlend( SDL_Surface *testsur )
             surface_compare( testsur, &img_blendMod, 0 )==0 ))
       return;
 
+   /* Test Premultiplied, which should look like Blend. */
+   premul = SDL_ConvertSurface( face, face->format, 0 );
+   if (SDL_ATassert( "SDL_ConvertSurface", premul != NULL))
+      return;
+   ret = SDL_PremultiplySurfaceAlpha( premul );
+   if (SDL_ATassert( "SDL_PremultiplySurfaceAlpha", ret == 0))
+      return;
+   ret = SDL_GetSurfaceBlendMode( premul, &blendMode );
+   if (SDL_ATassert( "SDL_GetSurfaceBlendMode",
+            (ret == 0) && (blendMode == SDL_BLENDMODE_PREMULTIPLIED)))
+      return;
+   /* A second call must not darken it again. */
+   ret = SDL_PremultiplySurfaceAlpha( premul );
+   if (SDL_ATassert( "SDL_PremultiplySurfaceAlpha", ret == 0))
+      return;
+   ret = SDL_SetSurfaceAlphaMod( premul, 100 );
+   if (SDL_ATassert( "SDL_SetSurfaceAlphaMod", ret == 0))
+      return;
+   if (surface_testBlitBlendMode( testsur, premul, SDL_BLENDMODE_PREMULTIPLIED ))
+      return;
+   if (SDL_ATassert( "Blitting blending output not the same (using SDL_BLENDMODE_PREMULTIPLIED).",
+            surface_compare( testsur, &img_blendBlend, ALLOWABLE_ERROR_BLENDED )==0 ))
+      return;
+   SDL_FreeSurface( premul );
+
    /* Clear surface. */
    ret = SDL_FillRect( testsur, NULL,
          SDL_MapRGB( testsur->format, 0, 0, 0 ) );
@@ -570,7 +1006,11 @@ void surface_runTests( SDL_Surface *testsur )
    surface_testPrimitives( testsur );
    surface_testPrimitivesBlend( testsur );
    surface_testBlit( testsur );
+   surface_testBlitCache( testsur );
+   surface_testBlitBatch( testsur );
    surface_testBlitBlend( testsur );
+   surface_testBlitPremultiplied();
+   surface_testBlitBands();
 }
 
 
@@ -620,6 +1060,29 @@ int test_surface (void)
    /* Exit SDL. */
    SDL_Quit();
 
+   /*
+    * Same again, with every blit split between three threads, however
+    * many CPUs there are.
+    */
+   SDL_ATbegin( "Initializing Blit Threads" );
+   SDL_setenv( "SDL_BLIT_THREADS", "3", 1 );
+   SDL_setenv( "SDL_BLIT_THREADS_FORCE", "1", 1 );
+   SDL_setenv( "SDL_BLIT_THREAD_PIXELS", "1", 1 );
+   ret = SDL_Init( SDL_INIT_VIDEO );
+   if (SDL_ATassert( "SDL_Init( SDL_INIT_VIDEO )", ret == 0))
+      goto err;
+   testsur = SDL_CreateRGBSurface( 0, 80, 60, 32,
+         RMASK, GMASK, BMASK, AMASK );
+   if (SDL_ATassert( "SDL_CreateRGBSurface", testsur != NULL))
+      goto err;
+   SDL_ATend();
+   surface_runTests( testsur );
+   SDL_FreeSurface( testsur );
+   SDL_Quit();
+   SDL_setenv( "SDL_BLIT_THREADS", "", 1 );
+   SDL_setenv( "SDL_BLIT_THREADS_FORCE", "", 1 );
+   SDL_setenv( "SDL_BLIT_THREAD_PIXELS", "", 1 );
+
    return SDL_ATfinish();
 
 err:
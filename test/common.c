@@ -375,6 +375,9 @@ PrintBlendMode(Uint32 flag)
     case SDL_BLENDMODE_MOD:
         fprintf(stderr, "Mod");
         break;
+    case SDL_BLENDMODE_PREMULTIPLIED:
+        fprintf(stderr, "Premultiplied");
+        break;
     default:
         fprintf(stderr, "0x%8.8x", flag);
         break;
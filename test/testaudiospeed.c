@@ -0,0 +1,569 @@
+/*
+ * Benchmarks the audio pipeline without any sound hardware: every
+ * SDL_BuildAudioCVT() format, channel and rate combination, the mixers,
+ * the WAV and ADPCM decoders whole and streamed, and an audio device on
+ * the disk driver writing to /dev/null.
+ *
+ * Results are printed as "key value" lines for scripts to pick up:
+ * <key>_mbps is megabytes of input handled per second, and <key>_nsframe
+ * is nanoseconds per input sample frame. The device keys add the average
+ * and worst time spent in the callback, in microseconds.
+ *
+ *   testaudiospeed [--msecs n] [--filter substring]
+ *
+ * Only the keys containing the filter string are run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef __WIN32__
+#include <sys/time.h>
+#endif
+
+#include "SDL.h"
+
+/* Sample frames in every buffer that is converted or mixed */
+#define TEST_FRAMES 4096
+
+/* Voices for SDL_MixAudioSources() */
+#define MIX_VOICES 32
+
+static int testMilliseconds = 4;
+static const char *testFilter = NULL;
+
+static const struct
+{
+    SDL_AudioFormat format;
+    const char *name;
+} formats[] = {
+    {AUDIO_U8, "u8"},
+    {AUDIO_S8, "s8"},
+    {AUDIO_U16LSB, "u16lsb"},
+    {AUDIO_S16LSB, "s16lsb"},
+    {AUDIO_U16MSB, "u16msb"},
+    {AUDIO_S16MSB, "s16msb"},
+    {AUDIO_S32LSB, "s32lsb"},
+    {AUDIO_S32MSB, "s32msb"},
+    {AUDIO_F32LSB, "f32lsb"},
+    {AUDIO_F32MSB, "f32msb"}
+};
+
+static const int channels[] = { 1, 2, 4, 6, 8 };
+
+static const int rates[] = { 22050, 44100, 48000 };
+
+/* SDL_GetTicks() is too coarse for runs this short */
+static Uint64
+now_usec(void)
+{
+#ifdef __WIN32__
+    return (Uint64) SDL_GetTicks() * 1000;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (Uint64) tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+static int
+wanted(const char *key)
+{
+    return (testFilter == NULL) || (strstr(key, testFilter) != NULL);
+}
+
+static void
+report(const char *key, double bytes, double frames, Uint64 usec)
+{
+    if (usec == 0) {
+        usec = 1;
+    }
+    printf("%s_mbps %.1f\n", key, bytes / usec);
+    printf("%s_nsframe %.2f\n", key, (usec * 1000.0) / frames);
+}
+
+/* Anything but silence, so nothing takes a shortcut */
+static void
+fill_noise(Uint8 * buf, int len)
+{
+    Uint32 seed = 1;
+    int i;
+
+    for (i = 0; i < len; ++i) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = (Uint8) (seed >> 16);
+    }
+}
+
+/* Floats have to be in range, or the converters saturate everything */
+static void
+fill_format(SDL_AudioFormat format, Uint8 * buf, int samples)
+{
+    int i;
+
+    fill_noise(buf, samples * (SDL_AUDIO_BITSIZE(format) / 8));
+    if (SDL_AUDIO_ISFLOAT(format)) {
+        for (i = 0; i < samples; ++i) {
+            Uint32 *sample = (Uint32 *) buf + i;
+            union
+            {
+                float f;
+                Uint32 u;
+            } x;
+            x.f = ((float) (*sample & 0xFFFF) / 32768.0f) - 1.0f;
+            *sample = SDL_AUDIO_ISBIGENDIAN(format) ?
+                SDL_SwapBE32(x.u) : SDL_SwapLE32(x.u);
+        }
+    }
+}
+
+/* src and dst index every format, channel count and rate */
+static int
+bench_cvt(int src, int dst)
+{
+    const int sr = src % SDL_arraysize(rates);
+    const int sc = (src / SDL_arraysize(rates)) % SDL_arraysize(channels);
+    const int sf = src / (SDL_arraysize(rates) * SDL_arraysize(channels));
+    const int dr = dst % SDL_arraysize(rates);
+    const int dc = (dst / SDL_arraysize(rates)) % SDL_arraysize(channels);
+    const int df = dst / (SDL_arraysize(rates) * SDL_arraysize(channels));
+    SDL_AudioCVT cvt;
+    char key[128];
+    Uint8 *data;
+    Uint64 start, elapsed;
+    int len, runs = 0;
+
+    SDL_snprintf(key, sizeof(key), "cvt_%s_%d_%d_%s_%d_%d",
+                 formats[sf].name, channels[sc], rates[sr],
+                 formats[df].name, channels[dc], rates[dr]);
+    if (!wanted(key)) {
+        return 0;
+    }
+    if (SDL_BuildAudioCVT(&cvt, formats[sf].format, channels[sc], rates[sr],
+                          formats[df].format, channels[dc],
+                          rates[dr]) < 0) {
+        /* not every channel layout converts to every other */
+        return 0;
+    }
+
+    len = TEST_FRAMES * channels[sc] *
+        (SDL_AUDIO_BITSIZE(formats[sf].format) / 8);
+    data = (Uint8 *) malloc(len);
+    cvt.len = len;
+    cvt.buf = (Uint8 *) malloc(len * cvt.len_mult);
+    if ((data == NULL) || (cvt.buf == NULL)) {
+        fprintf(stderr, "Out of memory.\n");
+        free(data);
+        free(cvt.buf);
+        return -1;
+    }
+    fill_format(formats[sf].format, data, TEST_FRAMES * channels[sc]);
+
+    /* the first run builds any resampler tables and warms the caches */
+    memcpy(cvt.buf, data, len);
+    SDL_ConvertAudio(&cvt);
+
+    start = now_usec();
+    do {
+        memcpy(cvt.buf, data, len);
+        SDL_ConvertAudio(&cvt);
+        ++runs;
+        elapsed = now_usec() - start;
+    } while (elapsed < (Uint64) testMilliseconds * 1000);
+
+    report(key, (double) len * runs, (double) TEST_FRAMES * runs, elapsed);
+    free(data);
+    free(cvt.buf);
+    return 0;
+}
+
+static int
+bench_mix(int f)
+{
+    const int len = TEST_FRAMES * 2 *
+        (SDL_AUDIO_BITSIZE(formats[f].format) / 8);
+    SDL_AudioMixSource sources[MIX_VOICES];
+    char key[64];
+    Uint8 *dst, *src;
+    Uint64 start, elapsed;
+    int i, runs;
+
+    dst = (Uint8 *) malloc(len);
+    src = (Uint8 *) malloc(len * MIX_VOICES);
+    if ((dst == NULL) || (src == NULL)) {
+        fprintf(stderr, "Out of memory.\n");
+        free(dst);
+        free(src);
+        return -1;
+    }
+    fill_format(formats[f].format, src, TEST_FRAMES * 2 * MIX_VOICES);
+    fill_format(formats[f].format, dst, TEST_FRAMES * 2);
+    for (i = 0; i < MIX_VOICES; ++i) {
+        sources[i].buf = src + i * len;
+        sources[i].volume = SDL_MIX_MAXVOLUME / 4;
+    }
+
+    /* One source at a time */
+    SDL_snprintf(key, sizeof(key), "mix_%s", formats[f].name);
+    if (wanted(key)) {
+        runs = 0;
+        start = now_usec();
+        do {
+            SDL_MixAudioFormat(dst, src, formats[f].format, len,
+                               SDL_MIX_MAXVOLUME / 2);
+            ++runs;
+            elapsed = now_usec() - start;
+        } while (elapsed < (Uint64) testMilliseconds * 1000);
+        report(key, (double) len * runs, (double) TEST_FRAMES * runs,
+               elapsed);
+    }
+
+    /* All the voices at once; the input is every voice */
+    SDL_snprintf(key, sizeof(key), "mixsources_%d_%s", MIX_VOICES,
+                 formats[f].name);
+    if (wanted(key)) {
+        runs = 0;
+        start = now_usec();
+        do {
+            SDL_MixAudioSources(dst, sources, MIX_VOICES, formats[f].format,
+                                len);
+            ++runs;
+            elapsed = now_usec() - start;
+        } while (elapsed < (Uint64) testMilliseconds * 1000);
+        report(key, (double) len * MIX_VOICES * runs,
+               (double) TEST_FRAMES * MIX_VOICES * runs, elapsed);
+    }
+
+    free(dst);
+    free(src);
+    return 0;
+}
+
+#define WAV_RATE 44100
+
+static void
+put16(Uint8 ** p, Uint16 v)
+{
+    (*p)[0] = (Uint8) v;
+    (*p)[1] = (Uint8) (v >> 8);
+    *p += 2;
+}
+
+static void
+put32(Uint8 ** p, Uint32 v)
+{
+    put16(p, (Uint16) v);
+    put16(p, (Uint16) (v >> 16));
+}
+
+/*
+ * Builds one second of a WAVE file in memory. encoding is 1 (PCM),
+ * 3 (float), 2 (MS ADPCM) or 0x11 (IMA ADPCM); ADPCM blocks get sane
+ * headers and noise for their nibbles.
+ */
+static Uint8 *
+build_wav(int encoding, int chans, int bits, Uint32 * wavlen)
+{
+    static const Sint16 ms_coeff[7][2] = {
+        {256, 0}, {512, -256}, {0, 0}, {192, 64},
+        {240, 0}, {460, -208}, {392, -232}
+    };
+    const int adpcm = (encoding == 2) || (encoding == 0x11);
+    const int blockalign = adpcm ? 256 * chans : chans * bits / 8;
+    const int perblock = (encoding == 2) ? (256 - 7) * 2 + 2 : (256 - 4) * 2 + 1;
+    const int blocks = adpcm ? (WAV_RATE + perblock - 1) / perblock : 0;
+    const Uint32 datalen = adpcm ? blocks * blockalign :
+        WAV_RATE * blockalign;
+    const Uint32 fmtlen = (encoding == 2) ? 50 : (adpcm ? 20 : 16);
+    Uint8 *wav, *p;
+    int i, c;
+
+    *wavlen = 12 + 8 + fmtlen + 8 + datalen;
+    wav = p = (Uint8 *) malloc(*wavlen);
+    if (wav == NULL) {
+        return NULL;
+    }
+
+    memcpy(p, "RIFF", 4);
+    p += 4;
+    put32(&p, *wavlen - 8);
+    memcpy(p, "WAVEfmt ", 8);
+    p += 8;
+    put32(&p, fmtlen);
+    put16(&p, (Uint16) encoding);
+    put16(&p, (Uint16) chans);
+    put32(&p, WAV_RATE);
+    put32(&p, WAV_RATE * blockalign / (adpcm ? perblock : 1));
+    put16(&p, (Uint16) blockalign);
+    put16(&p, (Uint16) bits);
+    if (adpcm) {
+        put16(&p, (Uint16) (fmtlen - 18));
+        put16(&p, (Uint16) perblock);
+    }
+    if (encoding == 2) {
+        put16(&p, 7);
+        for (i = 0; i < 7; ++i) {
+            put16(&p, (Uint16) ms_coeff[i][0]);
+            put16(&p, (Uint16) ms_coeff[i][1]);
+        }
+    }
+    memcpy(p, "data", 4);
+    p += 4;
+    put32(&p, datalen);
+
+    if (encoding == 3) {
+        fill_format(AUDIO_F32LSB, p, WAV_RATE * chans);
+    } else {
+        fill_noise(p, datalen);
+    }
+    for (i = 0; i < blocks; ++i) {
+        Uint8 *block = p + i * blockalign;
+        for (c = 0; c < chans; ++c) {
+            if (encoding == 2) {
+                block[c] = (Uint8) ((i + c) % 7);       /* predictor */
+                block[chans + c * 2] = 16;      /* delta, low byte */
+                block[chans + c * 2 + 1] = 0;
+            } else {
+                block[c * 4 + 2] = (Uint8) ((i + c) % 89);    /* index */
+                block[c * 4 + 3] = 0;
+            }
+        }
+    }
+    return wav;
+}
+
+static int
+bench_wav(const char *name, int encoding, int chans, int bits)
+{
+    char key[64];
+    SDL_AudioSpec spec;
+    Uint8 *wav, *buf;
+    Uint32 wavlen, len = 0;
+    Uint64 start, elapsed;
+    int runs = 0;
+
+    SDL_snprintf(key, sizeof(key), "wav_%s_%d", name, chans);
+    if (!wanted(key)) {
+        return 0;
+    }
+    wav = build_wav(encoding, chans, bits, &wavlen);
+    if (wav == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return -1;
+    }
+
+    start = now_usec();
+    do {
+        if (SDL_LoadWAV_RW(SDL_RWFromConstMem(wav, wavlen), 1, &spec,
+                           &buf, &len) == NULL) {
+            fprintf(stderr, "SDL_LoadWAV_RW(%s) failed: %s\n", key,
+                    SDL_GetError());
+            free(wav);
+            return -1;
+        }
+        SDL_FreeWAV(buf);
+        ++runs;
+        elapsed = now_usec() - start;
+    } while (elapsed < (Uint64) testMilliseconds * 1000);
+
+    /* the decoded size is the honest measure for ADPCM */
+    report(key, (double) len * runs,
+           (double) len / (chans * SDL_AUDIO_BITSIZE(spec.format) / 8) *
+           runs, elapsed);
+
+    free(wav);
+    return 0;
+}
+
+/* The same files a device buffer at a time, through SDL_WAVStream */
+static int
+bench_wavstream(const char *name, int encoding, int chans, int bits)
+{
+    char key[64];
+    SDL_AudioSpec spec;
+    Uint8 block[4096];
+    Uint8 *wav;
+    Uint32 wavlen, len = 0;
+    Uint64 start, elapsed;
+    int runs = 0;
+
+    SDL_snprintf(key, sizeof(key), "wavstream_%s_%d", name, chans);
+    if (!wanted(key)) {
+        return 0;
+    }
+    wav = build_wav(encoding, chans, bits, &wavlen);
+    if (wav == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return -1;
+    }
+
+    start = now_usec();
+    do {
+        SDL_WAVStream *stream;
+        int got;
+
+        stream = SDL_OpenWAVStream_RW(SDL_RWFromConstMem(wav, wavlen), 1,
+                                      &spec);
+        if (stream == NULL) {
+            fprintf(stderr, "SDL_OpenWAVStream_RW(%s) failed: %s\n", key,
+                    SDL_GetError());
+            free(wav);
+            return -1;
+        }
+        len = 0;
+        while ((got = SDL_WAVStreamRead(stream, block, sizeof(block))) > 0) {
+            len += got;
+        }
+        SDL_CloseWAVStream(stream);
+        if (got < 0) {
+            fprintf(stderr, "SDL_WAVStreamRead(%s) failed: %s\n", key,
+                    SDL_GetError());
+            free(wav);
+            return -1;
+        }
+        ++runs;
+        elapsed = now_usec() - start;
+    } while (elapsed < (Uint64) testMilliseconds * 1000);
+
+    report(key, (double) len * runs,
+           (double) len / (chans * SDL_AUDIO_BITSIZE(spec.format) / 8) *
+           runs, elapsed);
+    free(wav);
+    return 0;
+}
+
+static volatile Uint32 device_bytes;
+
+static void SDLCALL
+fill_device(void *userdata, Uint8 * stream, int len)
+{
+    memset(stream, 0, len);
+    device_bytes += len;
+}
+
+/* The audio thread itself, running flat out on the disk driver */
+static int
+bench_device(const char *name, int queued)
+{
+    char key[64];
+    SDL_AudioSpec spec;
+    SDL_AudioDeviceID dev;
+    SDL_AudioDeviceStats stats;
+    Uint8 block[4096];
+    Uint32 pushed = 0;
+    Uint64 start, elapsed;
+    int ret;
+
+    SDL_snprintf(key, sizeof(key), "device_%s", name);
+    if (!wanted(key)) {
+        return 0;
+    }
+
+    SDL_zero(spec);
+    spec.freq = 44100;
+    spec.format = AUDIO_S16SYS;
+    spec.channels = 2;
+    spec.samples = 512;
+    spec.callback = queued ? NULL : fill_device;
+
+    /* A callback can be run flat out offline, but a queue left to drain
+       that fast just plays silence and starves the thread filling it */
+    SDL_setenv("SDL_AUDIO_FREEWHEEL", queued ? "0" : "1", 1);
+    dev = SDL_OpenAudioDevice(NULL, 0, &spec, NULL, 0);
+    if (dev == 0) {
+        fprintf(stderr, "Couldn't open audio: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    memset(block, 0, sizeof(block));
+    device_bytes = 0;
+    SDL_PauseAudioDevice(dev, 0);
+    start = now_usec();
+    do {
+        if (queued) {
+            ret = SDL_QueueAudio(dev, block, sizeof(block));
+            pushed += (Uint32) SDL_max(ret, 0);
+        } else {
+            SDL_Delay(1);
+        }
+        elapsed = now_usec() - start;
+    } while (elapsed < (Uint64) testMilliseconds * 25000);
+    if (queued) {
+        device_bytes = pushed - SDL_GetQueuedAudioSize(dev);
+    }
+    SDL_GetAudioDeviceStats(dev, &stats);
+    SDL_CloseAudioDevice(dev);
+
+    report(key, device_bytes, device_bytes / 4.0, elapsed);
+    printf("%s_callback_avg_usec %.2f\n", key, stats.callbacks ?
+           (double) stats.callback_usec_total / stats.callbacks : 0.0);
+    printf("%s_callback_max_usec %u\n", key, stats.callback_usec_max);
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    int i, j;
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--msecs") == 0 && i + 1 < argc) {
+            testMilliseconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            testFilter = argv[++i];
+        } else {
+            fprintf(stderr, "USAGE: %s [--msecs n] [--filter substring]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    /* Runs anywhere: the disk driver throws the audio away as fast as
+       the audio thread can make it */
+    if (SDL_getenv("SDL_AUDIODRIVER") == NULL) {
+        SDL_setenv("SDL_AUDIODRIVER", "disk", 1);
+        SDL_setenv("SDL_DISKAUDIOFILE", "/dev/null", 1);
+        SDL_setenv("SDL_DISKAUDIODELAY", "0", 1);
+    }
+    if (SDL_Init(SDL_INIT_AUDIO) == -1) {
+        fprintf(stderr, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    for (i = 0; i < SDL_arraysize(formats) * SDL_arraysize(channels) *
+         SDL_arraysize(rates); ++i) {
+        for (j = 0; j < SDL_arraysize(formats) * SDL_arraysize(channels) *
+             SDL_arraysize(rates); ++j) {
+            if (bench_cvt(i, j) < 0) {
+                SDL_Quit();
+                return 3;
+            }
+        }
+    }
+
+    for (i = 0; i < SDL_arraysize(formats); ++i) {
+        if (bench_mix(i) < 0) {
+            SDL_Quit();
+            return 3;
+        }
+    }
+
+    if (bench_wav("pcm8", 1, 2, 8) < 0 || bench_wav("pcm16", 1, 2, 16) < 0 ||
+        bench_wav("pcm32", 1, 2, 32) < 0 || bench_wav("float", 3, 2, 32) < 0 ||
+        bench_wav("msadpcm", 2, 1, 4) < 0 ||
+        bench_wav("msadpcm", 2, 2, 4) < 0 ||
+        bench_wav("imaadpcm", 0x11, 1, 4) < 0 ||
+        bench_wav("imaadpcm", 0x11, 2, 4) < 0 ||
+        bench_wavstream("pcm16", 1, 2, 16) < 0 ||
+        bench_wavstream("msadpcm", 2, 2, 4) < 0 ||
+        bench_wavstream("imaadpcm", 0x11, 2, 4) < 0 ||
+        bench_device("callback", 0) < 0 || bench_device("queued", 1) < 0) {
+        SDL_Quit();
+        return 3;
+    }
+
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
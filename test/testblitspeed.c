@@ -13,6 +13,7 @@
 static SDL_Surface *dest = NULL;
 static SDL_Surface *src = NULL;
 static int testSeconds = 10;
+static int batchSize = 0;
 
 
 static int
@@ -163,6 +164,40 @@ blit(SDL_Surface * dst, SDL_Surface * src, int x, int y)
     return (SDL_GetTicks() - start);
 }
 
+/* Blits batchSize copies at random places with one SDL_BlitSurfaces() */
+static Uint32
+blitBatch(SDL_Surface * dst, SDL_Surface * src, int wmax, int hmax)
+{
+    static SDL_Surface **srcs = NULL;
+    static SDL_Rect *rects = NULL;
+    static SDL_Rect **dstrects = NULL;
+    Uint32 start = 0;
+    int i;
+
+    if (srcs == NULL) {
+        srcs = (SDL_Surface **) malloc(batchSize * sizeof(*srcs));
+        rects = (SDL_Rect *) malloc(batchSize * sizeof(*rects));
+        dstrects = (SDL_Rect **) malloc(batchSize * sizeof(*dstrects));
+        if ((srcs == NULL) || (rects == NULL) || (dstrects == NULL)) {
+            fprintf(stderr, "Out of memory.\n");
+            exit(1);
+        }
+        for (i = 0; i < batchSize; i++) {
+            srcs[i] = src;
+            dstrects[i] = &rects[i];
+        }
+    }
+
+    for (i = 0; i < batchSize; i++) {
+        rects[i].x = randRange(0, wmax);
+        rects[i].y = randRange(0, hmax);
+    }
+
+    start = SDL_GetTicks();
+    SDL_BlitSurfaces(srcs, NULL, dst, dstrects, batchSize);
+    return (SDL_GetTicks() - start);
+}
+
 static void
 blitCentered(SDL_Surface * dst, SDL_Surface * src)
 {
@@ -261,6 +296,12 @@ setup_test(int argc, char **argv)
             screenSurface = 1;
         else if (strcmp(arg, "--dumpfile") == 0)
             dumpfile = argv[++i];
+        else if (strcmp(arg, "--threads") == 0)
+            SDL_setenv("SDL_BLIT_THREADS", argv[++i], 1);
+        else if (strcmp(arg, "--threadpixels") == 0)
+            SDL_setenv("SDL_BLIT_THREAD_PIXELS", argv[++i], 1);
+        else if (strcmp(arg, "--batch") == 0)
+            batchSize = atoi(argv[++i]);
         /* !!! FIXME: set colorkey. */
         else if (0) {           /* !!! FIXME: we handle some commandlines elsewhere now */
             fprintf(stderr, "Unknown commandline option: %s\n", arg);
@@ -389,8 +430,13 @@ test_blit_speed(void)
             }
         }
 
-        iterations++;
-        elasped += blit(dest, src, randRange(0, wmax), randRange(0, hmax));
+        if (batchSize > 0) {
+            iterations += batchSize;
+            elasped += blitBatch(dest, src, wmax, hmax);
+        } else {
+            iterations++;
+            elasped += blit(dest, src, randRange(0, wmax), randRange(0, hmax));
+        }
         if (isScreen) {
             SDL_Flip(dest);     /* show it! */
             SDL_FillRect(dest, NULL, clearColor);       /* blank it for next time! */
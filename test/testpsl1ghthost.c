@@ -0,0 +1,891 @@
+/*
+ * Measures the PSL1GHT drivers against the host stand-in SDK: time spent
+ * rendering and presenting next to a simulated 8ms game update, texture
+ * copies, batched primitives, logical render sizes and mode switches,
+ * audio block turnaround and output latency, how long a game thread
+ * waits to hand audio over, and pad polling cost.
+ *
+ * Only builds against a library configured with --enable-psl1ght-host:
+ *   make testpsl1ghthost
+ * Results are printed as "key value" lines for scripts to pick up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "SDL.h"
+
+#include <psl1ght/host.h>
+
+static int frames = 120;
+static Uint64 sim_usec = 8000;
+static int numpads = 4;
+static int pad_iterations = 10000;
+static int primitives = 2000;
+
+static volatile int audio_callbacks = 0;
+static volatile int audio_bad_len = 0;
+static int audio_expected_len = 0;
+static Uint64 audio_last = 0;
+static Uint64 audio_gap_total = 0;
+static Uint64 audio_gap_max = 0;
+static Uint64 audio_played_first = 0;
+static Uint64 audio_latency_total = 0;
+static Uint64 audio_latency_max = 0;
+
+static Uint64
+now_usec(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (Uint64) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void SDLCALL
+fill_audio(void *userdata, Uint8 * stream, int len)
+{
+    Uint64 now = now_usec();
+    if (audio_last) {
+        Uint64 gap = now - audio_last;
+        audio_gap_total += gap;
+        if (gap > audio_gap_max) {
+            audio_gap_max = gap;
+        }
+    }
+    audio_last = now;
+    SDL_memset(stream, 0, len);
+    if (audio_expected_len && len != audio_expected_len) {
+        ++audio_bad_len;
+    }
+    ++audio_callbacks;
+}
+
+/* Blocks between the one being filled and the one being heard, measured
+   against what the host clock thread has played since the first fill */
+static void SDLCALL
+fill_audio_latency(void *userdata, Uint8 * stream, int len)
+{
+    psl1ghtHostStats stats;
+    Sint64 ahead;
+    Uint64 latency;
+
+    psl1ghtHostGetStats(&stats);
+    if (!audio_callbacks) {
+        audio_played_first = stats.audio_blocks;
+    }
+    ahead = (Sint64) audio_callbacks + 1 -
+        (Sint64) (stats.audio_blocks - audio_played_first);
+    latency = ahead > 0 ? (Uint64) ahead * 256 * 1000000 / 48000 : 0;
+    audio_latency_total += latency;
+    if (latency > audio_latency_max) {
+        audio_latency_max = latency;
+    }
+    fill_audio(userdata, stream, len);
+}
+
+/* CPU time of the calling thread, waits for the RSX not included */
+static Uint64
+cpu_usec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (Uint64) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Busy the CPU like a game's simulation step would */
+static void
+simulate(Uint64 usec)
+{
+    Uint64 end = now_usec() + usec;
+    while (now_usec() < end) {
+    }
+}
+
+static int
+bench_video(const char *name, Uint32 flags)
+{
+    SDL_Window *window;
+    SDL_Rect rect;
+    Uint64 start, elapsed, total = 0, worst = 0, frame_start;
+    int i;
+
+    window = SDL_CreateWindow("testpsl1ghthost", 0, 0, 1920, 1080,
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN);
+    if (!window || SDL_CreateRenderer(window, -1, flags) < 0) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    frame_start = now_usec();
+    for (i = 0; i < frames; ++i) {
+        simulate(sim_usec);
+
+        /* Time spent in the renderer, blocking included */
+        start = now_usec();
+        rect.x = i % 1000;
+        rect.y = i % 500;
+        rect.w = 320;
+        rect.h = 240;
+        SDL_SetRenderDrawColor(0, 0, 0, 255);
+        SDL_RenderClear();
+        SDL_SetRenderDrawColor(255, i & 0xFF, 0, 255);
+        SDL_RenderFillRect(&rect);
+        SDL_RenderPresent();
+        elapsed = now_usec() - start;
+        total += elapsed;
+        if (elapsed > worst) {
+            worst = elapsed;
+        }
+    }
+    elapsed = now_usec() - frame_start;
+    printf("video_%s_frames %d\n", name, frames);
+    printf("video_%s_frame_avg_usec %llu\n", name,
+           (unsigned long long) (elapsed / frames));
+    printf("video_%s_render_avg_usec %llu\n", name,
+           (unsigned long long) (total / frames));
+    printf("video_%s_render_max_usec %llu\n", name,
+           (unsigned long long) worst);
+
+    SDL_DestroyWindow(window);
+    return 0;
+}
+
+/* Texel used by bench_texture(), opaque unless alpha says otherwise */
+static Uint32
+texel(int x, int y, Uint32 alpha)
+{
+    return (alpha << 24) | ((x & 0xFF) << 16) | ((y & 0xFF) << 8) | 0x40;
+}
+
+static int
+copy_frames(SDL_Texture * texture, SDL_Rect * dst)
+{
+    Uint64 start, total = 0;
+    int i;
+
+    for (i = 0; i < frames; ++i) {
+        start = now_usec();
+        SDL_RenderCopy(texture, NULL, dst);
+        SDL_RenderPresent();
+        total += now_usec() - start;
+    }
+    return (int) (total / frames);
+}
+
+static int
+bench_texture(void)
+{
+    SDL_Window *window;
+    SDL_Texture *texture;
+    SDL_Rect dst, rect;
+    Uint32 *pixels, pixel;
+    int w = 640, h = 360, x, y, ok = 1;
+
+    window = SDL_CreateWindow("testpsl1ghthost", 0, 0, 1920, 1080,
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN);
+    if (!window || SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_PRESENTFLIP3) < 0) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+    texture = SDL_CreateTexture(SDL_PIXELFORMAT_ARGB8888,
+                                SDL_TEXTUREACCESS_STREAMING, w, h);
+    pixels = (Uint32 *) SDL_malloc(w * h * sizeof(Uint32));
+    if (!texture || !pixels) {
+        fprintf(stderr, "Couldn't create texture: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    /* Upper half opaque, lower half half transparent */
+    for (y = 0; y < h; ++y) {
+        for (x = 0; x < w; ++x) {
+            pixels[y * w + x] = texel(x, y, y < h / 2 ? 0xFF : 0x80);
+        }
+    }
+    SDL_UpdateTexture(texture, NULL, pixels, w * sizeof(Uint32));
+
+    /* Scaled 2x copy, then half of it blended over black */
+    dst.x = dst.y = 0;
+    dst.w = w * 2;
+    dst.h = h * 2;
+    SDL_SetRenderDrawColor(0, 0, 0, 255);
+    SDL_RenderClear();
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    SDL_RenderCopy(texture, NULL, &dst);
+    rect.x = rect.y = 0;
+    rect.w = 1;
+    rect.h = 1;
+    for (y = 0; y < h / 2 && ok; y += 37) {
+        for (x = 0; x < w && ok; x += 53) {
+            rect.x = x * 2 + 1;
+            rect.y = y * 2 + 1;
+            SDL_RenderReadPixels(&rect, SDL_PIXELFORMAT_ARGB8888, &pixel, 4);
+            if ((pixel & 0xFFFFFF) != (texel(x, y, 0) & 0xFFFFFF)) {
+                ok = 0;
+            }
+        }
+    }
+    SDL_RenderClear();
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_RenderCopy(texture, NULL, &dst);
+    rect.x = 2 * 100;
+    rect.y = 2 * (h - 1);
+    SDL_RenderReadPixels(&rect, SDL_PIXELFORMAT_ARGB8888, &pixel, 4);
+    if (((pixel >> 16) & 0xFF) < 49 || ((pixel >> 16) & 0xFF) > 51) {
+        ok = 0;
+    }
+    SDL_RenderPresent();
+    printf("video_copy_check %d\n", ok);
+
+    /* Full screen scaled copies, RSX path and CPU path */
+    dst.w = 1920;
+    dst.h = 1080;
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    printf("video_copy_rsx_avg_usec %d\n", copy_frames(texture, &dst));
+    SDL_SetTextureColorMod(texture, 255, 128, 255);
+    printf("video_copy_modulated_avg_usec %d\n",
+           copy_frames(texture, &dst));
+
+    SDL_free(pixels);
+    SDL_DestroyTexture(texture);
+    SDL_DestroyWindow(window);
+    return 0;
+}
+
+/* Colour of the back buffer at (x, y) */
+static Uint32
+read_pixel(int x, int y)
+{
+    SDL_Rect rect;
+    Uint32 pixel;
+
+    rect.x = x;
+    rect.y = y;
+    rect.w = rect.h = 1;
+    SDL_RenderReadPixels(&rect, SDL_PIXELFORMAT_ARGB8888, &pixel, 4);
+    return pixel & 0xFFFFFF;
+}
+
+static int
+bench_primitives(void)
+{
+    SDL_Window *window;
+    SDL_Rect rect;
+    SDL_Point points[4];
+    Uint64 start, cpu, busy = 0, total = 0;
+    int i, j, ok = 1;
+
+    window = SDL_CreateWindow("testpsl1ghthost", 0, 0, 1920, 1080,
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN);
+    if (!window || SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_PRESENTFLIP3) < 0) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    /* One of each, checked where the CPU renderer would have drawn */
+    SDL_SetRenderDrawBlendMode(SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(0, 0, 0, 255);
+    SDL_RenderClear();
+    SDL_SetRenderDrawColor(255, 0, 0, 255);
+    rect.x = 10;
+    rect.y = 10;
+    rect.w = 20;
+    rect.h = 10;
+    SDL_RenderDrawRect(&rect);
+    SDL_SetRenderDrawColor(0, 255, 0, 255);
+    SDL_RenderDrawLine(100, 50, 100, 40);
+    SDL_RenderDrawPoint(200, 200);
+    SDL_SetRenderDrawBlendMode(SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(0, 0, 255, 128);
+    rect.x = 300;
+    SDL_RenderFillRect(&rect);
+    if (read_pixel(10, 10) != 0xFF0000 || read_pixel(29, 19) != 0xFF0000 ||
+        read_pixel(20, 15) != 0 || read_pixel(30, 10) != 0 ||
+        read_pixel(100, 40) != 0x00FF00 || read_pixel(100, 39) != 0 ||
+        read_pixel(200, 200) != 0x00FF00 ||
+        (read_pixel(305, 15) & 0xFF) < 127 ||
+        (read_pixel(305, 15) & 0xFF) > 129) {
+        ok = 0;
+    }
+    SDL_RenderPresent();
+    printf("video_primitives_check %d\n", ok);
+
+    /* Frames of small rects and outlines in a couple of colours */
+    SDL_SetRenderDrawBlendMode(SDL_BLENDMODE_NONE);
+    for (i = 0; i < frames; ++i) {
+        start = now_usec();
+        cpu = cpu_usec();
+        SDL_SetRenderDrawColor(0, 0, 0, 255);
+        SDL_RenderClear();
+        for (j = 0; j < primitives; ++j) {
+            rect.x = (j * 37 + i) % 1900;
+            rect.y = (j * 53) % 1060;
+            rect.w = rect.h = 16;
+            SDL_SetRenderDrawColor(255, (j / 500) * 64, 0, 255);
+            if (j & 1) {
+                SDL_RenderFillRect(&rect);
+            } else {
+                points[0].x = points[3].x = rect.x;
+                points[0].y = points[1].y = rect.y;
+                points[1].x = points[2].x = rect.x + 15;
+                points[2].y = points[3].y = rect.y + 15;
+                SDL_RenderDrawLines(points, 4);
+            }
+        }
+        SDL_RenderPresent();
+        busy += cpu_usec() - cpu;
+        total += now_usec() - start;
+    }
+    printf("video_primitives_per_frame %d\n", primitives);
+    printf("video_primitives_cpu_avg_usec %llu\n",
+           (unsigned long long) (busy / frames));
+    printf("video_primitives_avg_usec %llu\n",
+           (unsigned long long) (total / frames));
+
+    SDL_DestroyWindow(window);
+    return 0;
+}
+
+/* Colour the display is scanning out at (x, y), once the RSX is idle */
+static Uint32
+scanout_pixel(int x, int y)
+{
+    void *pixels;
+    u32 pitch, width, height;
+
+    SDL_Delay(50);
+    psl1ghtHostWaitRSXIdle();
+    if (psl1ghtHostGetDisplayBuffer(&pixels, &pitch, &width, &height) < 0 ||
+        x >= (int) width || y >= (int) height) {
+        return 0xFFFFFFFF;
+    }
+    return ((Uint32 *) ((Uint8 *) pixels + y * pitch))[x] & 0xFFFFFF;
+}
+
+/* Fill bound frames: a clear and a stack of large translucent rects */
+static Uint64
+fill_frames(int w, int h)
+{
+    SDL_Rect rect;
+    Uint64 start;
+    int i, j;
+
+    start = now_usec();
+    for (i = 0; i < frames; ++i) {
+        SDL_SetRenderDrawBlendMode(SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(0, 0, 0, 255);
+        SDL_RenderClear();
+        SDL_SetRenderDrawBlendMode(SDL_BLENDMODE_BLEND);
+        for (j = 0; j < 8; ++j) {
+            rect.x = (j * w) / 16;
+            rect.y = (j * h) / 16;
+            rect.w = w / 2;
+            rect.h = h / 2;
+            SDL_SetRenderDrawColor(j * 32, 255 - j * 32, i & 0xFF, 128);
+            SDL_RenderFillRect(&rect);
+        }
+        SDL_RenderPresent();
+    }
+    psl1ghtHostWaitRSXIdle();
+    return (now_usec() - start) / frames;
+}
+
+static int
+bench_logical(void)
+{
+    SDL_Window *window;
+    SDL_DisplayMode mode;
+    SDL_Rect rect;
+    Uint64 start, native, logical, modeswitch;
+    int ok;
+
+    /* The same frames at display size and at 720p scaled by the RSX */
+    window = SDL_CreateWindow("testpsl1ghthost", 0, 0, 1920, 1080,
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN);
+    if (!window || SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_PRESENTFLIP3) < 0) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+    native = fill_frames(1920, 1080);
+    SDL_DestroyWindow(window);
+
+    window = SDL_CreateWindow("testpsl1ghthost", 0, 0, 1280, 720,
+                              SDL_WINDOW_SHOWN);
+    if (!window || SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_PRESENTFLIP3) < 0) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+    logical = fill_frames(1280, 720);
+
+    /* Red top left quarter of the logical screen, blue elsewhere */
+    SDL_SetRenderDrawBlendMode(SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(0, 0, 255, 255);
+    SDL_RenderClear();
+    SDL_SetRenderDrawColor(255, 0, 0, 255);
+    rect.x = rect.y = 0;
+    rect.w = 640;
+    rect.h = 360;
+    SDL_RenderFillRect(&rect);
+    SDL_RenderPresent();
+    ok = scanout_pixel(100, 100) == 0xFF0000 &&
+        scanout_pixel(1800, 1000) == 0x0000FF &&
+        scanout_pixel(900, 500) == 0xFF0000 &&
+        scanout_pixel(1000, 560) == 0x0000FF;
+    SDL_DestroyWindow(window);
+
+    /* A fullscreen 720p window gets the 720p mode from ps3fb_modedb */
+    start = now_usec();
+    window = SDL_CreateWindow("testpsl1ghthost", 0, 0, 1280, 720,
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN);
+    modeswitch = now_usec() - start;
+    if (!window || SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_PRESENTFLIP2) < 0) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+    SDL_GetCurrentDisplayMode(&mode);
+    SDL_SetRenderDrawColor(0, 255, 0, 255);
+    SDL_RenderClear();
+    SDL_RenderPresent();
+    ok = ok && mode.w == 1280 && mode.h == 720 &&
+        scanout_pixel(1279, 719) == 0x00FF00 &&
+        scanout_pixel(1280, 0) == 0xFFFFFFFF;
+    SDL_DestroyWindow(window);
+
+    printf("video_logical_check %d\n", ok);
+    printf("video_logical_native_avg_usec %llu\n",
+           (unsigned long long) native);
+    printf("video_logical_720p_avg_usec %llu\n",
+           (unsigned long long) logical);
+    printf("video_mode_switch_usec %llu\n", (unsigned long long) modeswitch);
+    return 0;
+}
+
+/* Fill a YUV texture: grey on the left half, red on the right half */
+static void
+fill_yuv(SDL_Texture * texture, Uint32 format, int w, int h, Uint8 * pixels)
+{
+    int x, y, red, pitch = w;
+    Uint8 *lum = pixels, *u, *v;
+
+    if (format == SDL_PIXELFORMAT_YUY2) {
+        pitch = w * 2;
+        for (y = 0; y < h; ++y) {
+            for (x = 0; x < w; x += 2) {
+                red = x >= w / 2;
+                lum[y * pitch + x * 2] = red ? 81 : 200;
+                lum[y * pitch + x * 2 + 1] = red ? 90 : 128;
+                lum[y * pitch + x * 2 + 2] = red ? 81 : 200;
+                lum[y * pitch + x * 2 + 3] = red ? 240 : 128;
+            }
+        }
+    } else {
+        u = pixels + w * h;
+        v = u + (w / 2) * (h / 2);
+        if (format == SDL_PIXELFORMAT_YV12) {
+            v = u;
+            u = v + (w / 2) * (h / 2);
+        }
+        for (y = 0; y < h; ++y) {
+            for (x = 0; x < w; ++x) {
+                lum[y * w + x] = x >= w / 2 ? 81 : 200;
+                if (!(x & 1) && !(y & 1)) {
+                    u[(y / 2) * (w / 2) + x / 2] = x >= w / 2 ? 90 : 128;
+                    v[(y / 2) * (w / 2) + x / 2] = x >= w / 2 ? 240 : 128;
+                }
+            }
+        }
+    }
+    SDL_UpdateTexture(texture, NULL, pixels, pitch);
+}
+
+/* Within 2 of what SDL_yuv_sw.c makes of Y, U and V */
+static int
+yuv_matches(Uint32 pixel, int y, int u, int v)
+{
+    int r = y + (int) ((0.419 / 0.299) * (v - 128));
+    int g = y - (int) ((0.299 / 0.419) * (v - 128)) -
+        (int) ((0.114 / 0.331) * (u - 128));
+    int b = y + (int) ((0.587 / 0.331) * (u - 128));
+
+    r = r < 0 ? 0 : (r > 255 ? 255 : r);
+    g = g < 0 ? 0 : (g > 255 ? 255 : g);
+    b = b < 0 ? 0 : (b > 255 ? 255 : b);
+    return abs((int) ((pixel >> 16) & 0xFF) - r) <= 2 &&
+        abs((int) ((pixel >> 8) & 0xFF) - g) <= 2 &&
+        abs((int) (pixel & 0xFF) - b) <= 2;
+}
+
+static int
+bench_yuv(void)
+{
+    static const Uint32 formats[] = {
+        SDL_PIXELFORMAT_YV12, SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_YUY2
+    };
+    SDL_Window *window;
+    SDL_Texture *texture;
+    SDL_Rect src, dst;
+    psl1ghtHostStats before, after;
+    Uint8 *pixels;
+    Uint64 start, copy = 0, total = 0;
+    int w = 1280, h = 720, i, ok = 1;
+
+    window = SDL_CreateWindow("testpsl1ghthost", 0, 0, 1920, 1080,
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN);
+    if (!window || SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_PRESENTFLIP3) < 0) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+    pixels = (Uint8 *) SDL_malloc(w * h * 2);
+    if (!pixels) {
+        return -1;
+    }
+    psl1ghtHostGetStats(&before);
+    for (i = 0; i < SDL_arraysize(formats); ++i) {
+        texture = SDL_CreateTexture(formats[i], SDL_TEXTUREACCESS_STREAMING,
+                                    w, h);
+        if (!texture) {
+            fprintf(stderr, "Couldn't create texture: %s\n",
+                    SDL_GetError());
+            return -1;
+        }
+        fill_yuv(texture, formats[i], w, h, pixels);
+
+        /* Scaled to the whole screen */
+        SDL_RenderCopy(texture, NULL, NULL);
+        ok = ok && yuv_matches(read_pixel(200, 500), 200, 128, 128) &&
+            yuv_matches(read_pixel(1700, 500), 81, 90, 240);
+
+        /* Clipped, 1:1 and at an odd position over a black screen */
+        SDL_SetRenderDrawColor(0, 0, 0, 255);
+        SDL_RenderClear();
+        src.x = w / 2 - 101;
+        src.y = 33;
+        src.w = dst.w = 201;
+        src.h = dst.h = 100;
+        dst.x = 3;
+        dst.y = 7;
+        SDL_RenderCopy(texture, &src, &dst);
+        ok = ok && read_pixel(2, 50) == 0 && read_pixel(204, 50) == 0 &&
+            read_pixel(50, 6) == 0 && read_pixel(50, 107) == 0 &&
+            yuv_matches(read_pixel(3, 7), 200, 128, 128) &&
+            yuv_matches(read_pixel(203, 106), 81, 90, 240);
+        SDL_RenderPresent();
+        SDL_DestroyTexture(texture);
+    }
+    psl1ghtHostGetStats(&after);
+    printf("video_yuv_check %d\n", ok);
+    printf("video_yuv_spe %d\n", after.spu_dma_bytes != before.spu_dma_bytes);
+
+    /* A 720p video played full screen at 1080p */
+    texture = SDL_CreateTexture(SDL_PIXELFORMAT_YV12,
+                                SDL_TEXTUREACCESS_STREAMING, w, h);
+    fill_yuv(texture, SDL_PIXELFORMAT_YV12, w, h, pixels);
+    for (i = 0; i < frames; ++i) {
+        start = now_usec();
+        SDL_RenderCopy(texture, NULL, NULL);
+        copy += now_usec() - start;
+        SDL_RenderPresent();
+        total += now_usec() - start;
+    }
+    printf("video_yuv_1080p_avg_usec %d\n", (int) (total / frames));
+    printf("video_yuv_1080p_copy_avg_usec %d\n", (int) (copy / frames));
+
+    SDL_free(pixels);
+    SDL_DestroyTexture(texture);
+    SDL_DestroyWindow(window);
+    return 0;
+}
+
+static int
+bench_audio(const char *name, int samples, int channels)
+{
+    SDL_AudioSpec spec;
+
+    audio_callbacks = 0;
+    audio_last = audio_gap_total = audio_gap_max = 0;
+    audio_latency_total = audio_latency_max = 0;
+
+    SDL_zero(spec);
+    spec.freq = 48000;
+    spec.format = AUDIO_F32SYS;
+    spec.channels = channels;
+    spec.samples = samples;
+    spec.callback = fill_audio_latency;
+    if (SDL_OpenAudio(&spec, NULL) < 0) {
+        fprintf(stderr, "Couldn't open audio: %s\n", SDL_GetError());
+        return -1;
+    }
+    SDL_PauseAudio(0);
+    SDL_Delay(1000);
+    SDL_CloseAudio();
+
+    printf("audio_%s_callbacks %d\n", name, audio_callbacks);
+    if (audio_callbacks > 1) {
+        printf("audio_%s_turnaround_avg_usec %llu\n", name,
+               (unsigned long long) (audio_gap_total /
+                                     (audio_callbacks - 1)));
+        printf("audio_%s_turnaround_max_usec %llu\n", name,
+               (unsigned long long) audio_gap_max);
+        printf("audio_%s_latency_avg_usec %llu\n", name,
+               (unsigned long long) (audio_latency_total / audio_callbacks));
+        printf("audio_%s_latency_max_usec %llu\n", name,
+               (unsigned long long) audio_latency_max);
+    }
+    return 0;
+}
+
+/* 44.1kHz has to stream through the resampler to reach the 48kHz port */
+static int
+bench_audio_resampled(void)
+{
+    SDL_AudioSpec spec;
+    psl1ghtHostStats before, after;
+
+    audio_callbacks = audio_bad_len = 0;
+    audio_last = audio_gap_total = audio_gap_max = 0;
+
+    SDL_zero(spec);
+    spec.freq = 44100;
+    spec.format = AUDIO_S16SYS;
+    spec.channels = 2;
+    spec.samples = 1024;
+    spec.callback = fill_audio;
+    if (SDL_OpenAudio(&spec, NULL) < 0) {
+        fprintf(stderr, "Couldn't open audio: %s\n", SDL_GetError());
+        return -1;
+    }
+    audio_expected_len = spec.size;
+    psl1ghtHostGetStats(&before);
+    SDL_PauseAudio(0);
+    SDL_Delay(1000);
+    SDL_CloseAudio();
+    psl1ghtHostGetStats(&after);
+    audio_expected_len = 0;
+
+    printf("audio_resampled_callbacks %d\n", audio_callbacks);
+    printf("audio_resampled_len_check %d\n", audio_bad_len == 0);
+    printf("audio_resampled_blocks %llu\n",
+           (unsigned long long) (after.audio_blocks - before.audio_blocks));
+    return 0;
+}
+
+#define QUEUE_FRAMES 256
+
+static float queue_block[QUEUE_FRAMES * 2];
+
+/* Copies the block the game thread last handed over under the lock */
+static void SDLCALL
+fill_audio_locked(void *userdata, Uint8 * stream, int len)
+{
+    SDL_memcpy(stream, queue_block, SDL_min(len, (int) sizeof(queue_block)));
+    fill_audio(userdata, stream, len);
+}
+
+/* A game thread handing the audio thread a block every millisecond, by
+   queueing it and then under SDL_LockAudio(); times how long it waits */
+static int
+bench_audio_queued(void)
+{
+    SDL_AudioSpec spec;
+    psl1ghtHostStats before, after;
+    Uint64 start, wait, wait_total, wait_max;
+    Uint32 pushed = 0, left;
+    int pass, handoffs, ret;
+
+    for (pass = 0; pass < 2; ++pass) {
+        const char *name = pass ? "locked" : "queued";
+
+        audio_callbacks = 0;
+        audio_last = audio_gap_total = audio_gap_max = 0;
+
+        SDL_zero(spec);
+        spec.freq = 48000;
+        spec.format = AUDIO_F32SYS;
+        spec.channels = 2;
+        spec.samples = QUEUE_FRAMES;
+        spec.callback = pass ? fill_audio_locked : NULL;
+        if (SDL_OpenAudio(&spec, NULL) < 0) {
+            fprintf(stderr, "Couldn't open audio: %s\n", SDL_GetError());
+            return -1;
+        }
+        psl1ghtHostGetStats(&before);
+        SDL_PauseAudio(0);
+
+        handoffs = 0;
+        wait_total = wait_max = 0;
+        start = now_usec();
+        while (now_usec() - start < 1000000) {
+            if (pass) {
+                wait = now_usec();
+                SDL_LockAudio();
+                wait = now_usec() - wait;
+                SDL_memset(queue_block, 0, sizeof(queue_block));
+                SDL_UnlockAudio();
+            } else if (SDL_GetQueuedAudioSize(1) < 4 * sizeof(queue_block)) {
+                wait = now_usec();
+                ret = SDL_QueueAudio(1, queue_block, sizeof(queue_block));
+                wait = now_usec() - wait;
+                pushed += (Uint32) SDL_max(ret, 0);
+            } else {
+                SDL_Delay(1);
+                continue;
+            }
+            ++handoffs;
+            wait_total += wait;
+            if (wait > wait_max) {
+                wait_max = wait;
+            }
+            SDL_Delay(1);
+        }
+
+        left = SDL_GetQueuedAudioSize(1);
+        SDL_CloseAudio();
+        psl1ghtHostGetStats(&after);
+
+        printf("audio_%s_handoffs %d\n", name, handoffs);
+        if (handoffs) {
+            printf("audio_%s_wait_avg_usec %llu\n", name,
+                   (unsigned long long) (wait_total / handoffs));
+            printf("audio_%s_wait_max_usec %llu\n", name,
+                   (unsigned long long) wait_max);
+        }
+        if (!pass) {
+            printf("audio_queued_bytes_played %u\n", pushed - left);
+        }
+        printf("audio_%s_blocks %llu\n", name,
+               (unsigned long long) (after.audio_blocks - before.audio_blocks));
+    }
+    return 0;
+}
+
+static int
+bench_joystick(void)
+{
+    SDL_Event events[128];
+    SDL_Joystick *joystick = NULL;
+    PadData data;
+    Uint64 start, elapsed;
+    int i, port, count, total = 0, check;
+
+    for (port = 0; port < numpads && port < SDL_NumJoysticks(); ++port) {
+        SDL_Joystick *opened = SDL_JoystickOpen(port);
+        if (port == 0) {
+            joystick = opened;
+        }
+    }
+
+    /* Resting pads, as they are when nobody touches them */
+    SDL_zero(data);
+    data.ANA_L_H = data.ANA_L_V = data.ANA_R_H = data.ANA_R_V = 0x80;
+    data.SENSOR_X = data.SENSOR_Y = data.SENSOR_Z = data.SENSOR_G = 512;
+    start = now_usec();
+    for (i = 0; i < pad_iterations; ++i) {
+        /* Analog noise on every pad, as a resting stick would produce */
+        for (port = 0; port < numpads; ++port) {
+            data.ANA_L_H = 0x80 + (rand() % 5) - 2;
+            data.ANA_L_V = 0x80 + (rand() % 5) - 2;
+            data.SENSOR_X = 512 + (rand() % 5) - 2;
+            data.BTN_CROSS = (i & 64) ? 1 : 0;
+            psl1ghtHostSetPadData(port, &data);
+        }
+        SDL_JoystickUpdate();
+        count = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT,
+                               SDL_JOYAXISMOTION, SDL_JOYBUTTONUP);
+        if (count > 0) {
+            total += count;
+        }
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    }
+    elapsed = now_usec() - start;
+
+    /* A pressed button and its pressure reach the application */
+    check = 0;
+    if (joystick) {
+        data.BTN_CROSS = 1;
+        data.PRE_CROSS = 255;
+        psl1ghtHostSetPadData(0, &data);
+        SDL_JoystickUpdate();
+        check = SDL_JoystickNumAxes(joystick) == 20 &&
+            SDL_JoystickGetButton(joystick, 9) == 1 &&
+            SDL_JoystickGetAxis(joystick, 10) == 32767 &&
+            SDL_JoystickGetAxis(joystick, 0) == 0;
+        data.BTN_CROSS = 0;
+        data.PRE_CROSS = 0;
+        psl1ghtHostSetPadData(0, &data);
+        SDL_JoystickUpdate();
+        check = check && SDL_JoystickGetButton(joystick, 9) == 0 &&
+            SDL_JoystickGetAxis(joystick, 10) == 0;
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    }
+
+    printf("pad_count %d\n", SDL_NumJoysticks());
+    printf("pad_polls %d\n", pad_iterations);
+    printf("pad_poll_avg_nsec %llu\n",
+           (unsigned long long) (elapsed * 1000 / pad_iterations));
+    printf("pad_events %d\n", total);
+    printf("pad_check %d\n", check);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    psl1ghtHostStats stats;
+
+    if (argc > 1) {
+        frames = atoi(argv[1]);
+        if (frames <= 0) {
+            frames = 120;
+        }
+    }
+
+    /* The pads have to be there when the joystick driver enumerates them */
+    psl1ghtHostSetPadCount(numpads);
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_JOYSTICK) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (bench_video("flip2", SDL_RENDERER_PRESENTFLIP2 |
+                    SDL_RENDERER_PRESENTVSYNC) < 0 ||
+        bench_video("flip3", SDL_RENDERER_PRESENTFLIP3 |
+                    SDL_RENDERER_PRESENTVSYNC) < 0 ||
+        bench_video("novsync", SDL_RENDERER_PRESENTFLIP2) < 0 ||
+        bench_texture() < 0 || bench_primitives() < 0 ||
+        bench_logical() < 0 || bench_yuv() < 0 ||
+        bench_audio("short", 256, 2) < 0 || bench_audio("deep", 2048, 2) < 0 ||
+        bench_audio("surround", 256, 6) < 0 ||
+        bench_audio_resampled() < 0 || bench_audio_queued() < 0 ||
+        bench_joystick() < 0) {
+        SDL_Quit();
+        return 1;
+    }
+
+    psl1ghtHostGetStats(&stats);
+    printf("host_vblanks %llu\n", (unsigned long long) stats.vblanks);
+    printf("host_flips %llu\n", (unsigned long long) stats.flips);
+    if (stats.flips) {
+        printf("host_flip_wait_avg_usec %llu\n",
+               (unsigned long long) (stats.flip_wait_usec / stats.flips));
+    }
+    printf("host_rsx_commands %llu\n",
+           (unsigned long long) stats.rsx_commands);
+    printf("host_audio_blocks %llu\n",
+           (unsigned long long) stats.audio_blocks);
+    printf("host_pad_reads %llu\n", (unsigned long long) stats.pad_reads);
+    printf("host_spu_dma_bytes %llu\n",
+           (unsigned long long) stats.spu_dma_bytes);
+
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,254 @@
+/*
+ * Benchmarks SDL_ConvertAudio() rate conversion with each resampler.
+ *
+ * For every rate pair and format this converts one second of a stereo sine
+ * wave over and over, then prints how many seconds of audio were resampled
+ * per second of CPU time, and the signal to noise ratio of the result
+ * against an ideal sine at the new rate.
+ *
+ * It then times some whole conversions (format, channels and rate at once)
+ * on a long buffer, with the usual chain of filters and with the fused
+ * single pass converter.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "SDL.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TONE_HZ 997.0
+#define TONE_AMPLITUDE 0.5
+
+static int testMilliseconds = 500;
+
+static const char *resamplers[] = { "legacy", "linear", "fast", "best" };
+
+static const int rates[][2] = {
+    {22050, 44100},
+    {44100, 48000},
+    {48000, 44100},
+    {11025, 48000},
+    {48000, 32000}
+};
+
+static void
+fill_tone(SDL_AudioFormat format, Uint8 * buf, int frames, int rate)
+{
+    int i;
+
+    for (i = 0; i < frames; ++i) {
+        const double v = TONE_AMPLITUDE * sin(2.0 * M_PI * TONE_HZ * i / rate);
+        if (format == AUDIO_F32SYS) {
+            ((float *) buf)[i * 2] = ((float *) buf)[i * 2 + 1] = (float) v;
+        } else {
+            ((Sint16 *) buf)[i * 2] = ((Sint16 *) buf)[i * 2 + 1] =
+                (Sint16) (v * 32767.0);
+        }
+    }
+}
+
+/* Left channel only; the first and last 64 frames are edge effects */
+static double
+tone_snr(SDL_AudioFormat format, const Uint8 * buf, int frames, int rate)
+{
+    double signal = 0.0;
+    double noise = 0.0;
+    int i;
+
+    for (i = 64; i < frames - 64; ++i) {
+        const double want =
+            TONE_AMPLITUDE * sin(2.0 * M_PI * TONE_HZ * i / rate);
+        double got;
+        if (format == AUDIO_F32SYS) {
+            got = ((const float *) buf)[i * 2];
+        } else {
+            got = ((const Sint16 *) buf)[i * 2] / 32767.0;
+        }
+        signal += want * want;
+        noise += (got - want) * (got - want);
+    }
+    if (noise == 0.0) {
+        return 999.0;
+    }
+    return 10.0 * log10(signal / noise);
+}
+
+static int
+run_test(const char *resampler, SDL_AudioFormat format, int src_rate,
+         int dst_rate)
+{
+    SDL_AudioCVT cvt;
+    const int framesize = (SDL_AUDIO_BITSIZE(format) / 8) * 2;
+    const int len = src_rate * framesize;
+    Uint8 *data;
+    Uint32 start, now;
+    int runs = 0;
+    double snr;
+
+    SDL_setenv("SDL_AUDIO_RESAMPLER", resampler, 1);
+    if (SDL_BuildAudioCVT(&cvt, format, 2, src_rate,
+                          format, 2, dst_rate) < 0) {
+        printf("  %-6s %5d -> %5d: %s\n", resampler, src_rate, dst_rate,
+               SDL_GetError());
+        return 0;
+    }
+
+    data = (Uint8 *) malloc(len);
+    cvt.len = len;
+    cvt.buf = (Uint8 *) malloc(len * cvt.len_mult);
+    if ((data == NULL) || (cvt.buf == NULL)) {
+        fprintf(stderr, "Out of memory.\n");
+        free(data);
+        free(cvt.buf);
+        return -1;
+    }
+    fill_tone(format, data, src_rate, src_rate);
+
+    start = now = SDL_GetTicks();
+    while ((now - start) < (Uint32) testMilliseconds) {
+        memcpy(cvt.buf, data, len);
+        SDL_ConvertAudio(&cvt);
+        ++runs;
+        now = SDL_GetTicks();
+    }
+
+    snr = tone_snr(format, cvt.buf, cvt.len_cvt / framesize, dst_rate);
+    printf("  %-6s %5d -> %5d: %8.1fx realtime, %5.1f dB SNR\n",
+           resampler, src_rate, dst_rate,
+           (runs * 1000.0) / ((now - start) ? (now - start) : 1), snr);
+
+    free(data);
+    free(cvt.buf);
+    return 0;
+}
+
+static const struct
+{
+    SDL_AudioFormat src_fmt;
+    Uint8 src_channels;
+    int src_rate;
+    SDL_AudioFormat dst_fmt;
+    Uint8 dst_channels;
+    int dst_rate;
+    const char *name;
+} chains[] = {
+    {AUDIO_S16SYS, 1, 11025, AUDIO_F32SYS, 2, 48000,
+     "S16 mono 11025 -> F32 stereo 48000"},
+    {AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 48000,
+     "S16 stereo 44100 -> F32 stereo 48000"},
+    {AUDIO_U8, 1, 22050, AUDIO_S16SYS, 2, 44100,
+     "U8 mono 22050 -> S16 stereo 44100"},
+    {AUDIO_F32SYS, 2, 48000, AUDIO_S16SYS, 2, 44100,
+     "F32 stereo 48000 -> S16 stereo 44100"},
+    {AUDIO_S16MSB, 2, 44100, AUDIO_F32SYS, 1, 44100,
+     "S16MSB stereo 44100 -> F32 mono 44100"}
+};
+
+#define CHAIN_SECONDS 30
+
+/* Seconds of audio converted per second, or < 0 on error */
+static double
+run_chain(int i, const char *fused)
+{
+    SDL_AudioCVT cvt;
+    const int len = chains[i].src_rate * CHAIN_SECONDS *
+        (SDL_AUDIO_BITSIZE(chains[i].src_fmt) / 8) * chains[i].src_channels;
+    Uint32 start, now;
+    int runs = 0;
+
+    SDL_setenv("SDL_AUDIO_FUSED", fused, 1);
+    if (SDL_BuildAudioCVT(&cvt, chains[i].src_fmt, chains[i].src_channels,
+                          chains[i].src_rate, chains[i].dst_fmt,
+                          chains[i].dst_channels, chains[i].dst_rate) < 0) {
+        fprintf(stderr, "SDL_BuildAudioCVT() failed: %s\n", SDL_GetError());
+        return -1.0;
+    }
+
+    cvt.len = len;
+    cvt.buf = (Uint8 *) malloc(len * cvt.len_mult);
+    if (cvt.buf == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return -1.0;
+    }
+
+    start = now = SDL_GetTicks();
+    while ((now - start) < (Uint32) testMilliseconds) {
+        /* silence, so the buffer has to be reloaded like real audio */
+        memset(cvt.buf, 0, len);
+        SDL_ConvertAudio(&cvt);
+        ++runs;
+        now = SDL_GetTicks();
+    }
+
+    free(cvt.buf);
+    return (runs * 1000.0 * CHAIN_SECONDS) /
+        ((now - start) ? (now - start) : 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    int i, j;
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--msecs") == 0 && i + 1 < argc) {
+            testMilliseconds = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "USAGE: %s [--msecs n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) == -1) {
+        fprintf(stderr, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    printf("AUDIO_S16SYS stereo:\n");
+    for (i = 0; i < SDL_arraysize(rates); ++i) {
+        for (j = 0; j < SDL_arraysize(resamplers); ++j) {
+            if (run_test(resamplers[j], AUDIO_S16SYS,
+                         rates[i][0], rates[i][1]) < 0) {
+                SDL_Quit();
+                return 3;
+            }
+        }
+    }
+
+    printf("AUDIO_F32SYS stereo:\n");
+    for (i = 0; i < SDL_arraysize(rates); ++i) {
+        for (j = 0; j < SDL_arraysize(resamplers); ++j) {
+            if (run_test(resamplers[j], AUDIO_F32SYS,
+                         rates[i][0], rates[i][1]) < 0) {
+                SDL_Quit();
+                return 3;
+            }
+        }
+    }
+
+    /* the rates above are reused, so no more resampler tables are built */
+    for (j = 1; j < SDL_arraysize(resamplers); ++j) {
+        SDL_setenv("SDL_AUDIO_RESAMPLER", resamplers[j], 1);
+        printf("Whole conversions, %s resampler, %d second buffer:\n",
+               resamplers[j], CHAIN_SECONDS);
+        for (i = 0; i < SDL_arraysize(chains); ++i) {
+            const double chained = run_chain(i, "0");
+            const double fused = (chained < 0.0) ? -1.0 : run_chain(i, "1");
+            if (fused < 0.0) {
+                SDL_Quit();
+                return 3;
+            }
+            printf("  %-38s chain %7.1fx, fused %7.1fx realtime, %5.2fx\n",
+                   chains[i].name, chained, fused, fused / chained);
+        }
+    }
+
+    SDL_Quit();
+    return 0;
+}
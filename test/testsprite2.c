@@ -75,6 +75,23 @@ LoadSprite(char *file)
         }
     }
 
+    if (blendMode == SDL_BLENDMODE_PREMULTIPLIED) {
+        /* Key the sprite out into an alpha channel, and premultiply it
+           once here instead of on every blend */
+        SDL_Surface *sprite = SDL_CreateRGBSurface(0, temp->w, temp->h, 32,
+                                                   0x00FF0000, 0x0000FF00,
+                                                   0x000000FF, 0xFF000000);
+        if (sprite == NULL) {
+            fprintf(stderr, "Couldn't create sprite: %s\n", SDL_GetError());
+            SDL_FreeSurface(temp);
+            return (-1);
+        }
+        SDL_BlitSurface(temp, NULL, sprite, NULL);
+        SDL_FreeSurface(temp);
+        temp = sprite;
+        SDL_PremultiplySurfaceAlpha(temp);
+    }
+
     /* Create textures from the image */
     for (i = 0; i < state->num_windows; ++i) {
         SDL_SelectRenderer(state->windows[i]);
@@ -251,6 +268,9 @@ main(int argc, char *argv[])
                     } else if (SDL_strcasecmp(argv[i + 1], "mod") == 0) {
                         blendMode = SDL_BLENDMODE_MOD;
                         consumed = 2;
+                    } else if (SDL_strcasecmp(argv[i + 1], "premultiplied") == 0) {
+                        blendMode = SDL_BLENDMODE_PREMULTIPLIED;
+                        consumed = 2;
                     }
                 }
             } else if (SDL_strcasecmp(argv[i], "--scale") == 0) {
@@ -282,7 +302,7 @@ main(int argc, char *argv[])
         }
         if (consumed < 0) {
             fprintf(stderr,
-                    "Usage: %s %s [--blend none|mask|blend|add|mod] [--scale none|fast|slow|best] [--cyclecolor] [--cyclealpha]\n",
+                    "Usage: %s %s [--blend none|mask|blend|add|mod|premultiplied] [--scale none|fast|slow|best] [--cyclecolor] [--cyclealpha]\n",
                     argv[0], CommonUsage(state));
             quit(1);
         }
@@ -0,0 +1,151 @@
+/*
+ * Benchmarks SDL_ConvertAudio() sample type conversion.
+ *
+ * For every format pair this converts one second of 48kHz stereo noise
+ * over and over, once with the autogenerated converters (by setting
+ * SDL_AUDIO_CPU_FEATURES to 0) and once with whatever SDL picks for this
+ * CPU (an empty override), then prints how many seconds of audio were converted per second of
+ * CPU time, the speedup, and whether both produced the same samples.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#define TEST_RATE 48000
+#define TEST_SAMPLES (TEST_RATE * 2)
+
+static int testMilliseconds = 500;
+
+static const struct
+{
+    SDL_AudioFormat src;
+    SDL_AudioFormat dst;
+    const char *name;
+} pairs[] = {
+    {AUDIO_S16LSB, AUDIO_F32LSB, "S16LSB -> F32LSB"},
+    {AUDIO_S16LSB, AUDIO_F32MSB, "S16LSB -> F32MSB"},
+    {AUDIO_S16MSB, AUDIO_F32MSB, "S16MSB -> F32MSB"},
+    {AUDIO_F32LSB, AUDIO_S16LSB, "F32LSB -> S16LSB"},
+    {AUDIO_F32MSB, AUDIO_S16MSB, "F32MSB -> S16MSB"},
+    {AUDIO_S32LSB, AUDIO_F32LSB, "S32LSB -> F32LSB"},
+    {AUDIO_F32LSB, AUDIO_S32LSB, "F32LSB -> S32LSB"},
+    {AUDIO_U8, AUDIO_F32SYS, "U8     -> F32SYS"},
+    {AUDIO_S16LSB, AUDIO_S16MSB, "S16LSB -> S16MSB"},
+    {AUDIO_F32LSB, AUDIO_F32MSB, "F32LSB -> F32MSB"}
+};
+
+/* Samples in range for the source format, so every converter agrees */
+static void
+fill_noise(SDL_AudioFormat format, Uint8 * buf, int samples)
+{
+    int i;
+
+    srand(0);
+    for (i = 0; i < samples; ++i) {
+        if (SDL_AUDIO_ISFLOAT(format)) {
+            float v = ((rand() % 65535) - 32767) / 32768.0f;
+            v = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapFloatBE(v) :
+                SDL_SwapFloatLE(v);
+            memcpy(buf + i * sizeof(float), &v, sizeof(float));
+        } else {
+            const int bytes = SDL_AUDIO_BITSIZE(format) / 8;
+            int j;
+            for (j = 0; j < bytes; ++j) {
+                buf[i * bytes + j] = (Uint8) rand();
+            }
+        }
+    }
+}
+
+/* Returns seconds of audio converted per second, or < 0 on error */
+static double
+run_test(const char *features, SDL_AudioFormat src, SDL_AudioFormat dst,
+         Uint8 ** result, int *result_len)
+{
+    SDL_AudioCVT cvt;
+    const int len = TEST_SAMPLES * (SDL_AUDIO_BITSIZE(src) / 8);
+    Uint8 *data;
+    Uint32 start, now;
+    int runs = 0;
+
+    SDL_setenv("SDL_AUDIO_CPU_FEATURES", features, 1);
+    if (SDL_BuildAudioCVT(&cvt, src, 2, TEST_RATE, dst, 2, TEST_RATE) < 0) {
+        fprintf(stderr, "SDL_BuildAudioCVT() failed: %s\n", SDL_GetError());
+        return -1.0;
+    }
+
+    data = (Uint8 *) malloc(len);
+    cvt.len = len;
+    cvt.buf = (Uint8 *) malloc(len * cvt.len_mult);
+    if ((data == NULL) || (cvt.buf == NULL)) {
+        fprintf(stderr, "Out of memory.\n");
+        free(data);
+        free(cvt.buf);
+        return -1.0;
+    }
+    fill_noise(src, data, TEST_SAMPLES);
+
+    start = now = SDL_GetTicks();
+    while ((now - start) < (Uint32) testMilliseconds) {
+        memcpy(cvt.buf, data, len);
+        SDL_ConvertAudio(&cvt);
+        ++runs;
+        now = SDL_GetTicks();
+    }
+
+    free(data);
+    *result = cvt.buf;
+    *result_len = cvt.len_cvt;
+    return (runs * 1000.0) / ((now - start) ? (now - start) : 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    int i;
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--msecs") == 0 && i + 1 < argc) {
+            testMilliseconds = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "USAGE: %s [--msecs n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) == -1) {
+        fprintf(stderr, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    printf("48kHz stereo, seconds converted per second:\n");
+    for (i = 0; i < SDL_arraysize(pairs); ++i) {
+        Uint8 *generic_buf, *tuned_buf;
+        int generic_len, tuned_len;
+        const double generic = run_test("0", pairs[i].src, pairs[i].dst,
+                                        &generic_buf, &generic_len);
+        const double tuned = (generic < 0.0) ? -1.0 :
+            run_test("", pairs[i].src, pairs[i].dst,
+                     &tuned_buf, &tuned_len);
+        if (tuned < 0.0) {
+            if (generic >= 0.0) {
+                free(generic_buf);
+            }
+            SDL_Quit();
+            return 3;
+        }
+        printf("  %s: generic %8.1fx, tuned %8.1fx, %5.2f times faster, %s\n",
+               pairs[i].name, generic, tuned, tuned / generic,
+               ((generic_len == tuned_len) &&
+                (memcmp(generic_buf, tuned_buf, tuned_len) == 0)) ?
+               "same output" : "OUTPUT DIFFERS");
+        free(generic_buf);
+        free(tuned_buf);
+    }
+
+    SDL_Quit();
+    return 0;
+}